@@ -0,0 +1,615 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : AABBTree.cpp 
+// Description : AABBTree Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "AABBTree.h"
+#include "TraversalStack.h"
+#include <queue>
+
+namespace
+{
+	/// <summary>
+	/// Returns true if the AABB is fully outside any plane of the frustum.
+	/// Sets _isFullyInside if every corner is inside all planes.
+	/// </summary>
+	bool IsOutsideFrustum(const Frustum& _frustum, const AABB& _aabb, bool& _isFullyInside)
+	{
+		_isFullyInside = true;
+		for (const glm::vec4& plane : _frustum.Planes)
+		{
+			glm::vec3 normal{ plane };
+
+			// Corner furthest along the plane normal
+			glm::vec3 positive{
+				normal.x >= 0 ? _aabb.Max.x : _aabb.Min.x,
+				normal.y >= 0 ? _aabb.Max.y : _aabb.Min.y,
+				normal.z >= 0 ? _aabb.Max.z : _aabb.Min.z };
+			if (glm::dot(normal, positive) + plane.w < 0)
+				return true;
+
+			// Corner furthest against the plane normal
+			glm::vec3 negative{
+				normal.x >= 0 ? _aabb.Min.x : _aabb.Max.x,
+				normal.y >= 0 ? _aabb.Min.y : _aabb.Max.y,
+				normal.z >= 0 ? _aabb.Min.z : _aabb.Max.z };
+			if (glm::dot(normal, negative) + plane.w < 0)
+				_isFullyInside = false;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Slab test. Returns true if the ray enters the AABB before _maxDistance.
+	/// </summary>
+	bool RayIntersectsAABB(const glm::vec3& _origin, const glm::vec3& _inverseDirection, float _maxDistance, const AABB& _aabb)
+	{
+		glm::vec3 t1 = (_aabb.Min - _origin) * _inverseDirection;
+		glm::vec3 t2 = (_aabb.Max - _origin) * _inverseDirection;
+		glm::vec3 tMin = glm::min(t1, t2);
+		glm::vec3 tMax = glm::max(t1, t2);
+		float entry = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+		float exit = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, _maxDistance));
+		return entry <= exit;
+	}
+}
+
+AABBTree::AABBTree(float _fatMargin, float _displacementMultiplier)
+{
+	m_FatMargin = _fatMargin;
+	m_DisplacementMultiplier = _displacementMultiplier;
+	m_Nodes.reserve(64);
+}
+
+AABBTree::~AABBTree()
+{
+	m_Nodes.clear();
+}
+
+int AABBTree::CreateProxy(const AABB& _bounds, void* _userData)
+{
+	int proxyID = AllocateNode();
+
+	// Fatten the AABB
+	glm::vec3 margin{ m_FatMargin, m_FatMargin, m_FatMargin };
+	m_Nodes[proxyID].Bounds = AABB{ _bounds.Min - margin, _bounds.Max + margin };
+	m_Nodes[proxyID].UserData = _userData;
+	m_Nodes[proxyID].Height = 0;
+
+	InsertLeaf(proxyID);
+	m_ProxyCount++;
+
+	return proxyID;
+}
+
+void AABBTree::DestroyProxy(int _proxyID)
+{
+	if (_proxyID < 0 || _proxyID >= (int)m_Nodes.size() || !m_Nodes[_proxyID].IsLeaf())
+		return;
+
+	// Free nodes also look like leaves, destroying one again would unlink it from the free list a second time
+	if (m_Nodes[_proxyID].Height == -1)
+	{
+		Print("AABBTree proxy " + std::to_string(_proxyID) + " was destroyed twice");
+		return;
+	}
+
+	RemoveLeaf(_proxyID);
+	FreeNode(_proxyID);
+	m_ProxyCount--;
+}
+
+bool AABBTree::MoveProxy(int _proxyID, const AABB& _bounds, const glm::vec3& _displacement)
+{
+	AABBTreeNode& node = m_Nodes[_proxyID];
+
+	// Fat AABB that would be given to the proxy if it were re-inserted
+	glm::vec3 margin{ m_FatMargin, m_FatMargin, m_FatMargin };
+	AABB fatAABB{ _bounds.Min - margin, _bounds.Max + margin };
+
+	// Predict movement by extending the AABB in the direction of travel
+	glm::vec3 prediction = _displacement * m_DisplacementMultiplier;
+	fatAABB.Min += glm::min(prediction, glm::vec3{ 0,0,0 });
+	fatAABB.Max += glm::max(prediction, glm::vec3{ 0,0,0 });
+
+	if (ContainsAABB(node.Bounds, _bounds))
+	{
+		// Still inside the fat AABB, but re-insert if it has become far too large
+		// (e.g. the object was moving fast and has now stopped)
+		glm::vec3 hugeMargin = margin * 4.0f;
+		AABB hugeAABB{ fatAABB.Min - hugeMargin, fatAABB.Max + hugeMargin };
+		if (ContainsAABB(hugeAABB, node.Bounds))
+			return false;
+	}
+
+	RemoveLeaf(_proxyID);
+	m_Nodes[_proxyID].Bounds = fatAABB;
+	InsertLeaf(_proxyID);
+
+	return true;
+}
+
+void* AABBTree::GetUserData(int _proxyID) const
+{
+	return m_Nodes[_proxyID].UserData;
+}
+
+const AABB& AABBTree::GetFatAABB(int _proxyID) const
+{
+	return m_Nodes[_proxyID].Bounds;
+}
+
+void AABBTree::QueryFrustum(const Frustum& _frustum, std::vector<int>& _results) const
+{
+	if (m_Root == NullNode)
+		return;
+
+	TraversalStack stack{};
+	stack.Push(m_Root);
+
+	while (!stack.IsEmpty())
+	{
+		int nodeID = stack.Pop();
+		const AABBTreeNode& node = m_Nodes[nodeID];
+
+		bool isFullyInside = false;
+		if (IsOutsideFrustum(_frustum, node.Bounds, isFullyInside))
+			continue;
+
+		// Everything below a node that is fully inside is also visible, skip the plane tests
+		if (isFullyInside || node.IsLeaf())
+		{
+			CollectLeaves(nodeID, _results);
+			continue;
+		}
+
+		stack.Push(node.Child1);
+		stack.Push(node.Child2);
+	}
+}
+
+void AABBTree::QueryAABB(const AABB& _bounds, std::vector<int>& _results) const
+{
+	if (m_Root == NullNode)
+		return;
+
+	TraversalStack stack{};
+	stack.Push(m_Root);
+
+	while (!stack.IsEmpty())
+	{
+		int nodeID = stack.Pop();
+		const AABBTreeNode& node = m_Nodes[nodeID];
+		if (!OverlapsAABB(node.Bounds, _bounds))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			_results.push_back(nodeID);
+		}
+		else
+		{
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+}
+
+void AABBTree::QuerySphere(const glm::vec3& _centre, float _radius, std::vector<int>& _results) const
+{
+	if (m_Root == NullNode)
+		return;
+
+	float radiusSquared = _radius * _radius;
+
+	TraversalStack stack{};
+	stack.Push(m_Root);
+
+	while (!stack.IsEmpty())
+	{
+		int nodeID = stack.Pop();
+		const AABBTreeNode& node = m_Nodes[nodeID];
+		if (DistanceSquaredToAABB(node.Bounds, _centre) > radiusSquared)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			_results.push_back(nodeID);
+		}
+		else
+		{
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+}
+
+void AABBTree::QueryKNearest(const glm::vec3& _point, int _k, std::vector<int>& _results) const
+{
+	if (m_Root == NullNode || _k <= 0)
+		return;
+
+	using Entry = std::pair<float, int>;
+
+	// Nodes still to visit, closest first
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> toVisit;
+	// Best leaves found so far, furthest on top so it can be replaced
+	std::priority_queue<Entry> best;
+
+	toVisit.push({ DistanceSquaredToAABB(m_Nodes[m_Root].Bounds, _point), m_Root });
+	while (!toVisit.empty())
+	{
+		Entry current = toVisit.top();
+		toVisit.pop();
+
+		// Nothing left can beat the current k'th best
+		if ((int)best.size() == _k && current.first >= best.top().first)
+			break;
+
+		const AABBTreeNode& node = m_Nodes[current.second];
+		if (node.IsLeaf())
+		{
+			best.push(current);
+			if ((int)best.size() > _k)
+				best.pop();
+			continue;
+		}
+
+		toVisit.push({ DistanceSquaredToAABB(m_Nodes[node.Child1].Bounds, _point), node.Child1 });
+		toVisit.push({ DistanceSquaredToAABB(m_Nodes[node.Child2].Bounds, _point), node.Child2 });
+	}
+
+	// Output nearest first
+	size_t start = _results.size();
+	_results.resize(start + best.size());
+	for (size_t i = _results.size(); i > start; i--)
+	{
+		_results[i - 1] = best.top().second;
+		best.pop();
+	}
+}
+
+void AABBTree::RayCast(const Ray& _ray, const std::function<float(int _proxyID, const Ray& _ray)>& _callback) const
+{
+	if (m_Root == NullNode || !_callback)
+		return;
+
+	Ray ray = _ray;
+	glm::vec3 inverseDirection = 1.0f / ray.Direction;
+
+	TraversalStack stack{};
+	stack.Push(m_Root);
+
+	while (!stack.IsEmpty())
+	{
+		int nodeID = stack.Pop();
+		const AABBTreeNode& node = m_Nodes[nodeID];
+		if (!RayIntersectsAABB(ray.Origin, inverseDirection, ray.MaxDistance, node.Bounds))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			float newMaxDistance = _callback(nodeID, ray);
+
+			// Client terminated the ray cast
+			if (newMaxDistance <= 0.0f)
+				return;
+
+			// Clip the ray so further away proxies are culled
+			ray.MaxDistance = glm::min(ray.MaxDistance, newMaxDistance);
+		}
+		else
+		{
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+}
+
+int AABBTree::GetHeight() const
+{
+	if (m_Root == NullNode)
+		return 0;
+
+	return m_Nodes[m_Root].Height;
+}
+
+int AABBTree::GetProxyCount() const
+{
+	return m_ProxyCount;
+}
+
+void AABBTree::Clear()
+{
+	m_Nodes.clear();
+	m_Root = NullNode;
+	m_FreeList = NullNode;
+	m_ProxyCount = 0;
+}
+
+int AABBTree::AllocateNode()
+{
+	// Grow the pool if there are no free nodes
+	if (m_FreeList == NullNode)
+	{
+		m_FreeList = (int)m_Nodes.size();
+		m_Nodes.emplace_back(AABBTreeNode{});
+		m_Nodes.back().Parent = NullNode;
+	}
+
+	int nodeID = m_FreeList;
+	m_FreeList = m_Nodes[nodeID].Parent;
+	m_Nodes[nodeID] = AABBTreeNode{};
+	return nodeID;
+}
+
+void AABBTree::FreeNode(int _nodeID)
+{
+	m_Nodes[_nodeID] = AABBTreeNode{};
+	m_Nodes[_nodeID].Parent = m_FreeList;
+	m_FreeList = _nodeID;
+}
+
+void AABBTree::InsertLeaf(int _leaf)
+{
+	if (m_Root == NullNode)
+	{
+		m_Root = _leaf;
+		m_Nodes[m_Root].Parent = NullNode;
+		return;
+	}
+
+	// Find the best sibling using the surface area heuristic
+	AABB leafAABB = m_Nodes[_leaf].Bounds;
+	int index = m_Root;
+	while (!m_Nodes[index].IsLeaf())
+	{
+		int child1 = m_Nodes[index].Child1;
+		int child2 = m_Nodes[index].Child2;
+
+		float area = SurfaceArea(m_Nodes[index].Bounds);
+		float combinedArea = SurfaceArea(MergeAABB(m_Nodes[index].Bounds, leafAABB));
+
+		// Cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		// Cost of descending into each child
+		auto descendCost = [&](int _child)
+		{
+			float mergedArea = SurfaceArea(MergeAABB(leafAABB, m_Nodes[_child].Bounds));
+			if (m_Nodes[_child].IsLeaf())
+				return mergedArea + inheritanceCost;
+			return mergedArea - SurfaceArea(m_Nodes[_child].Bounds) + inheritanceCost;
+		};
+		float cost1 = descendCost(child1);
+		float cost2 = descendCost(child2);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = cost1 < cost2 ? child1 : child2;
+	}
+	int sibling = index;
+
+	// Create a new parent
+	int oldParent = m_Nodes[sibling].Parent;
+	int newParent = AllocateNode();
+	m_Nodes[newParent].Parent = oldParent;
+	m_Nodes[newParent].Bounds = MergeAABB(leafAABB, m_Nodes[sibling].Bounds);
+	m_Nodes[newParent].Height = m_Nodes[sibling].Height + 1;
+	m_Nodes[newParent].Child1 = sibling;
+	m_Nodes[newParent].Child2 = _leaf;
+	m_Nodes[sibling].Parent = newParent;
+	m_Nodes[_leaf].Parent = newParent;
+
+	if (oldParent != NullNode)
+	{
+		if (m_Nodes[oldParent].Child1 == sibling)
+			m_Nodes[oldParent].Child1 = newParent;
+		else
+			m_Nodes[oldParent].Child2 = newParent;
+	}
+	else
+	{
+		// The sibling was the root
+		m_Root = newParent;
+	}
+
+	RefitAncestors(m_Nodes[_leaf].Parent);
+}
+
+void AABBTree::RemoveLeaf(int _leaf)
+{
+	if (_leaf == m_Root)
+	{
+		m_Root = NullNode;
+		return;
+	}
+
+	int parent = m_Nodes[_leaf].Parent;
+	int grandParent = m_Nodes[parent].Parent;
+	int sibling = m_Nodes[parent].Child1 == _leaf ? m_Nodes[parent].Child2 : m_Nodes[parent].Child1;
+
+	if (grandParent != NullNode)
+	{
+		// Destroy parent and connect sibling to grandParent
+		if (m_Nodes[grandParent].Child1 == parent)
+			m_Nodes[grandParent].Child1 = sibling;
+		else
+			m_Nodes[grandParent].Child2 = sibling;
+		m_Nodes[sibling].Parent = grandParent;
+		FreeNode(parent);
+
+		RefitAncestors(grandParent);
+	}
+	else
+	{
+		m_Root = sibling;
+		m_Nodes[sibling].Parent = NullNode;
+		FreeNode(parent);
+	}
+	m_Nodes[_leaf].Parent = NullNode;
+}
+
+void AABBTree::RefitAncestors(int _nodeID)
+{
+	int index = _nodeID;
+	while (index != NullNode)
+	{
+		index = Balance(index);
+
+		int child1 = m_Nodes[index].Child1;
+		int child2 = m_Nodes[index].Child2;
+		m_Nodes[index].Height = 1 + glm::max(m_Nodes[child1].Height, m_Nodes[child2].Height);
+		m_Nodes[index].Bounds = MergeAABB(m_Nodes[child1].Bounds, m_Nodes[child2].Bounds);
+
+		index = m_Nodes[index].Parent;
+	}
+}
+
+int AABBTree::Balance(int _iA)
+{
+	AABBTreeNode& A = m_Nodes[_iA];
+	if (A.IsLeaf() || A.Height < 2)
+		return _iA;
+
+	int iB = A.Child1;
+	int iC = A.Child2;
+	AABBTreeNode& B = m_Nodes[iB];
+	AABBTreeNode& C = m_Nodes[iC];
+
+	int balance = C.Height - B.Height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		int iF = C.Child1;
+		int iG = C.Child2;
+		AABBTreeNode& F = m_Nodes[iF];
+		AABBTreeNode& G = m_Nodes[iG];
+
+		// Swap A and C
+		C.Child1 = _iA;
+		C.Parent = A.Parent;
+		A.Parent = iC;
+
+		// A's old parent should point to C
+		if (C.Parent != NullNode)
+		{
+			if (m_Nodes[C.Parent].Child1 == _iA)
+				m_Nodes[C.Parent].Child1 = iC;
+			else
+				m_Nodes[C.Parent].Child2 = iC;
+		}
+		else
+		{
+			m_Root = iC;
+		}
+
+		// Keep the taller grandchild under C
+		if (F.Height > G.Height)
+		{
+			C.Child2 = iF;
+			A.Child2 = iG;
+			G.Parent = _iA;
+			A.Bounds = MergeAABB(B.Bounds, G.Bounds);
+			C.Bounds = MergeAABB(A.Bounds, F.Bounds);
+			A.Height = 1 + glm::max(B.Height, G.Height);
+			C.Height = 1 + glm::max(A.Height, F.Height);
+		}
+		else
+		{
+			C.Child2 = iG;
+			A.Child2 = iF;
+			F.Parent = _iA;
+			A.Bounds = MergeAABB(B.Bounds, F.Bounds);
+			C.Bounds = MergeAABB(A.Bounds, G.Bounds);
+			A.Height = 1 + glm::max(B.Height, F.Height);
+			C.Height = 1 + glm::max(A.Height, G.Height);
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		int iD = B.Child1;
+		int iE = B.Child2;
+		AABBTreeNode& D = m_Nodes[iD];
+		AABBTreeNode& E = m_Nodes[iE];
+
+		// Swap A and B
+		B.Child1 = _iA;
+		B.Parent = A.Parent;
+		A.Parent = iB;
+
+		// A's old parent should point to B
+		if (B.Parent != NullNode)
+		{
+			if (m_Nodes[B.Parent].Child1 == _iA)
+				m_Nodes[B.Parent].Child1 = iB;
+			else
+				m_Nodes[B.Parent].Child2 = iB;
+		}
+		else
+		{
+			m_Root = iB;
+		}
+
+		// Keep the taller grandchild under B
+		if (D.Height > E.Height)
+		{
+			B.Child2 = iD;
+			A.Child1 = iE;
+			E.Parent = _iA;
+			A.Bounds = MergeAABB(C.Bounds, E.Bounds);
+			B.Bounds = MergeAABB(A.Bounds, D.Bounds);
+			A.Height = 1 + glm::max(C.Height, E.Height);
+			B.Height = 1 + glm::max(A.Height, D.Height);
+		}
+		else
+		{
+			B.Child2 = iE;
+			A.Child1 = iD;
+			D.Parent = _iA;
+			A.Bounds = MergeAABB(C.Bounds, D.Bounds);
+			B.Bounds = MergeAABB(A.Bounds, E.Bounds);
+			A.Height = 1 + glm::max(C.Height, D.Height);
+			B.Height = 1 + glm::max(A.Height, E.Height);
+		}
+
+		return iB;
+	}
+
+	return _iA;
+}
+
+void AABBTree::CollectLeaves(int _nodeID, std::vector<int>& _results) const
+{
+	TraversalStack stack{};
+	stack.Push(_nodeID);
+
+	while (!stack.IsEmpty())
+	{
+		int nodeID = stack.Pop();
+		const AABBTreeNode& node = m_Nodes[nodeID];
+		if (node.IsLeaf())
+		{
+			_results.push_back(nodeID);
+		}
+		else
+		{
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+}
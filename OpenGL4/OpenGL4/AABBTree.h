@@ -0,0 +1,201 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : AABBTree.h 
+// Description : AABBTree Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// A single node of the AABBTree.
+/// Leaves hold a proxy (user data + fat bounds), branches always have two children.
+/// Free nodes reuse Parent as the next index in the free list.
+/// </summary>
+struct AABBTreeNode
+{
+	AABB Bounds{};
+	void* UserData = nullptr;
+	int Parent = -1;
+	int Child1 = -1;
+	int Child2 = -1;
+	int Height = -1;
+
+	bool IsLeaf() const { return Child1 == -1; }
+};
+
+/// <summary>
+/// Dynamic bounding volume hierarchy of AABB's.
+/// Proxies are stored with a fat AABB so small movements do not restructure the tree,
+/// Inserts use the surface area heuristic and the tree is kept balanced with rotations.
+/// </summary>
+class AABBTree
+{
+public:
+	static const int NullNode = -1;
+
+	/// <summary>
+	/// AABBTree Constructor
+	/// </summary>
+	/// <param name="_fatMargin"> Distance the stored AABB's are grown by in every direction </param>
+	/// <param name="_displacementMultiplier"> Amount the fat AABB is extended in the direction of movement </param>
+	AABBTree(float _fatMargin = 0.1f, float _displacementMultiplier = 2.0f);
+
+	/// <summary>
+	/// AABBTree Destructor
+	/// </summary>
+	~AABBTree();
+
+	/// <summary>
+	/// Creates a proxy with the given tight bounds and returns its ID.
+	/// </summary>
+	/// <param name="_bounds"></param>
+	/// <param name="_userData"></param>
+	/// <returns></returns>
+	int CreateProxy(const AABB& _bounds, void* _userData);
+
+	/// <summary>
+	/// Removes the proxy from the tree. Destroying a proxy that was already destroyed prints a warning and does nothing.
+	/// </summary>
+	/// <param name="_proxyID"></param>
+	void DestroyProxy(int _proxyID);
+
+	/// <summary>
+	/// Updates the bounds of a proxy.
+	/// Only re-inserts the proxy if the new bounds escape its fat AABB.
+	/// Returns true if the proxy was re-inserted.
+	/// </summary>
+	/// <param name="_proxyID"></param>
+	/// <param name="_bounds"></param>
+	/// <param name="_displacement"></param>
+	/// <returns></returns>
+	bool MoveProxy(int _proxyID, const AABB& _bounds, const glm::vec3& _displacement = {0,0,0});
+
+	/// <summary>
+	/// Returns the user data of the given proxy.
+	/// </summary>
+	/// <param name="_proxyID"></param>
+	/// <returns></returns>
+	void* GetUserData(int _proxyID) const;
+
+	/// <summary>
+	/// Returns the fat AABB of the given proxy.
+	/// </summary>
+	/// <param name="_proxyID"></param>
+	/// <returns></returns>
+	const AABB& GetFatAABB(int _proxyID) const;
+
+	/// <summary>
+	/// Appends every proxy whose fat AABB is inside or intersecting the frustum.
+	/// </summary>
+	/// <param name="_frustum"></param>
+	/// <param name="_results"></param>
+	void QueryFrustum(const Frustum& _frustum, std::vector<int>& _results) const;
+
+	/// <summary>
+	/// Appends every proxy whose fat AABB overlaps the given AABB.
+	/// </summary>
+	/// <param name="_bounds"></param>
+	/// <param name="_results"></param>
+	void QueryAABB(const AABB& _bounds, std::vector<int>& _results) const;
+
+	/// <summary>
+	/// Appends every proxy whose fat AABB overlaps the given sphere.
+	/// </summary>
+	/// <param name="_centre"></param>
+	/// <param name="_radius"></param>
+	/// <param name="_results"></param>
+	void QuerySphere(const glm::vec3& _centre, float _radius, std::vector<int>& _results) const;
+
+	/// <summary>
+	/// Fills the results with up to _k proxies closest to the point, nearest first.
+	/// Distance is measured to each proxies fat AABB.
+	/// </summary>
+	/// <param name="_point"></param>
+	/// <param name="_k"></param>
+	/// <param name="_results"></param>
+	void QueryKNearest(const glm::vec3& _point, int _k, std::vector<int>& _results) const;
+
+	/// <summary>
+	/// Casts the ray through the tree.
+	/// The callback is invoked for every proxy whose fat AABB the ray hits and returns the new max distance of the ray:
+	/// Return the hit distance to clip the ray, the current max distance to continue unchanged or 0 to stop.
+	/// </summary>
+	/// <param name="_ray"></param>
+	/// <param name="_callback"></param>
+	void RayCast(const Ray& _ray, const std::function<float(int _proxyID, const Ray& _ray)>& _callback) const;
+
+	/// <summary>
+	/// Returns the height of the tree (0 for a single leaf).
+	/// </summary>
+	/// <returns></returns>
+	int GetHeight() const;
+
+	/// <summary>
+	/// Returns the number of proxies in the tree.
+	/// </summary>
+	/// <returns></returns>
+	int GetProxyCount() const;
+
+	/// <summary>
+	/// Removes all proxies from the tree.
+	/// </summary>
+	void Clear();
+
+private:
+	/// <summary>
+	/// Returns a node from the free list, growing the pool if needed.
+	/// </summary>
+	/// <returns></returns>
+	int AllocateNode();
+
+	/// <summary>
+	/// Returns the node to the free list.
+	/// </summary>
+	/// <param name="_nodeID"></param>
+	void FreeNode(int _nodeID);
+
+	/// <summary>
+	/// Inserts a leaf, choosing the sibling with the lowest surface area cost.
+	/// </summary>
+	/// <param name="_leaf"></param>
+	void InsertLeaf(int _leaf);
+
+	/// <summary>
+	/// Removes a leaf and collapses its parent.
+	/// </summary>
+	/// <param name="_leaf"></param>
+	void RemoveLeaf(int _leaf);
+
+	/// <summary>
+	/// Refits bounds and heights from the given node to the root, balancing on the way up.
+	/// </summary>
+	/// <param name="_nodeID"></param>
+	void RefitAncestors(int _nodeID);
+
+	/// <summary>
+	/// Performs a left or right rotation if node _iA is imbalanced.
+	/// Returns the new root index of the subtree.
+	/// </summary>
+	/// <param name="_iA"></param>
+	/// <returns></returns>
+	int Balance(int _iA);
+
+	/// <summary>
+	/// Appends every leaf below the given node.
+	/// </summary>
+	/// <param name="_nodeID"></param>
+	/// <param name="_results"></param>
+	void CollectLeaves(int _nodeID, std::vector<int>& _results) const;
+
+	std::vector<AABBTreeNode> m_Nodes{};
+	int m_Root{ NullNode };
+	int m_FreeList{ NullNode };
+	int m_ProxyCount{ 0 };
+	float m_FatMargin{ 0.1f };
+	float m_DisplacementMultiplier{ 2.0f };
+};
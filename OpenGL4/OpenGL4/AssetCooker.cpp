@@ -0,0 +1,723 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : AssetCooker.cpp 
+// Description : AssetCooker Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "AssetCooker.h"
+#include "BlockCompressor.h"
+#include "KTX2.h"
+#include "ShaderLoader.h"
+#include "StringID.h"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "STBI/stb_image.h"
+
+namespace
+{
+	/// <summary>
+	/// A read only Assimp stream over a file read through the VirtualFileSystem.
+	/// </summary>
+	class VirtualIOStream : public Assimp::IOStream
+	{
+	public:
+		VirtualIOStream(FileData&& _file) : m_File{ std::move(_file) } {}
+
+		size_t Read(void* _buffer, size_t _size, size_t _count) override
+		{
+			if (_size == 0)
+				return 0;
+			size_t count = std::min(_count, (m_File.GetSize() - m_Position) / _size);
+			std::memcpy(_buffer, m_File.GetData() + m_Position, count * _size);
+			m_Position += count * _size;
+			return count;
+		}
+
+		size_t Write(const void*, size_t, size_t) override { return 0; }
+
+		aiReturn Seek(size_t _offset, aiOrigin _origin) override
+		{
+			size_t position = _origin == aiOrigin_SET ? _offset : _origin == aiOrigin_CUR ? m_Position + _offset : m_File.GetSize() + _offset;
+			if (position > m_File.GetSize())
+				return aiReturn_FAILURE;
+			m_Position = position;
+			return aiReturn_SUCCESS;
+		}
+
+		size_t Tell() const override { return m_Position; }
+		size_t FileSize() const override { return m_File.GetSize(); }
+		void Flush() override {}
+
+	private:
+		FileData m_File{};
+		size_t m_Position{ 0 };
+	};
+
+	/// <summary>
+	/// Lets Assimp open models and the files they reference, such as materials, through the VirtualFileSystem.
+	/// Every file opened is recorded so the cooker knows what a model depends on.
+	/// </summary>
+	class VirtualIOSystem : public Assimp::IOSystem
+	{
+	public:
+		VirtualIOSystem(std::vector<std::string>* _openedFiles) : m_OpenedFiles{ _openedFiles } {}
+
+		bool Exists(const char* _file) const override { return VirtualFileSystem::Exists(_file); }
+		char getOsSeparator() const override { return '/'; }
+
+		Assimp::IOStream* Open(const char* _file, const char* _mode) override
+		{
+			if (std::strchr(_mode, 'w') || std::strchr(_mode, 'a'))
+				return nullptr;
+			FileData file = VirtualFileSystem::ReadFile(_file);
+			if (!file.IsValid())
+				return nullptr;
+			if (m_OpenedFiles)
+				m_OpenedFiles->push_back(_file);
+			return new VirtualIOStream(std::move(file));
+		}
+
+		void Close(Assimp::IOStream* _file) override { delete _file; }
+
+	private:
+		std::vector<std::string>* m_OpenedFiles{ nullptr };
+	};
+
+	/// <summary>
+	/// Bounds checked reads from a cooked file.
+	/// </summary>
+	struct BinaryReader
+	{
+		const unsigned char* Data = nullptr;
+		size_t Size = 0;
+		size_t Position = 0;
+
+		// Returns the next _size bytes and moves past them, or nullptr if the file ends first
+		const unsigned char* Skip(size_t _size)
+		{
+			if (_size > Size - Position)
+				return nullptr;
+			const unsigned char* data = Data + Position;
+			Position += _size;
+			return data;
+		}
+
+		template<typename T>
+		bool Read(T& _value)
+		{
+			const unsigned char* data = Skip(sizeof(T));
+			if (data)
+				std::memcpy(&_value, data, sizeof(T));
+			return data != nullptr;
+		}
+	};
+
+	void WriteBytes(std::vector<unsigned char>& _output, const void* _data, size_t _size)
+	{
+		_output.insert(_output.end(), (const unsigned char*)_data, (const unsigned char*)_data + _size);
+	}
+
+	template<typename T>
+	void WriteValue(std::vector<unsigned char>& _output, const T& _value)
+	{
+		WriteBytes(_output, &_value, sizeof(T));
+	}
+
+	/// <summary>
+	/// Runs a job for every index across all cores, each worker taking the next index when it finishes one
+	/// so a few slow assets do not hold up the rest.
+	/// </summary>
+	void ParallelFor(size_t _count, const std::function<void(size_t)>& _job)
+	{
+		std::atomic<size_t> next{ 0 };
+		auto worker = [&]()
+			{
+				for (size_t index = next++; index < _count; index = next++)
+				{
+					_job(index);
+				}
+			};
+
+		size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(_count, 1));
+		std::vector<std::future<void>> workers{};
+		for (size_t thread = 1; thread < threadCount; thread++)
+		{
+			workers.push_back(std::async(std::launch::async, worker));
+		}
+		worker();
+		for (auto& result : workers)
+		{
+			result.get();
+		}
+	}
+
+	uint64_t HashFile(const std::string& _path)
+	{
+		FileData file = VirtualFileSystem::ReadFile(_path);
+		return file.IsValid() ? StringID::Hash(file.GetText()) : 0;
+	}
+
+	// Changing it has to bump AssetCooker::TextureVersion so the textures are cooked again
+	const CompressionQuality TextureQuality = CompressionQuality::Normal;
+
+	std::string ToLower(std::string_view _string)
+	{
+		std::string lower{ _string };
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char _character) { return (char)std::tolower(_character); });
+		return lower;
+	}
+}
+
+bool AssetCooker::Cook(std::string_view _sourceDirectory, std::string_view _outputDirectory, const std::vector<std::string>& _excludedDirectories)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Gather the source files relative to the directory, which is how they are read through the mount
+	std::vector<std::string> sources{};
+	std::error_code error{};
+	std::filesystem::path root{ _sourceDirectory };
+	auto iterator = std::filesystem::recursive_directory_iterator(root, error);
+	if (error)
+	{
+		Print("Could not read directory " + std::string(_sourceDirectory));
+		return false;
+	}
+	for (auto file = std::filesystem::begin(iterator); file != std::filesystem::end(iterator); file.increment(error))
+	{
+		if (error)
+			break;
+		std::string name = file->path().filename().string();
+		if (file->is_directory(error) && std::find(_excludedDirectories.begin(), _excludedDirectories.end(), name) != _excludedDirectories.end())
+		{
+			file.disable_recursion_pending();
+			continue;
+		}
+		if (file->is_regular_file(error))
+			sources.push_back(std::filesystem::relative(file->path(), root, error).generic_string());
+	}
+	std::sort(sources.begin(), sources.end());
+
+	// Hash every source once, files outside the directory that an asset read are hashed when first needed
+	std::vector<uint64_t> sourceHashes(sources.size());
+	ParallelFor(sources.size(), [&](size_t _index) { sourceHashes[_index] = HashFile(sources[_index]); });
+	std::unordered_map<std::string, uint64_t> contentHashes{};
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		contentHashes[sources[i]] = sourceHashes[i];
+	}
+	auto getContentHash = [&](const std::string& _path)
+		{
+			auto hash = contentHashes.find(_path);
+			if (hash == contentHashes.end())
+				hash = contentHashes.emplace(_path, HashFile(_path)).first;
+			return hash->second;
+		};
+
+	// An asset is up to date if its output exists and nothing it was made from has changed since
+	std::string outputRoot{ _outputDirectory };
+	std::string manifestPath = outputRoot + ".manifest";
+	std::unordered_map<std::string, CookRecord> previousRecords{};
+	for (auto& record : ReadManifest(manifestPath))
+	{
+		previousRecords[record.Output] = std::move(record);
+	}
+
+	std::vector<CookRecord> records{};
+	std::vector<std::string> outdated{};
+	std::unordered_map<std::string, bool> outputs{};
+	for (auto& source : sources)
+	{
+		if (GetAssetType(source) == AssetType::Dependency)
+			continue;
+
+		std::string output = GetCookedPath(source);
+		outputs[output] = true;
+		auto previous = previousRecords.find(output);
+		bool isUpToDate = previous != previousRecords.end() && previous->second.Version == GetVersion(GetAssetType(source))
+			&& std::filesystem::is_regular_file(outputRoot + "/" + output, error);
+		if (isUpToDate)
+		{
+			for (auto& input : previous->second.Inputs)
+			{
+				isUpToDate = isUpToDate && getContentHash(input.first) == input.second;
+			}
+		}
+
+		if (isUpToDate)
+			records.push_back(previous->second);
+		else
+			outdated.push_back(source);
+	}
+
+	// Outputs whose source was removed or excluded are deleted so they cannot be packed
+	for (auto& previous : previousRecords)
+	{
+		if (!outputs.contains(previous.first))
+			std::filesystem::remove(outputRoot + "/" + previous.first, error);
+	}
+
+	// Directories are created up front so the workers only write files
+	for (auto& source : outdated)
+	{
+		std::filesystem::create_directories(std::filesystem::path(outputRoot + "/" + GetCookedPath(source)).parent_path(), error);
+	}
+
+	std::vector<std::vector<std::string>> dependencies(outdated.size());
+	std::vector<char> isCooked(outdated.size(), false);
+	ParallelFor(outdated.size(), [&](size_t _index)
+		{
+			std::vector<unsigned char> output{};
+			if (!CookAsset(outdated[_index], output, dependencies[_index]))
+				return;
+
+			std::string outputPath = outputRoot + "/" + GetCookedPath(outdated[_index]);
+			std::ofstream fileStream(outputPath, std::ios::binary);
+			fileStream.write((const char*)output.data(), (std::streamsize)output.size());
+			isCooked[_index] = fileStream.good();
+			if (!isCooked[_index])
+				Print("Could not write " + outputPath);
+		});
+
+	// Failed assets get no record so they are tried again next time
+	size_t failedCount = 0;
+	for (size_t i = 0; i < outdated.size(); i++)
+	{
+		if (!isCooked[i])
+		{
+			failedCount++;
+			continue;
+		}
+
+		CookRecord record{ GetCookedPath(outdated[i]), GetVersion(GetAssetType(outdated[i])) };
+		for (auto& dependency : dependencies[i])
+		{
+			record.Inputs.emplace_back(dependency, getContentHash(dependency));
+		}
+		records.push_back(std::move(record));
+	}
+	bool isManifestWritten = WriteManifest(manifestPath, records);
+
+	double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	Print("Cooked " + std::to_string(outdated.size() - failedCount) + " assets, " + std::to_string(outputs.size() - outdated.size()) + " up to date, "
+		+ std::to_string(failedCount) + " failed in " + std::to_string(time) + " ms");
+	return failedCount == 0 && isManifestWritten;
+}
+
+std::string AssetCooker::GetCookedPath(std::string_view _path)
+{
+	switch (GetAssetType(_path))
+	{
+	case AssetType::Model:
+		return std::string(_path) + ".mesh";
+	case AssetType::Texture:
+		return std::string(_path) + ".ktx2";
+	default:
+		return std::string(_path);
+	}
+}
+
+bool AssetCooker::ImportModel(const std::string& _path, ModelData& _model, std::vector<std::string>* _dependencies)
+{
+	// Vertices are welded and reordered for the post transform cache, the vertex format has no tangents
+	Assimp::Importer importer;
+	importer.SetIOHandler(new VirtualIOSystem(_dependencies));
+	const aiScene* scene = importer.ReadFile(_path.c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals
+		| aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality);
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		Print("ERROR::ASSIMP:: " + std::string(importer.GetErrorString()));
+		return false;
+	}
+
+	// Node transforms are not applied, so each mesh of the scene is taken once instead of walking the nodes
+	const aiTextureType textureTypes[]{ aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_AMBIENT };
+	_model.SubMeshes.resize(scene->mNumMeshes);
+	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+	{
+		const aiMesh* mesh = scene->mMeshes[i];
+		ModelData::SubMesh& subMesh = _model.SubMeshes[i];
+
+		subMesh.Vertices.resize(mesh->mNumVertices);
+		for (unsigned int v = 0; v < mesh->mNumVertices; v++)
+		{
+			Vertex& vertex = subMesh.Vertices[v];
+			vertex.position = { mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z };
+			if (mesh->HasNormals())
+				vertex.normals = { mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z };
+			if (mesh->mTextureCoords[0])
+				vertex.texCoords = { mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y };
+		}
+
+		subMesh.Indices.reserve((size_t)mesh->mNumFaces * 3);
+		for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+		{
+			const aiFace& face = mesh->mFaces[f];
+			subMesh.Indices.insert(subMesh.Indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+		}
+
+		const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+		for (aiTextureType type : textureTypes)
+		{
+			for (unsigned int t = 0; t < material->GetTextureCount(type); t++)
+			{
+				aiString path;
+				material->GetTexture(type, t, &path);
+				subMesh.Textures.push_back(path.C_Str());
+			}
+		}
+	}
+	return true;
+}
+
+bool AssetCooker::ReadModel(const FileData& _file, ModelData& _model)
+{
+	BinaryReader reader{ _file.GetData(), _file.GetSize() };
+	uint32_t magic = 0, version = 0, subMeshCount = 0;
+	if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(subMeshCount) || magic != ModelMagic || version != ModelVersion)
+		return false;
+
+	_model.SubMeshes.clear();
+	for (uint32_t i = 0; i < subMeshCount; i++)
+	{
+		uint32_t vertexCount = 0, indexCount = 0, textureCount = 0;
+		if (!reader.Read(vertexCount) || !reader.Read(indexCount) || !reader.Read(textureCount))
+			return false;
+
+		const unsigned char* vertices = reader.Skip((size_t)vertexCount * sizeof(Vertex));
+		const unsigned char* indices = reader.Skip((size_t)indexCount * sizeof(unsigned int));
+		if (!vertices || !indices)
+			return false;
+
+		ModelData::SubMesh& subMesh = _model.SubMeshes.emplace_back();
+		subMesh.Vertices.resize(vertexCount);
+		subMesh.Indices.resize(indexCount);
+		std::memcpy(subMesh.Vertices.data(), vertices, (size_t)vertexCount * sizeof(Vertex));
+		std::memcpy(subMesh.Indices.data(), indices, (size_t)indexCount * sizeof(unsigned int));
+
+		for (uint32_t t = 0; t < textureCount; t++)
+		{
+			uint32_t length = 0;
+			const unsigned char* path = reader.Read(length) ? reader.Skip(length) : nullptr;
+			if (!path)
+				return false;
+			subMesh.Textures.emplace_back((const char*)path, length);
+		}
+
+		for (unsigned int index : subMesh.Indices)
+		{
+			if (index >= vertexCount)
+				return false;
+		}
+	}
+	return true;
+}
+
+bool AssetCooker::DecodeImage(const std::string& _path, bool _flip, bool _generateMips, ImageData& _image)
+{
+	FileData file = VirtualFileSystem::ReadFile(_path);
+	if (!file.IsValid())
+	{
+		Print("Could not read texture " + _path);
+		return false;
+	}
+
+	// The flip is done here rather than by stbi_set_flip_vertically_on_load, which is global and not thread safe
+	int width = 0, height = 0, components = 0;
+	unsigned char* pixels = stbi_load_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &components, 0);
+	if (!pixels)
+	{
+		Print("Could not decode texture " + _path + ": " + stbi_failure_reason());
+		return false;
+	}
+
+	_image.Size = { width, height };
+	_image.Components = components;
+	int levelCount = 1;
+	while (_generateMips && (width >> levelCount > 0 || height >> levelCount > 0))
+	{
+		levelCount++;
+	}
+
+	std::vector<size_t> levelOffsets(levelCount);
+	size_t storageSize = 0;
+	for (int level = 0; level < levelCount; level++)
+	{
+		glm::ivec2 size = GetLevelSize(_image, level);
+		levelOffsets[level] = storageSize;
+		storageSize += (size_t)size.x * size.y * components;
+	}
+	_image.Storage.resize(storageSize);
+
+	size_t rowSize = (size_t)width * components;
+	for (int row = 0; row < height; row++)
+	{
+		int sourceRow = _flip ? height - 1 - row : row;
+		std::memcpy(_image.Storage.data() + row * rowSize, pixels + sourceRow * rowSize, rowSize);
+	}
+	stbi_image_free(pixels);
+
+	// Each level averages 2x2 texels of the one above, clamping at odd edges, the same box filter as glGenerateMipmap
+	for (int level = 1; level < levelCount; level++)
+	{
+		glm::ivec2 sourceSize = GetLevelSize(_image, level - 1);
+		glm::ivec2 size = GetLevelSize(_image, level);
+		const unsigned char* source = _image.Storage.data() + levelOffsets[level - 1];
+		unsigned char* destination = _image.Storage.data() + levelOffsets[level];
+		for (int y = 0; y < size.y; y++)
+		{
+			int y0 = std::min(y * 2, sourceSize.y - 1) * sourceSize.x;
+			int y1 = std::min(y * 2 + 1, sourceSize.y - 1) * sourceSize.x;
+			for (int x = 0; x < size.x; x++)
+			{
+				int x0 = std::min(x * 2, sourceSize.x - 1);
+				int x1 = std::min(x * 2 + 1, sourceSize.x - 1);
+				for (int c = 0; c < components; c++)
+				{
+					int sum = source[(y0 + x0) * components + c] + source[(y0 + x1) * components + c]
+						+ source[(y1 + x0) * components + c] + source[(y1 + x1) * components + c];
+					destination[(y * size.x + x) * components + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	_image.Levels.resize(levelCount);
+	for (int level = 0; level < levelCount; level++)
+	{
+		_image.Levels[level] = _image.Storage.data() + levelOffsets[level];
+	}
+	return true;
+}
+
+bool AssetCooker::ReadTexture(const std::string& _path, bool _flip, FileData& _file, ImageData& _image)
+{
+	_file = VirtualFileSystem::ReadFile(GetCookedPath(_path));
+	if (_file.IsValid() && KTX2::Read(_file, _image))
+		return true;
+	return DecodeImage(_path, _flip, true, _image);
+}
+
+glm::ivec2 AssetCooker::GetLevelSize(const ImageData& _image, int _level)
+{
+	return { std::max(_image.Size.x >> _level, 1), std::max(_image.Size.y >> _level, 1) };
+}
+
+size_t AssetCooker::GetLevelBytes(const ImageData& _image, int _level)
+{
+	glm::ivec2 size = GetLevelSize(_image, _level);
+	if (_image.Format != 0)
+		return (size_t)((size.x + 3) / 4) * ((size.y + 3) / 4) * BlockCompressor::GetBlockBytes(_image.Format);
+	return (size_t)size.x * size.y * _image.Components;
+}
+
+AssetCooker::AssetType AssetCooker::GetAssetType(std::string_view _path)
+{
+	size_t dot = _path.find_last_of('.');
+	std::string extension = dot == std::string_view::npos ? "" : ToLower(_path.substr(dot + 1));
+	if (extension == "fbx" || extension == "obj" || extension == "dae" || extension == "gltf" || extension == "glb" || extension == "3ds")
+		return AssetType::Model;
+	if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "tga" || extension == "bmp")
+		return AssetType::Texture;
+	if (extension == "vert" || extension == "frag" || extension == "comp" || extension == "geom" || extension == "tesc" || extension == "tese")
+		return AssetType::Shader;
+	if (extension == "glsl" || extension == "mtl")
+		return AssetType::Dependency;
+	return AssetType::Other;
+}
+
+uint32_t AssetCooker::GetVersion(AssetType _type)
+{
+	switch (_type)
+	{
+	case AssetType::Model:
+		return ModelVersion;
+	case AssetType::Texture:
+		return TextureVersion;
+	case AssetType::Shader:
+		return ShaderVersion;
+	default:
+		return OtherVersion;
+	}
+}
+
+bool AssetCooker::CookAsset(const std::string& _path, std::vector<unsigned char>& _output, std::vector<std::string>& _dependencies)
+{
+	switch (GetAssetType(_path))
+	{
+	case AssetType::Model:
+	{
+		ModelData model{};
+		if (!ImportModel(_path, model, &_dependencies))
+			return false;
+		if (std::find(_dependencies.begin(), _dependencies.end(), _path) == _dependencies.end())
+			_dependencies.push_back(_path);
+		WriteModel(model, _output);
+		return true;
+	}
+	case AssetType::Texture:
+	{
+		// Cubemap faces are loaded unflipped, matching TextureLoader::LoadCubemap
+		ImageData image{};
+		ImageData compressed{};
+		bool isFlipped = _path.find("Cubemaps/") == std::string::npos;
+		_dependencies.push_back(_path);
+		if (!DecodeImage(_path, isFlipped, true, image)
+			|| !BlockCompressor::Compress(image, BlockCompressor::ChooseFormat(image, TextureQuality), TextureQuality, compressed))
+			return false;
+		return KTX2::Write(compressed, isFlipped, _output);
+	}
+	case AssetType::Shader:
+	{
+		return CookShader(_path, _output, _dependencies);
+	}
+	default:
+	{
+		FileData file = VirtualFileSystem::ReadFile(_path);
+		_dependencies.push_back(_path);
+		if (!file.IsValid())
+			return false;
+		WriteBytes(_output, file.GetData(), file.GetSize());
+		return true;
+	}
+	}
+}
+
+bool AssetCooker::CookShader(const std::string& _path, std::vector<unsigned char>& _output, std::vector<std::string>& _dependencies)
+{
+	// Shaders are loaded by name from the shader directory
+	const std::string directory = "Shaders/";
+	if (_path.compare(0, directory.size(), directory) != 0)
+	{
+		Print("Could not cook " + _path + ", shaders have to be in " + directory);
+		return false;
+	}
+
+	std::vector<std::string> files{};
+	std::string source = ShaderLoader::PreprocessShader(_path.substr(directory.size()), {}, &files);
+	bool isValid = true;
+	for (auto& file : files)
+	{
+		_dependencies.push_back(directory + file);
+		if (!VirtualFileSystem::Exists(directory + file))
+		{
+			Print("Could not cook " + _path + ", missing include " + file);
+			isValid = false;
+		}
+	}
+
+	// #version has to be the first directive and every conditional closed once the includes are expanded
+	std::istringstream lines{ source };
+	std::string line{};
+	bool isFirstDirective = true;
+	int depth = 0;
+	while (std::getline(lines, line))
+	{
+		size_t first = line.find_first_not_of(" \t");
+		if (first == std::string::npos || line[first] != '#')
+			continue;
+		std::string_view directive{ line.data() + first, line.size() - first };
+		if (isFirstDirective && directive.compare(0, 8, "#version") != 0)
+		{
+			Print("Could not cook " + _path + ", #version is not the first directive");
+			isValid = false;
+		}
+		isFirstDirective = false;
+		if (directive.compare(0, 3, "#if") == 0)
+			depth++;
+		else if (directive.compare(0, 6, "#endif") == 0 && --depth < 0)
+			break;
+	}
+	if (depth != 0)
+	{
+		Print("Could not cook " + _path + ", unbalanced #if and #endif");
+		isValid = false;
+	}
+
+	WriteBytes(_output, source.data(), source.size());
+	return isValid;
+}
+
+void AssetCooker::WriteModel(const ModelData& _model, std::vector<unsigned char>& _output)
+{
+	WriteValue(_output, ModelMagic);
+	WriteValue(_output, ModelVersion);
+	WriteValue(_output, (uint32_t)_model.SubMeshes.size());
+	for (auto& subMesh : _model.SubMeshes)
+	{
+		WriteValue(_output, (uint32_t)subMesh.Vertices.size());
+		WriteValue(_output, (uint32_t)subMesh.Indices.size());
+		WriteValue(_output, (uint32_t)subMesh.Textures.size());
+		WriteBytes(_output, subMesh.Vertices.data(), subMesh.Vertices.size() * sizeof(Vertex));
+		WriteBytes(_output, subMesh.Indices.data(), subMesh.Indices.size() * sizeof(unsigned int));
+		for (auto& texture : subMesh.Textures)
+		{
+			WriteValue(_output, (uint32_t)texture.size());
+			WriteBytes(_output, texture.data(), texture.size());
+		}
+	}
+}
+
+std::vector<AssetCooker::CookRecord> AssetCooker::ReadManifest(const std::string& _manifestPath)
+{
+	// One record per line: output, version, then pairs of input path and hex content hash, separated by tabs
+	std::vector<CookRecord> records{};
+	std::ifstream fileStream(_manifestPath);
+	std::string line{};
+	while (std::getline(fileStream, line))
+	{
+		std::vector<std::string> fields{};
+		std::istringstream fieldStream{ line };
+		std::string field{};
+		while (std::getline(fieldStream, field, '\t'))
+		{
+			fields.push_back(field);
+		}
+		if (fields.size() < 2 || fields.size() % 2 != 0)
+			continue;
+
+		CookRecord& record = records.emplace_back();
+		record.Output = fields[0];
+		record.Version = (uint32_t)std::strtoul(fields[1].c_str(), nullptr, 10);
+		for (size_t i = 2; i < fields.size(); i += 2)
+		{
+			record.Inputs.emplace_back(fields[i], std::strtoull(fields[i + 1].c_str(), nullptr, 16));
+		}
+	}
+	return records;
+}
+
+bool AssetCooker::WriteManifest(const std::string& _manifestPath, const std::vector<CookRecord>& _records)
+{
+	std::ofstream fileStream(_manifestPath);
+	for (auto& record : _records)
+	{
+		fileStream << record.Output << '\t' << record.Version;
+		for (auto& input : record.Inputs)
+		{
+			fileStream << '\t' << input.first << '\t' << std::hex << input.second << std::dec;
+		}
+		fileStream << '\n';
+	}
+	if (!fileStream.good())
+	{
+		Print("Could not write cook manifest " + _manifestPath);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,189 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : AssetCooker.h 
+// Description : AssetCooker Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+#include "VirtualFileSystem.h"
+
+/// <summary>
+/// The sub meshes of a model with the texture paths of their materials.
+/// Textures are in the order diffuse, specular, normal and height.
+/// </summary>
+struct ModelData
+{
+	struct SubMesh
+	{
+		std::vector<Vertex> Vertices{};
+		std::vector<unsigned int> Indices{};
+		std::vector<std::string> Textures{};
+	};
+
+	std::vector<SubMesh> SubMeshes{};
+};
+
+/// <summary>
+/// An image and its mip chain, level 0 first and each level tightly packed.
+/// Levels hold 8 bit texels of Components channels, or blocks of the compressed GL Format if it is set.
+/// Levels point into Storage when decoded or compressed, or into the cooked file they were read from,
+/// which has to outlive the image.
+/// </summary>
+struct ImageData
+{
+	glm::ivec2 Size{ 0,0 };
+	int Components{ 0 };
+	GLenum Format{ 0 };
+	std::vector<const unsigned char*> Levels{};
+	std::vector<unsigned char> Storage{};
+};
+
+/// <summary>
+/// Converts the source assets into the formats the runtime loads without Assimp or stb_image,
+/// and owns both the source importers and the cooked file readers so the two cannot drift apart.
+/// Models become binary meshes with welded, cache ordered vertices, textures become block compressed mip chains in KTX2 files
+/// and shaders have their includes expanded and are checked for missing includes and unbalanced conditionals.
+/// Cooked models and textures are stored next to the source name with a .mesh or .ktx2 extension added,
+/// shaders keep their name, and anything else is copied as is.
+///
+/// Cooking is incremental, every output is recorded in a manifest with the content hash of each file it was made from,
+/// including the includes of shaders and the files a model importer opened, and is only cooked again when one changed.
+/// Outdated assets are cooked in parallel across all cores.
+/// </summary>
+class AssetCooker
+{
+public:
+	/// <summary>
+	/// Cooks every file under a directory into the output directory, skipping any directory with one of the excluded names.
+	/// Sources are read through the VirtualFileSystem, so the source directory has to be mounted.
+	/// Returns false if any asset failed to cook.
+	/// </summary>
+	/// <param name="_sourceDirectory"></param>
+	/// <param name="_outputDirectory"></param>
+	/// <param name="_excludedDirectories"></param>
+	/// <returns></returns>
+	static bool Cook(std::string_view _sourceDirectory, std::string_view _outputDirectory, const std::vector<std::string>& _excludedDirectories = {});
+
+	/// <summary>
+	/// Returns the path the cooked version of a source asset is stored at.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <returns></returns>
+	static std::string GetCookedPath(std::string_view _path);
+
+	/// <summary>
+	/// Imports a source model with Assimp. The files opened by the importer are added to _dependencies if given.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <param name="_model"></param>
+	/// <param name="_dependencies"></param>
+	/// <returns></returns>
+	static bool ImportModel(const std::string& _path, ModelData& _model, std::vector<std::string>* _dependencies = nullptr);
+
+	/// <summary>
+	/// Reads a model cooked by Cook, returning false if the file is not a valid cooked model.
+	/// </summary>
+	/// <param name="_file"></param>
+	/// <param name="_model"></param>
+	/// <returns></returns>
+	static bool ReadModel(const FileData& _file, ModelData& _model);
+
+	/// <summary>
+	/// Decodes a source image with stb_image, flipped so the first row is the bottom as OpenGL expects if _flip is set.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <param name="_flip"></param>
+	/// <param name="_generateMips"> Builds the whole mip chain with a box filter, otherwise only level 0 is filled </param>
+	/// <param name="_image"></param>
+	/// <returns></returns>
+	static bool DecodeImage(const std::string& _path, bool _flip, bool _generateMips, ImageData& _image);
+
+	/// <summary>
+	/// Reads a texture from its cooked KTX2 file, which _file holds on to, or decodes the source image with its mips if it has none.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <param name="_flip"></param>
+	/// <param name="_file"></param>
+	/// <param name="_image"></param>
+	/// <returns></returns>
+	static bool ReadTexture(const std::string& _path, bool _flip, FileData& _file, ImageData& _image);
+
+	/// <summary>
+	/// Returns the size of a mip level of an image.
+	/// </summary>
+	/// <param name="_image"></param>
+	/// <param name="_level"></param>
+	/// <returns></returns>
+	static glm::ivec2 GetLevelSize(const ImageData& _image, int _level);
+
+	/// <summary>
+	/// Returns the size in bytes of a mip level of an image, whole blocks if it is compressed.
+	/// </summary>
+	/// <param name="_image"></param>
+	/// <param name="_level"></param>
+	/// <returns></returns>
+	static size_t GetLevelBytes(const ImageData& _image, int _level);
+
+private:
+	enum class AssetType
+	{
+		Model,
+		Texture,
+		Shader,
+		// Only read by other assets, such as shader includes and OBJ materials
+		Dependency,
+		Other,
+	};
+
+	/// <summary>
+	/// An output and the source files it was made from.
+	/// </summary>
+	struct CookRecord
+	{
+		std::string Output{};
+		uint32_t Version = 0;
+		std::vector<std::pair<std::string, uint64_t>> Inputs{};
+	};
+
+	static constexpr uint32_t ModelMagic = 0x48534D47; // "GMSH"
+
+	// Bumped whenever the cooked format or the cooking of that type of asset changes, so only those assets are cooked again
+	static constexpr uint32_t ModelVersion = 1;
+	static constexpr uint32_t TextureVersion = 2;
+	static constexpr uint32_t ShaderVersion = 1;
+	static constexpr uint32_t OtherVersion = 1;
+
+	/// <summary>
+	/// Returns the type of a source asset from its extension.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <returns></returns>
+	static AssetType GetAssetType(std::string_view _path);
+
+	/// <summary>
+	/// Returns the version of the cooked output of a type of asset.
+	/// </summary>
+	/// <param name="_type"></param>
+	/// <returns></returns>
+	static uint32_t GetVersion(AssetType _type);
+
+	/// <summary>
+	/// Cooks one source asset into _output, adding every file it read to _dependencies.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <param name="_output"></param>
+	/// <param name="_dependencies"></param>
+	/// <returns></returns>
+	static bool CookAsset(const std::string& _path, std::vector<unsigned char>& _output, std::vector<std::string>& _dependencies);
+
+	static bool CookShader(const std::string& _path, std::vector<unsigned char>& _output, std::vector<std::string>& _dependencies);
+	static void WriteModel(const ModelData& _model, std::vector<unsigned char>& _output);
+
+	static std::vector<CookRecord> ReadManifest(const std::string& _manifestPath);
+	static bool WriteManifest(const std::string& _manifestPath, const std::vector<CookRecord>& _records);
+};
@@ -0,0 +1,1028 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : BlockCompressor.cpp 
+// Description : BlockCompressor Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "BlockCompressor.h"
+#include <immintrin.h>
+#include <cfloat>
+#include <cstring>
+#include <chrono>
+#include <random>
+
+namespace
+{
+	// Thin wrappers so the index search is written once for both register widths
+#if defined(__AVX__)
+	using FloatBatch = __m256;
+	const int BatchWidth = 8;
+	inline FloatBatch BatchLoad(const float* _address) { return _mm256_load_ps(_address); }
+	inline void BatchStore(float* _address, FloatBatch _a) { _mm256_store_ps(_address, _a); }
+	inline FloatBatch BatchBroadcast(float _value) { return _mm256_set1_ps(_value); }
+	inline FloatBatch BatchAdd(FloatBatch _a, FloatBatch _b) { return _mm256_add_ps(_a, _b); }
+	inline FloatBatch BatchSubtract(FloatBatch _a, FloatBatch _b) { return _mm256_sub_ps(_a, _b); }
+	inline FloatBatch BatchMultiply(FloatBatch _a, FloatBatch _b) { return _mm256_mul_ps(_a, _b); }
+	inline FloatBatch BatchMin(FloatBatch _a, FloatBatch _b) { return _mm256_min_ps(_a, _b); }
+	inline FloatBatch BatchLessThan(FloatBatch _a, FloatBatch _b) { return _mm256_cmp_ps(_a, _b, _CMP_LT_OQ); }
+	inline FloatBatch BatchSelect(FloatBatch _mask, FloatBatch _a, FloatBatch _b) { return _mm256_blendv_ps(_b, _a, _mask); }
+#else
+	using FloatBatch = __m128;
+	const int BatchWidth = 4;
+	inline FloatBatch BatchLoad(const float* _address) { return _mm_load_ps(_address); }
+	inline void BatchStore(float* _address, FloatBatch _a) { _mm_store_ps(_address, _a); }
+	inline FloatBatch BatchBroadcast(float _value) { return _mm_set1_ps(_value); }
+	inline FloatBatch BatchAdd(FloatBatch _a, FloatBatch _b) { return _mm_add_ps(_a, _b); }
+	inline FloatBatch BatchSubtract(FloatBatch _a, FloatBatch _b) { return _mm_sub_ps(_a, _b); }
+	inline FloatBatch BatchMultiply(FloatBatch _a, FloatBatch _b) { return _mm_mul_ps(_a, _b); }
+	inline FloatBatch BatchMin(FloatBatch _a, FloatBatch _b) { return _mm_min_ps(_a, _b); }
+	inline FloatBatch BatchLessThan(FloatBatch _a, FloatBatch _b) { return _mm_cmplt_ps(_a, _b); }
+	inline FloatBatch BatchSelect(FloatBatch _mask, FloatBatch _a, FloatBatch _b) { return _mm_or_ps(_mm_and_ps(_mask, _a), _mm_andnot_ps(_mask, _b)); }
+#endif
+
+	// Interpolation weights out of 64 for 3 and 4 bit BC7 indices
+	const int BC7Weights3[8]{ 0, 9, 18, 27, 37, 46, 55, 64 };
+	const int BC7Weights4[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// The texels in the second subset of each 2 subset BC7 partition, one bit per texel in row order
+	const uint16_t BC7Partitions2[64]{
+		0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+		0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+		0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+		0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22 };
+
+	// The texel of the second subset whose index has its top bit dropped, the first subset's is always texel 0
+	const uint8_t BC7Anchors2[64]{
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+		15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+		6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15 };
+
+	// Packs fields from the lowest bit up, the order BC7 blocks are laid out in
+	struct BitWriter
+	{
+		uint64_t Bits[2]{};
+		int Position = 0;
+
+		void Write(uint32_t _value, int _count)
+		{
+			for (int bit = 0; bit < _count; bit++, Position++)
+			{
+				Bits[Position >> 6] |= (uint64_t)(_value >> bit & 1) << (Position & 63);
+			}
+		}
+	};
+
+	struct BitReader
+	{
+		uint64_t Bits[2]{};
+		int Position = 0;
+
+		uint32_t Read(int _count)
+		{
+			uint32_t value = 0;
+			for (int bit = 0; bit < _count; bit++, Position++)
+			{
+				value |= (uint32_t)(Bits[Position >> 6] >> (Position & 63) & 1) << bit;
+			}
+			return value;
+		}
+	};
+
+	// Finds the closest palette entry to each texel in _mask over the given channels, returning the squared error of those texels.
+	// Texels outside the mask keep their index
+	float SelectIndices(const float (*_channels)[16], int _firstChannel, int _channelCount, const glm::vec4* _palette, int _paletteSize, uint16_t _mask, uint8_t* _indices)
+	{
+		float error = 0.0f;
+		for (int start = 0; start < 16; start += BatchWidth)
+		{
+			FloatBatch best = BatchBroadcast(FLT_MAX);
+			FloatBatch bestIndex = BatchBroadcast(0.0f);
+			for (int entry = 0; entry < _paletteSize; entry++)
+			{
+				FloatBatch distance = BatchBroadcast(0.0f);
+				for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+				{
+					FloatBatch difference = BatchSubtract(BatchLoad(&_channels[channel][start]), BatchBroadcast(_palette[entry][channel]));
+					distance = BatchAdd(distance, BatchMultiply(difference, difference));
+				}
+				FloatBatch isCloser = BatchLessThan(distance, best);
+				best = BatchMin(distance, best);
+				bestIndex = BatchSelect(isCloser, BatchBroadcast((float)entry), bestIndex);
+			}
+
+			alignas(32) float errors[BatchWidth];
+			alignas(32) float indices[BatchWidth];
+			BatchStore(errors, best);
+			BatchStore(indices, bestIndex);
+			for (int lane = 0; lane < BatchWidth; lane++)
+			{
+				if (!(_mask >> (start + lane) & 1))
+					continue;
+				error += errors[lane];
+				_indices[start + lane] = (uint8_t)indices[lane];
+			}
+		}
+		return error;
+	}
+
+	// Mean and unnormalised covariance of the texels in _mask, returning how many there are
+	int ComputeCovariance(const float (*_channels)[16], int _firstChannel, int _channelCount, uint16_t _mask, glm::vec4& _mean, glm::mat4& _covariance)
+	{
+		int count = 0;
+		_mean = glm::vec4{ 0.0f };
+		for (int texel = 0; texel < 16; texel++)
+		{
+			if (!(_mask >> texel & 1))
+				continue;
+			for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+			{
+				_mean[channel] += _channels[channel][texel];
+			}
+			count++;
+		}
+		if (count == 0)
+			return 0;
+		_mean /= (float)count;
+
+		_covariance = glm::mat4{ 0.0f };
+		for (int texel = 0; texel < 16; texel++)
+		{
+			if (!(_mask >> texel & 1))
+				continue;
+			glm::vec4 difference{ 0.0f };
+			for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+			{
+				difference[channel] = _channels[channel][texel] - _mean[channel];
+			}
+			_covariance += glm::outerProduct(difference, difference);
+		}
+		return count;
+	}
+
+	// Power iteration towards the eigenvector with the largest eigenvalue, keeping _axis if the covariance is zero
+	glm::vec4 GetPrincipalAxis(const glm::mat4& _covariance, glm::vec4 _axis)
+	{
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			glm::vec4 next = _covariance * _axis;
+			float scale = glm::max(glm::max(glm::abs(next.x), glm::abs(next.y)), glm::max(glm::abs(next.z), glm::abs(next.w)));
+			if (scale < 1e-6f)
+				break;
+			_axis = next / scale;
+		}
+		return _axis;
+	}
+
+	// Fits a line through the texels in _mask, along their principal axis or across their bounding box, and returns its ends
+	void FitEndpoints(const float (*_channels)[16], int _firstChannel, int _channelCount, uint16_t _mask, bool _usePrincipalAxis, glm::vec4& _low, glm::vec4& _high)
+	{
+		glm::vec4 mean{};
+		glm::mat4 covariance{};
+		if (ComputeCovariance(_channels, _firstChannel, _channelCount, _mask, mean, covariance) == 0)
+		{
+			_low = _high = glm::vec4{ 0.0f };
+			return;
+		}
+
+		glm::vec4 minimum{ 0.0f }, maximum{ 0.0f };
+		for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+		{
+			minimum[channel] = 255.0f;
+			for (int texel = 0; texel < 16; texel++)
+			{
+				if (!(_mask >> texel & 1))
+					continue;
+				minimum[channel] = glm::min(minimum[channel], _channels[channel][texel]);
+				maximum[channel] = glm::max(maximum[channel], _channels[channel][texel]);
+			}
+		}
+
+		// The box diagonal, with channels that fall as the widest one rises flipped
+		glm::vec4 axis = maximum - minimum;
+		int widest = _firstChannel;
+		for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+		{
+			if (axis[channel] > axis[widest])
+				widest = channel;
+		}
+		for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+		{
+			if (covariance[widest][channel] < 0.0f)
+				axis[channel] = -axis[channel];
+		}
+		if (glm::dot(axis, axis) < 1e-6f)
+		{
+			_low = _high = mean;
+			return;
+		}
+
+		if (!_usePrincipalAxis)
+		{
+			// Inset by a 16th so the interpolated colours sit closer to the texels
+			for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+			{
+				_low[channel] = axis[channel] >= 0.0f ? minimum[channel] : maximum[channel];
+				_high[channel] = axis[channel] >= 0.0f ? maximum[channel] : minimum[channel];
+			}
+			glm::vec4 inset = (_high - _low) / 16.0f;
+			_low += inset;
+			_high -= inset;
+			return;
+		}
+
+		axis = GetPrincipalAxis(covariance, axis);
+		float lengthSquared = glm::dot(axis, axis);
+		float lowest = FLT_MAX, highest = -FLT_MAX;
+		for (int texel = 0; texel < 16; texel++)
+		{
+			if (!(_mask >> texel & 1))
+				continue;
+			glm::vec4 difference{ 0.0f };
+			for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+			{
+				difference[channel] = _channels[channel][texel] - mean[channel];
+			}
+			float projection = glm::dot(difference, axis) / lengthSquared;
+			lowest = glm::min(lowest, projection);
+			highest = glm::max(highest, projection);
+		}
+		_low = glm::clamp(mean + axis * lowest, 0.0f, 255.0f);
+		_high = glm::clamp(mean + axis * highest, 0.0f, 255.0f);
+	}
+
+	// Least squares endpoints for the chosen indices, given the weight of the high endpoint at each index.
+	// Returns false if every texel has the same weight, which leaves the endpoints undetermined
+	bool RefineEndpoints(const float (*_channels)[16], int _firstChannel, int _channelCount, uint16_t _mask, const uint8_t* _indices, const float* _weights, glm::vec4& _low, glm::vec4& _high)
+	{
+		float lowLow = 0.0f, lowHigh = 0.0f, highHigh = 0.0f;
+		glm::vec4 lowSum{ 0.0f }, highSum{ 0.0f };
+		for (int texel = 0; texel < 16; texel++)
+		{
+			if (!(_mask >> texel & 1))
+				continue;
+			float weight = _weights[_indices[texel]];
+			lowLow += (1.0f - weight) * (1.0f - weight);
+			lowHigh += (1.0f - weight) * weight;
+			highHigh += weight * weight;
+			for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+			{
+				lowSum[channel] += (1.0f - weight) * _channels[channel][texel];
+				highSum[channel] += weight * _channels[channel][texel];
+			}
+		}
+
+		float determinant = lowLow * highHigh - lowHigh * lowHigh;
+		if (glm::abs(determinant) < 1e-6f)
+			return false;
+		_low = glm::clamp((highHigh * lowSum - lowHigh * highSum) / determinant, 0.0f, 255.0f);
+		_high = glm::clamp((lowLow * highSum - lowHigh * lowSum) / determinant, 0.0f, 255.0f);
+		return true;
+	}
+
+	// Squared distance of the texels in _mask from their best fitting line, used to rank BC7 partitions
+	float GetLineError(const float (*_channels)[16], int _firstChannel, int _channelCount, uint16_t _mask)
+	{
+		glm::vec4 mean{};
+		glm::mat4 covariance{};
+		if (ComputeCovariance(_channels, _firstChannel, _channelCount, _mask, mean, covariance) == 0)
+			return 0.0f;
+
+		glm::vec4 axis{ 0.0f };
+		float trace = 0.0f;
+		for (int channel = _firstChannel; channel < _firstChannel + _channelCount; channel++)
+		{
+			axis[channel] = 1.0f - 0.25f * (channel - _firstChannel);
+			trace += covariance[channel][channel];
+		}
+		axis = GetPrincipalAxis(covariance, axis);
+		float lengthSquared = glm::dot(axis, axis);
+		if (lengthSquared < 1e-12f)
+			return 0.0f;
+		return glm::max(trace - glm::dot(axis, covariance * axis) / lengthSquared, 0.0f);
+	}
+
+	uint16_t To565(const glm::vec4& _color)
+	{
+		int red = glm::clamp((int)(_color.r * 31.0f / 255.0f + 0.5f), 0, 31);
+		int green = glm::clamp((int)(_color.g * 63.0f / 255.0f + 0.5f), 0, 63);
+		int blue = glm::clamp((int)(_color.b * 31.0f / 255.0f + 0.5f), 0, 31);
+		return (uint16_t)(red << 11 | green << 5 | blue);
+	}
+
+	glm::ivec4 From565(uint16_t _color)
+	{
+		int red = _color >> 11, green = _color >> 5 & 63, blue = _color & 31;
+		return { red << 3 | red >> 2, green << 2 | green >> 4, blue << 3 | blue >> 2, 255 };
+	}
+
+	// Interpolated values of a BC4 style channel block, 8 when the first endpoint is larger, otherwise 6 and exact 0 and 255
+	void GetChannelPalette(int _first, int _second, int* _palette)
+	{
+		_palette[0] = _first;
+		_palette[1] = _second;
+		if (_first > _second)
+		{
+			for (int i = 2; i < 8; i++)
+			{
+				_palette[i] = ((8 - i) * _first + (i - 1) * _second + 3) / 7;
+			}
+			return;
+		}
+		for (int i = 2; i < 6; i++)
+		{
+			_palette[i] = ((6 - i) * _first + (i - 1) * _second + 2) / 5;
+		}
+		_palette[6] = 0;
+		_palette[7] = 255;
+	}
+
+	// Expands a BC7 endpoint of _bits per channel plus a p-bit to 8 bits
+	int ExpandBC7(int _code, int _pBit, int _bits)
+	{
+		int value = _code << 1 | _pBit;
+		int precision = _bits + 1;
+		return precision == 8 ? value : (value << (8 - precision)) | (value >> (2 * precision - 8));
+	}
+
+	// Quantizes endpoints that share a p-bit, picking the p-bit that lands closer, and returns it
+	int QuantizeBC7(const glm::vec4* _ends, int _endCount, int _channelCount, int _bits, glm::ivec4* _codes, glm::ivec4* _expanded)
+	{
+		float bestError = FLT_MAX;
+		int bestBit = 0;
+		int largest = (1 << _bits) - 1;
+		float scale = (float)((1 << (_bits + 1)) - 1) / 255.0f;
+		for (int pBit = 0; pBit < 2; pBit++)
+		{
+			glm::ivec4 codes[2]{}, expanded[2]{};
+			float error = 0.0f;
+			for (int end = 0; end < _endCount; end++)
+			{
+				for (int channel = 0; channel < _channelCount; channel++)
+				{
+					codes[end][channel] = glm::clamp((int)std::round((_ends[end][channel] * scale - pBit) / 2.0f), 0, largest);
+					expanded[end][channel] = ExpandBC7(codes[end][channel], pBit, _bits);
+					float difference = expanded[end][channel] - _ends[end][channel];
+					error += difference * difference;
+				}
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				bestBit = pBit;
+				std::copy(codes, codes + _endCount, _codes);
+				std::copy(expanded, expanded + _endCount, _expanded);
+			}
+		}
+		return bestBit;
+	}
+}
+
+BlockFormat BlockCompressor::ChooseFormat(const ImageData& _image, CompressionQuality _quality)
+{
+	if (_image.Components == 2)
+		return BlockFormat::BC5;
+
+	bool isTranslucent = false;
+	if (_image.Components == 4 && _image.Levels.size() > 0)
+	{
+		size_t texelCount = (size_t)_image.Size.x * _image.Size.y;
+		for (size_t texel = 0; texel < texelCount && !isTranslucent; texel++)
+		{
+			isTranslucent = _image.Levels[0][texel * 4 + 3] != 255;
+		}
+	}
+	if (isTranslucent)
+		return _quality == CompressionQuality::Fast ? BlockFormat::BC3 : BlockFormat::BC7;
+	return _quality == CompressionQuality::High ? BlockFormat::BC7 : BlockFormat::BC1;
+}
+
+bool BlockCompressor::Compress(const ImageData& _image, BlockFormat _format, CompressionQuality _quality, ImageData& _compressed)
+{
+	if (_image.Format != 0 || _image.Components < 1 || _image.Components > 4)
+		return false;
+
+	_compressed.Size = _image.Size;
+	_compressed.Components = _format == BlockFormat::BC5 ? 2 : _format == BlockFormat::BC1 ? 3 : 4;
+	_compressed.Format = GetGLFormat(_format);
+	int levelCount = (int)_image.Levels.size();
+	std::vector<size_t> levelOffsets(levelCount);
+	size_t storageSize = 0;
+	for (int level = 0; level < levelCount; level++)
+	{
+		levelOffsets[level] = storageSize;
+		storageSize += AssetCooker::GetLevelBytes(_compressed, level);
+	}
+	_compressed.Storage.resize(storageSize);
+
+	// Blocks past the edge of levels smaller than 4 texels repeat the last row and column
+	int blockBytes = GetBlockBytes(_compressed.Format);
+	int components = _image.Components;
+	for (int level = 0; level < levelCount; level++)
+	{
+		glm::ivec2 size = AssetCooker::GetLevelSize(_image, level);
+		const unsigned char* source = _image.Levels[level];
+		unsigned char* destination = _compressed.Storage.data() + levelOffsets[level];
+		for (int blockY = 0; blockY < (size.y + 3) / 4; blockY++)
+		{
+			for (int blockX = 0; blockX < (size.x + 3) / 4; blockX++)
+			{
+				unsigned char texels[64]{};
+				for (int y = 0; y < 4; y++)
+				{
+					for (int x = 0; x < 4; x++)
+					{
+						int sourceX = std::min(blockX * 4 + x, size.x - 1);
+						int sourceY = std::min(blockY * 4 + y, size.y - 1);
+						const unsigned char* texel = source + ((size_t)sourceY * size.x + sourceX) * components;
+						unsigned char* rgba = texels + (y * 4 + x) * 4;
+						rgba[0] = texel[0];
+						rgba[1] = components == 1 ? texel[0] : texel[1];
+						rgba[2] = components == 1 ? texel[0] : components == 2 ? 0 : texel[2];
+						rgba[3] = components == 4 ? texel[3] : 255;
+					}
+				}
+				CompressBlock(_format, texels, _quality, destination);
+				destination += blockBytes;
+			}
+		}
+	}
+
+	_compressed.Levels.resize(levelCount);
+	for (int level = 0; level < levelCount; level++)
+	{
+		_compressed.Levels[level] = _compressed.Storage.data() + levelOffsets[level];
+	}
+	return true;
+}
+
+void BlockCompressor::CompressBlock(BlockFormat _format, const unsigned char* _texels, CompressionQuality _quality, unsigned char* _block)
+{
+	BlockTexels texels{};
+	for (int texel = 0; texel < 16; texel++)
+	{
+		for (int channel = 0; channel < 4; channel++)
+		{
+			texels.Channels[channel][texel] = _texels[texel * 4 + channel];
+		}
+	}
+
+	switch (_format)
+	{
+	case BlockFormat::BC1:
+		EncodeColorBlock(texels, _quality, _block);
+		break;
+	case BlockFormat::BC3:
+		EncodeChannelBlock(texels, 3, _quality, _block);
+		EncodeColorBlock(texels, _quality, _block + 8);
+		break;
+	case BlockFormat::BC5:
+		EncodeChannelBlock(texels, 0, _quality, _block);
+		EncodeChannelBlock(texels, 1, _quality, _block + 8);
+		break;
+	case BlockFormat::BC7:
+		EncodeBC7Block(texels, _quality, _block);
+		break;
+	}
+}
+
+bool BlockCompressor::DecompressBlock(BlockFormat _format, const unsigned char* _block, unsigned char* _texels)
+{
+	switch (_format)
+	{
+	case BlockFormat::BC1:
+		DecodeColorBlock(_block, true, _texels);
+		return true;
+	case BlockFormat::BC3:
+		DecodeColorBlock(_block + 8, false, _texels);
+		DecodeChannelBlock(_block, 3, _texels);
+		return true;
+	case BlockFormat::BC5:
+		for (int texel = 0; texel < 16; texel++)
+		{
+			_texels[texel * 4 + 2] = 0;
+			_texels[texel * 4 + 3] = 255;
+		}
+		DecodeChannelBlock(_block, 0, _texels);
+		DecodeChannelBlock(_block + 8, 1, _texels);
+		return true;
+	case BlockFormat::BC7:
+		return DecodeBC7Block(_block, _texels);
+	}
+	return false;
+}
+
+GLenum BlockCompressor::GetGLFormat(BlockFormat _format)
+{
+	switch (_format)
+	{
+	case BlockFormat::BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BlockFormat::BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case BlockFormat::BC5:
+		return GL_COMPRESSED_RG_RGTC2;
+	case BlockFormat::BC7:
+		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+	return 0;
+}
+
+int BlockCompressor::GetBlockBytes(GLenum _format)
+{
+	switch (_format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		return 8;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RG_RGTC2:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+void BlockCompressor::Benchmark(int _size)
+{
+	// Smooth gradients, flat tiles with hard edges and a noisy band, and an alpha ramp over the left half, so every kind of block is represented
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> noise(-24, 24);
+	ImageData image{ { _size, _size }, 4 };
+	image.Storage.resize((size_t)_size * _size * 4);
+	for (int y = 0; y < _size; y++)
+	{
+		for (int x = 0; x < _size; x++)
+		{
+			float u = (float)x / _size, v = (float)y / _size;
+			glm::vec3 color{ 128.0f + 100.0f * std::sin(u * 12.6f), 128.0f + 100.0f * std::cos(v * 18.8f), 128.0f + 100.0f * std::sin((u + v) * 6.3f) };
+			int tile = (x / 16 * 7 + y / 16 * 13) % 5;
+			if (y < _size / 3 && tile < 2)
+				color = tile == 0 ? glm::vec3{ 220.0f, 40.0f, 30.0f } : glm::vec3{ 20.0f, 60.0f, 200.0f };
+			if (y > _size * 2 / 3)
+				color += glm::vec3{ (float)noise(random), (float)noise(random), (float)noise(random) };
+
+			unsigned char* texel = image.Storage.data() + ((size_t)y * _size + x) * 4;
+			texel[0] = (unsigned char)glm::clamp(color.r, 0.0f, 255.0f);
+			texel[1] = (unsigned char)glm::clamp(color.g, 0.0f, 255.0f);
+			texel[2] = (unsigned char)glm::clamp(color.b, 0.0f, 255.0f);
+			texel[3] = (unsigned char)(255.0f * std::min(2.0f * u, 1.0f));
+		}
+	}
+	image.Levels = { image.Storage.data() };
+
+	Print("Block Compression Benchmark (" + std::to_string(_size) + "x" + std::to_string(_size) + ")");
+	const BlockFormat formats[]{ BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 };
+	const char* formatNames[]{ "BC1", "BC3", "BC5", "BC7" };
+	const int formatChannels[]{ 3, 4, 2, 4 };
+	const CompressionQuality qualities[]{ CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High };
+	const char* qualityNames[]{ "Fast", "Normal", "High" };
+	for (int format = 0; format < 4; format++)
+	{
+		for (int quality = 0; quality < 3; quality++)
+		{
+			ImageData compressed{};
+			auto start = std::chrono::high_resolution_clock::now();
+			Compress(image, formats[format], qualities[quality], compressed);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			// Error over the channels the format stores
+			double squaredError = 0.0;
+			int blockBytes = GetBlockBytes(compressed.Format);
+			const unsigned char* block = compressed.Levels[0];
+			for (int blockY = 0; blockY < _size / 4; blockY++)
+			{
+				for (int blockX = 0; blockX < _size / 4; blockX++, block += blockBytes)
+				{
+					unsigned char texels[64]{};
+					DecompressBlock(formats[format], block, texels);
+					for (int texel = 0; texel < 16; texel++)
+					{
+						const unsigned char* original = image.Levels[0] + ((size_t)(blockY * 4 + texel / 4) * _size + blockX * 4 + texel % 4) * 4;
+						for (int channel = 0; channel < formatChannels[format]; channel++)
+						{
+							double difference = (double)texels[texel * 4 + channel] - original[channel];
+							squaredError += difference * difference;
+						}
+					}
+				}
+			}
+
+			double time = std::chrono::duration<double>(end - start).count();
+			double meanSquaredError = squaredError / ((double)_size * _size * formatChannels[format]);
+			double psnr = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+			Print(std::string(formatNames[format]) + " " + qualityNames[quality] + ": " + std::to_string((double)_size * _size / time / 1000000.0)
+				+ " MPixels/s (1 core), PSNR " + std::to_string(psnr) + " dB");
+		}
+	}
+}
+
+void BlockCompressor::EncodeColorBlock(const BlockTexels& _texels, CompressionQuality _quality, unsigned char* _block)
+{
+	glm::vec4 low{}, high{};
+	FitEndpoints(_texels.Channels, 0, 3, 0xFFFF, _quality != CompressionQuality::Fast, low, high);
+
+	// Weight of the first colour at each index, the first colour is fitted as the high endpoint
+	const float weights[4]{ 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	int passCount = _quality == CompressionQuality::Fast ? 1 : _quality == CompressionQuality::Normal ? 2 : 4;
+	float bestError = FLT_MAX;
+	for (int pass = 0; pass < passCount; pass++)
+	{
+		// Four colour mode needs the first colour to be the larger, equal colours only use index 0
+		uint16_t color0 = To565(high), color1 = To565(low);
+		if (color0 < color1)
+			std::swap(color0, color1);
+		glm::vec4 end0{ From565(color0) }, end1{ From565(color1) };
+		glm::vec4 palette[4]{};
+		for (int entry = 0; entry < 4; entry++)
+		{
+			palette[entry] = end1 + (end0 - end1) * weights[entry];
+		}
+
+		uint8_t indices[16]{};
+		float error = SelectIndices(_texels.Channels, 0, 3, palette, color0 == color1 ? 1 : 4, 0xFFFF, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			uint32_t indexBits = 0;
+			for (int texel = 0; texel < 16; texel++)
+			{
+				indexBits |= (uint32_t)indices[texel] << (texel * 2);
+			}
+			std::memcpy(_block, &color0, 2);
+			std::memcpy(_block + 2, &color1, 2);
+			std::memcpy(_block + 4, &indexBits, 4);
+		}
+		if (error == 0.0f || !RefineEndpoints(_texels.Channels, 0, 3, 0xFFFF, indices, weights, low, high))
+			break;
+	}
+}
+
+void BlockCompressor::EncodeChannelBlock(const BlockTexels& _texels, int _channel, CompressionQuality _quality, unsigned char* _block)
+{
+	// The 6 value mode has exact 0 and 255, so its endpoints only have to cover the values between them
+	const float* values = _texels.Channels[_channel];
+	int minimum = 255, maximum = 0, innerMinimum = 255, innerMaximum = 0;
+	for (int texel = 0; texel < 16; texel++)
+	{
+		int value = (int)values[texel];
+		minimum = std::min(minimum, value);
+		maximum = std::max(maximum, value);
+		if (value != 0 && value != 255)
+		{
+			innerMinimum = std::min(innerMinimum, value);
+			innerMaximum = std::max(innerMaximum, value);
+		}
+	}
+
+	// Endpoint pairs to try, the first larger for the 8 value mode
+	std::vector<glm::ivec2> candidates{ { maximum, minimum } };
+	if (_quality != CompressionQuality::Fast && innerMinimum <= innerMaximum && (minimum == 0 || maximum == 255))
+		candidates.push_back({ innerMinimum, innerMaximum });
+	if (_quality == CompressionQuality::High && maximum > minimum)
+	{
+		for (int offsetHigh = -2; offsetHigh <= 2; offsetHigh++)
+		{
+			for (int offsetLow = -2; offsetLow <= 2; offsetLow++)
+			{
+				glm::ivec2 candidate{ std::clamp(maximum + offsetHigh, 0, 255), std::clamp(minimum + offsetLow, 0, 255) };
+				if (candidate.x > candidate.y && (offsetHigh != 0 || offsetLow != 0))
+					candidates.push_back(candidate);
+			}
+		}
+	}
+
+	// Weight of the first endpoint at each index of the 8 value mode
+	const float weights[8]{ 1.0f, 0.0f, 6.0f / 7.0f, 5.0f / 7.0f, 4.0f / 7.0f, 3.0f / 7.0f, 2.0f / 7.0f, 1.0f / 7.0f };
+	float bestError = FLT_MAX;
+	for (size_t candidate = 0; candidate < candidates.size(); candidate++)
+	{
+		glm::ivec2 ends = candidates[candidate];
+		int palette[8]{};
+		GetChannelPalette(ends.x, ends.y, palette);
+		glm::vec4 entries[8]{};
+		for (int entry = 0; entry < 8; entry++)
+		{
+			entries[entry][_channel] = (float)palette[entry];
+		}
+
+		uint8_t indices[16]{};
+		float error = SelectIndices(_texels.Channels, _channel, 1, entries, 8, 0xFFFF, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			uint64_t indexBits = 0;
+			for (int texel = 0; texel < 16; texel++)
+			{
+				indexBits |= (uint64_t)indices[texel] << (texel * 3);
+			}
+			_block[0] = (unsigned char)ends.x;
+			_block[1] = (unsigned char)ends.y;
+			std::memcpy(_block + 2, &indexBits, 6);
+		}
+
+		// The first candidate's indices give a least squares fit of the 8 value mode to try last
+		glm::vec4 low{}, high{};
+		if (candidate == 0 && _quality != CompressionQuality::Fast && ends.x > ends.y
+			&& RefineEndpoints(_texels.Channels, _channel, 1, 0xFFFF, indices, weights, low, high))
+		{
+			glm::ivec2 refined{ (int)std::round(high[_channel]), (int)std::round(low[_channel]) };
+			if (refined.x > refined.y && refined != ends)
+				candidates.push_back(refined);
+		}
+	}
+}
+
+void BlockCompressor::EncodeBC7Block(const BlockTexels& _texels, CompressionQuality _quality, unsigned char* _block)
+{
+	float error = EncodeBC7Mode6(_texels, _quality, _block);
+	if (_quality != CompressionQuality::High || error == 0.0f)
+		return;
+
+	// Mode 1 has no alpha
+	for (int texel = 0; texel < 16; texel++)
+	{
+		if (_texels.Channels[3][texel] != 255.0f)
+			return;
+	}
+
+	// Only the partitions whose subsets lie closest to lines are encoded
+	const int candidateCount = 4;
+	std::pair<float, int> ranked[64]{};
+	for (int partition = 0; partition < 64; partition++)
+	{
+		uint16_t mask = BC7Partitions2[partition];
+		ranked[partition] = { GetLineError(_texels.Channels, 0, 3, (uint16_t)~mask) + GetLineError(_texels.Channels, 0, 3, mask), partition };
+	}
+	std::partial_sort(ranked, ranked + candidateCount, ranked + 64);
+	for (int candidate = 0; candidate < candidateCount; candidate++)
+	{
+		unsigned char block[16]{};
+		float candidateError = EncodeBC7Mode1(_texels, ranked[candidate].second, block);
+		if (candidateError < error)
+		{
+			error = candidateError;
+			std::memcpy(_block, block, 16);
+		}
+	}
+}
+
+float BlockCompressor::EncodeBC7Mode6(const BlockTexels& _texels, CompressionQuality _quality, unsigned char* _block)
+{
+	glm::vec4 low{}, high{};
+	FitEndpoints(_texels.Channels, 0, 4, 0xFFFF, _quality != CompressionQuality::Fast, low, high);
+
+	float weights[16]{};
+	for (int index = 0; index < 16; index++)
+	{
+		weights[index] = BC7Weights4[index] / 64.0f;
+	}
+
+	// Each endpoint is 7 bits per channel with its own p-bit as the lowest bit
+	int passCount = _quality == CompressionQuality::Fast ? 1 : _quality == CompressionQuality::Normal ? 2 : 3;
+	float bestError = FLT_MAX;
+	glm::ivec4 bestCodes[2]{};
+	int bestBits[2]{};
+	uint8_t bestIndices[16]{};
+	for (int pass = 0; pass < passCount; pass++)
+	{
+		glm::ivec4 codes[2]{}, expanded[2]{};
+		int bits[2]{ QuantizeBC7(&low, 1, 4, 7, &codes[0], &expanded[0]), QuantizeBC7(&high, 1, 4, 7, &codes[1], &expanded[1]) };
+		glm::vec4 palette[16]{};
+		for (int entry = 0; entry < 16; entry++)
+		{
+			palette[entry] = glm::vec4(((64 - BC7Weights4[entry]) * expanded[0] + BC7Weights4[entry] * expanded[1] + 32) >> 6);
+		}
+
+		uint8_t indices[16]{};
+		float error = SelectIndices(_texels.Channels, 0, 4, palette, 16, 0xFFFF, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			std::copy(codes, codes + 2, bestCodes);
+			std::copy(bits, bits + 2, bestBits);
+			std::copy(indices, indices + 16, bestIndices);
+		}
+		if (error == 0.0f || !RefineEndpoints(_texels.Channels, 0, 4, 0xFFFF, indices, weights, low, high))
+			break;
+	}
+
+	// The top bit of texel 0's index is implied 0, so the endpoints are swapped if it would be set
+	if (bestIndices[0] >= 8)
+	{
+		std::swap(bestCodes[0], bestCodes[1]);
+		std::swap(bestBits[0], bestBits[1]);
+		for (auto& index : bestIndices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	BitWriter writer{};
+	writer.Write(1 << 6, 7);
+	for (int channel = 0; channel < 4; channel++)
+	{
+		writer.Write(bestCodes[0][channel], 7);
+		writer.Write(bestCodes[1][channel], 7);
+	}
+	writer.Write(bestBits[0], 1);
+	writer.Write(bestBits[1], 1);
+	for (int texel = 0; texel < 16; texel++)
+	{
+		writer.Write(bestIndices[texel], texel == 0 ? 3 : 4);
+	}
+	std::memcpy(_block, writer.Bits, 16);
+	return bestError;
+}
+
+float BlockCompressor::EncodeBC7Mode1(const BlockTexels& _texels, int _partition, unsigned char* _block)
+{
+	const uint16_t masks[2]{ (uint16_t)~BC7Partitions2[_partition], BC7Partitions2[_partition] };
+	float weights[8]{};
+	for (int index = 0; index < 8; index++)
+	{
+		weights[index] = BC7Weights3[index] / 64.0f;
+	}
+
+	// Each subset has two RGB endpoints of 6 bits per channel sharing one p-bit
+	float totalError = 0.0f;
+	glm::ivec4 codes[2][2]{};
+	int bits[2]{};
+	uint8_t indices[16]{};
+	for (int subset = 0; subset < 2; subset++)
+	{
+		glm::vec4 ends[2]{};
+		FitEndpoints(_texels.Channels, 0, 3, masks[subset], true, ends[0], ends[1]);
+		float bestError = FLT_MAX;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			glm::ivec4 subsetCodes[2]{}, expanded[2]{};
+			int bit = QuantizeBC7(ends, 2, 3, 6, subsetCodes, expanded);
+			glm::vec4 palette[8]{};
+			for (int entry = 0; entry < 8; entry++)
+			{
+				palette[entry] = glm::vec4(((64 - BC7Weights3[entry]) * expanded[0] + BC7Weights3[entry] * expanded[1] + 32) >> 6);
+			}
+
+			uint8_t subsetIndices[16]{};
+			float error = SelectIndices(_texels.Channels, 0, 3, palette, 8, masks[subset], subsetIndices);
+			if (error < bestError)
+			{
+				bestError = error;
+				codes[subset][0] = subsetCodes[0];
+				codes[subset][1] = subsetCodes[1];
+				bits[subset] = bit;
+				for (int texel = 0; texel < 16; texel++)
+				{
+					if (masks[subset] >> texel & 1)
+						indices[texel] = subsetIndices[texel];
+				}
+			}
+			if (error == 0.0f || !RefineEndpoints(_texels.Channels, 0, 3, masks[subset], subsetIndices, weights, ends[0], ends[1]))
+				break;
+		}
+		totalError += bestError;
+	}
+
+	// Each subset's anchor texel has its top index bit implied 0
+	const int anchors[2]{ 0, BC7Anchors2[_partition] };
+	for (int subset = 0; subset < 2; subset++)
+	{
+		if (indices[anchors[subset]] < 4)
+			continue;
+		std::swap(codes[subset][0], codes[subset][1]);
+		for (int texel = 0; texel < 16; texel++)
+		{
+			if (masks[subset] >> texel & 1)
+				indices[texel] = 7 - indices[texel];
+		}
+	}
+
+	BitWriter writer{};
+	writer.Write(1 << 1, 2);
+	writer.Write(_partition, 6);
+	for (int channel = 0; channel < 3; channel++)
+	{
+		for (int subset = 0; subset < 2; subset++)
+		{
+			writer.Write(codes[subset][0][channel], 6);
+			writer.Write(codes[subset][1][channel], 6);
+		}
+	}
+	writer.Write(bits[0], 1);
+	writer.Write(bits[1], 1);
+	for (int texel = 0; texel < 16; texel++)
+	{
+		writer.Write(indices[texel], texel == anchors[0] || texel == anchors[1] ? 2 : 3);
+	}
+	std::memcpy(_block, writer.Bits, 16);
+	return totalError;
+}
+
+void BlockCompressor::DecodeColorBlock(const unsigned char* _block, bool _allowTransparent, unsigned char* _texels)
+{
+	uint16_t color0 = 0, color1 = 0;
+	uint32_t indexBits = 0;
+	std::memcpy(&color0, _block, 2);
+	std::memcpy(&color1, _block + 2, 2);
+	std::memcpy(&indexBits, _block + 4, 4);
+
+	glm::ivec4 end0 = From565(color0), end1 = From565(color1);
+	glm::ivec4 palette[4]{ end0, end1 };
+	if (color0 > color1 || !_allowTransparent)
+	{
+		palette[2] = (2 * end0 + end1) / 3;
+		palette[3] = (end0 + 2 * end1) / 3;
+	}
+	else
+	{
+		palette[2] = (end0 + end1) / 2;
+		palette[3] = glm::ivec4{ 0 };
+	}
+	for (int texel = 0; texel < 16; texel++)
+	{
+		glm::ivec4 color = palette[indexBits >> (texel * 2) & 3];
+		for (int channel = 0; channel < 4; channel++)
+		{
+			_texels[texel * 4 + channel] = (unsigned char)color[channel];
+		}
+	}
+}
+
+void BlockCompressor::DecodeChannelBlock(const unsigned char* _block, int _channel, unsigned char* _texels)
+{
+	int palette[8]{};
+	GetChannelPalette(_block[0], _block[1], palette);
+	uint64_t indexBits = 0;
+	std::memcpy(&indexBits, _block + 2, 6);
+	for (int texel = 0; texel < 16; texel++)
+	{
+		_texels[texel * 4 + _channel] = (unsigned char)palette[indexBits >> (texel * 3) & 7];
+	}
+}
+
+bool BlockCompressor::DecodeBC7Block(const unsigned char* _block, unsigned char* _texels)
+{
+	BitReader reader{};
+	std::memcpy(reader.Bits, _block, 16);
+	int mode = 0;
+	while (mode < 8 && reader.Read(1) == 0)
+	{
+		mode++;
+	}
+
+	if (mode == 6)
+	{
+		glm::ivec4 codes[2]{};
+		for (int channel = 0; channel < 4; channel++)
+		{
+			codes[0][channel] = reader.Read(7);
+			codes[1][channel] = reader.Read(7);
+		}
+		int bits[2]{ (int)reader.Read(1), (int)reader.Read(1) };
+		for (int texel = 0; texel < 16; texel++)
+		{
+			int weight = BC7Weights4[reader.Read(texel == 0 ? 3 : 4)];
+			for (int channel = 0; channel < 4; channel++)
+			{
+				int end0 = ExpandBC7(codes[0][channel], bits[0], 7), end1 = ExpandBC7(codes[1][channel], bits[1], 7);
+				_texels[texel * 4 + channel] = (unsigned char)(((64 - weight) * end0 + weight * end1 + 32) >> 6);
+			}
+		}
+		return true;
+	}
+
+	if (mode == 1)
+	{
+		int partition = (int)reader.Read(6);
+		glm::ivec4 codes[2][2]{};
+		for (int channel = 0; channel < 3; channel++)
+		{
+			for (int subset = 0; subset < 2; subset++)
+			{
+				codes[subset][0][channel] = reader.Read(6);
+				codes[subset][1][channel] = reader.Read(6);
+			}
+		}
+		int bits[2]{ (int)reader.Read(1), (int)reader.Read(1) };
+		for (int texel = 0; texel < 16; texel++)
+		{
+			int subset = BC7Partitions2[partition] >> texel & 1;
+			int weight = BC7Weights3[reader.Read(texel == 0 || texel == BC7Anchors2[partition] ? 2 : 3)];
+			for (int channel = 0; channel < 3; channel++)
+			{
+				int end0 = ExpandBC7(codes[subset][0][channel], bits[subset], 6), end1 = ExpandBC7(codes[subset][1][channel], bits[subset], 6);
+				_texels[texel * 4 + channel] = (unsigned char)(((64 - weight) * end0 + weight * end1 + 32) >> 6);
+			}
+			_texels[texel * 4 + 3] = 255;
+		}
+		return true;
+	}
+
+	std::memset(_texels, 0, 64);
+	return false;
+}
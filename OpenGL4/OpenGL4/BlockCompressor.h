@@ -0,0 +1,157 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : BlockCompressor.h 
+// Description : BlockCompressor Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "AssetCooker.h"
+
+/// <summary>
+/// The block compressed formats the encoder writes, each storing 4x4 texel blocks.
+/// BC1 is opaque RGB in 8 bytes, BC3 adds an interpolated alpha block for 16, BC5 stores two interpolated channels in 16
+/// and BC7 stores RGBA in 16 with far fewer artifacts than BC1 and BC3.
+/// </summary>
+enum class BlockFormat
+{
+	BC1,
+	BC3,
+	BC5,
+	BC7,
+};
+
+/// <summary>
+/// How hard the encoder searches for the endpoints of a block.
+/// Fast fits the bounding box, Normal fits the principal axis and refines it with least squares,
+/// High refines further and also tries the 2 subset partitions of BC7.
+/// </summary>
+enum class CompressionQuality
+{
+	Fast,
+	Normal,
+	High,
+};
+
+/// <summary>
+/// A CPU encoder for block compressed textures, used by the AssetCooker so textures take 4 to 8 times less memory and bandwidth.
+/// The texels of a block are held as floats per channel and matched against the palette of its endpoints
+/// 8 or 4 texels at a time with AVX or SSE, which is where nearly all of the encoding time goes.
+/// </summary>
+class BlockCompressor
+{
+public:
+	/// <summary>
+	/// Returns the format an image is best stored in at a quality.
+	/// Two channel images become BC5, images with translucent texels BC3 or BC7 and everything else BC1 or BC7.
+	/// </summary>
+	/// <param name="_image"></param>
+	/// <param name="_quality"></param>
+	/// <returns></returns>
+	static BlockFormat ChooseFormat(const ImageData& _image, CompressionQuality _quality);
+
+	/// <summary>
+	/// Compresses every level of an 8 bit image into _compressed, whose levels point into its own storage.
+	/// Returns false if the image is already compressed.
+	/// </summary>
+	/// <param name="_image"></param>
+	/// <param name="_format"></param>
+	/// <param name="_quality"></param>
+	/// <param name="_compressed"></param>
+	/// <returns></returns>
+	static bool Compress(const ImageData& _image, BlockFormat _format, CompressionQuality _quality, ImageData& _compressed);
+
+	/// <summary>
+	/// Compresses one block of 16 RGBA texels, row by row, into 8 or 16 bytes.
+	/// </summary>
+	/// <param name="_format"></param>
+	/// <param name="_texels"></param>
+	/// <param name="_quality"></param>
+	/// <param name="_block"></param>
+	static void CompressBlock(BlockFormat _format, const unsigned char* _texels, CompressionQuality _quality, unsigned char* _block);
+
+	/// <summary>
+	/// Decompresses one block into 16 RGBA texels. BC7 blocks are only decoded in the modes the encoder writes,
+	/// which is enough to measure its error.
+	/// </summary>
+	/// <param name="_format"></param>
+	/// <param name="_block"></param>
+	/// <param name="_texels"></param>
+	/// <returns></returns>
+	static bool DecompressBlock(BlockFormat _format, const unsigned char* _block, unsigned char* _texels);
+
+	static GLenum GetGLFormat(BlockFormat _format);
+
+	/// <summary>
+	/// Returns the size of a block of a GL compressed format, or 0 if it is not one the encoder writes.
+	/// </summary>
+	/// <param name="_format"></param>
+	/// <returns></returns>
+	static int GetBlockBytes(GLenum _format);
+
+	/// <summary>
+	/// Compresses a procedural image in every format at every quality and prints the single threaded throughput and PSNR.
+	/// </summary>
+	/// <param name="_size"></param>
+	static void Benchmark(int _size = 512);
+
+private:
+	/// <summary>
+	/// The texels of a block split into channels, the layout the SIMD index search loads from.
+	/// </summary>
+	struct BlockTexels
+	{
+		alignas(32) float Channels[4][16];
+	};
+
+	/// <summary>
+	/// Writes the two endpoint colours and 2 bit indices of a BC1 block, also used for the colour half of BC3.
+	/// </summary>
+	/// <param name="_texels"></param>
+	/// <param name="_quality"></param>
+	/// <param name="_block"></param>
+	static void EncodeColorBlock(const BlockTexels& _texels, CompressionQuality _quality, unsigned char* _block);
+
+	/// <summary>
+	/// Writes the two endpoints and 3 bit indices of one channel, the alpha half of BC3 and both halves of BC5.
+	/// </summary>
+	/// <param name="_texels"></param>
+	/// <param name="_channel"></param>
+	/// <param name="_quality"></param>
+	/// <param name="_block"></param>
+	static void EncodeChannelBlock(const BlockTexels& _texels, int _channel, CompressionQuality _quality, unsigned char* _block);
+
+	/// <summary>
+	/// Writes a BC7 block in mode 6, one RGBA line with 4 bit indices, or at High quality in mode 1,
+	/// two RGB lines picked from the 64 partitions, if the block is opaque and that is closer.
+	/// </summary>
+	/// <param name="_texels"></param>
+	/// <param name="_quality"></param>
+	/// <param name="_block"></param>
+	static void EncodeBC7Block(const BlockTexels& _texels, CompressionQuality _quality, unsigned char* _block);
+
+	/// <summary>
+	/// Encodes a BC7 mode 6 block and returns its squared error.
+	/// </summary>
+	/// <param name="_texels"></param>
+	/// <param name="_quality"></param>
+	/// <param name="_block"></param>
+	/// <returns></returns>
+	static float EncodeBC7Mode6(const BlockTexels& _texels, CompressionQuality _quality, unsigned char* _block);
+
+	/// <summary>
+	/// Encodes a BC7 mode 1 block of an opaque block in the given partition and returns its squared error.
+	/// </summary>
+	/// <param name="_texels"></param>
+	/// <param name="_partition"></param>
+	/// <param name="_block"></param>
+	/// <returns></returns>
+	static float EncodeBC7Mode1(const BlockTexels& _texels, int _partition, unsigned char* _block);
+
+	static void DecodeColorBlock(const unsigned char* _block, bool _allowTransparent, unsigned char* _texels);
+	static void DecodeChannelBlock(const unsigned char* _block, int _channel, unsigned char* _texels);
+	static bool DecodeBC7Block(const unsigned char* _block, unsigned char* _texels);
+};
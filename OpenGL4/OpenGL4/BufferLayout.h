@@ -0,0 +1,254 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : BufferLayout.h 
+// Description : BufferLayout Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+#include <array>
+#include <tuple>
+#include <cstring>
+#include <cstddef>
+
+/// <summary>
+/// The packing rules of a GLSL block.
+/// Std140 rounds array strides and struct alignments up to 16 bytes, std430 does not.
+/// In both a vec3 aligns like a vec4.
+/// </summary>
+enum class LayoutStandard
+{
+	Std140,
+	Std430,
+};
+
+/// <summary>
+/// The shape of the GLSL type a C++ member stands in for.
+/// Only 4 byte scalars, glm vectors and glm matrices of them have a GLSL equivalent,
+/// so a bool or double member fails to compile here instead of misaligning silently.
+/// </summary>
+template<typename T>
+struct GLSLType;
+
+template<>
+struct GLSLType<float> { static constexpr size_t Components = 1; static constexpr size_t Columns = 1; };
+
+template<>
+struct GLSLType<int> { static constexpr size_t Components = 1; static constexpr size_t Columns = 1; };
+
+template<>
+struct GLSLType<unsigned> { static constexpr size_t Components = 1; static constexpr size_t Columns = 1; };
+
+template<glm::length_t L, typename T, glm::qualifier Q>
+struct GLSLType<glm::vec<L, T, Q>>
+{
+	static_assert(sizeof(T) == 4, "Only 32 bit vectors have a GLSL equivalent");
+	static constexpr size_t Components = L;
+	static constexpr size_t Columns = 1;
+};
+
+template<glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+struct GLSLType<glm::mat<C, R, T, Q>>
+{
+	static_assert(sizeof(T) == 4, "Only 32 bit matrices have a GLSL equivalent");
+	static constexpr size_t Components = R;
+	static constexpr size_t Columns = C;
+};
+
+/// <summary>
+/// Rounds _value up to a multiple of _alignment.
+/// </summary>
+/// <param name="_value"></param>
+/// <param name="_alignment"></param>
+/// <returns></returns>
+constexpr size_t AlignLayoutOffset(size_t _value, size_t _alignment)
+{
+	return (_value + _alignment - 1) / _alignment * _alignment;
+}
+
+/// <summary>
+/// Returns the alignment of an array whose elements align to _alignment.
+/// </summary>
+/// <param name="_standard"></param>
+/// <param name="_alignment"></param>
+/// <returns></returns>
+constexpr size_t ArrayLayoutAlignment(LayoutStandard _standard, size_t _alignment)
+{
+	return _standard == LayoutStandard::Std140 ? AlignLayoutOffset(_alignment, 16) : _alignment;
+}
+
+/// <summary>
+/// Base alignment, size and array stride of a member type in a block of the given standard.
+/// Matrices are laid out as an array of their column vectors.
+/// </summary>
+template<LayoutStandard Standard, typename T>
+struct LayoutRules
+{
+	static constexpr size_t ColumnSize = 4 * GLSLType<T>::Components;
+	static constexpr size_t VectorAlignment = 4 * (GLSLType<T>::Components == 3 ? 4 : GLSLType<T>::Components);
+	static constexpr size_t ColumnStride = AlignLayoutOffset(ColumnSize, ArrayLayoutAlignment(Standard, VectorAlignment));
+
+	static constexpr size_t Alignment = GLSLType<T>::Columns == 1 ? VectorAlignment : ArrayLayoutAlignment(Standard, VectorAlignment);
+	static constexpr size_t Size = GLSLType<T>::Columns == 1 ? ColumnSize : ColumnStride * GLSLType<T>::Columns;
+};
+
+template<LayoutStandard Standard, typename T, size_t N>
+struct LayoutRules<Standard, T[N]>
+{
+	static constexpr size_t Alignment = ArrayLayoutAlignment(Standard, LayoutRules<Standard, T>::Alignment);
+	static constexpr size_t Stride = AlignLayoutOffset(LayoutRules<Standard, T>::Size, Alignment);
+	static constexpr size_t Size = Stride * N;
+};
+
+/// <summary>
+/// Returns the offset of every member of a block with the given member types.
+/// </summary>
+/// <returns></returns>
+template<LayoutStandard Standard, typename... Members>
+constexpr std::array<size_t, sizeof...(Members)> CalculateLayoutOffsets()
+{
+	std::array<size_t, sizeof...(Members)> offsets{};
+	size_t offset = 0;
+	size_t index = 0;
+	((offset = AlignLayoutOffset(offset, LayoutRules<Standard, Members>::Alignment),
+		offsets[index++] = offset,
+		offset += LayoutRules<Standard, Members>::Size), ...);
+	return offsets;
+}
+
+/// <summary>
+/// A block layout checked against its shader when programs link.
+/// For a uniform block it describes the whole block, for a shader storage block
+/// it describes the element of the block's runtime sized array.
+/// </summary>
+struct BlockLayoutDescription
+{
+	std::vector<size_t> Offsets{};
+	size_t Size = 0;
+};
+
+/// <summary>
+/// Compile time description of a std140 or std430 GLSL struct or block, one C++ type per member in declaration order.
+/// A C++ struct mirroring a block is checked by a static_assert on Matches with the offsetof each of its members,
+/// and is then uploaded whole with one buffer update.
+/// Blocks that cannot be mirrored by a plain C++ struct, such as a vec3 followed by a vec3, are filled through BufferBlock.
+/// </summary>
+template<LayoutStandard Packing, typename... Members>
+struct BufferLayout
+{
+	static_assert(sizeof...(Members) > 0, "A block needs at least one member");
+	static constexpr LayoutStandard Standard = Packing;
+
+	template<size_t Index>
+	using Member = std::tuple_element_t<Index, std::tuple<Members...>>;
+
+	static constexpr size_t MemberCount = sizeof...(Members);
+	static constexpr std::array<size_t, MemberCount> Offsets = CalculateLayoutOffsets<Standard, Members...>();
+
+	// A struct aligns to its widest member and its size is padded to that alignment, so it is also its array stride
+	static constexpr size_t Alignment = ArrayLayoutAlignment(Standard, std::max({ size_t{ 4 }, LayoutRules<Standard, Members>::Alignment... }));
+	static constexpr size_t Size = AlignLayoutOffset(Offsets[MemberCount - 1] + LayoutRules<Standard, Member<MemberCount - 1>>::Size, Alignment);
+
+	/// <summary>
+	/// Returns true if a C++ struct with the given member offsets matches this layout member for member and in size.
+	/// </summary>
+	/// <param name="_offsets"> offsetof each member of T in declaration order </param>
+	/// <returns></returns>
+	template<typename T>
+	static constexpr bool Matches(const std::array<size_t, MemberCount>& _offsets)
+	{
+		return sizeof(T) == Size && _offsets == Offsets;
+	}
+
+	/// <summary>
+	/// Returns the layout for checking against program reflection with ShaderLoader::AddBlockLayout.
+	/// </summary>
+	/// <returns></returns>
+	static BlockLayoutDescription Describe()
+	{
+		return { std::vector<size_t>(Offsets.begin(), Offsets.end()), Size };
+	}
+};
+
+/// <summary>
+/// Padded storage for a block described by a BufferLayout.
+/// Members are written and read by index with the layout's padding and strides applied,
+/// so the whole block can be uploaded from Data with a single buffer update.
+/// </summary>
+template<typename Layout>
+class BufferBlock
+{
+public:
+	/// <summary>
+	/// Writes a member.
+	/// </summary>
+	/// <param name="_value"></param>
+	template<size_t Index>
+	void Set(const typename Layout::template Member<Index>& _value)
+	{
+		Write(m_Data.data() + Layout::Offsets[Index], _value);
+	}
+
+	/// <summary>
+	/// Reads a member back.
+	/// </summary>
+	/// <param name="_value"></param>
+	template<size_t Index>
+	void Get(typename Layout::template Member<Index>& _value) const
+	{
+		Read(m_Data.data() + Layout::Offsets[Index], _value);
+	}
+
+	/// <summary>
+	/// Returns the padded block, Layout::Size bytes long.
+	/// </summary>
+	/// <returns></returns>
+	const void* Data() const { return m_Data.data(); }
+
+private:
+	static constexpr LayoutStandard Standard = Layout::Standard;
+
+	template<typename T>
+	static void Write(unsigned char* _destination, const T& _value)
+	{
+		if constexpr (std::is_array_v<T>)
+		{
+			for (size_t i = 0; i < std::extent_v<T>; i++)
+				Write(_destination + i * LayoutRules<Standard, T>::Stride, _value[i]);
+		}
+		else if constexpr (GLSLType<T>::Columns > 1)
+		{
+			for (size_t i = 0; i < GLSLType<T>::Columns; i++)
+				std::memcpy(_destination + i * LayoutRules<Standard, T>::ColumnStride, &_value[(glm::length_t)i], LayoutRules<Standard, T>::ColumnSize);
+		}
+		else
+		{
+			std::memcpy(_destination, &_value, sizeof(T));
+		}
+	}
+
+	template<typename T>
+	static void Read(const unsigned char* _source, T& _value)
+	{
+		if constexpr (std::is_array_v<T>)
+		{
+			for (size_t i = 0; i < std::extent_v<T>; i++)
+				Read(_source + i * LayoutRules<Standard, T>::Stride, _value[i]);
+		}
+		else if constexpr (GLSLType<T>::Columns > 1)
+		{
+			for (size_t i = 0; i < GLSLType<T>::Columns; i++)
+				std::memcpy(&_value[(glm::length_t)i], _source + i * LayoutRules<Standard, T>::ColumnStride, LayoutRules<Standard, T>::ColumnSize);
+		}
+		else
+		{
+			std::memcpy(&_value, _source, sizeof(T));
+		}
+	}
+
+	alignas(16) std::array<unsigned char, Layout::Size> m_Data{};
+};
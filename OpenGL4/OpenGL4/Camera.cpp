@@ -73,6 +73,30 @@ glm::mat4 Camera::GetPVMatrix()
     return GetProjectionMatrix() * GetViewMatrix();
 }
 
+Frustum Camera::GetFrustum()
+{
+    return ExtractFrustum(GetPVMatrix());
+}
+
+Ray Camera::ScreenPointToRay(glm::vec2 _screenPosition)
+{
+    // Window to normalized device coordinates, y points up in NDC
+    glm::vec2 ndc{ 2.0f * _screenPosition.x / m_WindowSize->x - 1.0f, 1.0f - 2.0f * _screenPosition.y / m_WindowSize->y };
+
+    // Unproject points on the near and far plane
+    glm::mat4 inversePV = glm::inverse(GetPVMatrix());
+    glm::vec4 nearPoint = inversePV * glm::vec4{ ndc, -1.0f, 1.0f };
+    glm::vec4 farPoint = inversePV * glm::vec4{ ndc, 1.0f, 1.0f };
+    nearPoint /= nearPoint.w;
+    farPoint /= farPoint.w;
+
+    Ray ray{};
+    ray.Origin = glm::vec3(nearPoint);
+    ray.Direction = glm::normalize(glm::vec3(farPoint - nearPoint));
+    ray.MaxDistance = glm::length(glm::vec3(farPoint - nearPoint));
+    return ray;
+}
+
 void Camera::SetNearAndFarPlane(glm::vec2 _nearAndFar)
 {
     m_NearPlane = _nearAndFar.x;
@@ -57,6 +57,19 @@ public:
     /// <returns></returns>
     glm::mat4 GetPVMatrix();
 
+    /// <summary>
+    /// Extracts And Returns The World Space Frustum Planes From The Projection * View Matrix
+    /// </summary>
+    /// <returns></returns>
+    Frustum GetFrustum();
+
+    /// <summary>
+    /// Returns a world space ray from the camera through the given window position (pixels from the top left).
+    /// </summary>
+    /// <param name="_screenPosition"></param>
+    /// <returns></returns>
+    Ray ScreenPointToRay(glm::vec2 _screenPosition);
+
     /// <summary>
     /// Sets the near and far plane of the camera in that order ({newNear, newFar}).
     /// </summary>
@@ -99,6 +112,12 @@ public:
     /// <returns></returns>
     glm::mat4 GetProjectionMatrix();
 
+    /// <summary>
+    /// Returns the size of the window the camera renders to.
+    /// </summary>
+    /// <returns></returns>
+    inline glm::ivec2 GetWindowSize() { return *m_WindowSize; }
+
     /// <summary>
     /// Returns the front vector of the camera
     /// </summary>
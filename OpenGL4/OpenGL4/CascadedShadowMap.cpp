@@ -0,0 +1,308 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : CascadedShadowMap.cpp 
+// Description : CascadedShadowMap Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "CascadedShadowMap.h"
+#include "GLState.h"
+#include <cstring>
+
+CascadedShadowMap::CascadedShadowMap(CascadedShadowSettings _settings)
+{
+	m_Settings = _settings;
+	m_AppliedSettings = _settings;
+	m_DepthShader = new Shader{
+		{
+			ShaderInfo{GL_VERTEX_SHADER, "ShadowDepth.vert"},
+			ShaderInfo{GL_FRAGMENT_SHADER, "ShadowDepth.frag"},
+		}
+	, nullptr };
+	m_LightPVMatrixHandle = ShaderLoader::GetUniformHandle<glm::mat4>(m_DepthShader->ID, "LightPVMatrix"_id);
+	m_ModelMatrixHandle = ShaderLoader::GetUniformHandle<glm::mat4>(m_DepthShader->ID, "ModelMatrix"_id);
+	CreateTexture();
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+	DestroyTexture();
+	GLState::DeleteProgram(m_DepthShader->ID);
+	delete m_DepthShader;
+	m_DepthShader = nullptr;
+}
+
+void CascadedShadowMap::Render(const std::vector<GameObject*>& _gameObjects, const DirectionalLight& _light, Camera& _camera)
+{
+	m_Settings.CascadeCount = std::clamp(m_Settings.CascadeCount, 1, MaxCascades);
+	m_Settings.Resolution = std::max(m_Settings.Resolution, 64);
+	m_Settings.CacheMargin = std::max(m_Settings.CacheMargin, 1.0f);
+
+	// Any change to the cascade layout invalidates what was rendered with the old one
+	if (std::memcmp(&m_Settings, &m_AppliedSettings, offsetof(CascadedShadowSettings, UpdateIntervals)) != 0)
+	{
+		if (m_Settings.Resolution != m_AppliedSettings.Resolution)
+		{
+			DestroyTexture();
+			CreateTexture();
+		}
+		Invalidate();
+	}
+	m_AppliedSettings = m_Settings;
+	m_FrameIndex++;
+	m_RenderedCascadeCount = 0;
+
+	glm::vec3 lightDirection = glm::normalize(_light.Direction);
+	unsigned staticVersion = GameObject::GetStaticVersion();
+	bool hasDynamicCasters = std::any_of(_gameObjects.begin(), _gameObjects.end(), [](GameObject* _gameObject)
+	{
+		return _gameObject->GetMesh() && !_gameObject->GetIsStatic();
+	});
+
+	// Practical split scheme, blending logarithmic and uniform splits
+	float nearPlane = _camera.GetNearPlane();
+	float farPlane = std::min(m_Settings.MaxDistance, _camera.GetFarPlane());
+	float sliceNear = nearPlane;
+	for (int i = 0; i < m_Settings.CascadeCount; i++)
+	{
+		float fraction = (float)(i + 1) / m_Settings.CascadeCount;
+		float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+		float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+		float sliceFar = m_Settings.SplitLambda * logSplit + (1.0f - m_Settings.SplitLambda) * uniformSplit;
+
+		glm::vec3 centre{};
+		float radius = 0.0f;
+		CalculateSliceSphere(_camera, sliceNear, sliceFar, centre, radius);
+
+		Cascade& cascade = m_Cascades[i];
+		int interval = std::max(m_Settings.UpdateIntervals[i], 0);
+		bool isCached = interval == 0;
+		bool isStale = !cascade.IsValid || cascade.LightDirection != lightDirection || cascade.Split != sliceFar;
+		if (isCached)
+		{
+			// Cached cascades stay until static casters change or the slice leaves the area they cover
+			isStale = isStale || cascade.StaticVersion != staticVersion || glm::distance(centre, cascade.Centre) + radius > cascade.Radius;
+		}
+		else
+		{
+			isStale = isStale || m_FrameIndex - cascade.LastRenderedFrame >= interval;
+		}
+
+		if (isStale)
+		{
+			cascade.Centre = centre;
+			cascade.Radius = isCached ? radius * m_Settings.CacheMargin : radius;
+			cascade.Split = sliceFar;
+			cascade.LightDirection = lightDirection;
+			cascade.StaticVersion = staticVersion;
+			cascade.LastRenderedFrame = m_FrameIndex;
+			cascade.IsValid = true;
+			CalculateCascadeMatrix(cascade);
+			if (isCached)
+				RenderCascade(i, _gameObjects, m_StaticTextureID, CasterSet::Static);
+			else
+				RenderCascade(i, _gameObjects, m_TextureID, CasterSet::All);
+			m_RenderedCascadeCount++;
+		}
+
+		// Dynamic casters are redrawn over a fresh copy of the cached static depth every frame,
+		// and the copy is made once more after the last of them is gone so its shadow does not linger
+		if (isCached && (isStale || hasDynamicCasters || cascade.HasDynamicCasters))
+		{
+			glCopyImageSubData(m_StaticTextureID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, m_TextureID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+				m_Settings.Resolution, m_Settings.Resolution, 1);
+			if (hasDynamicCasters)
+				RenderCascade(i, _gameObjects, m_TextureID, CasterSet::Dynamic);
+			cascade.HasDynamicCasters = hasDynamicCasters;
+		}
+		sliceNear = sliceFar;
+	}
+
+	GLState::BindTexture(TextureUnit, GL_TEXTURE_2D_ARRAY, m_TextureID);
+	GLState::ActiveTexture(GL_TEXTURE0);
+}
+
+void CascadedShadowMap::Invalidate()
+{
+	for (auto& cascade : m_Cascades)
+	{
+		cascade.IsValid = false;
+	}
+}
+
+CascadedShadowSettings& CascadedShadowMap::GetSettings()
+{
+	return m_Settings;
+}
+
+int CascadedShadowMap::GetCascadeCount()
+{
+	return m_AppliedSettings.CascadeCount;
+}
+
+glm::mat4 CascadedShadowMap::GetCascadeMatrix(int _cascade)
+{
+	return m_Cascades[_cascade].Matrix;
+}
+
+float CascadedShadowMap::GetCascadeSplit(int _cascade)
+{
+	return m_Cascades[_cascade].Split;
+}
+
+float CascadedShadowMap::GetCascadeTexelSize(int _cascade)
+{
+	return m_Cascades[_cascade].TexelSize;
+}
+
+int CascadedShadowMap::GetRenderedCascadeCount()
+{
+	return m_RenderedCascadeCount;
+}
+
+void CascadedShadowMap::CreateTexture()
+{
+	// Both arrays share a format so layers can be copied between them
+	for (GLuint* textureID : { &m_TextureID, &m_StaticTextureID })
+	{
+		glGenTextures(1, textureID);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, *textureID);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, m_Settings.Resolution, m_Settings.Resolution, MaxCascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	}
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenFramebuffers(1, &m_FramebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CascadedShadowMap::DestroyTexture()
+{
+	if (m_TextureID)
+		GLState::DeleteTextures(1, &m_TextureID);
+	if (m_StaticTextureID)
+		GLState::DeleteTextures(1, &m_StaticTextureID);
+	if (m_FramebufferID)
+		glDeleteFramebuffers(1, &m_FramebufferID);
+	m_TextureID = 0;
+	m_StaticTextureID = 0;
+	m_FramebufferID = 0;
+}
+
+void CascadedShadowMap::CalculateSliceSphere(Camera& _camera, float _nearDepth, float _farDepth, glm::vec3& _centre, float& _radius)
+{
+	glm::mat4 inverseProjection = glm::inverse(_camera.GetProjectionMatrix());
+	glm::mat4 inverseView = glm::inverse(_camera.GetViewMatrix());
+
+	// Walk the frustums corner lines to the slice depths
+	glm::vec3 corners[8]{};
+	for (int corner = 0; corner < 4; corner++)
+	{
+		glm::vec2 ndc{ (corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f };
+		glm::vec4 nearPoint = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseProjection * glm::vec4(ndc, 1.0f, 1.0f);
+		glm::vec3 lineStart = glm::vec3(nearPoint) / nearPoint.w;
+		glm::vec3 lineEnd = glm::vec3(farPoint) / farPoint.w;
+
+		float nearT = (_nearDepth + lineStart.z) / (lineStart.z - lineEnd.z);
+		float farT = (_farDepth + lineStart.z) / (lineStart.z - lineEnd.z);
+		corners[corner] = inverseView * glm::vec4(glm::mix(lineStart, lineEnd, nearT), 1.0f);
+		corners[corner + 4] = inverseView * glm::vec4(glm::mix(lineStart, lineEnd, farT), 1.0f);
+	}
+
+	_centre = glm::vec3{ 0,0,0 };
+	for (auto& corner : corners)
+	{
+		_centre += corner / 8.0f;
+	}
+	_radius = 0.0f;
+	for (auto& corner : corners)
+	{
+		_radius = std::max(_radius, glm::distance(corner, _centre));
+	}
+
+	// The slice is rigid so its radius only changes by rounding error, round it up so the projection size never changes
+	_radius = std::ceil(_radius * 16.0f) / 16.0f;
+}
+
+void CascadedShadowMap::CalculateCascadeMatrix(Cascade& _cascade)
+{
+	glm::vec3 up = std::abs(_cascade.LightDirection.y) > 0.99f ? glm::vec3{ 0,0,1 } : glm::vec3{ 0,1,0 };
+	glm::mat4 lightRotation = glm::lookAt(glm::vec3{ 0,0,0 }, _cascade.LightDirection, up);
+
+	// Snap the centre to whole texels in light space so the cascade only ever moves by full texels
+	_cascade.TexelSize = 2.0f * _cascade.Radius / m_Settings.Resolution;
+	glm::vec3 centre = lightRotation * glm::vec4(_cascade.Centre, 1.0f);
+	centre.x = std::floor(centre.x / _cascade.TexelSize) * _cascade.TexelSize;
+	centre.y = std::floor(centre.y / _cascade.TexelSize) * _cascade.TexelSize;
+
+	// Extend towards the light so casters outside the slice still cast into it
+	glm::mat4 projection = glm::ortho(
+		centre.x - _cascade.Radius, centre.x + _cascade.Radius,
+		centre.y - _cascade.Radius, centre.y + _cascade.Radius,
+		-centre.z - _cascade.Radius - m_Settings.CasterDistance, -centre.z + _cascade.Radius);
+	_cascade.Matrix = projection * lightRotation;
+}
+
+void CascadedShadowMap::RenderCascade(int _cascadeIndex, const std::vector<GameObject*>& _gameObjects, GLuint _textureID, CasterSet _casters)
+{
+	GLint viewport[4]{};
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _textureID, 0, _cascadeIndex);
+	glViewport(0, 0, m_Settings.Resolution, m_Settings.Resolution);
+	if (_casters != CasterSet::Dynamic)
+		GLState::Clear(GL_DEPTH_BUFFER_BIT);
+
+	// Slope scaled bias while rendering, a constant bias and normal offset are applied when sampling
+	PipelineState shadowPipeline{};
+	shadowPipeline.Stencil.TestEnabled = false;
+	shadowPipeline.Raster.PolygonOffsetEnabled = true;
+	shadowPipeline.Raster.PolygonOffsetFactor = 2.0f;
+	shadowPipeline.Raster.PolygonOffsetUnits = 4.0f;
+	GLState::SetPipeline(shadowPipeline);
+
+	m_DepthShader->Bind();
+	ShaderLoader::SetUniform(m_LightPVMatrixHandle, m_Cascades[_cascadeIndex].Matrix);
+	for (auto& gameObject : _gameObjects)
+	{
+		bool isStatic = gameObject->GetIsStatic();
+		if (!gameObject->GetMesh() || (_casters == CasterSet::Static && !isStatic) || (_casters == CasterSet::Dynamic && isStatic))
+			continue;
+
+		ShaderLoader::SetUniform(m_ModelMatrixHandle, gameObject->m_Transform.transform);
+		DrawMeshDepth(gameObject->GetMesh());
+	}
+	m_DepthShader->UnBind();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void CascadedShadowMap::DrawMeshDepth(Mesh* _mesh)
+{
+	// Mesh::Draw also sets texture uniforms on the cel shader, so draw the ranges directly
+	for (auto& subMesh : _mesh->GetSubMeshes())
+	{
+		DrawMeshDepth(subMesh);
+	}
+
+	GeometryRange range = _mesh->GetGeometryRange();
+	if (range.IndexCount == 0)
+		return;
+
+	GLState::BindVertexArray(GeometryArena::GetVertexArrayID());
+	glDrawElementsBaseVertex(GL_TRIANGLES, range.IndexCount, GL_UNSIGNED_INT, (void*)(range.FirstIndex * sizeof(unsigned int)), range.BaseVertex);
+}
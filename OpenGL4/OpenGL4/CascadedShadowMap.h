@@ -0,0 +1,190 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : CascadedShadowMap.h 
+// Description : CascadedShadowMap Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "GameObject.h"
+
+/// <summary>
+/// Budget knobs for the cascaded shadow map.
+/// An update interval of 1 renders the cascade every frame, 2 every other frame and so on.
+/// An interval of 0 caches the depth of the static casters, re-rendering it when they or the light change
+/// or the camera leaves the extra area given by CacheMargin, and draws the dynamic casters over a copy of it every frame.
+/// </summary>
+struct CascadedShadowSettings
+{
+	int CascadeCount = 4;
+	int Resolution = 2048;
+	float MaxDistance = 150.0f;
+	float SplitLambda = 0.75f;
+	float CasterDistance = 100.0f;
+	float CacheMargin = 1.5f;
+	int UpdateIntervals[4]{ 1, 2, 0, 0 };
+	float DepthBias = 0.0005f;
+	float NormalOffset = 1.5f;
+};
+
+/// <summary>
+/// Cascaded shadow maps for a directional light, stored as layers of one depth texture array.
+/// Each cascade fits an orthographic projection around a bounding sphere of its slice of the view frustum
+/// and snaps it to whole shadow map texels so shadows do not shimmer as the camera moves.
+/// </summary>
+class CascadedShadowMap
+{
+public:
+	/// <summary>
+	/// CascadedShadowMap Constructor
+	/// </summary>
+	/// <param name="_settings"></param>
+	CascadedShadowMap(CascadedShadowSettings _settings = {});
+
+	/// <summary>
+	/// CascadedShadowMap Destructor
+	/// </summary>
+	~CascadedShadowMap();
+
+	/// <summary>
+	/// Renders the cascades that are due this frame and binds the shadow map for the lit shaders.
+	/// </summary>
+	/// <param name="_gameObjects"></param>
+	/// <param name="_light"></param>
+	/// <param name="_camera"></param>
+	void Render(const std::vector<GameObject*>& _gameObjects, const DirectionalLight& _light, Camera& _camera);
+
+	/// <summary>
+	/// Forces every cascade to re-render next frame.
+	/// </summary>
+	void Invalidate();
+
+	/// <summary>
+	/// Returns the settings. Changes are picked up next render.
+	/// </summary>
+	/// <returns></returns>
+	CascadedShadowSettings& GetSettings();
+
+	/// <summary>
+	/// Returns the number of active cascades.
+	/// </summary>
+	/// <returns></returns>
+	int GetCascadeCount();
+
+	/// <summary>
+	/// Returns the world to shadow map clip space matrix the cascade was last rendered with.
+	/// </summary>
+	/// <param name="_cascade"></param>
+	/// <returns></returns>
+	glm::mat4 GetCascadeMatrix(int _cascade);
+
+	/// <summary>
+	/// Returns the view space depth where the cascade ends.
+	/// </summary>
+	/// <param name="_cascade"></param>
+	/// <returns></returns>
+	float GetCascadeSplit(int _cascade);
+
+	/// <summary>
+	/// Returns the world space size of one shadow map texel in the cascade.
+	/// </summary>
+	/// <param name="_cascade"></param>
+	/// <returns></returns>
+	float GetCascadeTexelSize(int _cascade);
+
+	/// <summary>
+	/// Returns the number of cascades rendered in the last frame.
+	/// </summary>
+	/// <returns></returns>
+	int GetRenderedCascadeCount();
+
+	static const int MaxCascades = 4;
+	static const GLuint TextureUnit = 7;
+
+private:
+	/// <summary>
+	/// A cascade and the state it was last rendered with.
+	/// </summary>
+	struct Cascade
+	{
+		glm::mat4 Matrix{ 1 };
+		glm::vec3 Centre{ 0,0,0 };
+		float Radius = 0.0f;
+		float Split = 0.0f;
+		float TexelSize = 0.0f;
+		glm::vec3 LightDirection{ 0,0,0 };
+		unsigned StaticVersion = 0;
+		int LastRenderedFrame = 0;
+		bool HasDynamicCasters = false;
+		bool IsValid = false;
+	};
+
+	/// <summary>
+	/// Which gameobjects a cascade render draws.
+	/// </summary>
+	enum class CasterSet
+	{
+		All,
+		Static,
+		Dynamic,
+	};
+
+	/// <summary>
+	/// Creates the sampled and static depth texture arrays and the framebuffer at the current resolution.
+	/// </summary>
+	void CreateTexture();
+
+	/// <summary>
+	/// Deletes the depth texture arrays and framebuffer.
+	/// </summary>
+	void DestroyTexture();
+
+	/// <summary>
+	/// Calculates the bounding sphere of the cameras view frustum between two view space depths.
+	/// </summary>
+	/// <param name="_camera"></param>
+	/// <param name="_nearDepth"></param>
+	/// <param name="_farDepth"></param>
+	/// <param name="_centre"></param>
+	/// <param name="_radius"></param>
+	void CalculateSliceSphere(Camera& _camera, float _nearDepth, float _farDepth, glm::vec3& _centre, float& _radius);
+
+	/// <summary>
+	/// Fits the cascades matrix around its sphere, snapped to whole texels in light space.
+	/// </summary>
+	/// <param name="_cascade"></param>
+	void CalculateCascadeMatrix(Cascade& _cascade);
+
+	/// <summary>
+	/// Renders a set of casters into the cascades layer of a texture array.
+	/// The layer is cleared first unless only dynamic casters are drawn, which go over the static depth already there.
+	/// </summary>
+	/// <param name="_cascadeIndex"></param>
+	/// <param name="_gameObjects"></param>
+	/// <param name="_textureID"></param>
+	/// <param name="_casters"></param>
+	void RenderCascade(int _cascadeIndex, const std::vector<GameObject*>& _gameObjects, GLuint _textureID, CasterSet _casters);
+
+	/// <summary>
+	/// Draws the mesh and its submeshes with the bound depth program.
+	/// </summary>
+	/// <param name="_mesh"></param>
+	void DrawMeshDepth(Mesh* _mesh);
+
+	CascadedShadowSettings m_Settings{};
+	CascadedShadowSettings m_AppliedSettings{};
+	Cascade m_Cascades[MaxCascades]{};
+	int m_FrameIndex{ 0 };
+	int m_RenderedCascadeCount{ 0 };
+
+	Shader* m_DepthShader{ nullptr };
+	UniformHandle<glm::mat4> m_LightPVMatrixHandle{};
+	UniformHandle<glm::mat4> m_ModelMatrixHandle{};
+	GLuint m_TextureID{ 0 };
+	// Static caster depth of the cached cascades, copied into m_TextureID before dynamic casters are drawn
+	GLuint m_StaticTextureID{ 0 };
+	GLuint m_FramebufferID{ 0 };
+};
@@ -0,0 +1,305 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : ClusteredLighting.cpp 
+// Description : ClusteredLighting Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "ClusteredLighting.h"
+#include "GLState.h"
+#include <future>
+#include <thread>
+#include <chrono>
+#include <random>
+
+ClusteredLighting::ClusteredLighting(glm::ivec3 _gridSize, int _threadCount)
+{
+	m_GridSize = _gridSize;
+	m_ThreadCount = _threadCount > 0 ? _threadCount : (int)std::thread::hardware_concurrency();
+	if (m_ThreadCount < 1)
+		m_ThreadCount = 1;
+	m_ThreadCount = std::min(m_ThreadCount, m_GridSize.z);
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+	if (m_LightBufferID)
+		GLState::DeleteBuffers(1, &m_LightBufferID);
+	if (m_ClusterBufferID)
+		GLState::DeleteBuffers(1, &m_ClusterBufferID);
+	if (m_LightIndexBufferID)
+		GLState::DeleteBuffers(1, &m_LightIndexBufferID);
+}
+
+void ClusteredLighting::Build(const std::vector<ClusterLight>& _lights, const glm::mat4& _viewMatrix, const glm::mat4& _projectionMatrix, glm::vec2 _nearAndFar, glm::ivec2 _screenSize)
+{
+	// Cluster bounds only depend on the projection so are kept until it changes
+	if (_projectionMatrix != m_ProjectionMatrix || _nearAndFar != m_NearAndFar || m_ClusterBounds.empty())
+	{
+		m_ProjectionMatrix = _projectionMatrix;
+		m_NearAndFar = _nearAndFar;
+		CalculateClusterBounds();
+	}
+	m_ViewMatrix = _viewMatrix;
+	m_ScreenSize = glm::max(_screenSize, glm::ivec2{ 1, 1 });
+	m_Lights = _lights;
+
+	// Find the clusters each light could touch from its view space sphere
+	m_ViewSpaceSpheres.resize(m_Lights.size());
+	m_LightExtents.resize(m_Lights.size());
+	for (size_t i = 0; i < m_Lights.size(); i++)
+	{
+		glm::vec3 centre = m_ViewMatrix * glm::vec4(glm::vec3(m_Lights[i].PositionRadius), 1.0f);
+		// Unattenuated lights only need to reach past the far plane
+		float radius = std::min(m_Lights[i].PositionRadius.w, glm::length(centre) + m_NearAndFar.y);
+		m_ViewSpaceSpheres[i] = { centre, radius };
+
+		LightExtent& extent = m_LightExtents[i];
+		extent = LightExtent{};
+		float nearDepth = -centre.z - radius;
+		float farDepth = -centre.z + radius;
+		if (farDepth < m_NearAndFar.x || nearDepth > m_NearAndFar.y)
+			continue;
+
+		// Project the corners of the spheres box, clamped in front of the near plane, to find its screen rectangle
+		glm::vec2 ndcMin{ FLT_MAX }, ndcMax{ -FLT_MAX };
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 point = centre + glm::vec3{ (corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius };
+			point.z = std::min(point.z, -m_NearAndFar.x);
+			glm::vec4 clip = m_ProjectionMatrix * glm::vec4(point, 1.0f);
+			glm::vec2 ndc = glm::vec2(clip) / clip.w;
+			ndcMin = glm::min(ndcMin, ndc);
+			ndcMax = glm::max(ndcMax, ndc);
+		}
+		if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+			continue;
+
+		glm::vec2 gridXY{ m_GridSize.x, m_GridSize.y };
+		glm::ivec2 tileMin = glm::clamp(glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * gridXY)), glm::ivec2{ 0 }, glm::ivec2(m_GridSize) - 1);
+		glm::ivec2 tileMax = glm::clamp(glm::ivec2(glm::floor((ndcMax * 0.5f + 0.5f) * gridXY)), glm::ivec2{ 0 }, glm::ivec2(m_GridSize) - 1);
+		extent.Min = { tileMin, GetSlice(nearDepth) };
+		extent.Max = { tileMax, GetSlice(farDepth) };
+	}
+
+	int clusterCount = m_GridSize.x * m_GridSize.y * m_GridSize.z;
+	m_ClusterLights.resize(clusterCount);
+	for (auto& lights : m_ClusterLights)
+	{
+		lights.clear();
+	}
+
+	// Each thread owns a range of depth slices so no two threads write the same cluster
+	int slicesPerThread = (m_GridSize.z + m_ThreadCount - 1) / m_ThreadCount;
+	std::vector<std::future<void>> workers{};
+	for (int thread = 1; thread < m_ThreadCount; thread++)
+	{
+		int firstSlice = thread * slicesPerThread;
+		int lastSlice = std::min(firstSlice + slicesPerThread, m_GridSize.z) - 1;
+		if (firstSlice <= lastSlice)
+			workers.push_back(std::async(std::launch::async, &ClusteredLighting::AssignSlices, this, firstSlice, lastSlice));
+	}
+	AssignSlices(0, std::min(slicesPerThread, m_GridSize.z) - 1);
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+
+	// Flatten the per cluster lists into one index list with an (offset, count) per cluster
+	m_ClusterRanges.resize(clusterCount);
+	m_LightIndices.clear();
+	m_MaxLightsPerCluster = 0;
+	for (int cluster = 0; cluster < clusterCount; cluster++)
+	{
+		std::vector<GLuint>& lights = m_ClusterLights[cluster];
+		m_ClusterRanges[cluster] = { (GLuint)m_LightIndices.size(), (GLuint)lights.size() };
+		m_LightIndices.insert(m_LightIndices.end(), lights.begin(), lights.end());
+		m_MaxLightsPerCluster = std::max(m_MaxLightsPerCluster, (int)lights.size());
+	}
+}
+
+void ClusteredLighting::Upload()
+{
+	if (m_LightBufferID == 0)
+	{
+		glGenBuffers(1, &m_LightBufferID);
+		glGenBuffers(1, &m_ClusterBufferID);
+		glGenBuffers(1, &m_LightIndexBufferID);
+	}
+
+	// Empty buffers cannot be bound, so always upload at least one element
+	ClusterLight emptyLight{};
+	glm::uvec2 emptyRange{ 0, 0 };
+	GLuint emptyIndex{ 0 };
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_LightBufferID);
+	if (m_Lights.empty())
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ClusterLight), &emptyLight, GL_STREAM_DRAW);
+	else
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_Lights.size() * sizeof(ClusterLight), m_Lights.data(), GL_STREAM_DRAW);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterBufferID);
+	if (m_ClusterRanges.empty())
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::uvec2), &emptyRange, GL_STREAM_DRAW);
+	else
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_ClusterRanges.size() * sizeof(glm::uvec2), m_ClusterRanges.data(), GL_STREAM_DRAW);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_LightIndexBufferID);
+	if (m_LightIndices.empty())
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &emptyIndex, GL_STREAM_DRAW);
+	else
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_LightIndices.size() * sizeof(GLuint), m_LightIndices.data(), GL_STREAM_DRAW);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void ClusteredLighting::Bind()
+{
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, LightBinding, m_LightBufferID);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, ClusterBinding, m_ClusterBufferID);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, LightIndexBinding, m_LightIndexBufferID);
+}
+
+glm::ivec3 ClusteredLighting::GetGridSize()
+{
+	return m_GridSize;
+}
+
+glm::vec4 ClusteredLighting::GetTileSizeAndDepthScaleBias()
+{
+	// Matches GetSlice
+	float logRatio = std::log(m_NearAndFar.y / m_NearAndFar.x);
+	float depthScale = m_GridSize.z / logRatio;
+	float depthBias = m_GridSize.z * std::log(m_NearAndFar.x) / logRatio;
+	return { (float)m_ScreenSize.x / m_GridSize.x, (float)m_ScreenSize.y / m_GridSize.y, depthScale, depthBias };
+}
+
+int ClusteredLighting::GetLightCount()
+{
+	return (int)m_Lights.size();
+}
+
+int ClusteredLighting::GetLightIndexCount()
+{
+	return (int)m_LightIndices.size();
+}
+
+int ClusteredLighting::GetMaxLightsPerCluster()
+{
+	return m_MaxLightsPerCluster;
+}
+
+void ClusteredLighting::Benchmark(int _lightCount)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> radius(2.0f, 10.0f);
+
+	std::vector<ClusterLight> lights(_lightCount);
+	for (auto& light : lights)
+	{
+		light.PositionRadius = { position(random), position(random), position(random), radius(random) };
+	}
+
+	glm::mat4 projectionMatrix = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+	glm::mat4 viewMatrix = glm::lookAt(glm::vec3{ 0,0,150 }, glm::vec3{ 0,0,0 }, glm::vec3{ 0,1,0 });
+
+	ClusteredLighting clusters{};
+	const int iterations = 100;
+	double buildTime = 0.0;
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		clusters.Build(lights, viewMatrix, projectionMatrix, { 0.1f, 2000.0f }, { 1920, 1080 });
+		buildTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	int clusterCount = clusters.m_GridSize.x * clusters.m_GridSize.y * clusters.m_GridSize.z;
+	Print("Clustered Lighting Benchmark (" + std::to_string(clusters.m_GridSize.x) + "x" + std::to_string(clusters.m_GridSize.y) + "x" + std::to_string(clusters.m_GridSize.z) + ", " + std::to_string(clusters.m_ThreadCount) + " threads)");
+	Print("Lights: " + std::to_string(_lightCount) + " Build: " + std::to_string(buildTime / iterations) + "ms");
+	Print("Light References: " + std::to_string(clusters.GetLightIndexCount()) + " Average Per Cluster: " + std::to_string((float)clusters.GetLightIndexCount() / clusterCount) + " Max Per Cluster: " + std::to_string(clusters.GetMaxLightsPerCluster()));
+}
+
+void ClusteredLighting::CalculateClusterBounds()
+{
+	glm::mat4 inverseProjection = glm::inverse(m_ProjectionMatrix);
+	auto unproject = [&](glm::vec2 _ndc, float _ndcDepth)
+	{
+		glm::vec4 view = inverseProjection * glm::vec4(_ndc, _ndcDepth, 1.0f);
+		return glm::vec3(view) / view.w;
+	};
+
+	m_ClusterBounds.resize(m_GridSize.x * m_GridSize.y * m_GridSize.z);
+	for (int z = 0; z < m_GridSize.z; z++)
+	{
+		float depthRatio = m_NearAndFar.y / m_NearAndFar.x;
+		float sliceNear = m_NearAndFar.x * std::pow(depthRatio, (float)z / m_GridSize.z);
+		float sliceFar = m_NearAndFar.x * std::pow(depthRatio, (float)(z + 1) / m_GridSize.z);
+
+		for (int y = 0; y < m_GridSize.y; y++)
+		{
+			for (int x = 0; x < m_GridSize.x; x++)
+			{
+				AABB& bounds = m_ClusterBounds[x + m_GridSize.x * (y + m_GridSize.y * z)];
+				bounds.Min = glm::vec3{ FLT_MAX };
+				bounds.Max = glm::vec3{ -FLT_MAX };
+
+				// Walk each corner line of the tile from the near to far plane and take its points at the slice depths
+				for (int corner = 0; corner < 4; corner++)
+				{
+					glm::vec2 ndc{ -1.0f + 2.0f * (x + (corner & 1)) / m_GridSize.x, -1.0f + 2.0f * (y + ((corner >> 1) & 1)) / m_GridSize.y };
+					glm::vec3 nearPoint = unproject(ndc, -1.0f);
+					glm::vec3 farPoint = unproject(ndc, 1.0f);
+					for (float depth : { sliceNear, sliceFar })
+					{
+						float t = (depth + nearPoint.z) / (nearPoint.z - farPoint.z);
+						glm::vec3 point = glm::mix(nearPoint, farPoint, t);
+						bounds.Min = glm::min(bounds.Min, point);
+						bounds.Max = glm::max(bounds.Max, point);
+					}
+				}
+			}
+		}
+	}
+}
+
+void ClusteredLighting::AssignSlices(int _firstSlice, int _lastSlice)
+{
+	for (size_t i = 0; i < m_LightExtents.size(); i++)
+	{
+		const LightExtent& extent = m_LightExtents[i];
+		int firstSlice = std::max(extent.Min.z, _firstSlice);
+		int lastSlice = std::min(extent.Max.z, _lastSlice);
+		if (firstSlice > lastSlice)
+			continue;
+
+		glm::vec3 centre = m_ViewSpaceSpheres[i];
+		float radiusSquared = m_ViewSpaceSpheres[i].w * m_ViewSpaceSpheres[i].w;
+		for (int z = firstSlice; z <= lastSlice; z++)
+		{
+			for (int y = extent.Min.y; y <= extent.Max.y; y++)
+			{
+				for (int x = extent.Min.x; x <= extent.Max.x; x++)
+				{
+					// Sphere against the clusters box
+					int cluster = x + m_GridSize.x * (y + m_GridSize.y * z);
+					const AABB& bounds = m_ClusterBounds[cluster];
+					glm::vec3 closest = glm::clamp(centre, bounds.Min, bounds.Max);
+					glm::vec3 offset = closest - centre;
+					if (glm::dot(offset, offset) <= radiusSquared)
+						m_ClusterLights[cluster].push_back((GLuint)i);
+				}
+			}
+		}
+	}
+}
+
+int ClusteredLighting::GetSlice(float _depth)
+{
+	float depth = std::max(_depth, m_NearAndFar.x);
+	int slice = (int)std::floor(std::log(depth / m_NearAndFar.x) / std::log(m_NearAndFar.y / m_NearAndFar.x) * m_GridSize.z);
+	return std::clamp(slice, 0, m_GridSize.z - 1);
+}
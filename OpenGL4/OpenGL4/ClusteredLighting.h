@@ -0,0 +1,174 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : ClusteredLighting.h 
+// Description : ClusteredLighting Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+#include "BufferLayout.h"
+
+/// <summary>
+/// A point or spot light as stored in the light shader storage buffer (std430, 64 bytes).
+/// Point lights have an outer cutoff (DirectionOuterCutoff.w) of -2.
+/// </summary>
+struct ClusterLight
+{
+	glm::vec4 PositionRadius{ 0,0,0,1 };
+	glm::vec4 ColorSpecular{ 1,1,1,1 };
+	glm::vec4 DirectionOuterCutoff{ 0,0,-1,-2 };
+	glm::vec4 AttenuationInnerCutoff{ 0.045f, 0.0075f, -2, 0 };
+};
+
+/// <summary>
+/// The Light struct in Lights.glsl.
+/// </summary>
+using ClusterLightLayout = BufferLayout<LayoutStandard::Std430, glm::vec4, glm::vec4, glm::vec4, glm::vec4>;
+
+static_assert(ClusterLightLayout::Matches<ClusterLight>({ offsetof(ClusterLight, PositionRadius), offsetof(ClusterLight, ColorSpecular),
+	offsetof(ClusterLight, DirectionOuterCutoff), offsetof(ClusterLight, AttenuationInnerCutoff) }), "ClusterLight does not match the std430 Light struct");
+
+/// <summary>
+/// Elements of the cluster (offset, count) and light index buffers.
+/// </summary>
+using ClusterRangeLayout = BufferLayout<LayoutStandard::Std430, glm::uvec2>;
+using LightIndexLayout = BufferLayout<LayoutStandard::Std430, GLuint>;
+
+/// <summary>
+/// Clustered forward lighting.
+/// The view frustum is split into a 3D grid of clusters (screen tiles x exponential depth slices)
+/// and each frame every light is assigned to the clusters its sphere of influence touches, split across worker threads by depth slice.
+/// The lights, a per cluster (offset, count) grid and the light index list are uploaded to shader storage buffers
+/// so fragments only shade the lights of their own cluster.
+/// </summary>
+class ClusteredLighting
+{
+public:
+	/// <summary>
+	/// ClusteredLighting Constructor
+	/// </summary>
+	/// <param name="_gridSize"> Number of clusters in x, y (screen) and z (depth) </param>
+	/// <param name="_threadCount"> Number of worker threads, 0 uses the hardware thread count </param>
+	ClusteredLighting(glm::ivec3 _gridSize = { 16, 9, 24 }, int _threadCount = 0);
+
+	/// <summary>
+	/// ClusteredLighting Destructor
+	/// </summary>
+	~ClusteredLighting();
+
+	/// <summary>
+	/// Assigns the lights to clusters for the given camera. Does not touch GL so can run without a context.
+	/// </summary>
+	/// <param name="_lights"></param>
+	/// <param name="_viewMatrix"></param>
+	/// <param name="_projectionMatrix"></param>
+	/// <param name="_nearAndFar"></param>
+	/// <param name="_screenSize"></param>
+	void Build(const std::vector<ClusterLight>& _lights, const glm::mat4& _viewMatrix, const glm::mat4& _projectionMatrix, glm::vec2 _nearAndFar, glm::ivec2 _screenSize);
+
+	/// <summary>
+	/// Uploads the lights, cluster grid and light indices of the last build.
+	/// </summary>
+	void Upload();
+
+	/// <summary>
+	/// Binds the light, cluster and light index storage buffers to their fixed bindings.
+	/// </summary>
+	void Bind();
+
+	/// <summary>
+	/// Returns the number of clusters in x, y and z.
+	/// </summary>
+	/// <returns></returns>
+	glm::ivec3 GetGridSize();
+
+	/// <summary>
+	/// Returns the parameters shaders need to find their cluster:
+	/// the tile size in pixels (xy) and the depth slice scale and bias (zw), where slice = log(depth) * scale - bias.
+	/// </summary>
+	/// <returns></returns>
+	glm::vec4 GetTileSizeAndDepthScaleBias();
+
+	/// <summary>
+	/// Returns the number of lights in the last build.
+	/// </summary>
+	/// <returns></returns>
+	int GetLightCount();
+
+	/// <summary>
+	/// Returns the total number of light references across all clusters in the last build.
+	/// </summary>
+	/// <returns></returns>
+	int GetLightIndexCount();
+
+	/// <summary>
+	/// Returns the most lights any one cluster received in the last build.
+	/// </summary>
+	/// <returns></returns>
+	int GetMaxLightsPerCluster();
+
+	/// <summary>
+	/// Runs a headless benchmark assigning randomly placed lights and prints the timings.
+	/// </summary>
+	/// <param name="_lightCount"></param>
+	static void Benchmark(int _lightCount = 500);
+
+	static const GLuint LightBinding = 4;
+	static const GLuint ClusterBinding = 5;
+	static const GLuint LightIndexBinding = 6;
+
+private:
+	/// <summary>
+	/// Recalculates the view space bounds of every cluster for the current projection.
+	/// </summary>
+	void CalculateClusterBounds();
+
+	/// <summary>
+	/// Assigns the view space lights to the clusters in the given range of depth slices.
+	/// </summary>
+	/// <param name="_firstSlice"></param>
+	/// <param name="_lastSlice"></param>
+	void AssignSlices(int _firstSlice, int _lastSlice);
+
+	/// <summary>
+	/// Returns the depth slice containing the given positive view space depth.
+	/// </summary>
+	/// <param name="_depth"></param>
+	/// <returns></returns>
+	int GetSlice(float _depth);
+
+	/// <summary>
+	/// The inclusive range of clusters a light could touch. Lights outside the frustum have Min greater than Max.
+	/// </summary>
+	struct LightExtent
+	{
+		glm::ivec3 Min{ 0,0,0 };
+		glm::ivec3 Max{ -1,-1,-1 };
+	};
+
+	glm::ivec3 m_GridSize{ 16, 9, 24 };
+	int m_ThreadCount{ 1 };
+
+	glm::mat4 m_ViewMatrix{ 1 };
+	glm::mat4 m_ProjectionMatrix{ 0 };
+	glm::vec2 m_NearAndFar{ 0.1f, 2000.0f };
+	glm::ivec2 m_ScreenSize{ 1, 1 };
+
+	std::vector<ClusterLight> m_Lights{};
+	std::vector<glm::vec4> m_ViewSpaceSpheres{};
+	std::vector<LightExtent> m_LightExtents{};
+	std::vector<AABB> m_ClusterBounds{};
+	std::vector<std::vector<GLuint>> m_ClusterLights{};
+
+	std::vector<glm::uvec2> m_ClusterRanges{};
+	std::vector<GLuint> m_LightIndices{};
+	int m_MaxLightsPerCluster{ 0 };
+
+	GLuint m_LightBufferID{ 0 };
+	GLuint m_ClusterBufferID{ 0 };
+	GLuint m_LightIndexBufferID{ 0 };
+};
@@ -0,0 +1,180 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : DeferredRenderer.cpp 
+// Description : DeferredRenderer Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "DeferredRenderer.h"
+#include "GLState.h"
+
+DeferredRenderer::DeferredRenderer(Camera& _camera, glm::ivec2& _screenSize)
+{
+	m_ActiveCamera = &_camera;
+	m_ScreenSize = &_screenSize;
+
+	m_GBufferShader = new Shader{
+		{
+			ShaderInfo{GL_VERTEX_SHADER, "Normals3D.vert"},
+			ShaderInfo{GL_FRAGMENT_SHADER, "GBuffer.frag"},
+		}
+	, nullptr };
+	m_LightingShader = new Shader{ { ShaderInfo{GL_COMPUTE_SHADER, "DeferredLighting.comp"} }, nullptr };
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+	DestroyTargets();
+
+	for (Shader* shader : { m_GBufferShader, m_LightingShader })
+	{
+		GLState::DeleteProgram(shader->ID);
+		delete shader;
+	}
+	m_GBufferShader = nullptr;
+	m_LightingShader = nullptr;
+
+	m_ActiveCamera = nullptr;
+	m_ScreenSize = nullptr;
+}
+
+void DeferredRenderer::Draw(const std::vector<GameObject*>& _gameObjects, const std::vector<int>& _visibleObjects)
+{
+	if (m_TargetSize != *m_ScreenSize)
+	{
+		DestroyTargets();
+		CreateTargets();
+	}
+
+	m_OpaqueObjects.clear();
+	m_TransparentObjects.clear();
+	for (auto& index : _visibleObjects)
+	{
+		if (_gameObjects[index]->GetIsTransparent())
+			m_TransparentObjects.push_back(_gameObjects[index]);
+		else
+			m_OpaqueObjects.push_back(_gameObjects[index]);
+	}
+
+	// Clear every target, the lit target keeps the clear color wherever nothing is drawn
+	GLenum drawBuffers[4]{ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+	GLuint clearMaterial[4]{ 0, 0, 0, 0 };
+	glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+	glDrawBuffers(4, drawBuffers);
+	GLState::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	glClearBufferuiv(GL_COLOR, 2, clearMaterial);
+
+	// Geometry pass, each gameobject sets its pipeline without blending so albedo alpha does not mix normals
+	glDrawBuffers(3, drawBuffers);
+	for (GLuint program : { m_GBufferShader->ID, m_GBufferShader->GetVariant(1, []() { return std::vector<std::string>{ "HAS_TEXTURE" }; }) })
+	{
+		GLState::UseProgram(program);
+		ShaderLoader::SetUniform1i(std::move(program), "MaterialID"_id, CelShadedMaterial);
+	}
+	for (auto& gameObject : m_OpaqueObjects)
+	{
+		gameObject->DrawGBuffer(*m_GBufferShader);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	DispatchLighting();
+	Composite();
+
+	// Outlines wherever the stencil was not marked, then transparents back to front
+	for (auto& gameObject : m_OpaqueObjects)
+	{
+		gameObject->DrawOutline();
+	}
+
+	glm::vec3 cameraPosition = m_ActiveCamera->GetPosition();
+	std::sort(m_TransparentObjects.begin(), m_TransparentObjects.end(), [&cameraPosition](GameObject* _a, GameObject* _b)
+		{
+			return glm::distance(_a->m_Transform.translation, cameraPosition) > glm::distance(_b->m_Transform.translation, cameraPosition);
+		});
+	for (auto& gameObject : m_TransparentObjects)
+	{
+		gameObject->Draw();
+	}
+}
+
+void DeferredRenderer::CreateTargets()
+{
+	m_TargetSize = glm::max(*m_ScreenSize, glm::ivec2{ 1, 1 });
+
+	auto createTexture = [this](GLuint& _textureID, GLenum _internalFormat)
+	{
+		glGenTextures(1, &_textureID);
+		GLState::BindTexture(GL_TEXTURE_2D, _textureID);
+		glTexStorage2D(GL_TEXTURE_2D, 1, _internalFormat, m_TargetSize.x, m_TargetSize.y);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	};
+	createTexture(m_AlbedoTextureID, GL_RGBA8);
+	createTexture(m_NormalTextureID, GL_RGBA16F);
+	createTexture(m_MaterialTextureID, GL_R8UI);
+	createTexture(m_LitTextureID, GL_RGBA8);
+	// Same format as the default framebuffer so depth and stencil can be blitted across
+	createTexture(m_DepthStencilTextureID, GL_DEPTH24_STENCIL8);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_FramebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_AlbedoTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_NormalTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_MaterialTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, m_LitTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_DepthStencilTextureID, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		Print("Deferred G-buffer framebuffer is incomplete");
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredRenderer::DestroyTargets()
+{
+	for (GLuint* textureID : { &m_AlbedoTextureID, &m_NormalTextureID, &m_MaterialTextureID, &m_LitTextureID, &m_DepthStencilTextureID })
+	{
+		if (*textureID)
+			GLState::DeleteTextures(1, textureID);
+		*textureID = 0;
+	}
+	if (m_FramebufferID)
+		glDeleteFramebuffers(1, &m_FramebufferID);
+	m_FramebufferID = 0;
+}
+
+void DeferredRenderer::DispatchLighting()
+{
+	GLState::UseProgram(m_LightingShader->ID);
+	ShaderLoader::SetUniformMatrix4fv(std::move(m_LightingShader->ID), "InversePVMatrix"_id, glm::inverse(m_ActiveCamera->GetPVMatrix()));
+	ShaderLoader::SetUniform2i(std::move(m_LightingShader->ID), "ScreenSize"_id, m_TargetSize.x, m_TargetSize.y);
+
+	GLuint textures[4]{ m_AlbedoTextureID, m_NormalTextureID, m_MaterialTextureID, m_DepthStencilTextureID };
+	for (int i = 0; i < 4; i++)
+	{
+		GLState::BindTexture(i, GL_TEXTURE_2D, textures[i]);
+	}
+	glBindImageTexture(0, m_LitTextureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	glDispatchCompute((m_TargetSize.x + TileSize - 1) / TileSize, (m_TargetSize.y + TileSize - 1) / TileSize, 1);
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+
+	// Unbound so the next geometry pass never has its own attachments bound for sampling
+	for (int i = 3; i >= 0; i--)
+	{
+		GLState::BindTexture(i, GL_TEXTURE_2D, 0);
+	}
+}
+
+void DeferredRenderer::Composite()
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_FramebufferID);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glReadBuffer(GL_COLOR_ATTACHMENT3);
+	glBlitFramebuffer(0, 0, m_TargetSize.x, m_TargetSize.y, 0, 0, m_TargetSize.x, m_TargetSize.y, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,84 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : DeferredRenderer.h 
+// Description : DeferredRenderer Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "GameObject.h"
+
+/// <summary>
+/// Deferred cel shading.
+/// Opaque gameobjects are drawn once into a G-buffer (albedo, normal and shininess, material ID, depth and stencil),
+/// then a tiled compute pass lights each visible pixel with only the lights of its cluster and the sun.
+/// The result and the depth and stencil are copied to the default framebuffer so toon outlines
+/// and transparent gameobjects are drawn forward on top as before.
+/// </summary>
+class DeferredRenderer
+{
+public:
+	/// <summary>
+	/// DeferredRenderer Constructor
+	/// </summary>
+	/// <param name="_camera"></param>
+	/// <param name="_screenSize"></param>
+	DeferredRenderer(Camera& _camera, glm::ivec2& _screenSize);
+
+	/// <summary>
+	/// DeferredRenderer Destructor
+	/// </summary>
+	~DeferredRenderer();
+
+	/// <summary>
+	/// Draws the visible gameobjects, opaque ones deferred and transparent ones forward.
+	/// The frame uniforms and light clusters must already be updated.
+	/// </summary>
+	/// <param name="_gameObjects"></param>
+	/// <param name="_visibleObjects"> Indices into _gameObjects </param>
+	void Draw(const std::vector<GameObject*>& _gameObjects, const std::vector<int>& _visibleObjects);
+
+	static const int CelShadedMaterial = 1;
+	static const int TileSize = 16;
+
+private:
+	/// <summary>
+	/// Creates the G-buffer textures and framebuffer at the screen size.
+	/// </summary>
+	void CreateTargets();
+
+	/// <summary>
+	/// Deletes the G-buffer textures and framebuffer.
+	/// </summary>
+	void DestroyTargets();
+
+	/// <summary>
+	/// Lights the G-buffer into the lit texture with the tiled compute pass.
+	/// </summary>
+	void DispatchLighting();
+
+	/// <summary>
+	/// Copies the lit color, depth and stencil to the default framebuffer.
+	/// </summary>
+	void Composite();
+
+	Camera* m_ActiveCamera{ nullptr };
+	glm::ivec2* m_ScreenSize{ nullptr };
+	glm::ivec2 m_TargetSize{ 0, 0 };
+
+	Shader* m_GBufferShader{ nullptr };
+	Shader* m_LightingShader{ nullptr };
+
+	GLuint m_FramebufferID{ 0 };
+	GLuint m_AlbedoTextureID{ 0 };
+	GLuint m_NormalTextureID{ 0 };
+	GLuint m_MaterialTextureID{ 0 };
+	GLuint m_LitTextureID{ 0 };
+	GLuint m_DepthStencilTextureID{ 0 };
+
+	std::vector<GameObject*> m_OpaqueObjects{};
+	std::vector<GameObject*> m_TransparentObjects{};
+};
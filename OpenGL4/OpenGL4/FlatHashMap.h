@@ -0,0 +1,200 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : FlatHashMap.h 
+// Description : FlatHashMap Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "StringID.h"
+
+/// <summary>
+/// An open addressing hash map for registries keyed by StringID or other cheaply hashed keys.
+/// Entries are stored densely in insertion order, apart from erases which move the last entry into the gap,
+/// and a power of two slot table of entry indices is probed linearly from the key's hash.
+/// Lookups touch one slot table and one entry array instead of a node per key.
+/// Pointers to values are invalidated by inserting or erasing.
+/// </summary>
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap
+{
+public:
+	using Entry = std::pair<Key, Value>;
+
+	/// <summary>
+	/// Returns the value of a key, or nullptr if it is not in the map.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	Value* Find(const Key& _key)
+	{
+		if (m_Entries.empty())
+			return nullptr;
+		uint32_t index = m_Slots[FindSlot(_key)];
+		return index == EmptySlot ? nullptr : &m_Entries[index].second;
+	}
+
+	const Value* Find(const Key& _key) const
+	{
+		return const_cast<FlatHashMap*>(this)->Find(_key);
+	}
+
+	/// <summary>
+	/// Returns true if the key is in the map.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	bool Contains(const Key& _key) const
+	{
+		return Find(_key) != nullptr;
+	}
+
+	/// <summary>
+	/// Returns the value of a key, default constructing it first if the key is not in the map.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	Value& operator[](const Key& _key)
+	{
+		// Kept at most half full so probe runs stay short
+		if ((m_Entries.size() + 1) * 2 > m_Slots.size())
+			Rehash(std::max<size_t>(m_Slots.size() * 2, MinimumSlotCount));
+
+		size_t slot = FindSlot(_key);
+		if (m_Slots[slot] == EmptySlot)
+		{
+			m_Slots[slot] = (uint32_t)m_Entries.size();
+			m_Entries.emplace_back(_key, Value{});
+		}
+		return m_Entries[m_Slots[slot]].second;
+	}
+
+	/// <summary>
+	/// Removes a key, returning false if it was not in the map.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	bool Erase(const Key& _key)
+	{
+		if (m_Entries.empty())
+			return false;
+		size_t slot = FindSlot(_key);
+		uint32_t index = m_Slots[slot];
+		if (index == EmptySlot)
+			return false;
+
+		// Shift later slots of the probe run back so no lookup stops early at the hole
+		size_t mask = m_Slots.size() - 1;
+		size_t next = slot;
+		while (true)
+		{
+			next = (next + 1) & mask;
+			if (m_Slots[next] == EmptySlot)
+				break;
+			size_t home = GetHomeSlot(m_Entries[m_Slots[next]].first);
+			bool isBetween = slot <= next ? (slot < home && home <= next) : (slot < home || home <= next);
+			if (isBetween)
+				continue;
+			m_Slots[slot] = m_Slots[next];
+			slot = next;
+		}
+		m_Slots[slot] = EmptySlot;
+
+		// Fill the gap in the entries with the last entry
+		uint32_t last = (uint32_t)m_Entries.size() - 1;
+		if (index != last)
+		{
+			m_Slots[FindSlot(m_Entries[last].first)] = index;
+			m_Entries[index] = std::move(m_Entries[last]);
+		}
+		m_Entries.pop_back();
+		return true;
+	}
+
+	/// <summary>
+	/// Removes every entry, keeping the allocated slots.
+	/// </summary>
+	void Clear()
+	{
+		m_Entries.clear();
+		std::fill(m_Slots.begin(), m_Slots.end(), EmptySlot);
+	}
+
+	/// <summary>
+	/// Allocates room for the given number of entries.
+	/// </summary>
+	/// <param name="_count"></param>
+	void Reserve(size_t _count)
+	{
+		size_t slotCount = MinimumSlotCount;
+		while (slotCount < _count * 2)
+			slotCount *= 2;
+		if (slotCount > m_Slots.size())
+			Rehash(slotCount);
+	}
+
+	size_t Size() const { return m_Entries.size(); }
+	bool IsEmpty() const { return m_Entries.empty(); }
+
+	auto begin() { return m_Entries.begin(); }
+	auto end() { return m_Entries.end(); }
+	auto begin() const { return m_Entries.begin(); }
+	auto end() const { return m_Entries.end(); }
+
+private:
+	static constexpr uint32_t EmptySlot = 0xFFFFFFFF;
+	static constexpr size_t MinimumSlotCount = 16;
+
+	/// <summary>
+	/// Returns the slot a key's probe run starts at.
+	/// The hash is multiplied by 2^64 / golden ratio and the top bits taken, so hashes that only differ in high bits still spread out.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	size_t GetHomeSlot(const Key& _key) const
+	{
+		uint64_t hash = (uint64_t)Hash{}(_key) * 0x9E3779B97F4A7C15ull;
+		return (size_t)(hash >> m_Shift);
+	}
+
+	/// <summary>
+	/// Returns the slot holding the key, or the empty slot its probe run ends at.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	size_t FindSlot(const Key& _key) const
+	{
+		size_t mask = m_Slots.size() - 1;
+		size_t slot = GetHomeSlot(_key);
+		while (m_Slots[slot] != EmptySlot && !(m_Entries[m_Slots[slot]].first == _key))
+		{
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+	/// <summary>
+	/// Rebuilds the slot table with a new power of two size.
+	/// </summary>
+	/// <param name="_slotCount"></param>
+	void Rehash(size_t _slotCount)
+	{
+		m_Slots.assign(_slotCount, EmptySlot);
+		m_Shift = 64;
+		for (size_t count = _slotCount; count > 1; count >>= 1)
+		{
+			m_Shift--;
+		}
+		for (uint32_t index = 0; index < (uint32_t)m_Entries.size(); index++)
+		{
+			m_Slots[FindSlot(m_Entries[index].first)] = index;
+		}
+	}
+
+	std::vector<Entry> m_Entries{};
+	std::vector<uint32_t> m_Slots{};
+	int m_Shift{ 64 };
+};
@@ -9,6 +9,7 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "FontLoader.h"
+#include "GLState.h"
 
 Font FontLoader::LoadFont(std::string&& _fileName, unsigned _characterLimit)
 {
@@ -73,7 +74,7 @@ GLuint FontLoader::LoadFontTexture(FT_Face&& _fontFace)
 	// Generate a texture for the fontFace glyph
 	GLuint textureID;
 	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::BindTexture(GL_TEXTURE_2D, textureID);
 	glTexImage2D(GL_TEXTURE_2D,
 		0,
 		GL_RED,
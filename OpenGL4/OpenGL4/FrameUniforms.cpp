@@ -0,0 +1,79 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : FrameUniforms.cpp 
+// Description : FrameUniforms Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "FrameUniforms.h"
+#include "GLState.h"
+
+void FrameUniforms::Update(Camera& _camera, LightManager& _lightManager, CascadedShadowMap* _shadowMap, IrradianceVolume* _irradianceVolume)
+{
+	if (m_BufferID == 0)
+	{
+		glGenBuffers(1, &m_BufferID);
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	ClusteredLighting& clusters = _lightManager.GetClusteredLighting();
+	m_Data.ViewMatrix = _camera.GetViewMatrix();
+	m_Data.ProjectionMatrix = _camera.GetProjectionMatrix();
+	m_Data.PVMatrix = m_Data.ProjectionMatrix * m_Data.ViewMatrix;
+	m_Data.CameraPosition = { _camera.GetPosition(), 1.0f };
+	m_Data.AmbientColorStrength = _lightManager.GetAmbientLight();
+	m_Data.ClusterGridSize = { clusters.GetGridSize(), clusters.GetLightCount() };
+	m_Data.ClusterTileSizeDepthScaleBias = clusters.GetTileSizeAndDepthScaleBias();
+
+	// Only the first directional light is shaded
+	m_Data.SunDirection = { 0,-1,0,0 };
+	m_Data.SunColorSpecular = { 0,0,0,0 };
+	if (_lightManager.GetDirectionalLights().size() > 0)
+	{
+		DirectionalLight& sun = _lightManager.GetDirectionalLights()[0];
+		m_Data.SunDirection = { glm::normalize(sun.Direction), 1.0f };
+		m_Data.SunColorSpecular = { sun.Color, sun.SpecularStrength };
+	}
+
+	m_Data.ShadowParameters = { 0,0,0,0 };
+	if (_shadowMap)
+	{
+		CascadedShadowSettings& settings = _shadowMap->GetSettings();
+		for (int i = 0; i < _shadowMap->GetCascadeCount(); i++)
+		{
+			m_Data.CascadeMatrices[i] = _shadowMap->GetCascadeMatrix(i);
+			m_Data.CascadeSplits[i] = _shadowMap->GetCascadeSplit(i);
+			m_Data.CascadeTexelSizes[i] = _shadowMap->GetCascadeTexelSize(i);
+		}
+		m_Data.ShadowParameters = { (float)_shadowMap->GetCascadeCount(), 1.0f / settings.Resolution, settings.DepthBias, settings.NormalOffset };
+	}
+
+	m_Data.ProbeGridMin = { 0,0,0,0 };
+	if (_irradianceVolume && _irradianceVolume->IsLoaded())
+	{
+		m_Data.ProbeGridMin = { _irradianceVolume->GetBounds().Min, 1.0f };
+		m_Data.ProbeGridCellSize = { _irradianceVolume->GetCellSize(), 0.0f };
+		m_Data.ProbeGridResolution = { _irradianceVolume->GetResolution(), 0 };
+	}
+
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniformData), &m_Data);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, Binding, m_BufferID);
+}
+
+const FrameUniformData& FrameUniforms::GetData()
+{
+	return m_Data;
+}
+
+void FrameUniforms::Cleanup()
+{
+	if (m_BufferID)
+		GLState::DeleteBuffers(1, &m_BufferID);
+	m_BufferID = 0;
+}
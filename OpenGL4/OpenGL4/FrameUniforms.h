@@ -0,0 +1,90 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : FrameUniforms.h 
+// Description : FrameUniforms Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "CascadedShadowMap.h"
+#include "IrradianceVolume.h"
+
+/// <summary>
+/// Per frame data shared by every program through the FrameUniforms std140 uniform block.
+/// Every member is 16 byte aligned so the C++ layout matches std140 exactly, checked against FrameUniformLayout.
+/// SunDirection.w is 1 when there is a directional light, ShadowParameters holds
+/// the cascade count, shadow map texel size, depth bias and normal offset in texels.
+/// ProbeGridMin.w is 1 when irradiance probes replace the flat ambient light.
+/// </summary>
+struct FrameUniformData
+{
+	glm::mat4 ViewMatrix{ 1 };
+	glm::mat4 ProjectionMatrix{ 1 };
+	glm::mat4 PVMatrix{ 1 };
+	glm::vec4 CameraPosition{ 0,0,0,1 };
+	glm::vec4 AmbientColorStrength{ 1,1,1,0.5f };
+	glm::ivec4 ClusterGridSize{ 1,1,1,0 };
+	glm::vec4 ClusterTileSizeDepthScaleBias{ 1,1,0,0 };
+	glm::vec4 SunDirection{ 0,-1,0,0 };
+	glm::vec4 SunColorSpecular{ 0,0,0,0 };
+	glm::mat4 CascadeMatrices[CascadedShadowMap::MaxCascades]{};
+	glm::vec4 CascadeSplits{ 0,0,0,0 };
+	glm::vec4 CascadeTexelSizes{ 0,0,0,0 };
+	glm::vec4 ShadowParameters{ 0,0,0,0 };
+	glm::vec4 ProbeGridMin{ 0,0,0,0 };
+	glm::vec4 ProbeGridCellSize{ 1,1,1,0 };
+	glm::ivec4 ProbeGridResolution{ 0,0,0,0 };
+};
+
+/// <summary>
+/// The FrameUniforms block in FrameUniforms.glsl, member for member.
+/// </summary>
+using FrameUniformLayout = BufferLayout<LayoutStandard::Std140,
+	glm::mat4, glm::mat4, glm::mat4, glm::vec4, glm::vec4, glm::ivec4, glm::vec4, glm::vec4, glm::vec4,
+	glm::mat4[CascadedShadowMap::MaxCascades], glm::vec4, glm::vec4, glm::vec4, glm::vec4, glm::vec4, glm::ivec4>;
+
+static_assert(FrameUniformLayout::Matches<FrameUniformData>({
+	offsetof(FrameUniformData, ViewMatrix), offsetof(FrameUniformData, ProjectionMatrix), offsetof(FrameUniformData, PVMatrix),
+	offsetof(FrameUniformData, CameraPosition), offsetof(FrameUniformData, AmbientColorStrength), offsetof(FrameUniformData, ClusterGridSize),
+	offsetof(FrameUniformData, ClusterTileSizeDepthScaleBias), offsetof(FrameUniformData, SunDirection), offsetof(FrameUniformData, SunColorSpecular),
+	offsetof(FrameUniformData, CascadeMatrices), offsetof(FrameUniformData, CascadeSplits), offsetof(FrameUniformData, CascadeTexelSizes),
+	offsetof(FrameUniformData, ShadowParameters), offsetof(FrameUniformData, ProbeGridMin), offsetof(FrameUniformData, ProbeGridCellSize),
+	offsetof(FrameUniformData, ProbeGridResolution) }), "FrameUniformData does not match the std140 FrameUniforms block");
+
+/// <summary>
+/// Owns the per frame uniform buffer, bound at a fixed binding so programs never set camera or lighting uniforms themselves.
+/// Declare the matching block in a shader as: layout(std140, binding = 0) uniform FrameUniforms { ... };
+/// </summary>
+class FrameUniforms
+{
+public:
+	/// <summary>
+	/// Gathers the camera and lighting state and writes it to the buffer with a single update.
+	/// Call once per frame after the light clusters are updated and before drawing.
+	/// </summary>
+	/// <param name="_camera"></param>
+	/// <param name="_lightManager"></param>
+	/// <param name="_shadowMap"> Shadow map of the first directional light, if any </param>
+	/// <param name="_irradianceVolume"> Baked probes for indirect light, if any </param>
+	static void Update(Camera& _camera, LightManager& _lightManager, CascadedShadowMap* _shadowMap = nullptr, IrradianceVolume* _irradianceVolume = nullptr);
+
+	/// <summary>
+	/// Returns the data of the last update.
+	/// </summary>
+	/// <returns></returns>
+	static const FrameUniformData& GetData();
+
+	/// <summary>
+	/// Deletes the uniform buffer.
+	/// </summary>
+	static void Cleanup();
+
+	static const GLuint Binding = 0;
+
+private:
+	inline static FrameUniformData m_Data{};
+	inline static GLuint m_BufferID{ 0 };
+};
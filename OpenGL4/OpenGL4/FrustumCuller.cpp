@@ -0,0 +1,177 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : FrustumCuller.cpp 
+// Description : FrustumCuller Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "FrustumCuller.h"
+#include <immintrin.h>
+
+namespace
+{
+	// Thin wrappers so the cull loop is written once for both register widths
+#if defined(__AVX__)
+	using FloatBatch = __m256;
+	inline FloatBatch BatchLoad(const float* _address) { return _mm256_loadu_ps(_address); }
+	inline FloatBatch BatchBroadcast(float _value) { return _mm256_set1_ps(_value); }
+	inline FloatBatch BatchAdd(FloatBatch _a, FloatBatch _b) { return _mm256_add_ps(_a, _b); }
+	inline FloatBatch BatchMultiply(FloatBatch _a, FloatBatch _b) { return _mm256_mul_ps(_a, _b); }
+	inline FloatBatch BatchNegate(FloatBatch _a) { return _mm256_sub_ps(_mm256_setzero_ps(), _a); }
+	inline FloatBatch BatchLessThan(FloatBatch _a, FloatBatch _b) { return _mm256_cmp_ps(_a, _b, _CMP_LT_OQ); }
+	inline FloatBatch BatchOr(FloatBatch _a, FloatBatch _b) { return _mm256_or_ps(_a, _b); }
+	inline FloatBatch BatchAndNot(FloatBatch _mask, FloatBatch _value) { return _mm256_andnot_ps(_mask, _value); }
+	inline FloatBatch BatchAllTrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+	inline int BatchMoveMask(FloatBatch _a) { return _mm256_movemask_ps(_a); }
+#else
+	using FloatBatch = __m128;
+	inline FloatBatch BatchLoad(const float* _address) { return _mm_loadu_ps(_address); }
+	inline FloatBatch BatchBroadcast(float _value) { return _mm_set1_ps(_value); }
+	inline FloatBatch BatchAdd(FloatBatch _a, FloatBatch _b) { return _mm_add_ps(_a, _b); }
+	inline FloatBatch BatchMultiply(FloatBatch _a, FloatBatch _b) { return _mm_mul_ps(_a, _b); }
+	inline FloatBatch BatchNegate(FloatBatch _a) { return _mm_sub_ps(_mm_setzero_ps(), _a); }
+	inline FloatBatch BatchLessThan(FloatBatch _a, FloatBatch _b) { return _mm_cmplt_ps(_a, _b); }
+	inline FloatBatch BatchOr(FloatBatch _a, FloatBatch _b) { return _mm_or_ps(_a, _b); }
+	inline FloatBatch BatchAndNot(FloatBatch _mask, FloatBatch _value) { return _mm_andnot_ps(_mask, _value); }
+	inline FloatBatch BatchAllTrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+	inline int BatchMoveMask(FloatBatch _a) { return _mm_movemask_ps(_a); }
+#endif
+}
+
+void FrustumCuller::Clear()
+{
+	m_Count = 0;
+	m_VisibleCount = 0;
+
+	m_CentreX.clear();
+	m_CentreY.clear();
+	m_CentreZ.clear();
+	m_Radius.clear();
+
+	m_MinX.clear();
+	m_MinY.clear();
+	m_MinZ.clear();
+	m_MaxX.clear();
+	m_MaxY.clear();
+	m_MaxZ.clear();
+}
+
+int FrustumCuller::Add(const BoundingSphere& _sphere, const AABB& _bounds)
+{
+	m_CentreX.push_back(_sphere.Centre.x);
+	m_CentreY.push_back(_sphere.Centre.y);
+	m_CentreZ.push_back(_sphere.Centre.z);
+	m_Radius.push_back(_sphere.Radius);
+
+	m_MinX.push_back(_bounds.Min.x);
+	m_MinY.push_back(_bounds.Min.y);
+	m_MinZ.push_back(_bounds.Min.z);
+	m_MaxX.push_back(_bounds.Max.x);
+	m_MaxY.push_back(_bounds.Max.y);
+	m_MaxZ.push_back(_bounds.Max.z);
+
+	return m_Count++;
+}
+
+void FrustumCuller::Cull(const Frustum& _frustum, std::vector<int>& _visible)
+{
+	_visible.clear();
+	m_VisibleCount = 0;
+	if (m_Count == 0)
+		return;
+
+	PadToBatchWidth();
+
+	const int batchWidth = GetBatchWidth();
+	const int paddedCount = (int)m_Radius.size();
+
+	for (int i = 0; i < paddedCount; i += batchWidth)
+	{
+		FloatBatch centreX = BatchLoad(&m_CentreX[i]);
+		FloatBatch centreY = BatchLoad(&m_CentreY[i]);
+		FloatBatch centreZ = BatchLoad(&m_CentreZ[i]);
+		FloatBatch negativeRadius = BatchNegate(BatchLoad(&m_Radius[i]));
+
+		FloatBatch visible = BatchAllTrue();
+		for (const glm::vec4& plane : _frustum.Planes)
+		{
+			FloatBatch normalX = BatchBroadcast(plane.x);
+			FloatBatch normalY = BatchBroadcast(plane.y);
+			FloatBatch normalZ = BatchBroadcast(plane.z);
+			FloatBatch distance = BatchBroadcast(plane.w);
+
+			// Sphere is outside if its centre is further than its radius behind the plane
+			FloatBatch sphereDistance = BatchAdd(BatchAdd(BatchMultiply(centreX, normalX), BatchMultiply(centreY, normalY)), BatchAdd(BatchMultiply(centreZ, normalZ), distance));
+			FloatBatch sphereOutside = BatchLessThan(sphereDistance, negativeRadius);
+
+			// AABB is outside if the corner furthest along the normal is behind the plane.
+			// The plane is the same for the whole batch so the corner is chosen per axis, not per object.
+			FloatBatch positiveX = BatchLoad(plane.x >= 0 ? &m_MaxX[i] : &m_MinX[i]);
+			FloatBatch positiveY = BatchLoad(plane.y >= 0 ? &m_MaxY[i] : &m_MinY[i]);
+			FloatBatch positiveZ = BatchLoad(plane.z >= 0 ? &m_MaxZ[i] : &m_MinZ[i]);
+			FloatBatch boxDistance = BatchAdd(BatchAdd(BatchMultiply(positiveX, normalX), BatchMultiply(positiveY, normalY)), BatchAdd(BatchMultiply(positiveZ, normalZ), distance));
+			FloatBatch boxOutside = BatchLessThan(boxDistance, BatchBroadcast(0.0f));
+
+			visible = BatchAndNot(BatchOr(sphereOutside, boxOutside), visible);
+		}
+
+		// Write out the indices of the visible objects in this batch
+		int mask = BatchMoveMask(visible);
+		while (mask != 0)
+		{
+			int lane = 0;
+			while ((mask & (1 << lane)) == 0)
+				lane++;
+			mask &= ~(1 << lane);
+
+			if (i + lane < m_Count)
+				_visible.push_back(i + lane);
+		}
+	}
+
+	m_VisibleCount = (int)_visible.size();
+
+	// Remove the padding so more bounds can still be added this frame
+	m_CentreX.resize(m_Count);
+	m_CentreY.resize(m_Count);
+	m_CentreZ.resize(m_Count);
+	m_Radius.resize(m_Count);
+	m_MinX.resize(m_Count);
+	m_MinY.resize(m_Count);
+	m_MinZ.resize(m_Count);
+	m_MaxX.resize(m_Count);
+	m_MaxY.resize(m_Count);
+	m_MaxZ.resize(m_Count);
+}
+
+int FrustumCuller::GetCount()
+{
+	return m_Count;
+}
+
+int FrustumCuller::GetVisibleCount()
+{
+	return m_VisibleCount;
+}
+
+void FrustumCuller::PadToBatchWidth()
+{
+	const int batchWidth = GetBatchWidth();
+	int paddedCount = ((m_Count + batchWidth - 1) / batchWidth) * batchWidth;
+
+	// Padding lanes are ignored when writing the visibility list
+	m_CentreX.resize(paddedCount, 0.0f);
+	m_CentreY.resize(paddedCount, 0.0f);
+	m_CentreZ.resize(paddedCount, 0.0f);
+	m_Radius.resize(paddedCount, 0.0f);
+
+	m_MinX.resize(paddedCount, 0.0f);
+	m_MinY.resize(paddedCount, 0.0f);
+	m_MinZ.resize(paddedCount, 0.0f);
+	m_MaxX.resize(paddedCount, 0.0f);
+	m_MaxY.resize(paddedCount, 0.0f);
+	m_MaxZ.resize(paddedCount, 0.0f);
+}
@@ -0,0 +1,88 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : FrustumCuller.h 
+// Description : FrustumCuller Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// Batch frustum culler.
+/// Bounds are stored structure of arrays so a whole SIMD register of objects (8 with AVX, 4 with SSE)
+/// can be tested against a plane at once. Each object is tested with its bounding sphere and its AABB.
+/// </summary>
+class FrustumCuller
+{
+public:
+	/// <summary>
+	/// Removes all bounds from the culler. Should be called at the start of each frame.
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Adds world space bounds for an object and returns its index in the visibility list.
+	/// </summary>
+	/// <param name="_sphere"></param>
+	/// <param name="_bounds"></param>
+	/// <returns></returns>
+	int Add(const BoundingSphere& _sphere, const AABB& _bounds);
+
+	/// <summary>
+	/// Tests every added object against the frustum and fills _visible with the indices of those that are inside or intersecting.
+	/// </summary>
+	/// <param name="_frustum"></param>
+	/// <param name="_visible"></param>
+	void Cull(const Frustum& _frustum, std::vector<int>& _visible);
+
+	/// <summary>
+	/// Returns the number of objects added this frame.
+	/// </summary>
+	/// <returns></returns>
+	int GetCount();
+
+	/// <summary>
+	/// Returns the number of objects that passed the last cull.
+	/// </summary>
+	/// <returns></returns>
+	int GetVisibleCount();
+
+	/// <summary>
+	/// Returns the number of objects tested per SIMD instruction.
+	/// </summary>
+	/// <returns></returns>
+	static constexpr int GetBatchWidth()
+	{
+#if defined(__AVX__)
+		return 8;
+#else
+		return 4;
+#endif
+	}
+
+private:
+	/// <summary>
+	/// Pads the arrays up to a multiple of the batch width with zeroed bounds, so whole batches can be loaded.
+	/// The padding lanes are still tested, their results are dropped by only writing lanes below the object count.
+	/// </summary>
+	void PadToBatchWidth();
+
+	int m_Count{ 0 };
+	int m_VisibleCount{ 0 };
+
+	std::vector<float> m_CentreX{};
+	std::vector<float> m_CentreY{};
+	std::vector<float> m_CentreZ{};
+	std::vector<float> m_Radius{};
+
+	std::vector<float> m_MinX{};
+	std::vector<float> m_MinY{};
+	std::vector<float> m_MinZ{};
+	std::vector<float> m_MaxX{};
+	std::vector<float> m_MaxY{};
+	std::vector<float> m_MaxZ{};
+};
@@ -0,0 +1,310 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : GLState.cpp 
+// Description : GLState Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "GLState.h"
+
+void GLState::Reset()
+{
+	Invalidate();
+	SetPipeline(PipelineState{});
+}
+
+void GLState::Invalidate()
+{
+	m_IsKnown = false;
+	m_Program = UnknownBinding;
+	m_VertexArray = UnknownBinding;
+	m_ActiveTexture = UnknownBinding;
+	for (auto& unit : m_Textures)
+	{
+		for (auto& texture : unit)
+		{
+			texture = UnknownBinding;
+		}
+	}
+	for (auto& buffer : m_Buffers)
+	{
+		buffer = UnknownBinding;
+	}
+	for (auto& target : m_IndexedBuffers)
+	{
+		for (auto& buffer : target)
+		{
+			buffer = UnknownBinding;
+		}
+	}
+}
+
+void GLState::SetPipeline(const PipelineState& _state)
+{
+	const PipelineState& current = m_Pipeline;
+
+	SetCapability(GL_BLEND, m_Pipeline.Blend.Enabled, _state.Blend.Enabled);
+	if (ShouldApply(current.Blend.Source != _state.Blend.Source || current.Blend.Destination != _state.Blend.Destination))
+		glBlendFunc(_state.Blend.Source, _state.Blend.Destination);
+
+	SetCapability(GL_DEPTH_TEST, m_Pipeline.Depth.TestEnabled, _state.Depth.TestEnabled);
+	if (ShouldApply(current.Depth.WriteEnabled != _state.Depth.WriteEnabled))
+		glDepthMask(_state.Depth.WriteEnabled ? GL_TRUE : GL_FALSE);
+	if (ShouldApply(current.Depth.Function != _state.Depth.Function))
+		glDepthFunc(_state.Depth.Function);
+
+	SetCapability(GL_STENCIL_TEST, m_Pipeline.Stencil.TestEnabled, _state.Stencil.TestEnabled);
+	if (ShouldApply(current.Stencil.Function != _state.Stencil.Function || current.Stencil.Reference != _state.Stencil.Reference || current.Stencil.ReadMask != _state.Stencil.ReadMask))
+		glStencilFunc(_state.Stencil.Function, _state.Stencil.Reference, _state.Stencil.ReadMask);
+	if (ShouldApply(current.Stencil.WriteMask != _state.Stencil.WriteMask))
+		glStencilMask(_state.Stencil.WriteMask);
+	if (ShouldApply(current.Stencil.StencilFail != _state.Stencil.StencilFail || current.Stencil.DepthFail != _state.Stencil.DepthFail || current.Stencil.DepthPass != _state.Stencil.DepthPass))
+		glStencilOp(_state.Stencil.StencilFail, _state.Stencil.DepthFail, _state.Stencil.DepthPass);
+
+	SetCapability(GL_CULL_FACE, m_Pipeline.Raster.CullEnabled, _state.Raster.CullEnabled);
+	if (ShouldApply(current.Raster.CullFace != _state.Raster.CullFace))
+		glCullFace(_state.Raster.CullFace);
+	SetCapability(GL_POLYGON_OFFSET_FILL, m_Pipeline.Raster.PolygonOffsetEnabled, _state.Raster.PolygonOffsetEnabled);
+	if (ShouldApply(current.Raster.PolygonOffsetFactor != _state.Raster.PolygonOffsetFactor || current.Raster.PolygonOffsetUnits != _state.Raster.PolygonOffsetUnits))
+		glPolygonOffset(_state.Raster.PolygonOffsetFactor, _state.Raster.PolygonOffsetUnits);
+
+	m_Pipeline = _state;
+	m_IsKnown = true;
+}
+
+void GLState::SetPipeline(const PipelineState& _state, GLuint _program)
+{
+	SetPipeline(_state);
+	UseProgram(_program);
+}
+
+void GLState::Clear(GLbitfield _mask)
+{
+	// Write masks also mask clears, so a pass that left them off would keep last frame's depth or stencil
+	PipelineState state = m_Pipeline;
+	if (_mask & GL_DEPTH_BUFFER_BIT)
+		state.Depth.WriteEnabled = true;
+	if (_mask & GL_STENCIL_BUFFER_BIT)
+		state.Stencil.WriteMask = 0xFF;
+	SetPipeline(state);
+
+	glClear(_mask);
+}
+
+void GLState::UseProgram(GLuint _program)
+{
+	if (BindingChanged(m_Program, _program))
+		glUseProgram(_program);
+}
+
+GLuint GLState::GetProgram()
+{
+	return m_Program == UnknownBinding ? 0 : m_Program;
+}
+
+void GLState::BindVertexArray(GLuint _vertexArray)
+{
+	if (BindingChanged(m_VertexArray, _vertexArray))
+		glBindVertexArray(_vertexArray);
+}
+
+void GLState::ActiveTexture(GLenum _unit)
+{
+	if (BindingChanged(m_ActiveTexture, _unit - GL_TEXTURE0))
+		glActiveTexture(_unit);
+}
+
+void GLState::BindTexture(GLenum _target, GLuint _texture)
+{
+	int targetIndex = GetTextureTargetIndex(_target);
+	if (m_ActiveTexture >= MaxTextureUnits || targetIndex < 0)
+	{
+		m_FrameStats.Calls++;
+		glBindTexture(_target, _texture);
+		return;
+	}
+
+	if (BindingChanged(m_Textures[m_ActiveTexture][targetIndex], _texture))
+		glBindTexture(_target, _texture);
+}
+
+void GLState::BindTexture(GLuint _unit, GLenum _target, GLuint _texture)
+{
+	ActiveTexture(GL_TEXTURE0 + _unit);
+	BindTexture(_target, _texture);
+}
+
+void GLState::BindBuffer(GLenum _target, GLuint _buffer)
+{
+	int targetIndex = GetBufferTargetIndex(_target);
+	if (targetIndex < 0)
+	{
+		m_FrameStats.Calls++;
+		glBindBuffer(_target, _buffer);
+		return;
+	}
+
+	if (BindingChanged(m_Buffers[targetIndex], _buffer))
+		glBindBuffer(_target, _buffer);
+}
+
+void GLState::BindBufferBase(GLenum _target, GLuint _index, GLuint _buffer)
+{
+	int targetIndex = GetIndexedTargetIndex(_target);
+	if (targetIndex < 0 || _index >= MaxIndexedBindings)
+	{
+		m_FrameStats.Calls++;
+		glBindBufferBase(_target, _index, _buffer);
+		if (GetBufferTargetIndex(_target) >= 0)
+			m_Buffers[GetBufferTargetIndex(_target)] = _buffer;
+		return;
+	}
+
+	// Binding to an index also binds to the generic target
+	if (BindingChanged(m_IndexedBuffers[targetIndex][_index], _buffer))
+	{
+		glBindBufferBase(_target, _index, _buffer);
+		m_Buffers[GetBufferTargetIndex(_target)] = _buffer;
+	}
+}
+
+void GLState::DeleteTextures(GLsizei _count, const GLuint* _textures)
+{
+	for (GLsizei i = 0; i < _count; i++)
+	{
+		for (auto& unit : m_Textures)
+		{
+			for (auto& texture : unit)
+			{
+				if (texture == _textures[i])
+					texture = UnknownBinding;
+			}
+		}
+	}
+	glDeleteTextures(_count, _textures);
+}
+
+void GLState::DeleteBuffers(GLsizei _count, const GLuint* _buffers)
+{
+	for (GLsizei i = 0; i < _count; i++)
+	{
+		for (auto& buffer : m_Buffers)
+		{
+			if (buffer == _buffers[i])
+				buffer = UnknownBinding;
+		}
+		for (auto& target : m_IndexedBuffers)
+		{
+			for (auto& buffer : target)
+			{
+				if (buffer == _buffers[i])
+					buffer = UnknownBinding;
+			}
+		}
+	}
+	glDeleteBuffers(_count, _buffers);
+}
+
+void GLState::DeleteVertexArrays(GLsizei _count, const GLuint* _vertexArrays)
+{
+	for (GLsizei i = 0; i < _count; i++)
+	{
+		if (m_VertexArray == _vertexArrays[i])
+			m_VertexArray = UnknownBinding;
+	}
+	glDeleteVertexArrays(_count, _vertexArrays);
+}
+
+void GLState::DeleteProgram(GLuint _program)
+{
+	if (m_Program == _program)
+		m_Program = UnknownBinding;
+	glDeleteProgram(_program);
+}
+
+void GLState::BeginFrame()
+{
+	m_LastFrameStats = m_FrameStats;
+	m_FrameStats = {};
+}
+
+GLStateStats GLState::GetStats()
+{
+	return m_LastFrameStats;
+}
+
+int GLState::GetTextureTargetIndex(GLenum _target)
+{
+	switch (_target)
+	{
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_2D_ARRAY: return 1;
+	case GL_TEXTURE_CUBE_MAP: return 2;
+	default: return -1;
+	}
+}
+
+int GLState::GetBufferTargetIndex(GLenum _target)
+{
+	switch (_target)
+	{
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_COPY_READ_BUFFER: return 1;
+	case GL_COPY_WRITE_BUFFER: return 2;
+	case GL_UNIFORM_BUFFER: return 3;
+	case GL_SHADER_STORAGE_BUFFER: return 4;
+	case GL_DRAW_INDIRECT_BUFFER: return 5;
+	case GL_PARAMETER_BUFFER: return 6;
+	case GL_PIXEL_UNPACK_BUFFER: return 7;
+	case GL_PIXEL_PACK_BUFFER: return 8;
+	case GL_DISPATCH_INDIRECT_BUFFER: return 9;
+	default: return -1;
+	}
+}
+
+int GLState::GetIndexedTargetIndex(GLenum _target)
+{
+	switch (_target)
+	{
+	case GL_UNIFORM_BUFFER: return 0;
+	case GL_SHADER_STORAGE_BUFFER: return 1;
+	default: return -1;
+	}
+}
+
+bool GLState::ShouldApply(bool _differs)
+{
+	if (m_IsKnown && !_differs)
+	{
+		m_FrameStats.Skipped++;
+		return false;
+	}
+	m_FrameStats.Calls++;
+	return true;
+}
+
+bool GLState::BindingChanged(GLuint& _cached, GLuint _value)
+{
+	if (_cached == _value)
+	{
+		m_FrameStats.Skipped++;
+		return false;
+	}
+	_cached = _value;
+	m_FrameStats.Calls++;
+	return true;
+}
+
+void GLState::SetCapability(GLenum _capability, bool& _cached, bool _enabled)
+{
+	if (!ShouldApply(_cached != _enabled))
+		return;
+
+	if (_enabled)
+		glEnable(_capability);
+	else
+		glDisable(_capability);
+}
@@ -0,0 +1,231 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : GLState.h 
+// Description : GLState Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+struct BlendState
+{
+	bool Enabled = true;
+	GLenum Source = GL_SRC_ALPHA;
+	GLenum Destination = GL_ONE_MINUS_SRC_ALPHA;
+};
+
+struct DepthState
+{
+	bool TestEnabled = true;
+	bool WriteEnabled = true;
+	GLenum Function = GL_LESS;
+};
+
+struct StencilState
+{
+	bool TestEnabled = true;
+	GLenum Function = GL_ALWAYS;
+	GLint Reference = 0;
+	GLuint ReadMask = 0xFF;
+	GLuint WriteMask = 0xFF;
+	GLenum StencilFail = GL_KEEP;
+	GLenum DepthFail = GL_KEEP;
+	GLenum DepthPass = GL_KEEP;
+};
+
+struct RasterState
+{
+	bool CullEnabled = false;
+	GLenum CullFace = GL_BACK;
+	bool PolygonOffsetEnabled = false;
+	float PolygonOffsetFactor = 0.0f;
+	float PolygonOffsetUnits = 0.0f;
+};
+
+/// <summary>
+/// The fixed function state a pass draws with, the defaults are the state set up at startup.
+/// </summary>
+struct PipelineState
+{
+	BlendState Blend{};
+	DepthState Depth{};
+	StencilState Stencil{};
+	RasterState Raster{};
+};
+
+/// <summary>
+/// GL calls made and calls skipped because the context already had that state.
+/// </summary>
+struct GLStateStats
+{
+	int Calls = 0;
+	int Skipped = 0;
+};
+
+/// <summary>
+/// Shadow copy of the GL context state so only the differences between consecutive draws reach the driver.
+/// Pipeline state, the program, the vertex array, texture units and buffer bindings all go through here,
+/// bound objects are left bound rather than unbound after each draw.
+/// Anything that changes tracked state behind its back must call Invalidate.
+/// </summary>
+class GLState
+{
+public:
+	/// <summary>
+	/// Forgets everything and applies the default pipeline, call once the context is created.
+	/// </summary>
+	static void Reset();
+
+	/// <summary>
+	/// Forgets the cached state so the next call of each kind reaches GL.
+	/// </summary>
+	static void Invalidate();
+
+	/// <summary>
+	/// Applies the parts of a pipeline state that differ from the current one.
+	/// </summary>
+	/// <param name="_state"></param>
+	static void SetPipeline(const PipelineState& _state);
+
+	/// <summary>
+	/// Applies a pipeline state and uses a program.
+	/// </summary>
+	/// <param name="_state"></param>
+	/// <param name="_program"></param>
+	static void SetPipeline(const PipelineState& _state, GLuint _program);
+
+	/// <summary>
+	/// Clears the given buffers of the bound framebuffer, enabling the write masks the clear needs first.
+	/// </summary>
+	/// <param name="_mask"></param>
+	static void Clear(GLbitfield _mask);
+
+	static void UseProgram(GLuint _program);
+
+	/// <summary>
+	/// Returns the program in use without querying GL, 0 if it is not known.
+	/// </summary>
+	/// <returns></returns>
+	static GLuint GetProgram();
+
+	static void BindVertexArray(GLuint _vertexArray);
+	static void ActiveTexture(GLenum _unit);
+
+	/// <summary>
+	/// Binds a texture to the active texture unit.
+	/// </summary>
+	/// <param name="_target"></param>
+	/// <param name="_texture"></param>
+	static void BindTexture(GLenum _target, GLuint _texture);
+
+	/// <summary>
+	/// Binds a texture to a texture unit, making it the active unit.
+	/// </summary>
+	/// <param name="_unit"> Index of the unit, not GL_TEXTURE0 + index </param>
+	/// <param name="_target"></param>
+	/// <param name="_texture"></param>
+	static void BindTexture(GLuint _unit, GLenum _target, GLuint _texture);
+
+	static void BindBuffer(GLenum _target, GLuint _buffer);
+	static void BindBufferBase(GLenum _target, GLuint _index, GLuint _buffer);
+
+	/// <summary>
+	/// Deletes textures and forgets any unit they were bound to, their names may be reused.
+	/// </summary>
+	/// <param name="_count"></param>
+	/// <param name="_textures"></param>
+	static void DeleteTextures(GLsizei _count, const GLuint* _textures);
+
+	/// <summary>
+	/// Deletes buffers and forgets any binding they had.
+	/// </summary>
+	/// <param name="_count"></param>
+	/// <param name="_buffers"></param>
+	static void DeleteBuffers(GLsizei _count, const GLuint* _buffers);
+
+	/// <summary>
+	/// Deletes vertex arrays and forgets the bound one if it was deleted.
+	/// </summary>
+	/// <param name="_count"></param>
+	/// <param name="_vertexArrays"></param>
+	static void DeleteVertexArrays(GLsizei _count, const GLuint* _vertexArrays);
+
+	/// <summary>
+	/// Deletes a program and forgets it if it was in use.
+	/// </summary>
+	/// <param name="_program"></param>
+	static void DeleteProgram(GLuint _program);
+
+	/// <summary>
+	/// Starts counting GL calls for a new frame.
+	/// </summary>
+	static void BeginFrame();
+
+	/// <summary>
+	/// Returns the GL calls made and skipped last frame.
+	/// </summary>
+	/// <returns></returns>
+	static GLStateStats GetStats();
+
+	static const int MaxTextureUnits = 32;
+	static const int MaxIndexedBindings = 16;
+
+private:
+	/// <summary>
+	/// Returns the index of a texture target in the per unit table, or -1 if it is not tracked.
+	/// </summary>
+	/// <param name="_target"></param>
+	/// <returns></returns>
+	static int GetTextureTargetIndex(GLenum _target);
+
+	/// <summary>
+	/// Returns the index of a buffer target in the binding table, or -1 if it is not tracked.
+	/// Element array bindings belong to the vertex array so they are never tracked.
+	/// </summary>
+	/// <param name="_target"></param>
+	/// <returns></returns>
+	static int GetBufferTargetIndex(GLenum _target);
+
+	/// <summary>
+	/// Returns the index of an indexed buffer target, or -1 if it is not tracked.
+	/// </summary>
+	/// <param name="_target"></param>
+	/// <returns></returns>
+	static int GetIndexedTargetIndex(GLenum _target);
+
+	/// <summary>
+	/// Counts a call and returns true if it has to reach GL, everything does while the pipeline is unknown.
+	/// </summary>
+	/// <param name="_differs"></param>
+	/// <returns></returns>
+	static bool ShouldApply(bool _differs);
+
+	/// <summary>
+	/// Counts a binding call and returns true if it has to reach GL, storing the new binding.
+	/// </summary>
+	/// <param name="_cached"></param>
+	/// <param name="_value"></param>
+	/// <returns></returns>
+	static bool BindingChanged(GLuint& _cached, GLuint _value);
+
+	static void SetCapability(GLenum _capability, bool& _cached, bool _enabled);
+
+	static const GLuint UnknownBinding = 0xFFFFFFFF;
+
+	inline static PipelineState m_Pipeline{};
+	inline static bool m_IsKnown{ false };
+
+	inline static GLuint m_Program{ UnknownBinding };
+	inline static GLuint m_VertexArray{ UnknownBinding };
+	inline static GLuint m_ActiveTexture{ UnknownBinding };
+	inline static GLuint m_Textures[MaxTextureUnits][3]{};
+	inline static GLuint m_Buffers[10]{};
+	inline static GLuint m_IndexedBuffers[2][MaxIndexedBindings]{};
+
+	inline static GLStateStats m_FrameStats{};
+	inline static GLStateStats m_LastFrameStats{};
+};
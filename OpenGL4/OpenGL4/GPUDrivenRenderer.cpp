@@ -0,0 +1,339 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : GPUDrivenRenderer.cpp 
+// Description : GPUDrivenRenderer Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "GPUDrivenRenderer.h"
+#include "GLState.h"
+#include "TextureLoader.h"
+
+namespace
+{
+	constexpr StringID FrustumPlaneNames[6]{
+		"FrustumPlanes[0]"_id, "FrustumPlanes[1]"_id, "FrustumPlanes[2]"_id,
+		"FrustumPlanes[3]"_id, "FrustumPlanes[4]"_id, "FrustumPlanes[5]"_id,
+	};
+}
+
+GPUDrivenRenderer::GPUDrivenRenderer(Camera& _camera, glm::ivec2& _screenSize)
+{
+	m_ActiveCamera = &_camera;
+	m_ScreenSize = &_screenSize;
+
+	m_CullShader = new Shader{ { ShaderInfo{GL_COMPUTE_SHADER, "CullInstances.comp"} }, nullptr };
+	m_DepthPyramidShader = new Shader{ { ShaderInfo{GL_COMPUTE_SHADER, "DepthPyramid.comp"} }, nullptr };
+	m_CellShadingShader = new Shader{
+		{
+			ShaderInfo{GL_VERTEX_SHADER, "Normals3D_Indirect.vert"},
+			ShaderInfo{GL_FRAGMENT_SHADER, "BlinnFong3D_CelShaded.frag"},
+		}
+	, nullptr };
+	m_ToonOutlineShader = new Shader{
+		{
+			ShaderInfo{GL_VERTEX_SHADER, "Normals3D_Indirect.vert"},
+			ShaderInfo{GL_FRAGMENT_SHADER, "UnlitColor.frag"},
+		}
+	, nullptr, { "OUTLINE" } };
+
+	glGenBuffers(1, &m_InstanceBufferID);
+	glGenBuffers(1, &m_InstanceDrawBufferID);
+	glGenBuffers(1, &m_CommandBufferID);
+	glGenBuffers(1, &m_DrawCountBufferID);
+}
+
+GPUDrivenRenderer::~GPUDrivenRenderer()
+{
+	DestroyDepthPyramid();
+
+	GLState::DeleteBuffers(1, &m_InstanceBufferID);
+	GLState::DeleteBuffers(1, &m_InstanceDrawBufferID);
+	GLState::DeleteBuffers(1, &m_CommandBufferID);
+	GLState::DeleteBuffers(1, &m_DrawCountBufferID);
+
+	for (Shader* shader : { m_CullShader, m_DepthPyramidShader, m_CellShadingShader, m_ToonOutlineShader })
+	{
+		GLState::DeleteProgram(shader->ID);
+		delete shader;
+	}
+	m_CullShader = nullptr;
+	m_DepthPyramidShader = nullptr;
+	m_CellShadingShader = nullptr;
+	m_ToonOutlineShader = nullptr;
+
+	m_ActiveCamera = nullptr;
+	m_ScreenSize = nullptr;
+}
+
+void GPUDrivenRenderer::Draw(const std::vector<GameObject*>& _gameObjects)
+{
+	BuildInstances(_gameObjects);
+	m_DrawCallCount = 0;
+	if (m_Instances.size() == 0)
+		return;
+
+	UploadBuffers();
+	DispatchCulling();
+
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBufferID);
+	GLState::BindBuffer(GL_PARAMETER_BUFFER, m_DrawCountBufferID);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_InstanceBufferID);
+
+	// Cel shading pass, writes to the stencil buffer
+	GLState::SetPipeline(GameObject::SurfacePipeline);
+	m_CellShadingShader->Bind();
+	ShaderLoader::SetUniform1f(std::move(m_CellShadingShader->ID), "Shininess"_id, 32.0f * 5);
+	DrawGroups(*m_CellShadingShader, true);
+	m_CellShadingShader->UnBind();
+
+	// Toon outline pass, only where the cel shading pass did not draw
+	GLState::SetPipeline(GameObject::OutlinePipeline);
+	m_ToonOutlineShader->Bind();
+	ShaderLoader::SetUniform1f(std::move(m_ToonOutlineShader->ID), "OutlineWidth"_id, 0.2f);
+	ShaderLoader::SetUniform3fv(std::move(m_ToonOutlineShader->ID), "Color"_id, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	DrawGroups(*m_ToonOutlineShader, false);
+	m_ToonOutlineShader->UnBind();
+
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	GLState::BindBuffer(GL_PARAMETER_BUFFER, 0);
+}
+
+void GPUDrivenRenderer::CaptureDepth()
+{
+	if (m_DepthSize != *m_ScreenSize)
+		CreateDepthPyramid();
+
+	// Copy the default framebuffers depth so it can be sampled
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebufferID);
+	glBlitFramebuffer(0, 0, m_DepthSize.x, m_DepthSize.y, 0, 0, m_DepthSize.x, m_DepthSize.y, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// Reduce each level into the next keeping the furthest depth
+	GLState::UseProgram(m_DepthPyramidShader->ID);
+	ShaderLoader::SetUniform1i(std::move(m_DepthPyramidShader->ID), "SourceDepth"_id, 0);
+	glm::ivec2 levelSize = m_DepthPyramidSize;
+	for (int level = 0; level < m_DepthPyramidLevels; level++)
+	{
+		GLState::BindTexture(0, GL_TEXTURE_2D, level == 0 ? m_DepthTextureID : m_DepthPyramidID);
+		ShaderLoader::SetUniform1i(std::move(m_DepthPyramidShader->ID), "SourceLevel"_id, level == 0 ? 0 : level - 1);
+		glBindImageTexture(0, m_DepthPyramidID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute((levelSize.x + 7) / 8, (levelSize.y + 7) / 8, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		levelSize = glm::max(levelSize / 2, glm::ivec2{ 1, 1 });
+	}
+
+	// The pyramid is used to cull next frame, so keep the matrix it was rendered with
+	m_PreviousPVMatrix = m_ActiveCamera->GetPVMatrix();
+	m_HasDepthPyramid = true;
+}
+
+void GPUDrivenRenderer::SetHiZCulling(bool _isEnabled)
+{
+	m_IsHiZCullingEnabled = _isEnabled;
+}
+
+bool GPUDrivenRenderer::GetHiZCulling()
+{
+	return m_IsHiZCullingEnabled;
+}
+
+int GPUDrivenRenderer::GetInstanceCount()
+{
+	return (int)m_Instances.size();
+}
+
+int GPUDrivenRenderer::GetDrawCallCount()
+{
+	return m_DrawCallCount;
+}
+
+void GPUDrivenRenderer::BuildInstances(const std::vector<GameObject*>& _gameObjects)
+{
+	m_Instances.clear();
+	m_InstanceDraws.clear();
+	m_Groups.clear();
+	m_GroupLookup.clear();
+
+	for (auto& gameObject : _gameObjects)
+	{
+		Mesh* mesh = gameObject->GetMesh();
+		if (!mesh)
+			continue;
+
+		std::vector<TextureHandle> textures = gameObject->GetActiveTextures();
+		GLuint textureID = textures.size() > 0 ? TextureLoader::GetID(textures[0]) : 0;
+		const glm::mat4& modelMatrix = gameObject->m_Transform.transform;
+		glm::mat4 normalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(modelMatrix))));
+
+		// Models are drawn through their sub meshes, primitives through themselves
+		std::vector<Mesh*> leaves = mesh->GetSubMeshes();
+		if (leaves.size() == 0)
+			leaves.push_back(mesh);
+
+		for (auto& leaf : leaves)
+		{
+			GeometryRange range = leaf->GetGeometryRange();
+			if (range.IndexCount == 0)
+				continue;
+
+			auto group = m_GroupLookup.try_emplace({ leaf->GetVertexArrayID(), textureID }, (GLuint)m_Groups.size());
+			if (group.second)
+				m_Groups.push_back({ leaf->GetVertexArrayID(), textureID, 0, 0 });
+			m_Groups[group.first->second].MaxDrawCount++;
+
+			AABB bounds = TransformAABB(leaf->GetLocalBounds(), modelMatrix);
+			m_Instances.push_back({ modelMatrix, normalMatrix, glm::vec4{ bounds.Min, 1.0f }, glm::vec4{ bounds.Max, 1.0f } });
+			m_InstanceDraws.push_back({ (GLuint)range.IndexCount, range.FirstIndex, range.BaseVertex, group.first->second, 0 });
+		}
+	}
+
+	// Each group gets a contiguous range of command slots, one per instance in the worst case
+	GLuint commandOffset = 0;
+	for (auto& group : m_Groups)
+	{
+		group.CommandOffset = commandOffset;
+		commandOffset += group.MaxDrawCount;
+	}
+	for (auto& draw : m_InstanceDraws)
+	{
+		draw.CommandOffset = m_Groups[draw.GroupIndex].CommandOffset;
+	}
+}
+
+void GPUDrivenRenderer::UploadBuffers()
+{
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_InstanceBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_Instances.size() * sizeof(GPUInstance), m_Instances.data(), GL_DYNAMIC_DRAW);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_InstanceDrawBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_InstanceDraws.size() * sizeof(GPUInstanceDraw), m_InstanceDraws.data(), GL_DYNAMIC_DRAW);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_CommandBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_Instances.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+
+	// Counts start at zero and are incremented by the culling shader
+	std::vector<GLuint> drawCounts(m_Groups.size(), 0);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_DrawCountBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, drawCounts.size() * sizeof(GLuint), drawCounts.data(), GL_DYNAMIC_DRAW);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GPUDrivenRenderer::DispatchCulling()
+{
+	GLState::UseProgram(m_CullShader->ID);
+	ShaderLoader::SetUniform1i(std::move(m_CullShader->ID), "InstanceCount"_id, (GLint)m_Instances.size());
+
+	Frustum frustum = m_ActiveCamera->GetFrustum();
+	for (int i = 0; i < 6; i++)
+	{
+		ShaderLoader::SetUniform4fv(std::move(m_CullShader->ID), FrustumPlaneNames[i], frustum.Planes[i]);
+	}
+
+	bool useHiZ = m_IsHiZCullingEnabled && m_HasDepthPyramid;
+	ShaderLoader::SetUniform1i(std::move(m_CullShader->ID), "UseHiZ"_id, useHiZ);
+	if (useHiZ)
+	{
+		ShaderLoader::SetUniformMatrix4fv(std::move(m_CullShader->ID), "PreviousPVMatrix"_id, m_PreviousPVMatrix);
+		ShaderLoader::SetUniform1i(std::move(m_CullShader->ID), "HiZLevels"_id, m_DepthPyramidLevels);
+		ShaderLoader::SetUniform1i(std::move(m_CullShader->ID), "HiZ"_id, 0);
+		GLState::BindTexture(0, GL_TEXTURE_2D, m_DepthPyramidID);
+	}
+
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_InstanceBufferID);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_InstanceDrawBufferID);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_CommandBufferID);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_DrawCountBufferID);
+
+	glDispatchCompute(((GLuint)m_Instances.size() + 63) / 64, 1, 1);
+
+	// Commands and counts are consumed as indirect arguments, the instances by the vertex shaders
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GPUDrivenRenderer::DrawGroups(Shader& _shader, bool _isTextured)
+{
+	GLuint boundProgram = _shader.ID;
+	for (unsigned i = 0; i < m_Groups.size(); i++)
+	{
+		GPUDrawGroup& group = m_Groups[i];
+
+		if (_isTextured)
+		{
+			// Textured groups draw with the HAS_TEXTURE permutation
+			GLuint program = group.TextureID != 0 ? _shader.GetVariant(1, []() { return std::vector<std::string>{ "HAS_TEXTURE" }; }) : _shader.ID;
+			if (program != boundProgram)
+			{
+				GLState::UseProgram(program);
+				ShaderLoader::SetUniform1f(std::move(program), "Shininess"_id, 32.0f * 5);
+				boundProgram = program;
+			}
+			GLState::BindTexture(0, GL_TEXTURE_2D, group.TextureID);
+			ShaderLoader::SetUniform1i(std::move(program), "ImageTexture0"_id, 0);
+		}
+
+		GLState::BindVertexArray(group.VertexArrayID);
+		glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(const void*)(group.CommandOffset * sizeof(DrawElementsIndirectCommand)),
+			(GLintptr)(i * sizeof(GLuint)),
+			(GLsizei)group.MaxDrawCount, sizeof(DrawElementsIndirectCommand));
+		m_DrawCallCount++;
+	}
+}
+
+void GPUDrivenRenderer::CreateDepthPyramid()
+{
+	DestroyDepthPyramid();
+	m_DepthSize = *m_ScreenSize;
+
+	// Same format as the default framebuffer so it can be blit
+	glGenTextures(1, &m_DepthTextureID);
+	GLState::BindTexture(GL_TEXTURE_2D, m_DepthTextureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, m_DepthSize.x, m_DepthSize.y, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenFramebuffers(1, &m_DepthFramebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_DepthFramebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_DepthTextureID, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		Print("Depth pyramid framebuffer is incomplete");
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// The first level is half the screen, each level after halves again down to 1x1
+	m_DepthPyramidSize = glm::max(m_DepthSize / 2, glm::ivec2{ 1, 1 });
+	m_DepthPyramidLevels = (int)std::floor(std::log2((float)std::max(m_DepthPyramidSize.x, m_DepthPyramidSize.y))) + 1;
+
+	glGenTextures(1, &m_DepthPyramidID);
+	GLState::BindTexture(GL_TEXTURE_2D, m_DepthPyramidID);
+	glTexStorage2D(GL_TEXTURE_2D, m_DepthPyramidLevels, GL_R32F, m_DepthPyramidSize.x, m_DepthPyramidSize.y);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+	m_HasDepthPyramid = false;
+}
+
+void GPUDrivenRenderer::DestroyDepthPyramid()
+{
+	if (m_DepthFramebufferID)
+		glDeleteFramebuffers(1, &m_DepthFramebufferID);
+	if (m_DepthTextureID)
+		GLState::DeleteTextures(1, &m_DepthTextureID);
+	if (m_DepthPyramidID)
+		GLState::DeleteTextures(1, &m_DepthPyramidID);
+
+	m_DepthFramebufferID = 0;
+	m_DepthTextureID = 0;
+	m_DepthPyramidID = 0;
+	m_HasDepthPyramid = false;
+}
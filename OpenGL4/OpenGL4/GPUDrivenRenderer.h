@@ -0,0 +1,201 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : GPUDrivenRenderer.h 
+// Description : GPUDrivenRenderer Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "GameObject.h"
+
+/// <summary>
+/// Per instance data read by the culling compute shader and the indirect vertex shaders.
+/// Matches the std430 Instance struct in CullInstances.comp.
+/// </summary>
+struct GPUInstance
+{
+	glm::mat4 ModelMatrix{ 1 };
+	glm::mat4 NormalMatrix{ 1 };
+	glm::vec4 BoundsMin{};
+	glm::vec4 BoundsMax{};
+};
+
+using GPUInstanceLayout = BufferLayout<LayoutStandard::Std430, glm::mat4, glm::mat4, glm::vec4, glm::vec4>;
+
+static_assert(GPUInstanceLayout::Matches<GPUInstance>({ offsetof(GPUInstance, ModelMatrix), offsetof(GPUInstance, NormalMatrix),
+	offsetof(GPUInstance, BoundsMin), offsetof(GPUInstance, BoundsMax) }), "GPUInstance does not match the std430 Instance struct");
+
+/// <summary>
+/// The draw an instance appends if it survives culling.
+/// Matches the std430 InstanceDraw struct in CullInstances.comp.
+/// </summary>
+struct GPUInstanceDraw
+{
+	GLuint IndexCount{ 0 };
+	GLuint FirstIndex{ 0 };
+	GLint BaseVertex{ 0 };
+	GLuint GroupIndex{ 0 };
+	GLuint CommandOffset{ 0 };
+};
+
+using GPUInstanceDrawLayout = BufferLayout<LayoutStandard::Std430, GLuint, GLuint, GLint, GLuint, GLuint>;
+
+static_assert(GPUInstanceDrawLayout::Matches<GPUInstanceDraw>({ offsetof(GPUInstanceDraw, IndexCount), offsetof(GPUInstanceDraw, FirstIndex),
+	offsetof(GPUInstanceDraw, BaseVertex), offsetof(GPUInstanceDraw, GroupIndex), offsetof(GPUInstanceDraw, CommandOffset) }), "GPUInstanceDraw does not match the std430 InstanceDraw struct");
+
+/// <summary>
+/// Layout of a single glMultiDrawElementsIndirect command.
+/// Matches the std430 DrawCommand struct in CullInstances.comp.
+/// </summary>
+struct DrawElementsIndirectCommand
+{
+	GLuint Count{ 0 };
+	GLuint InstanceCount{ 0 };
+	GLuint FirstIndex{ 0 };
+	GLint BaseVertex{ 0 };
+	GLuint BaseInstance{ 0 };
+};
+
+using DrawElementsIndirectCommandLayout = BufferLayout<LayoutStandard::Std430, GLuint, GLuint, GLuint, GLint, GLuint>;
+
+static_assert(DrawElementsIndirectCommandLayout::Matches<DrawElementsIndirectCommand>({ offsetof(DrawElementsIndirectCommand, Count),
+	offsetof(DrawElementsIndirectCommand, InstanceCount), offsetof(DrawElementsIndirectCommand, FirstIndex), offsetof(DrawElementsIndirectCommand, BaseVertex),
+	offsetof(DrawElementsIndirectCommand, BaseInstance) }), "DrawElementsIndirectCommand does not match the std430 DrawCommand struct");
+
+/// <summary>
+/// Instances that share a vertex array and texture and so can be submitted with one multi draw.
+/// Every mesh lives in the GeometryArena so in practice there is one group per texture.
+/// </summary>
+struct GPUDrawGroup
+{
+	GLuint VertexArrayID{ 0 };
+	GLuint TextureID{ 0 };
+	GLuint CommandOffset{ 0 };
+	GLuint MaxDrawCount{ 0 };
+};
+
+/// <summary>
+/// GPU driven renderer for the cel shaded gameobjects.
+/// Every frame the instances are uploaded to shader storage buffers and a compute shader frustum culls them,
+/// then occlusion culls them against a max depth pyramid built from the previous frames depth buffer.
+/// Survivors are compacted into indirect draw commands and submitted with glMultiDrawElementsIndirectCount,
+/// so the CPU never reads back the visibility results.
+/// </summary>
+class GPUDrivenRenderer
+{
+public:
+	/// <summary>
+	/// GPUDrivenRenderer Constructor
+	/// </summary>
+	/// <param name="_camera"></param>
+	/// <param name="_screenSize"></param>
+	GPUDrivenRenderer(Camera& _camera, glm::ivec2& _screenSize);
+
+	/// <summary>
+	/// GPUDrivenRenderer Destructor
+	/// </summary>
+	~GPUDrivenRenderer();
+
+	/// <summary>
+	/// Culls and draws the given gameobjects with their cel shading and toon outline passes.
+	/// </summary>
+	/// <param name="_gameObjects"></param>
+	void Draw(const std::vector<GameObject*>& _gameObjects);
+
+	/// <summary>
+	/// Copies the depth buffer of the default framebuffer and builds the depth pyramid used to cull the next frame.
+	/// Should be called once the scene has been drawn.
+	/// </summary>
+	void CaptureDepth();
+
+	/// <summary>
+	/// Sets whether instances are occlusion culled against the previous frames depth pyramid.
+	/// </summary>
+	/// <param name="_isEnabled"></param>
+	void SetHiZCulling(bool _isEnabled);
+
+	/// <summary>
+	/// Returns true if instances are occlusion culled against the previous frames depth pyramid.
+	/// </summary>
+	/// <returns></returns>
+	bool GetHiZCulling();
+
+	/// <summary>
+	/// Returns the number of instances submitted to the culling shader last frame.
+	/// </summary>
+	/// <returns></returns>
+	int GetInstanceCount();
+
+	/// <summary>
+	/// Returns the number of multi draw calls issued last frame.
+	/// </summary>
+	/// <returns></returns>
+	int GetDrawCallCount();
+
+private:
+	/// <summary>
+	/// Fills the instance, draw and group arrays from the gameobjects.
+	/// </summary>
+	/// <param name="_gameObjects"></param>
+	void BuildInstances(const std::vector<GameObject*>& _gameObjects);
+
+	/// <summary>
+	/// Uploads the instances and resets the draw counts.
+	/// </summary>
+	void UploadBuffers();
+
+	/// <summary>
+	/// Dispatches the culling compute shader which writes the draw commands and counts.
+	/// </summary>
+	void DispatchCulling();
+
+	/// <summary>
+	/// Issues one multi draw per group with the bound program, textured groups switch to its HAS_TEXTURE permutation.
+	/// </summary>
+	/// <param name="_shader"></param>
+	/// <param name="_isTextured"></param>
+	void DrawGroups(Shader& _shader, bool _isTextured);
+
+	/// <summary>
+	/// (Re)creates the depth copy and depth pyramid textures for the current screen size.
+	/// </summary>
+	void CreateDepthPyramid();
+
+	/// <summary>
+	/// Deletes the depth copy and depth pyramid textures.
+	/// </summary>
+	void DestroyDepthPyramid();
+
+	Camera* m_ActiveCamera{ nullptr };
+	glm::ivec2* m_ScreenSize{ nullptr };
+
+	Shader* m_CullShader{ nullptr };
+	Shader* m_DepthPyramidShader{ nullptr };
+	Shader* m_CellShadingShader{ nullptr };
+	Shader* m_ToonOutlineShader{ nullptr };
+
+	GLuint m_InstanceBufferID{ 0 };
+	GLuint m_InstanceDrawBufferID{ 0 };
+	GLuint m_CommandBufferID{ 0 };
+	GLuint m_DrawCountBufferID{ 0 };
+
+	std::vector<GPUInstance> m_Instances{};
+	std::vector<GPUInstanceDraw> m_InstanceDraws{};
+	std::vector<GPUDrawGroup> m_Groups{};
+	std::map<std::pair<GLuint, GLuint>, GLuint> m_GroupLookup{};
+
+	GLuint m_DepthFramebufferID{ 0 };
+	GLuint m_DepthTextureID{ 0 };
+	GLuint m_DepthPyramidID{ 0 };
+	glm::ivec2 m_DepthSize{ 0, 0 };
+	glm::ivec2 m_DepthPyramidSize{ 0, 0 };
+	int m_DepthPyramidLevels{ 0 };
+	bool m_HasDepthPyramid{ false };
+	glm::mat4 m_PreviousPVMatrix{ 1 };
+
+	bool m_IsHiZCullingEnabled{ true };
+	int m_DrawCallCount{ 0 };
+};
@@ -9,6 +9,8 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "GameObject.h"
+#include "GLState.h"
+#include "TextureLoader.h"
 
 GameObject::GameObject(Camera& _camera, glm::vec3 _position)
 {
@@ -16,11 +18,11 @@ GameObject::GameObject(Camera& _camera, glm::vec3 _position)
     // Set starting position
     SetTranslation(_position);
 
-    StaticShader::Shaders["CellShading"]->UniformsFunction = [this]()
+    StaticShader::Shaders["CellShading"_id]->UniformsFunction = [this]()
     {
         SetCellShadingUniforms();
     };
-    StaticShader::Shaders["ToonOutline"]->UniformsFunction = [this]()
+    StaticShader::Shaders["ToonOutline"_id]->UniformsFunction = [this]()
     {
         SetToonOutlineUniforms();
     };
@@ -29,9 +31,27 @@ GameObject::GameObject(Camera& _camera, glm::vec3 _position)
 
 GameObject::~GameObject()
 {
+    if (m_IsStatic)
+        m_StaticVersion++;
+
+    if (m_SceneTree)
+    {
+        m_SceneTree->DestroyProxy(m_SceneProxyID);
+        m_SceneTree = nullptr;
+    }
+
     if (m_Mesh)
         m_Mesh = nullptr;
 
+    if (m_OccluderMesh)
+        m_OccluderMesh = nullptr;
+
+    for (auto& texture : m_ActiveTextures)
+    {
+        TextureLoader::Release(texture);
+    }
+    TextureLoader::Release(m_SkyboxTexture);
+
     if (m_ActiveCamera)
         m_ActiveCamera = nullptr;
 
@@ -111,34 +131,48 @@ void GameObject::Draw()
         
         //Bind normal Shader
         //Write to StencilBuffer
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-        glStencilMask(0xFF);
+        GLState::SetPipeline(SurfacePipeline);
+        m_Shaders[0].SelectVariant(GatherObjectLights(), [this]() { return GetCellShadingDefines(); });
         m_Shaders[0].Bind();
         // Draw the mesh
         m_Mesh->Draw();
         m_Shaders[0].UnBind();
 
-        glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-        glStencilMask(0x00);
-        glDisable(GL_DEPTH_TEST);
-        //Bind Second Shader / Single Color Shader
-        m_Shaders[1].Bind();
+        DrawOutline();
+    }
+}
 
-        m_Mesh->Draw();
-        glStencilMask(0xFF);
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-        glEnable(GL_DEPTH_TEST);
-        m_Shaders[1].UnBind();
+void GameObject::DrawGBuffer(Shader& _gBufferShader)
+{
+    if (!m_Mesh)
+        return;
+
+    // Same stencil marking as the forward pass, without blending so albedo alpha does not mix normals
+    PipelineState gBufferPipeline = SurfacePipeline;
+    gBufferPipeline.Blend.Enabled = false;
+    GLuint program = _gBufferShader.GetVariant(GetSurfaceVariantKey(), [this]() { return GetSurfaceDefines(); });
+    GLState::SetPipeline(gBufferPipeline, program);
+    SetSurfaceUniforms(program);
+    m_Mesh->Draw();
+}
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-    }
+void GameObject::DrawOutline()
+{
+    if (!m_Mesh)
+        return;
+
+    //Bind Second Shader / Single Color Shader
+    GLState::SetPipeline(OutlinePipeline);
+    m_Shaders[1].Bind();
+
+    m_Mesh->Draw();
+    m_Shaders[1].UnBind();
 }
 
 void GameObject::SetMesh(Mesh* _mesh)
 {
     m_Mesh = _mesh;
+    UpdateSceneProxy();
 }
 
 Mesh* GameObject::GetMesh()
@@ -151,14 +185,17 @@ Mesh* GameObject::GetMesh()
 
 void GameObject::SetTranslation(glm::vec3 _newPosition)
 {
+    glm::vec3 displacement = _newPosition - m_Transform.translation;
     m_Transform.translation = _newPosition;
     UpdateModelValueOfTransform(m_Transform);
+    UpdateSceneProxy(displacement);
 }
 
 void GameObject::Translate(glm::vec3 _translation)
 {
     m_Transform.translation += _translation;
     UpdateModelValueOfTransform(m_Transform);
+    UpdateSceneProxy(_translation);
 }
 
 void GameObject::SetRotation(glm::vec3 _axis, float _degrees)
@@ -166,6 +203,7 @@ void GameObject::SetRotation(glm::vec3 _axis, float _degrees)
     m_Transform.rotation_axis = _axis;
     m_Transform.rotation_value = glm::radians(_degrees);
     UpdateModelValueOfTransform(m_Transform);
+    UpdateSceneProxy();
 }
 
 void GameObject::Rotate(glm::vec3 _axis, float _degrees)
@@ -173,18 +211,21 @@ void GameObject::Rotate(glm::vec3 _axis, float _degrees)
     m_Transform.rotation_axis = _axis;
     m_Transform.rotation_value += glm::radians(_degrees);
     UpdateModelValueOfTransform(m_Transform);
+    UpdateSceneProxy();
 }
 
 void GameObject::SetScale(glm::vec3 _newScale)
 {
     m_Transform.scale = _newScale;
     UpdateModelValueOfTransform(m_Transform);
+    UpdateSceneProxy();
 }
 
 void GameObject::Scale(glm::vec3 _scaleFactor)
 {
     m_Transform.scale *= _scaleFactor;
     UpdateModelValueOfTransform(m_Transform);
+    UpdateSceneProxy();
 }
 
 void GameObject::RotateAround(glm::vec3&& _position, glm::vec3&& _axis, float&& _degrees)
@@ -197,6 +238,7 @@ void GameObject::RotateAround(glm::vec3&& _position, glm::vec3&& _axis, float&&
     m_Transform.transform = glm::rotate(m_Transform.transform, _degrees, _axis);
     // Translate back
     m_Transform.transform = glm::translate(m_Transform.transform, -direction);
+    UpdateSceneProxy();
 }
 
 void GameObject::SetActiveCamera(Camera& _newCamera)
@@ -212,12 +254,16 @@ Camera* GameObject::GetActiveCamera()
         return nullptr;
 }
 
-void GameObject::SetActiveTextures(std::vector<Texture> _textures)
+void GameObject::SetActiveTextures(std::vector<TextureHandle> _textures)
 {
+    for (auto& texture : m_ActiveTextures)
+    {
+        TextureLoader::Release(texture);
+    }
     m_ActiveTextures = _textures;
 }
 
-std::vector<Texture> GameObject::GetActiveTextures()
+std::vector<TextureHandle> GameObject::GetActiveTextures()
 {
     return m_ActiveTextures;
 }
@@ -242,55 +288,240 @@ void GameObject::SetLightManager(LightManager& _lightManager)
     m_LightManager = &_lightManager;
 }
 
-void GameObject::SetSkyboxTexture(Texture _skyboxTexture)
+void GameObject::SetSkyboxTexture(TextureHandle _skyboxTexture)
 {
+    TextureLoader::Release(m_SkyboxTexture);
     m_SkyboxTexture = _skyboxTexture;
 }
 
+void GameObject::SetSceneTree(AABBTree& _sceneTree)
+{
+    // Remove from the old tree
+    if (m_SceneTree)
+        m_SceneTree->DestroyProxy(m_SceneProxyID);
+
+    m_SceneTree = &_sceneTree;
+    m_SceneProxyID = AABBTree::NullNode;
+    UpdateSceneProxy();
+}
+
+AABB GameObject::GetWorldBounds()
+{
+    if (m_Mesh)
+        return TransformAABB(m_Mesh->GetLocalBounds(), m_Transform.transform);
+
+    return AABB{ m_Transform.translation, m_Transform.translation };
+}
+
+BoundingSphere GameObject::GetWorldSphere()
+{
+    if (m_Mesh)
+        return TransformSphere(m_Mesh->GetLocalSphere(), m_Transform.transform);
+
+    return BoundingSphere{ m_Transform.translation, 0.0f };
+}
+
+void GameObject::SetIsStatic(bool _isStatic)
+{
+    if (m_IsStatic != _isStatic)
+        m_StaticVersion++;
+    m_IsStatic = _isStatic;
+}
+
+bool GameObject::GetIsStatic()
+{
+    return m_IsStatic;
+}
+
+unsigned GameObject::GetStaticVersion()
+{
+    return m_StaticVersion;
+}
+
+void GameObject::SetObjectIndex(int _objectIndex)
+{
+    m_ObjectIndex = _objectIndex;
+}
+
+int GameObject::GetObjectIndex()
+{
+    return m_ObjectIndex;
+}
+
+void GameObject::SetIsTransparent(bool _isTransparent)
+{
+    m_IsTransparent = _isTransparent;
+}
+
+bool GameObject::GetIsTransparent()
+{
+    return m_IsTransparent;
+}
+
+void GameObject::SetIsOccluder(bool _isOccluder)
+{
+    m_IsOccluder = _isOccluder;
+}
+
+bool GameObject::GetIsOccluder()
+{
+    return m_IsOccluder;
+}
+
+void GameObject::SetOccluderMesh(Mesh* _occluderMesh)
+{
+    m_OccluderMesh = _occluderMesh;
+}
+
+Mesh* GameObject::GetOccluderMesh()
+{
+    if (m_OccluderMesh)
+        return m_OccluderMesh;
+
+    return m_Mesh;
+}
+
+int GameObject::GetSceneProxyID()
+{
+    return m_SceneProxyID;
+}
+
+bool GameObject::RayCast(const Ray& _ray, RaycastHit& _hit)
+{
+    if (!m_Mesh)
+        return false;
+
+    // Into local space. The direction is not renormalized so hit distances stay in world units
+    glm::mat4 inverseModel = glm::inverse(m_Transform.transform);
+    Ray localRay{};
+    localRay.Origin = glm::vec3(inverseModel * glm::vec4(_ray.Origin, 1.0f));
+    localRay.Direction = glm::mat3(inverseModel) * _ray.Direction;
+    localRay.MaxDistance = _ray.MaxDistance;
+
+    MeshHit meshHit{};
+    if (!m_Mesh->Intersect(localRay, meshHit))
+        return false;
+
+    _hit.Object = this;
+    _hit.SubMesh = meshHit.SubMesh;
+    _hit.Triangle = meshHit.Triangle;
+    _hit.Barycentrics = meshHit.Barycentrics;
+    _hit.UV = meshHit.UV;
+    _hit.Distance = meshHit.Distance;
+    _hit.Position = _ray.Origin + _ray.Direction * meshHit.Distance;
+    _hit.Normal = glm::normalize(glm::transpose(glm::mat3(inverseModel)) * meshHit.Normal);
+    return true;
+}
+
+void GameObject::BuildBVH()
+{
+    if (m_Mesh)
+        m_Mesh->BuildBVH();
+}
+
+bool GameObject::RayCastScene(const AABBTree& _sceneTree, const Ray& _ray, RaycastHit& _hit)
+{
+    bool isHit = false;
+    _sceneTree.RayCast(_ray, [&](int _proxyID, const Ray& _clippedRay)
+        {
+            GameObject* gameObject = (GameObject*)_sceneTree.GetUserData(_proxyID);
+            RaycastHit hit{};
+            if (gameObject && gameObject->RayCast(_clippedRay, hit))
+            {
+                _hit = hit;
+                isHit = true;
+                // Clip the ray so only closer objects are tested
+                return hit.Distance;
+            }
+            return _clippedRay.MaxDistance;
+        });
+    return isHit;
+}
+
+void GameObject::UpdateSceneProxy(glm::vec3 _displacement)
+{
+    // Anything cached from static gameobjects is now stale
+    if (m_IsStatic)
+        m_StaticVersion++;
+
+    if (!m_SceneTree)
+        return;
+
+    // Only gameobjects with a mesh are renderable
+    if (!m_Mesh)
+    {
+        m_SceneTree->DestroyProxy(m_SceneProxyID);
+        m_SceneProxyID = AABBTree::NullNode;
+        return;
+    }
+
+    if (m_SceneProxyID == AABBTree::NullNode)
+        m_SceneProxyID = m_SceneTree->CreateProxy(GetWorldBounds(), this);
+    else
+        m_SceneTree->MoveProxy(m_SceneProxyID, GetWorldBounds(), _displacement);
+}
+
 void GameObject::SetToonOutlineUniforms()
 {
-    ShaderLoader::SetUniformMatrix4fv(std::move(StaticShader::Shaders["ToonOutline"]->ID), "PVMMatrix", m_ActiveCamera->GetPVMatrix() * m_Transform.transform);
-    ShaderLoader::SetUniformMatrix4fv(std::move(StaticShader::Shaders["ToonOutline"]->ID), "ModelMatrix", m_Transform.transform);
-    ShaderLoader::SetUniform1f(std::move(StaticShader::Shaders["ToonOutline"]->ID), "OutlineWidth", 0.2f);
-    ShaderLoader::SetUniform3fv(std::move(StaticShader::Shaders["ToonOutline"]->ID), "Color", glm::vec4(0.0f,0.0f,0.0f,1.0f));
+    // Matrices come from the object transform buffer
+    ShaderLoader::SetUniform1i(std::move(m_Shaders[1].ID), "ObjectIndex"_id, m_ObjectIndex);
+    ShaderLoader::SetUniform1f(std::move(m_Shaders[1].ID), "OutlineWidth"_id, 0.2f);
+    ShaderLoader::SetUniform3fv(std::move(m_Shaders[1].ID), "Color"_id, glm::vec4(0.0f,0.0f,0.0f,1.0f));
 }
 
 void GameObject::SetCellShadingUniforms()
 {
-    ShaderLoader::SetUniformMatrix4fv(std::move(StaticShader::Shaders["CellShading"]->ID), "PVMMatrix", m_ActiveCamera->GetPVMatrix() * m_Transform.transform);
-    ShaderLoader::SetUniformMatrix4fv(std::move(StaticShader::Shaders["CellShading"]->ID), "ModelMatrix", m_Transform.transform);
+    // Camera, ambient and light data come from the per frame uniform block and light clusters
+    SetSurfaceUniforms(m_Shaders[0].ID);
+
+    // Or from only the strongest lights that reach this object, their count is baked into the permutation
+    if (m_ObjectLights.size() > 0)
+        ShaderLoader::SetUniform1iv(std::move(m_Shaders[0].ID), "ObjectLightIndices"_id, (GLsizei)m_ObjectLights.size(), m_ObjectLights.data());
+}
+
+void GameObject::SetSurfaceUniforms(GLuint _program)
+{
+    ShaderLoader::SetUniform1i(std::move(_program), "ObjectIndex"_id, m_ObjectIndex);
 
-    // Apply Texture
+    // Apply Texture, only the HAS_TEXTURE permutation samples it
     if (m_ActiveTextures.size() > 0)
     {
-        ShaderLoader::SetUniform1i(std::move(StaticShader::Shaders["CellShading"]->ID), "TextureCount", m_ActiveTextures.size());
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_ActiveTextures[0].ID);
-        ShaderLoader::SetUniform1i(std::move(StaticShader::Shaders["CellShading"]->ID), "ImageTexture0", 0);
+        GLState::BindTexture(0, GL_TEXTURE_2D, TextureLoader::GetID(m_ActiveTextures[0]));
+        ShaderLoader::SetUniform1i(std::move(_program), "ImageTexture0"_id, 0);
     }
 
-    // Set Global Ambient Colour And Strength
-    ShaderLoader::SetUniform1f(std::move(StaticShader::Shaders["CellShading"]->ID), "AmbientStrength", 0.5f);
-    ShaderLoader::SetUniform3fv(std::move(StaticShader::Shaders["CellShading"]->ID), "AmbientColor", { 1.0f,1.0f,1.0f });
-
     // Set Shininess
-    ShaderLoader::SetUniform1f(std::move(StaticShader::Shaders["CellShading"]->ID), "Shininess", 32.0f * 5);
+    ShaderLoader::SetUniform1f(std::move(_program), "Shininess"_id, 32.0f * 5);
+}
+
+std::vector<std::string> GameObject::GetSurfaceDefines()
+{
+    std::vector<std::string> defines{};
+    if (m_ActiveTextures.size() > 0)
+        defines.push_back("HAS_TEXTURE");
+    return defines;
+}
 
-    // Set Camera Position
-    ShaderLoader::SetUniform3fv(std::move(StaticShader::Shaders["CellShading"]->ID), "CameraPos", m_ActiveCamera->GetPosition());
+uint32_t GameObject::GetSurfaceVariantKey()
+{
+    return m_ActiveTextures.size() > 0 ? 1 : 0;
+}
 
-    if (m_LightManager)
-    {
-        // Set Point Light Uniforms From Light Manager
-        std::vector<PointLight>& pointLights = m_LightManager->GetPointLights();
-        ShaderLoader::SetUniform1i(std::move(StaticShader::Shaders["CellShading"]->ID), "PointLightCount", (int)pointLights.size());
-        for (unsigned i = 0; i < pointLights.size(); i++)
-        {
-            ShaderLoader::SetUniform3fv(std::move(StaticShader::Shaders["CellShading"]->ID), "PointLights[" + std::to_string(i) + "].Position", pointLights[i].Position);
-            ShaderLoader::SetUniform3fv(std::move(StaticShader::Shaders["CellShading"]->ID), "PointLights[" + std::to_string(i) + "].Color", pointLights[i].Color);
-            ShaderLoader::SetUniform1f(std::move(StaticShader::Shaders["CellShading"]->ID), "PointLights[" + std::to_string(i) + "].SpecularStrength", pointLights[i].SpecularStrength);
-            ShaderLoader::SetUniform1f(std::move(StaticShader::Shaders["CellShading"]->ID), "PointLights[" + std::to_string(i) + "].AttenuationLinear", pointLights[i].AttenuationLinear);
-            ShaderLoader::SetUniform1f(std::move(StaticShader::Shaders["CellShading"]->ID), "PointLights[" + std::to_string(i) + "].AttenuationExponent", pointLights[i].AttenuationExponent);
-        }
-    }
+uint32_t GameObject::GatherObjectLights()
+{
+    // Without per object lights the permutation loops over the light cluster instead
+    m_ObjectLights.clear();
+    if (!m_LightManager || !m_LightManager->GetPerObjectLighting())
+        return GetSurfaceVariantKey();
+
+    m_LightManager->GatherObjectLights(GetWorldBounds(), LightManager::MaxObjectLights, m_ObjectLights);
+    return GetSurfaceVariantKey() | (uint32_t)(m_ObjectLights.size() + 1) << 1;
+}
+
+std::vector<std::string> GameObject::GetCellShadingDefines()
+{
+    std::vector<std::string> defines = GetSurfaceDefines();
+    if (m_LightManager && m_LightManager->GetPerObjectLighting())
+        defines.push_back("LIGHT_COUNT=" + std::to_string(m_ObjectLights.size()));
+    return defines;
 }
\ No newline at end of file
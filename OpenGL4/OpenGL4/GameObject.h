@@ -11,6 +11,26 @@
 #pragma once
 #include "LightManager.h"
 #include "StaticShader.h"
+#include "AABBTree.h"
+#include "GLState.h"
+
+class GameObject;
+
+/// <summary>
+/// The closest gameobject surface hit by a world space ray.
+/// SubMesh is -1 for primitives, Barycentrics are the weights of the triangles second and third vertex.
+/// </summary>
+struct RaycastHit
+{
+	GameObject* Object = nullptr;
+	int SubMesh = -1;
+	int Triangle = -1;
+	glm::vec2 Barycentrics{ 0,0 };
+	glm::vec2 UV{ 0,0 };
+	glm::vec3 Position{ 0,0,0 };
+	glm::vec3 Normal{ 0,0,0 };
+	float Distance = FLT_MAX;
+};
 
 class GameObject
 {
@@ -51,6 +71,17 @@ public:
 	/// </summary>
 	void Draw();
 
+	/// <summary>
+	/// Draws the gameobject into the bound G-buffer with the given program, marking it in the stencil buffer.
+	/// </summary>
+	/// <param name="_gBufferShader"></param>
+	void DrawGBuffer(Shader& _gBufferShader);
+
+	/// <summary>
+	/// Draws the toon outline wherever the stencil buffer was not marked.
+	/// </summary>
+	void DrawOutline();
+
 	/// <summary>
 	/// Attaches a mesh to be used for drawing.
 	/// </summary>
@@ -117,15 +148,15 @@ public:
 	Camera* GetActiveCamera();
 
 	/// <summary>
-	/// Sets the active textures to specified textures.
+	/// Sets the active textures to specified textures, taking over a reference to each and releasing the previous ones.
 	/// </summary>
 	/// <param name="_textures"></param>
-	void SetActiveTextures(std::vector<Texture> _textures);
+	void SetActiveTextures(std::vector<TextureHandle> _textures);
 	/// <summary>
 	/// Returns the vector of active textures
 	/// </summary>
 	/// <returns></returns>
-	std::vector<Texture> GetActiveTextures();
+	std::vector<TextureHandle> GetActiveTextures();
 
 	/// <summary>
 	/// Sets the shader program to use for rendering
@@ -150,20 +181,183 @@ public:
 	void SetLightManager(LightManager& _lightManager);
 
 	/// <summary>
-	/// Sets the texture of the skybox
+	/// Sets the texture of the skybox, taking over a reference to it and releasing the previous one.
 	/// </summary>
 	/// <param name="_skyboxTexture"></param>
-	void SetSkyboxTexture(Texture _skyboxTexture);
+	void SetSkyboxTexture(TextureHandle _skyboxTexture);
+
+	/// <summary>
+	/// Registers the gameobject with the given scene tree so it can be found by spatial queries.
+	/// The proxy is kept up to date whenever the transform or mesh changes.
+	/// </summary>
+	/// <param name="_sceneTree"></param>
+	void SetSceneTree(AABBTree& _sceneTree);
+
+	/// <summary>
+	/// Returns the world space bounds of the attached mesh.
+	/// </summary>
+	/// <returns></returns>
+	AABB GetWorldBounds();
+
+	/// <summary>
+	/// Returns the world space bounding sphere of the attached mesh.
+	/// </summary>
+	/// <returns></returns>
+	BoundingSphere GetWorldSphere();
+
+	/// <summary>
+	/// Sets whether the gameobject is rasterized into the occlusion buffer to hide objects behind it.
+	/// </summary>
+	/// <param name="_isOccluder"></param>
+	void SetIsOccluder(bool _isOccluder);
+
+	/// <summary>
+	/// Returns true if the gameobject is used as an occluder.
+	/// </summary>
+	/// <returns></returns>
+	bool GetIsOccluder();
+
+	/// <summary>
+	/// Sets whether the gameobject never moves, which lets cached shadow cascades keep it between frames.
+	/// </summary>
+	/// <param name="_isStatic"></param>
+	void SetIsStatic(bool _isStatic);
+
+	/// <summary>
+	/// Returns true if the gameobject is static.
+	/// </summary>
+	/// <returns></returns>
+	bool GetIsStatic();
+
+	/// <summary>
+	/// Returns a counter that changes whenever a static gameobject is added, moved, changed or destroyed.
+	/// </summary>
+	/// <returns></returns>
+	static unsigned GetStaticVersion();
+
+	/// <summary>
+	/// Sets the index of the gameobjects matrices in the object transform buffer.
+	/// </summary>
+	/// <param name="_objectIndex"></param>
+	void SetObjectIndex(int _objectIndex);
+
+	/// <summary>
+	/// Returns the index of the gameobjects matrices in the object transform buffer.
+	/// </summary>
+	/// <returns></returns>
+	int GetObjectIndex();
+
+	/// <summary>
+	/// Sets whether the gameobject is see through, which keeps it on the forward path when deferred shading.
+	/// </summary>
+	/// <param name="_isTransparent"></param>
+	void SetIsTransparent(bool _isTransparent);
+
+	/// <summary>
+	/// Returns true if the gameobject is transparent.
+	/// </summary>
+	/// <returns></returns>
+	bool GetIsTransparent();
+
+	/// <summary>
+	/// Sets a simplified mesh to rasterize as the occluder instead of the render mesh.
+	/// It must fit inside the render mesh so it never hides anything the real mesh wouldn't.
+	/// </summary>
+	/// <param name="_occluderMesh"></param>
+	void SetOccluderMesh(Mesh* _occluderMesh);
+
+	/// <summary>
+	/// Returns the occluder mesh if set, otherwise the render mesh.
+	/// </summary>
+	/// <returns></returns>
+	Mesh* GetOccluderMesh();
+
+	/// <summary>
+	/// Returns the ID of the gameobjects proxy in the scene tree (-1 if not registered).
+	/// </summary>
+	/// <returns></returns>
+	int GetSceneProxyID();
+
+	/// <summary>
+	/// Intersects a world space ray with the triangles of the attached mesh.
+	/// Returns true and fills _hit if the mesh was hit within the rays max distance.
+	/// </summary>
+	/// <param name="_ray"></param>
+	/// <param name="_hit"></param>
+	/// <returns></returns>
+	bool RayCast(const Ray& _ray, RaycastHit& _hit);
+
+	/// <summary>
+	/// Builds the BVHs of the attached mesh, which RayCast otherwise builds on first use.
+	/// Must be called before the gameobject is ray cast from several threads at once.
+	/// </summary>
+	void BuildBVH();
+
+	/// <summary>
+	/// Finds the closest gameobject in the scene tree hit by the world space ray.
+	/// The tree culls by bounds, then each candidates mesh BVH is tested.
+	/// </summary>
+	/// <param name="_sceneTree"></param>
+	/// <param name="_ray"></param>
+	/// <param name="_hit"></param>
+	/// <returns></returns>
+	static bool RayCastScene(const AABBTree& _sceneTree, const Ray& _ray, RaycastHit& _hit);
 
 	Transform m_Transform{};
+
+	// Surfaces mark the stencil where they draw, outlines then draw over everything outside the marked pixels
+	inline static const PipelineState SurfacePipeline{ {}, {}, StencilState{ true, GL_ALWAYS, 1, 0xFF, 0xFF, GL_KEEP, GL_KEEP, GL_REPLACE } };
+	inline static const PipelineState OutlinePipeline{ {}, DepthState{ false, true, GL_LESS }, StencilState{ true, GL_NOTEQUAL, 1, 0xFF, 0x00, GL_KEEP, GL_KEEP, GL_REPLACE } };
 private:
 
+	/// <summary>
+	/// Inserts, moves or removes the scene tree proxy to match the current bounds.
+	/// </summary>
+	/// <param name="_displacement"></param>
+	void UpdateSceneProxy(glm::vec3 _displacement = {0,0,0});
+
 	void SetToonOutlineUniforms();
 
 	void SetCellShadingUniforms();
 
+	/// <summary>
+	/// Sets the model matrix, texture and material uniforms of the given bound surface program.
+	/// </summary>
+	/// <param name="_program"></param>
+	void SetSurfaceUniforms(GLuint _program);
+
+	/// <summary>
+	/// Returns the permutation defines of the surface shaders for this gameobject.
+	/// </summary>
+	/// <returns></returns>
+	std::vector<std::string> GetSurfaceDefines();
+
+	/// <summary>
+	/// Returns the key of the surface permutation, which only depends on whether the gameobject is textured.
+	/// </summary>
+	/// <returns></returns>
+	uint32_t GetSurfaceVariantKey();
+
+	/// <summary>
+	/// Gathers the per object lights if they are enabled and returns the key of the cel shader permutation they need.
+	/// </summary>
+	/// <returns></returns>
+	uint32_t GatherObjectLights();
+
+	/// <summary>
+	/// Returns the permutation defines of the cel shader for the lights last gathered.
+	/// </summary>
+	/// <returns></returns>
+	std::vector<std::string> GetCellShadingDefines();
+
 	bool m_RimLighting = false;
-	std::vector<Texture> m_ActiveTextures{};
+	bool m_IsOccluder = false;
+	bool m_IsStatic = false;
+	bool m_IsTransparent = false;
+	int m_ObjectIndex = 0;
+	inline static unsigned m_StaticVersion = 0;
+	Mesh* m_OccluderMesh = nullptr;
+	std::vector<TextureHandle> m_ActiveTextures{};
 	std::vector<Shader> m_Shaders{};
 	GLuint m_ShaderID{0};
 	ShaderProgramLocation m_ShaderLocation{nullptr,nullptr};
@@ -172,7 +366,10 @@ private:
 	Mesh* m_Mesh = nullptr;
 	Camera* m_ActiveCamera = nullptr;
 	LightManager* m_LightManager{ nullptr };
+	std::vector<int> m_ObjectLights{};
+	AABBTree* m_SceneTree{ nullptr };
+	int m_SceneProxyID{ AABBTree::NullNode };
 
-	Texture m_SkyboxTexture;
+	TextureHandle m_SkyboxTexture{};
 };
 
@@ -0,0 +1,233 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : GeometryArena.cpp 
+// Description : GeometryArena Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "GeometryArena.h"
+#include "GLState.h"
+
+int GeometryArena::Allocate(const std::vector<Vertex>& _vertices, const std::vector<unsigned>& _indices)
+{
+	if (_vertices.size() == 0 || _indices.size() == 0)
+		return InvalidHandle;
+
+	if (m_VertexArrayID == 0)
+		Init();
+
+	GeometryAllocation allocation{};
+	allocation.Vertices = AllocateOrGrow(m_VertexAllocator, m_VertexBufferID, sizeof(Vertex), (unsigned)_vertices.size());
+	allocation.Indices = AllocateOrGrow(m_IndexAllocator, m_IndexBufferID, sizeof(unsigned), (unsigned)_indices.size());
+	allocation.IsLive = true;
+
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_VertexBufferID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.Vertices.Offset * sizeof(Vertex), _vertices.size() * sizeof(Vertex), _vertices.data());
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_IndexBufferID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.Indices.Offset * sizeof(unsigned), _indices.size() * sizeof(unsigned), _indices.data());
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	// Reuse a freed handle if there is one
+	if (m_FreeHandles.size() > 0)
+	{
+		int handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+		m_Allocations[handle] = allocation;
+		return handle;
+	}
+
+	m_Allocations.push_back(allocation);
+	return (int)m_Allocations.size() - 1;
+}
+
+void GeometryArena::Free(int _handle)
+{
+	if (_handle < 0 || _handle >= (int)m_Allocations.size() || !m_Allocations[_handle].IsLive)
+		return;
+
+	m_VertexAllocator.Free(m_Allocations[_handle].Vertices);
+	m_IndexAllocator.Free(m_Allocations[_handle].Indices);
+	m_Allocations[_handle] = GeometryAllocation{};
+	m_FreeHandles.push_back(_handle);
+}
+
+GeometryRange GeometryArena::GetRange(int _handle)
+{
+	if (_handle < 0 || _handle >= (int)m_Allocations.size() || !m_Allocations[_handle].IsLive)
+		return {};
+
+	GeometryAllocation& allocation = m_Allocations[_handle];
+	return { (GLint)allocation.Vertices.Offset, allocation.Indices.Offset, (GLsizei)allocation.Indices.Size };
+}
+
+GLuint GeometryArena::GetVertexArrayID()
+{
+	return m_VertexArrayID;
+}
+
+void GeometryArena::Compact(float _fragmentationThreshold, int _maxMoves)
+{
+	bool compactVertices = m_VertexAllocator.GetFragmentation() > _fragmentationThreshold;
+	bool compactIndices = m_IndexAllocator.GetFragmentation() > _fragmentationThreshold;
+	if (!compactVertices && !compactIndices)
+		return;
+
+	// Move the highest ranges first so the holes bubble up to the end of the buffers
+	std::vector<int> handles{};
+	for (int i = 0; i < (int)m_Allocations.size(); i++)
+	{
+		if (m_Allocations[i].IsLive)
+			handles.push_back(i);
+	}
+
+	if (compactVertices)
+	{
+		std::sort(handles.begin(), handles.end(), [](int _a, int _b)
+			{
+				return m_Allocations[_a].Vertices.Offset > m_Allocations[_b].Vertices.Offset;
+			});
+		for (int i = 0; i < (int)handles.size() && i < _maxMoves; i++)
+		{
+			if (!MoveRange(m_VertexAllocator, m_VertexBufferID, sizeof(Vertex), m_Allocations[handles[i]].Vertices))
+				break;
+		}
+	}
+
+	if (compactIndices)
+	{
+		std::sort(handles.begin(), handles.end(), [](int _a, int _b)
+			{
+				return m_Allocations[_a].Indices.Offset > m_Allocations[_b].Indices.Offset;
+			});
+		for (int i = 0; i < (int)handles.size() && i < _maxMoves; i++)
+		{
+			if (!MoveRange(m_IndexAllocator, m_IndexBufferID, sizeof(unsigned), m_Allocations[handles[i]].Indices))
+				break;
+		}
+	}
+}
+
+const TLSFAllocator& GeometryArena::GetVertexAllocator()
+{
+	return m_VertexAllocator;
+}
+
+const TLSFAllocator& GeometryArena::GetIndexAllocator()
+{
+	return m_IndexAllocator;
+}
+
+void GeometryArena::Cleanup()
+{
+	GLState::BindVertexArray(0);
+	if (m_VertexArrayID)
+		GLState::DeleteVertexArrays(1, &m_VertexArrayID);
+	if (m_VertexBufferID)
+		GLState::DeleteBuffers(1, &m_VertexBufferID);
+	if (m_IndexBufferID)
+		GLState::DeleteBuffers(1, &m_IndexBufferID);
+
+	m_VertexArrayID = 0;
+	m_VertexBufferID = 0;
+	m_IndexBufferID = 0;
+
+	m_VertexAllocator = TLSFAllocator{};
+	m_IndexAllocator = TLSFAllocator{};
+	m_Allocations.clear();
+	m_FreeHandles.clear();
+}
+
+void GeometryArena::Init()
+{
+	m_VertexAllocator = TLSFAllocator{ m_InitialVertexCapacity };
+	m_IndexAllocator = TLSFAllocator{ m_InitialIndexCapacity };
+
+	ResizeBuffer(m_VertexBufferID, 0, m_InitialVertexCapacity * sizeof(Vertex));
+	ResizeBuffer(m_IndexBufferID, 0, m_InitialIndexCapacity * sizeof(unsigned));
+
+	glGenVertexArrays(1, &m_VertexArrayID);
+	SetupVertexArray();
+}
+
+void GeometryArena::ResizeBuffer(GLuint& _bufferID, GLsizeiptr _oldSize, GLsizeiptr _newSize)
+{
+	GLuint newBufferID = 0;
+	glGenBuffers(1, &newBufferID);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+	glBufferData(GL_COPY_WRITE_BUFFER, _newSize, nullptr, GL_STATIC_DRAW);
+
+	if (_bufferID)
+	{
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, _bufferID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, _oldSize);
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, 0);
+		GLState::DeleteBuffers(1, &_bufferID);
+	}
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	_bufferID = newBufferID;
+}
+
+void GeometryArena::SetupVertexArray()
+{
+	GLState::BindVertexArray(m_VertexArrayID);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID);
+
+	// Layouts
+	// Position
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+	// TexCoords
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, texCoords)));
+	// Normals
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, normals)));
+
+	// Unbind
+	GLState::BindVertexArray(0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+TLSFAllocation GeometryArena::AllocateOrGrow(TLSFAllocator& _allocator, GLuint& _bufferID, GLsizeiptr _elementSize, unsigned _size)
+{
+	TLSFAllocation allocation = _allocator.Allocate(_size);
+	while (!allocation.IsValid())
+	{
+		// Double the capacity, the new space merges with any free block at the end
+		unsigned oldSize = _allocator.GetSize();
+		unsigned newSize = std::max(oldSize * 2, oldSize + _size);
+		ResizeBuffer(_bufferID, oldSize * _elementSize, newSize * _elementSize);
+		_allocator.Grow(newSize);
+		SetupVertexArray();
+
+		allocation = _allocator.Allocate(_size);
+	}
+	return allocation;
+}
+
+bool GeometryArena::MoveRange(TLSFAllocator& _allocator, GLuint _bufferID, GLsizeiptr _elementSize, TLSFAllocation& _allocation)
+{
+	TLSFAllocation destination = _allocator.Allocate(_allocation.Size);
+	if (!destination.IsValid() || destination.Offset > _allocation.Offset)
+	{
+		_allocator.Free(destination);
+		return false;
+	}
+
+	// Both ranges are allocated so they cannot overlap, which allows copying within the same buffer
+	GLState::BindBuffer(GL_COPY_READ_BUFFER, _bufferID);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, _bufferID);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, _allocation.Offset * _elementSize, destination.Offset * _elementSize, _allocation.Size * _elementSize);
+	GLState::BindBuffer(GL_COPY_READ_BUFFER, 0);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	_allocator.Free(_allocation);
+	_allocation = destination;
+	return true;
+}
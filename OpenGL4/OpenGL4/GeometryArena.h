@@ -0,0 +1,149 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : GeometryArena.h 
+// Description : GeometryArena Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "TLSFAllocator.h"
+
+/// <summary>
+/// Where a mesh lives inside the shared geometry buffers.
+/// Draw with glDrawElementsBaseVertex(GL_TRIANGLES, IndexCount, GL_UNSIGNED_INT, FirstIndex * sizeof(unsigned), BaseVertex).
+/// </summary>
+struct GeometryRange
+{
+	GLint BaseVertex{ 0 };
+	GLuint FirstIndex{ 0 };
+	GLsizei IndexCount{ 0 };
+};
+
+/// <summary>
+/// Shared vertex and index buffers for every mesh, with one vertex array for the Vertex format.
+/// Ranges are sub allocated with a TLSFAllocator and grow the buffers when full.
+/// Freed ranges leave holes, so Compact moves a few meshes per call into lower free blocks
+/// once the free space becomes fragmented. The moves are GPU side copies so they can run every frame.
+/// </summary>
+class GeometryArena
+{
+public:
+	/// <summary>
+	/// Copies the vertices and indices into the shared buffers and returns a handle to them.
+	/// </summary>
+	/// <param name="_vertices"></param>
+	/// <param name="_indices"></param>
+	/// <returns></returns>
+	static int Allocate(const std::vector<Vertex>& _vertices, const std::vector<unsigned>& _indices);
+
+	/// <summary>
+	/// Frees the ranges used by the handle.
+	/// </summary>
+	/// <param name="_handle"></param>
+	static void Free(int _handle);
+
+	/// <summary>
+	/// Returns the current range of the handle. Ranges move when compacting so should not be kept across frames.
+	/// </summary>
+	/// <param name="_handle"></param>
+	/// <returns></returns>
+	static GeometryRange GetRange(int _handle);
+
+	/// <summary>
+	/// Returns the ID of the shared vertex array.
+	/// </summary>
+	/// <returns></returns>
+	static GLuint GetVertexArrayID();
+
+	/// <summary>
+	/// Moves up to _maxMoves meshes into lower free blocks if either buffer is more fragmented than the threshold.
+	/// Should be called once per frame.
+	/// </summary>
+	/// <param name="_fragmentationThreshold"></param>
+	/// <param name="_maxMoves"></param>
+	static void Compact(float _fragmentationThreshold = 0.5f, int _maxMoves = 8);
+
+	/// <summary>
+	/// Returns the vertex allocator for stats.
+	/// </summary>
+	/// <returns></returns>
+	static const TLSFAllocator& GetVertexAllocator();
+
+	/// <summary>
+	/// Returns the index allocator for stats.
+	/// </summary>
+	/// <returns></returns>
+	static const TLSFAllocator& GetIndexAllocator();
+
+	/// <summary>
+	/// Deletes the shared buffers and vertex array.
+	/// </summary>
+	static void Cleanup();
+
+	static const int InvalidHandle = -1;
+
+private:
+	/// <summary>
+	/// The vertex and index ranges of a single mesh.
+	/// </summary>
+	struct GeometryAllocation
+	{
+		TLSFAllocation Vertices{};
+		TLSFAllocation Indices{};
+		bool IsLive{ false };
+	};
+
+	/// <summary>
+	/// Creates the buffers and vertex array on first use.
+	/// </summary>
+	static void Init();
+
+	/// <summary>
+	/// Replaces the buffer with one of the new capacity, copying the old contents across.
+	/// </summary>
+	/// <param name="_bufferID"></param>
+	/// <param name="_oldSize"></param>
+	/// <param name="_newSize"></param>
+	static void ResizeBuffer(GLuint& _bufferID, GLsizeiptr _oldSize, GLsizeiptr _newSize);
+
+	/// <summary>
+	/// Points the vertex array at the current buffers.
+	/// </summary>
+	static void SetupVertexArray();
+
+	/// <summary>
+	/// Allocates from the allocator, growing it and its buffer until the allocation fits.
+	/// </summary>
+	/// <param name="_allocator"></param>
+	/// <param name="_bufferID"></param>
+	/// <param name="_elementSize"></param>
+	/// <param name="_size"></param>
+	/// <returns></returns>
+	static TLSFAllocation AllocateOrGrow(TLSFAllocator& _allocator, GLuint& _bufferID, GLsizeiptr _elementSize, unsigned _size);
+
+	/// <summary>
+	/// Moves a range to a lower free block in the same buffer.
+	/// Returns false if there is no lower block large enough.
+	/// </summary>
+	/// <param name="_allocator"></param>
+	/// <param name="_bufferID"></param>
+	/// <param name="_elementSize"></param>
+	/// <param name="_allocation"></param>
+	/// <returns></returns>
+	static bool MoveRange(TLSFAllocator& _allocator, GLuint _bufferID, GLsizeiptr _elementSize, TLSFAllocation& _allocation);
+
+	inline static TLSFAllocator m_VertexAllocator{};
+	inline static TLSFAllocator m_IndexAllocator{};
+	inline static std::vector<GeometryAllocation> m_Allocations{};
+	inline static std::vector<int> m_FreeHandles{};
+
+	inline static GLuint m_VertexArrayID{ 0 };
+	inline static GLuint m_VertexBufferID{ 0 };
+	inline static GLuint m_IndexBufferID{ 0 };
+
+	inline static const unsigned m_InitialVertexCapacity{ 1 << 18 };
+	inline static const unsigned m_InitialIndexCapacity{ 1 << 20 };
+};
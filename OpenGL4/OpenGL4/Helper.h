@@ -22,6 +22,8 @@
 #include <iostream>
 #include <fstream>
 #include <functional>
+#include <algorithm>
+#include <cfloat>
 
 /// <summary>
 /// Alias For Keymap (int = Key, bool = bPressed)
@@ -69,14 +71,54 @@ struct Transform
 };
 
 /// <summary>
-/// Texture Struct that contains the ID of the texture, 
-/// Its dimentions and its filePath.
+/// Axis aligned bounding box struct that encapsulates the minimum and maximum corners of a volume.
 /// </summary>
-struct Texture
+struct AABB
 {
-	GLuint ID = 0;
-	glm::vec2 Dimensions{ 0 };
-	std::string FilePath = "";
+	glm::vec3 Min{ 0,0,0 };
+	glm::vec3 Max{ 0,0,0 };
+};
+
+/// <summary>
+/// Bounding sphere struct that encapsulates a centre and radius.
+/// </summary>
+struct BoundingSphere
+{
+	glm::vec3 Centre{ 0,0,0 };
+	float Radius = 0.0f;
+};
+
+/// <summary>
+/// Ray struct that encapsulates an origin, a normalized direction and the furthest distance to test along it.
+/// </summary>
+struct Ray
+{
+	glm::vec3 Origin{ 0,0,0 };
+	glm::vec3 Direction{ 0,0,-1 };
+	float MaxDistance = FLT_MAX;
+};
+
+/// <summary>
+/// Frustum struct that contains six planes (Left, Right, Bottom, Top, Near, Far).
+/// Each plane is stored as (Normal, Distance) with the normal pointing into the frustum.
+/// </summary>
+struct Frustum
+{
+	glm::vec4 Planes[6]{};
+};
+
+/// <summary>
+/// Handle to a texture in the TextureLoader registry, resolved with TextureLoader::GetID.
+/// The generation changes when a slot is reused, so a handle to an evicted texture resolves to 0 instead of another texture.
+/// Index 0 is never used, so a default handle is invalid.
+/// </summary>
+struct TextureHandle
+{
+	uint32_t Index = 0;
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Index != 0; }
+	bool operator==(const TextureHandle&) const = default;
 };
 
 /// <summary>
@@ -197,4 +239,130 @@ inline void Print(int&& _int)
 inline void Print(float&& _float)
 {
 	std::cout << _float << std::endl;
+}
+
+/// <summary>
+/// Returns the smallest AABB that contains both of the given AABB's.
+/// </summary>
+/// <param name="_a"></param>
+/// <param name="_b"></param>
+/// <returns></returns>
+inline AABB MergeAABB(const AABB& _a, const AABB& _b)
+{
+	return AABB{ glm::min(_a.Min, _b.Min), glm::max(_a.Max, _b.Max) };
+}
+
+/// <summary>
+/// Returns true if the outer AABB fully contains the inner AABB.
+/// </summary>
+/// <param name="_outer"></param>
+/// <param name="_inner"></param>
+/// <returns></returns>
+inline bool ContainsAABB(const AABB& _outer, const AABB& _inner)
+{
+	return glm::all(glm::lessThanEqual(_outer.Min, _inner.Min)) && glm::all(glm::greaterThanEqual(_outer.Max, _inner.Max));
+}
+
+/// <summary>
+/// Returns true if the two AABB's overlap.
+/// </summary>
+/// <param name="_a"></param>
+/// <param name="_b"></param>
+/// <returns></returns>
+inline bool OverlapsAABB(const AABB& _a, const AABB& _b)
+{
+	return glm::all(glm::lessThanEqual(_a.Min, _b.Max)) && glm::all(glm::greaterThanEqual(_a.Max, _b.Min));
+}
+
+/// <summary>
+/// Returns the surface area of the given AABB.
+/// Used as the cost metric when building and balancing bounding volume hierarchies.
+/// </summary>
+/// <param name="_aabb"></param>
+/// <returns></returns>
+inline float SurfaceArea(const AABB& _aabb)
+{
+	glm::vec3 extent = _aabb.Max - _aabb.Min;
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+/// <summary>
+/// Returns the squared distance from the point to the closest point on the AABB (0 if inside).
+/// </summary>
+/// <param name="_aabb"></param>
+/// <param name="_point"></param>
+/// <returns></returns>
+inline float DistanceSquaredToAABB(const AABB& _aabb, const glm::vec3& _point)
+{
+	glm::vec3 delta = glm::max(glm::max(_aabb.Min - _point, _point - _aabb.Max), glm::vec3{ 0,0,0 });
+	return glm::dot(delta, delta);
+}
+
+/// <summary>
+/// Transforms a local space AABB by the given matrix and returns the world space AABB that encloses it.
+/// Uses the absolute value of the rotation/scale part to transform the extents (Arvo's method).
+/// </summary>
+/// <param name="_aabb"></param>
+/// <param name="_transform"></param>
+/// <returns></returns>
+inline AABB TransformAABB(const AABB& _aabb, const glm::mat4& _transform)
+{
+	glm::vec3 centre = (_aabb.Min + _aabb.Max) * 0.5f;
+	glm::vec3 extent = (_aabb.Max - _aabb.Min) * 0.5f;
+
+	glm::vec3 newCentre = glm::vec3(_transform * glm::vec4(centre, 1.0f));
+	glm::mat3 absolute = glm::mat3(_transform);
+	for (int i = 0; i < 3; i++)
+	{
+		absolute[i] = glm::abs(absolute[i]);
+	}
+	glm::vec3 newExtent = absolute * extent;
+
+	return AABB{ newCentre - newExtent, newCentre + newExtent };
+}
+
+/// <summary>
+/// Transforms a local space bounding sphere by the given matrix.
+/// The radius is scaled by the largest axis scale so the sphere stays conservative under non uniform scale.
+/// </summary>
+/// <param name="_sphere"></param>
+/// <param name="_transform"></param>
+/// <returns></returns>
+inline BoundingSphere TransformSphere(const BoundingSphere& _sphere, const glm::mat4& _transform)
+{
+	float maxScaleSquared = glm::max(glm::max(
+		glm::dot(glm::vec3(_transform[0]), glm::vec3(_transform[0])),
+		glm::dot(glm::vec3(_transform[1]), glm::vec3(_transform[1]))),
+		glm::dot(glm::vec3(_transform[2]), glm::vec3(_transform[2])));
+
+	return BoundingSphere{ glm::vec3(_transform * glm::vec4(_sphere.Centre, 1.0f)), _sphere.Radius * sqrtf(maxScaleSquared) };
+}
+
+/// <summary>
+/// Extracts the six normalized frustum planes from a projection * view matrix (Gribb/Hartmann).
+/// Plane normals point into the frustum.
+/// </summary>
+/// <param name="_pvMatrix"></param>
+/// <returns></returns>
+inline Frustum ExtractFrustum(const glm::mat4& _pvMatrix)
+{
+	// glm is column major, grab the rows
+	glm::vec4 row0{ _pvMatrix[0][0], _pvMatrix[1][0], _pvMatrix[2][0], _pvMatrix[3][0] };
+	glm::vec4 row1{ _pvMatrix[0][1], _pvMatrix[1][1], _pvMatrix[2][1], _pvMatrix[3][1] };
+	glm::vec4 row2{ _pvMatrix[0][2], _pvMatrix[1][2], _pvMatrix[2][2], _pvMatrix[3][2] };
+	glm::vec4 row3{ _pvMatrix[0][3], _pvMatrix[1][3], _pvMatrix[2][3], _pvMatrix[3][3] };
+
+	Frustum frustum{};
+	frustum.Planes[0] = row3 + row0; // Left
+	frustum.Planes[1] = row3 - row0; // Right
+	frustum.Planes[2] = row3 + row1; // Bottom
+	frustum.Planes[3] = row3 - row1; // Top
+	frustum.Planes[4] = row3 + row2; // Near
+	frustum.Planes[5] = row3 - row2; // Far
+
+	for (auto& plane : frustum.Planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
 }
\ No newline at end of file
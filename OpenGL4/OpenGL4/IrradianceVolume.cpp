@@ -0,0 +1,415 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : IrradianceVolume.cpp 
+// Description : IrradianceVolume Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "IrradianceVolume.h"
+#include "GLState.h"
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/constants.hpp>
+#include <future>
+#include <thread>
+#include <chrono>
+
+namespace
+{
+	const char ProbeFileMagic[4]{ 'S', 'H', 'I', 'V' };
+	const uint32_t ProbeFileVersion = 1;
+}
+
+IrradianceVolume::IrradianceVolume()
+{
+}
+
+IrradianceVolume::~IrradianceVolume()
+{
+	if (m_BufferID)
+		GLState::DeleteBuffers(1, &m_BufferID);
+	m_BufferID = 0;
+}
+
+bool IrradianceVolume::Bake(const std::vector<GameObject*>& _gameObjects, LightManager& _lightManager, const IrradianceBakeSettings& _settings)
+{
+	if (_settings.Resolution.x < 1 || _settings.Resolution.y < 1 || _settings.Resolution.z < 1 || _settings.SampleCount < 1)
+	{
+		Print("Irradiance volume bake needs at least one probe and one sample");
+		return false;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	m_Settings = _settings;
+	m_Bounds = _settings.Bounds;
+	m_Resolution = _settings.Resolution;
+	m_CellSize = (m_Bounds.Max - m_Bounds.Min) / glm::vec3(glm::max(m_Resolution - 1, glm::ivec3{ 1,1,1 }));
+
+	// Static gameobjects only, their BVHs are built here since workers must not build them lazily
+	m_StaticTree.Clear();
+	for (auto& gameObject : _gameObjects)
+	{
+		if (!gameObject->GetIsStatic())
+			continue;
+
+		gameObject->BuildBVH();
+		m_StaticTree.CreateProxy(gameObject->GetWorldBounds(), gameObject);
+	}
+
+	m_Lights.clear();
+	for (auto& light : _lightManager.GetPointLights())
+	{
+		if (!light.IsStatic)
+			continue;
+
+		BakeLight bakeLight{};
+		bakeLight.Position = light.Position;
+		bakeLight.Color = light.Color;
+		bakeLight.AttenuationLinear = light.AttenuationLinear;
+		bakeLight.AttenuationExponent = light.AttenuationExponent;
+		bakeLight.Radius = light.Radius > 0.0f ? light.Radius : LightManager::CalculateInfluenceRadius(light.Color, light.SpecularStrength, light.AttenuationLinear, light.AttenuationExponent);
+		m_Lights.push_back(bakeLight);
+	}
+	for (auto& light : _lightManager.GetSpotLights())
+	{
+		if (!light.IsStatic || light.IsAttachedToCamera)
+			continue;
+
+		BakeLight bakeLight{};
+		bakeLight.Position = light.Position;
+		bakeLight.Color = light.Color;
+		bakeLight.Direction = glm::normalize(light.Direction);
+		bakeLight.AttenuationLinear = light.AttenuationLinear;
+		bakeLight.AttenuationExponent = light.AttenuationExponent;
+		bakeLight.Radius = light.Radius > 0.0f ? light.Radius : LightManager::CalculateInfluenceRadius(light.Color, light.SpecularStrength, light.AttenuationLinear, light.AttenuationExponent);
+		bakeLight.CosInnerCutoff = glm::cos(glm::radians(light.Cutoff));
+		bakeLight.CosOuterCutoff = glm::cos(glm::radians(light.OuterCutoff));
+		m_Lights.push_back(bakeLight);
+	}
+
+	m_HasSun = _lightManager.GetDirectionalLights().size() > 0;
+	if (m_HasSun)
+	{
+		m_Sun.Direction = glm::normalize(_lightManager.GetDirectionalLights()[0].Direction);
+		m_Sun.Color = _lightManager.GetDirectionalLights()[0].Color;
+	}
+	glm::vec4 ambient = _lightManager.GetAmbientLight();
+	m_SkyColor = glm::vec3(ambient) * ambient.a;
+
+	// Evenly spread directions on a fibonacci sphere
+	m_SampleDirections.resize(_settings.SampleCount);
+	float goldenAngle = glm::pi<float>() * (3.0f - std::sqrt(5.0f));
+	for (int i = 0; i < _settings.SampleCount; i++)
+	{
+		float y = 1.0f - 2.0f * (i + 0.5f) / _settings.SampleCount;
+		float radius = std::sqrt(std::max(0.0f, 1.0f - y * y));
+		m_SampleDirections[i] = { std::cos(goldenAngle * i) * radius, y, std::sin(goldenAngle * i) * radius };
+	}
+
+	int probeCount = m_Resolution.x * m_Resolution.y * m_Resolution.z;
+	m_Coefficients.assign(probeCount * CoefficientCount, glm::vec4{ 0,0,0,0 });
+
+	int threadCount = _settings.ThreadCount > 0 ? _settings.ThreadCount : (int)std::thread::hardware_concurrency();
+	threadCount = std::clamp(threadCount, 1, probeCount);
+	int probesPerThread = (probeCount + threadCount - 1) / threadCount;
+	std::vector<std::future<void>> workers{};
+	for (int thread = 1; thread < threadCount; thread++)
+	{
+		int firstProbe = thread * probesPerThread;
+		int lastProbe = std::min(firstProbe + probesPerThread, probeCount);
+		if (firstProbe < lastProbe)
+			workers.push_back(std::async(std::launch::async, &IrradianceVolume::BakeProbes, this, firstProbe, lastProbe));
+	}
+	BakeProbes(0, std::min(probesPerThread, probeCount));
+	for (auto& worker : workers)
+	{
+		worker.get();
+	}
+
+	m_StaticTree.Clear();
+	m_Lights.clear();
+	m_SampleDirections.clear();
+
+	m_BakeTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	Print("Baked " + std::to_string(probeCount) + " irradiance probes from " + std::to_string(m_Settings.SampleCount) + " rays each in " + std::to_string(m_BakeTime) + "ms on " + std::to_string(threadCount) + " threads");
+	return true;
+}
+
+bool IrradianceVolume::Save(std::string_view _filePath)
+{
+	if (m_Coefficients.size() == 0)
+		return false;
+
+	std::ofstream fileStream(std::string(_filePath), std::ios::binary);
+	if (!fileStream.is_open())
+	{
+		Print("Failed to open " + std::string(_filePath) + " for writing");
+		return false;
+	}
+
+	fileStream.write(ProbeFileMagic, sizeof(ProbeFileMagic));
+	fileStream.write((const char*)&ProbeFileVersion, sizeof(ProbeFileVersion));
+	fileStream.write((const char*)&m_Bounds, sizeof(AABB));
+	fileStream.write((const char*)&m_Resolution, sizeof(glm::ivec3));
+
+	// Half floats, 54 bytes a probe
+	std::vector<uint16_t> packedCoefficients{};
+	packedCoefficients.reserve(m_Coefficients.size() * 3);
+	for (auto& coefficient : m_Coefficients)
+	{
+		for (int channel = 0; channel < 3; channel++)
+		{
+			packedCoefficients.push_back(glm::packHalf1x16(coefficient[channel]));
+		}
+	}
+	fileStream.write((const char*)packedCoefficients.data(), packedCoefficients.size() * sizeof(uint16_t));
+	return fileStream.good();
+}
+
+bool IrradianceVolume::Load(std::string_view _filePath)
+{
+	std::ifstream fileStream(std::string(_filePath), std::ios::binary);
+	if (!fileStream.is_open())
+		return false;
+
+	char magic[4]{};
+	uint32_t version = 0;
+	AABB bounds{};
+	glm::ivec3 resolution{ 0,0,0 };
+	fileStream.read(magic, sizeof(magic));
+	fileStream.read((char*)&version, sizeof(version));
+	fileStream.read((char*)&bounds, sizeof(AABB));
+	fileStream.read((char*)&resolution, sizeof(glm::ivec3));
+	if (!fileStream.good() || std::memcmp(magic, ProbeFileMagic, sizeof(magic)) != 0 || version != ProbeFileVersion
+		|| resolution.x < 1 || resolution.y < 1 || resolution.z < 1)
+	{
+		Print(std::string(_filePath) + " is not an irradiance probe file");
+		return false;
+	}
+
+	size_t coefficientCount = (size_t)resolution.x * resolution.y * resolution.z * CoefficientCount;
+	std::vector<uint16_t> packedCoefficients(coefficientCount * 3);
+	fileStream.read((char*)packedCoefficients.data(), packedCoefficients.size() * sizeof(uint16_t));
+	if (!fileStream.good())
+	{
+		Print(std::string(_filePath) + " is truncated");
+		return false;
+	}
+
+	m_Bounds = bounds;
+	m_Resolution = resolution;
+	m_CellSize = (m_Bounds.Max - m_Bounds.Min) / glm::vec3(glm::max(m_Resolution - 1, glm::ivec3{ 1,1,1 }));
+	m_Coefficients.resize(coefficientCount);
+	for (size_t i = 0; i < coefficientCount; i++)
+	{
+		m_Coefficients[i] = { glm::unpackHalf1x16(packedCoefficients[i * 3 + 0]), glm::unpackHalf1x16(packedCoefficients[i * 3 + 1]), glm::unpackHalf1x16(packedCoefficients[i * 3 + 2]), 0.0f };
+	}
+	return true;
+}
+
+void IrradianceVolume::Upload()
+{
+	if (m_Coefficients.size() == 0)
+		return;
+
+	if (m_BufferID == 0)
+		glGenBuffers(1, &m_BufferID);
+
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_BufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_Coefficients.size() * sizeof(glm::vec4), m_Coefficients.data(), GL_STATIC_DRAW);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, ProbeBinding, m_BufferID);
+}
+
+glm::vec3 IrradianceVolume::SampleIrradiance(glm::vec3 _position, glm::vec3 _normal)
+{
+	if (m_Coefficients.size() == 0)
+		return { 0,0,0 };
+
+	float basis[CoefficientCount];
+	EvaluateBasis(glm::normalize(_normal), basis);
+
+	// Trilinear blend of the 8 surrounding probes, clamped to the grid
+	glm::vec3 gridPosition = glm::clamp((_position - m_Bounds.Min) / m_CellSize, glm::vec3(0), glm::vec3(m_Resolution - 1));
+	glm::ivec3 baseProbe = glm::min(glm::ivec3(gridPosition), glm::max(m_Resolution - 2, glm::ivec3(0)));
+	glm::vec3 fraction = glm::clamp(gridPosition - glm::vec3(baseProbe), glm::vec3(0), glm::vec3(1));
+
+	glm::vec3 irradiance{ 0,0,0 };
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::ivec3 offset{ corner & 1, (corner >> 1) & 1, (corner >> 2) & 1 };
+		glm::ivec3 probe = glm::min(baseProbe + offset, m_Resolution - 1);
+		glm::vec3 weights = glm::mix(1.0f - fraction, fraction, glm::vec3(offset));
+		float weight = weights.x * weights.y * weights.z;
+
+		int probeIndex = probe.x + m_Resolution.x * (probe.y + m_Resolution.y * probe.z);
+		for (int i = 0; i < CoefficientCount; i++)
+		{
+			irradiance += weight * basis[i] * glm::vec3(m_Coefficients[probeIndex * CoefficientCount + i]);
+		}
+	}
+	return glm::max(irradiance, glm::vec3(0));
+}
+
+bool IrradianceVolume::IsLoaded()
+{
+	return m_Coefficients.size() > 0;
+}
+
+AABB IrradianceVolume::GetBounds()
+{
+	return m_Bounds;
+}
+
+glm::ivec3 IrradianceVolume::GetResolution()
+{
+	return m_Resolution;
+}
+
+glm::vec3 IrradianceVolume::GetCellSize()
+{
+	return m_CellSize;
+}
+
+double IrradianceVolume::GetBakeTime()
+{
+	return m_BakeTime;
+}
+
+void IrradianceVolume::BakeProbes(int _firstProbe, int _lastProbe)
+{
+	float basis[CoefficientCount];
+	float sampleWeight = 4.0f * glm::pi<float>() / m_SampleDirections.size();
+
+	// Convolving radiance with the clamped cosine scales each band, 1/pi turns irradiance into the lighting the shaders add
+	const float bandScales[CoefficientCount]{ 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+
+	for (int probeIndex = _firstProbe; probeIndex < _lastProbe; probeIndex++)
+	{
+		glm::ivec3 probe{ probeIndex % m_Resolution.x, (probeIndex / m_Resolution.x) % m_Resolution.y, probeIndex / (m_Resolution.x * m_Resolution.y) };
+		glm::vec3 position = m_Bounds.Min + glm::vec3(probe) * m_CellSize;
+		glm::vec3 coefficients[CoefficientCount]{};
+
+		// Incoming radiance from the sky and bounced off static surfaces
+		for (auto& direction : m_SampleDirections)
+		{
+			glm::vec3 radiance = m_SkyColor;
+			RaycastHit hit{};
+			if (GameObject::RayCastScene(m_StaticTree, Ray{ position, direction, FLT_MAX }, hit))
+			{
+				// Back faces mean the probe is inside geometry and sees no light
+				radiance = glm::vec3(0);
+				if (glm::dot(hit.Normal, direction) < 0.0f)
+					radiance = m_Settings.Albedo * ShadeSurface(hit.Position + hit.Normal * m_Settings.RayBias, hit.Normal);
+			}
+
+			EvaluateBasis(direction, basis);
+			for (int i = 0; i < CoefficientCount; i++)
+			{
+				coefficients[i] += radiance * basis[i] * sampleWeight;
+			}
+		}
+
+		// Static lights arrive from a single direction, pi undoes the 1/pi so they match a dynamic light
+		for (auto& light : m_Lights)
+		{
+			glm::vec3 toLight{};
+			float distance = 0.0f;
+			glm::vec3 intensity = CalculateLightIntensity(light, position, toLight, distance);
+			if (intensity == glm::vec3(0) || !IsVisible(Ray{ position, toLight, distance - m_Settings.RayBias }))
+				continue;
+
+			EvaluateBasis(toLight, basis);
+			for (int i = 0; i < CoefficientCount; i++)
+			{
+				coefficients[i] += glm::pi<float>() * intensity * basis[i];
+			}
+		}
+
+		for (int i = 0; i < CoefficientCount; i++)
+		{
+			m_Coefficients[probeIndex * CoefficientCount + i] = { coefficients[i] * bandScales[i], 0.0f };
+		}
+	}
+}
+
+glm::vec3 IrradianceVolume::CalculateLightIntensity(const BakeLight& _light, glm::vec3 _position, glm::vec3& _toLight, float& _distance)
+{
+	_distance = glm::length(_light.Position - _position);
+	if (_distance >= _light.Radius || _distance <= 0.0f)
+		return { 0,0,0 };
+	_toLight = (_light.Position - _position) / _distance;
+
+	// Same falloff as the lit shaders
+	float attenuation = 1.0f + _light.AttenuationLinear * _distance + _light.AttenuationExponent * _distance * _distance;
+	float window = glm::clamp(1.0f - std::pow(_distance / _light.Radius, 4.0f), 0.0f, 1.0f);
+	float intensity = window * window / attenuation;
+
+	if (_light.CosOuterCutoff > -1.5f)
+	{
+		float theta = glm::dot(-_toLight, _light.Direction);
+		intensity *= glm::clamp((theta - _light.CosOuterCutoff) / std::max(_light.CosInnerCutoff - _light.CosOuterCutoff, 0.0001f), 0.0f, 1.0f);
+	}
+	return _light.Color * intensity;
+}
+
+glm::vec3 IrradianceVolume::ShadeSurface(glm::vec3 _position, glm::vec3 _normal)
+{
+	glm::vec3 lighting = m_SkyColor;
+	for (auto& light : m_Lights)
+	{
+		glm::vec3 toLight{};
+		float distance = 0.0f;
+		glm::vec3 intensity = CalculateLightIntensity(light, _position, toLight, distance);
+		float strength = glm::dot(_normal, toLight);
+		if (strength > 0.0f && intensity != glm::vec3(0) && IsVisible(Ray{ _position, toLight, distance - m_Settings.RayBias }))
+			lighting += intensity * strength;
+	}
+
+	if (m_HasSun)
+	{
+		float strength = glm::dot(_normal, -m_Sun.Direction);
+		if (strength > 0.0f && IsVisible(Ray{ _position, -m_Sun.Direction, FLT_MAX }))
+			lighting += m_Sun.Color * strength;
+	}
+	return lighting;
+}
+
+bool IrradianceVolume::IsVisible(const Ray& _ray)
+{
+	if (_ray.MaxDistance <= 0.0f)
+		return true;
+
+	bool isBlocked = false;
+	m_StaticTree.RayCast(_ray, [&](int _proxyID, const Ray& _clippedRay)
+		{
+			GameObject* gameObject = (GameObject*)m_StaticTree.GetUserData(_proxyID);
+			RaycastHit hit{};
+			if (gameObject && gameObject->RayCast(_clippedRay, hit))
+			{
+				// Any hit will do, stop the ray cast
+				isBlocked = true;
+				return 0.0f;
+			}
+			return _clippedRay.MaxDistance;
+		});
+	return !isBlocked;
+}
+
+void IrradianceVolume::EvaluateBasis(glm::vec3 _direction, float _basis[CoefficientCount])
+{
+	float x = _direction.x;
+	float y = _direction.y;
+	float z = _direction.z;
+	_basis[0] = 0.282095f;
+	_basis[1] = 0.488603f * y;
+	_basis[2] = 0.488603f * z;
+	_basis[3] = 0.488603f * x;
+	_basis[4] = 1.092548f * x * y;
+	_basis[5] = 1.092548f * y * z;
+	_basis[6] = 0.315392f * (3.0f * z * z - 1.0f);
+	_basis[7] = 1.092548f * x * z;
+	_basis[8] = 0.546274f * (x * x - y * y);
+}
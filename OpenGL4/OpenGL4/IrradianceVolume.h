@@ -0,0 +1,194 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : IrradianceVolume.h 
+// Description : IrradianceVolume Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "GameObject.h"
+
+/// <summary>
+/// Settings for baking an irradiance volume.
+/// Probes sit on the corners of a Resolution sized grid spanning Bounds.
+/// A ThreadCount of 0 uses every hardware thread.
+/// </summary>
+struct IrradianceBakeSettings
+{
+	AABB Bounds{ { -30.0f, -2.0f, -40.0f }, { 30.0f, 12.0f, 20.0f } };
+	glm::ivec3 Resolution{ 12, 4, 12 };
+	int SampleCount = 256;
+	float Albedo = 0.6f;
+	float RayBias = 0.01f;
+	int ThreadCount = 0;
+};
+
+/// <summary>
+/// A grid of L2 spherical harmonic irradiance probes baked from static gameobjects and static lights.
+/// Each probe stores 9 RGB coefficients with the cosine lobe and 1/pi already applied,
+/// so shading a normal is a 9 term dot product and the grid is blended trilinearly.
+/// The sky is the ambient light, static point and spot lights are baked direct and bounced,
+/// the sun only bounces since its direct light stays dynamic and shadowed.
+/// </summary>
+class IrradianceVolume
+{
+public:
+	/// <summary>
+	/// IrradianceVolume Constructor
+	/// </summary>
+	IrradianceVolume();
+
+	/// <summary>
+	/// IrradianceVolume Destructor
+	/// </summary>
+	~IrradianceVolume();
+
+	/// <summary>
+	/// Ray traces the static gameobjects and lights into the probe grid on the CPU.
+	/// Returns false if the settings ask for no probes or samples.
+	/// </summary>
+	/// <param name="_gameObjects"></param>
+	/// <param name="_lightManager"></param>
+	/// <param name="_settings"></param>
+	/// <returns></returns>
+	bool Bake(const std::vector<GameObject*>& _gameObjects, LightManager& _lightManager, const IrradianceBakeSettings& _settings = {});
+
+	/// <summary>
+	/// Saves the probes as half floats to a binary file.
+	/// </summary>
+	/// <param name="_filePath"></param>
+	/// <returns></returns>
+	bool Save(std::string_view _filePath);
+
+	/// <summary>
+	/// Loads probes saved by Save.
+	/// </summary>
+	/// <param name="_filePath"></param>
+	/// <returns></returns>
+	bool Load(std::string_view _filePath);
+
+	/// <summary>
+	/// Uploads the probes to the probe buffer and binds it.
+	/// </summary>
+	void Upload();
+
+	/// <summary>
+	/// Evaluates the blended irradiance at a position for a normal, matching the shaders.
+	/// </summary>
+	/// <param name="_position"></param>
+	/// <param name="_normal"></param>
+	/// <returns></returns>
+	glm::vec3 SampleIrradiance(glm::vec3 _position, glm::vec3 _normal);
+
+	/// <summary>
+	/// Returns true if probes have been baked or loaded.
+	/// </summary>
+	/// <returns></returns>
+	bool IsLoaded();
+
+	/// <summary>
+	/// Returns the bounds of the probe grid.
+	/// </summary>
+	/// <returns></returns>
+	AABB GetBounds();
+
+	/// <summary>
+	/// Returns the number of probes along each axis.
+	/// </summary>
+	/// <returns></returns>
+	glm::ivec3 GetResolution();
+
+	/// <summary>
+	/// Returns the distance between neighbouring probes.
+	/// </summary>
+	/// <returns></returns>
+	glm::vec3 GetCellSize();
+
+	/// <summary>
+	/// Returns how long the last bake took in milliseconds.
+	/// </summary>
+	/// <returns></returns>
+	double GetBakeTime();
+
+	static const GLuint ProbeBinding = 7;
+	static const int CoefficientCount = 9;
+
+	// Element of the ProbeBuffer block in CelLighting.glsl
+	using ProbeCoefficientLayout = BufferLayout<LayoutStandard::Std430, glm::vec4>;
+
+private:
+	/// <summary>
+	/// A static light in the form the baker shades with.
+	/// </summary>
+	struct BakeLight
+	{
+		glm::vec3 Position{ 0,0,0 };
+		glm::vec3 Color{ 0,0,0 };
+		glm::vec3 Direction{ 0,0,-1 };
+		float AttenuationLinear = 0.0f;
+		float AttenuationExponent = 0.0f;
+		float Radius = 0.0f;
+		float CosInnerCutoff = -2.0f;
+		float CosOuterCutoff = -2.0f;
+	};
+
+	/// <summary>
+	/// Bakes the probes in [_firstProbe, _lastProbe).
+	/// </summary>
+	/// <param name="_firstProbe"></param>
+	/// <param name="_lastProbe"></param>
+	void BakeProbes(int _firstProbe, int _lastProbe);
+
+	/// <summary>
+	/// Returns the unshadowed intensity of a light at a position, and the direction to it.
+	/// </summary>
+	/// <param name="_light"></param>
+	/// <param name="_position"></param>
+	/// <param name="_toLight"></param>
+	/// <param name="_distance"></param>
+	/// <returns></returns>
+	glm::vec3 CalculateLightIntensity(const BakeLight& _light, glm::vec3 _position, glm::vec3& _toLight, float& _distance);
+
+	/// <summary>
+	/// Returns the diffuse light leaving a static surface point.
+	/// </summary>
+	/// <param name="_position"></param>
+	/// <param name="_normal"></param>
+	/// <returns></returns>
+	glm::vec3 ShadeSurface(glm::vec3 _position, glm::vec3 _normal);
+
+	/// <summary>
+	/// Returns true if nothing static blocks the ray before its max distance.
+	/// </summary>
+	/// <param name="_ray"></param>
+	/// <returns></returns>
+	bool IsVisible(const Ray& _ray);
+
+	/// <summary>
+	/// Fills the 9 L2 basis functions for a unit direction.
+	/// </summary>
+	/// <param name="_direction"></param>
+	/// <param name="_basis"></param>
+	static void EvaluateBasis(glm::vec3 _direction, float _basis[CoefficientCount]);
+
+	AABB m_Bounds{};
+	glm::ivec3 m_Resolution{ 0,0,0 };
+	glm::vec3 m_CellSize{ 1,1,1 };
+
+	// CoefficientCount per probe, rgb with w unused to match the std430 buffer
+	std::vector<glm::vec4> m_Coefficients{};
+	GLuint m_BufferID{ 0 };
+	double m_BakeTime{ 0.0 };
+
+	// Bake only
+	IrradianceBakeSettings m_Settings{};
+	AABBTree m_StaticTree{ 0.0f };
+	std::vector<BakeLight> m_Lights{};
+	BakeLight m_Sun{};
+	bool m_HasSun{ false };
+	glm::vec3 m_SkyColor{ 0,0,0 };
+	std::vector<glm::vec3> m_SampleDirections{};
+};
@@ -0,0 +1,254 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : KTX2.cpp 
+// Description : KTX2 Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "KTX2.h"
+#include "BlockCompressor.h"
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	// Colour models of the Khronos data format descriptor
+	const uint8_t ModelRGBSDA = 1;
+	const uint8_t ModelBC1A = 128;
+	const uint8_t ModelBC3 = 130;
+	const uint8_t ModelBC5 = 132;
+	const uint8_t ModelBC7 = 134;
+
+	/// <summary>
+	/// How a format is described in the container. Uncompressed formats have no GL format, only a channel count.
+	/// </summary>
+	struct FormatInfo
+	{
+		GLenum GLFormat = 0;
+		uint32_t VkFormat = 0;
+		int Components = 0;
+		uint8_t ColorModel = 0;
+	};
+
+	const FormatInfo Formats[]{
+		{ 0, 9, 1, ModelRGBSDA }, // VK_FORMAT_R8_UNORM
+		{ 0, 16, 2, ModelRGBSDA }, // VK_FORMAT_R8G8_UNORM
+		{ 0, 23, 3, ModelRGBSDA }, // VK_FORMAT_R8G8B8_UNORM
+		{ 0, 37, 4, ModelRGBSDA }, // VK_FORMAT_R8G8B8A8_UNORM
+		{ GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 131, 3, ModelBC1A }, // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		{ GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 137, 4, ModelBC3 }, // VK_FORMAT_BC3_UNORM_BLOCK
+		{ GL_COMPRESSED_RG_RGTC2, 141, 2, ModelBC5 }, // VK_FORMAT_BC5_UNORM_BLOCK
+		{ GL_COMPRESSED_RGBA_BPTC_UNORM, 145, 4, ModelBC7 }, // VK_FORMAT_BC7_UNORM_BLOCK
+	};
+
+	const unsigned char Identifier[12]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	// The identifier, the header and the index before the level index
+	const size_t LevelIndexOffset = 80;
+	const size_t LevelIndexEntrySize = 24;
+
+	const FormatInfo* FindFormat(const ImageData& _image)
+	{
+		for (auto& format : Formats)
+		{
+			if (format.GLFormat == _image.Format && (_image.Format != 0 || format.Components == _image.Components))
+				return &format;
+		}
+		return nullptr;
+	}
+
+	const FormatInfo* FindFormat(uint32_t _vkFormat)
+	{
+		for (auto& format : Formats)
+		{
+			if (format.VkFormat == _vkFormat)
+				return &format;
+		}
+		return nullptr;
+	}
+
+	template<typename T>
+	void WriteValue(std::vector<unsigned char>& _output, T _value)
+	{
+		_output.insert(_output.end(), (const unsigned char*)&_value, (const unsigned char*)&_value + sizeof(T));
+	}
+
+	template<typename T>
+	T ReadValue(const unsigned char* _data)
+	{
+		T value{};
+		std::memcpy(&value, _data, sizeof(T));
+		return value;
+	}
+
+	// The basic descriptor block, with one sample per channel of a texel or per 64 bit half of a block
+	void WriteDataFormat(const FormatInfo& _format, std::vector<unsigned char>& _output)
+	{
+		struct Sample
+		{
+			uint32_t BitOffset = 0;
+			uint32_t BitLength = 0;
+			uint32_t Channel = 0;
+		};
+
+		std::vector<Sample> samples{};
+		switch (_format.ColorModel)
+		{
+		case ModelBC1A:
+			samples = { { 0, 64, 0 } };
+			break;
+		case ModelBC3:
+			samples = { { 0, 64, 15 }, { 64, 64, 0 } };
+			break;
+		case ModelBC5:
+			samples = { { 0, 64, 0 }, { 64, 64, 1 } };
+			break;
+		case ModelBC7:
+			samples = { { 0, 128, 0 } };
+			break;
+		default:
+			for (int channel = 0; channel < _format.Components; channel++)
+			{
+				samples.push_back({ (uint32_t)channel * 8, 8, channel == 3 ? 15u : (uint32_t)channel });
+			}
+			break;
+		}
+
+		bool isCompressed = _format.GLFormat != 0;
+		uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+		WriteValue<uint32_t>(_output, 4 + blockSize);
+		// Khronos vendor and basic descriptor type, then version 1.3 of the data format
+		WriteValue<uint32_t>(_output, 0);
+		WriteValue<uint32_t>(_output, 2 | blockSize << 16);
+		// BT.709 primaries, linear transfer and straight alpha
+		WriteValue<uint32_t>(_output, _format.ColorModel | 1 << 8 | 1 << 16);
+		// Block dimensions minus 1, then the bytes in the only plane
+		WriteValue<uint32_t>(_output, isCompressed ? 3 | 3 << 8 : 0);
+		WriteValue<uint32_t>(_output, isCompressed ? BlockCompressor::GetBlockBytes(_format.GLFormat) : _format.Components);
+		WriteValue<uint32_t>(_output, 0);
+		for (auto& sample : samples)
+		{
+			WriteValue<uint32_t>(_output, sample.BitOffset | (sample.BitLength - 1) << 16 | sample.Channel << 24);
+			WriteValue<uint32_t>(_output, 0);
+			WriteValue<uint32_t>(_output, 0);
+			WriteValue<uint32_t>(_output, isCompressed ? 0xFFFFFFFF : 255);
+		}
+	}
+
+	// A length, the key and value each ending in a zero, then padding to 4 bytes that the length leaves out
+	void WriteKeyValue(std::vector<unsigned char>& _output, std::string_view _key, std::string_view _value)
+	{
+		WriteValue<uint32_t>(_output, (uint32_t)(_key.size() + _value.size() + 2));
+		_output.insert(_output.end(), _key.begin(), _key.end());
+		_output.push_back(0);
+		_output.insert(_output.end(), _value.begin(), _value.end());
+		_output.push_back(0);
+		while (_output.size() % 4 != 0)
+		{
+			_output.push_back(0);
+		}
+	}
+}
+
+bool KTX2::Read(const FileData& _file, ImageData& _image)
+{
+	const unsigned char* data = _file.GetData();
+	size_t size = _file.GetSize();
+	if (!_file.IsValid() || size < LevelIndexOffset || std::memcmp(data, Identifier, sizeof(Identifier)) != 0)
+		return false;
+
+	const FormatInfo* format = FindFormat(ReadValue<uint32_t>(data + 12));
+	uint32_t width = ReadValue<uint32_t>(data + 20);
+	uint32_t height = ReadValue<uint32_t>(data + 24);
+	uint32_t depth = ReadValue<uint32_t>(data + 28);
+	uint32_t layerCount = ReadValue<uint32_t>(data + 32);
+	uint32_t faceCount = ReadValue<uint32_t>(data + 36);
+	uint32_t levelCount = std::max(ReadValue<uint32_t>(data + 40), 1u);
+	uint32_t supercompression = ReadValue<uint32_t>(data + 44);
+	if (!format || width == 0 || height == 0 || width > 65536 || height > 65536 || depth != 0 || layerCount != 0 || faceCount != 1
+		|| supercompression != 0 || levelCount > 17 || LevelIndexOffset + levelCount * LevelIndexEntrySize > size)
+		return false;
+
+	_image.Size = { (int)width, (int)height };
+	_image.Components = format->Components;
+	_image.Format = format->GLFormat;
+	_image.Storage.clear();
+	_image.Levels.resize(levelCount);
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		const unsigned char* entry = data + LevelIndexOffset + level * LevelIndexEntrySize;
+		uint64_t offset = ReadValue<uint64_t>(entry);
+		uint64_t length = ReadValue<uint64_t>(entry + 8);
+		if (length != AssetCooker::GetLevelBytes(_image, (int)level) || offset > size || length > size - offset)
+			return false;
+		_image.Levels[level] = data + offset;
+	}
+	return true;
+}
+
+bool KTX2::Write(const ImageData& _image, bool _isFlipped, std::vector<unsigned char>& _output)
+{
+	const FormatInfo* format = FindFormat(_image);
+	if (!format || _image.Levels.empty())
+		return false;
+
+	std::vector<unsigned char> dataFormat{};
+	WriteDataFormat(*format, dataFormat);
+	std::vector<unsigned char> keyValues{};
+	WriteKeyValue(keyValues, "KTXorientation", _isFlipped ? "ru" : "rd");
+	WriteKeyValue(keyValues, "KTXwriter", "OpenGL4 AssetCooker");
+
+	// Levels are stored smallest first, each aligned to both its block or texel size and 4 bytes
+	uint32_t levelCount = (uint32_t)_image.Levels.size();
+	size_t dataFormatOffset = LevelIndexOffset + levelCount * LevelIndexEntrySize;
+	size_t keyValueOffset = dataFormatOffset + dataFormat.size();
+	size_t alignment = std::lcm((size_t)(_image.Format != 0 ? BlockCompressor::GetBlockBytes(_image.Format) : _image.Components), (size_t)4);
+	std::vector<uint64_t> levelOffsets(levelCount);
+	size_t fileSize = keyValueOffset + keyValues.size();
+	for (int level = (int)levelCount - 1; level >= 0; level--)
+	{
+		fileSize = (fileSize + alignment - 1) / alignment * alignment;
+		levelOffsets[level] = fileSize;
+		fileSize += AssetCooker::GetLevelBytes(_image, level);
+	}
+
+	size_t start = _output.size();
+	_output.reserve(start + fileSize);
+	_output.insert(_output.end(), Identifier, Identifier + sizeof(Identifier));
+	WriteValue<uint32_t>(_output, format->VkFormat);
+	WriteValue<uint32_t>(_output, 1);
+	WriteValue<uint32_t>(_output, (uint32_t)_image.Size.x);
+	WriteValue<uint32_t>(_output, (uint32_t)_image.Size.y);
+	WriteValue<uint32_t>(_output, 0);
+	WriteValue<uint32_t>(_output, 0);
+	WriteValue<uint32_t>(_output, 1);
+	WriteValue<uint32_t>(_output, levelCount);
+	WriteValue<uint32_t>(_output, 0);
+
+	WriteValue<uint32_t>(_output, (uint32_t)dataFormatOffset);
+	WriteValue<uint32_t>(_output, (uint32_t)dataFormat.size());
+	WriteValue<uint32_t>(_output, (uint32_t)keyValueOffset);
+	WriteValue<uint32_t>(_output, (uint32_t)keyValues.size());
+	WriteValue<uint64_t>(_output, 0);
+	WriteValue<uint64_t>(_output, 0);
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		uint64_t length = AssetCooker::GetLevelBytes(_image, (int)level);
+		WriteValue<uint64_t>(_output, levelOffsets[level]);
+		WriteValue<uint64_t>(_output, length);
+		WriteValue<uint64_t>(_output, length);
+	}
+	_output.insert(_output.end(), dataFormat.begin(), dataFormat.end());
+	_output.insert(_output.end(), keyValues.begin(), keyValues.end());
+
+	for (int level = (int)levelCount - 1; level >= 0; level--)
+	{
+		_output.resize(start + levelOffsets[level], 0);
+		_output.insert(_output.end(), _image.Levels[level], _image.Levels[level] + AssetCooker::GetLevelBytes(_image, level));
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : KTX2.h 
+// Description : KTX2 Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "AssetCooker.h"
+
+/// <summary>
+/// Reads and writes 2D textures with their mip chains in the KTX 2.0 container, the format cooked textures are stored in.
+/// BC1, BC3, BC5 and BC7 textures and 8 bit textures of 1 to 4 channels are supported,
+/// supercompressed files, arrays, cubemaps and 3D textures are not.
+/// Files are written with the first row at the bottom, as OpenGL expects, and say so in their KTXorientation,
+/// which reading does not act on, so hand made files have to be flipped when they are authored.
+/// </summary>
+class KTX2
+{
+public:
+	/// <summary>
+	/// Reads a texture without copying its levels, which point into the file, returning false if it is not a supported KTX2 file.
+	/// </summary>
+	/// <param name="_file"></param>
+	/// <param name="_image"></param>
+	/// <returns></returns>
+	static bool Read(const FileData& _file, ImageData& _image);
+
+	/// <summary>
+	/// Writes a texture and every level it has, returning false if its format cannot be stored.
+	/// </summary>
+	/// <param name="_image"></param>
+	/// <param name="_isFlipped"> The first row is the bottom of the image </param>
+	/// <param name="_output"></param>
+	/// <returns></returns>
+	static bool Write(const ImageData& _image, bool _isFlipped, std::vector<unsigned char>& _output);
+};
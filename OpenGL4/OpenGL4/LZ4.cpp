@@ -0,0 +1,191 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : LZ4.cpp 
+// Description : LZ4 Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "LZ4.h"
+#include <cstring>
+
+size_t LZ4::GetCompressBound(size_t _size)
+{
+	return _size + _size / 255 + 16;
+}
+
+size_t LZ4::GetDecompressBound(size_t _compressedSize)
+{
+	return _compressedSize * 255 + 16;
+}
+
+size_t LZ4::Compress(const unsigned char* _source, size_t _sourceSize, unsigned char* _destination, size_t _capacity)
+{
+	std::vector<int64_t> table((size_t)1 << HashBits, -1);
+	size_t anchor = 0;
+	size_t output = 0;
+
+	// Blocks shorter than the match limit are stored as a single run of literals
+	if (_sourceSize > MatchLimit)
+	{
+		size_t position = 0;
+		while (position + MatchLimit < _sourceSize)
+		{
+			uint32_t sequence = 0;
+			std::memcpy(&sequence, _source + position, sizeof(sequence));
+			uint32_t hash = (sequence * 2654435761u) >> (32 - HashBits);
+			int64_t candidate = table[hash];
+			table[hash] = (int64_t)position;
+
+			uint32_t candidateSequence = 0;
+			if (candidate >= 0)
+				std::memcpy(&candidateSequence, _source + candidate, sizeof(candidateSequence));
+			if (candidate < 0 || position - (size_t)candidate > MaxOffset || candidateSequence != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			size_t matchLength = MinMatch;
+			size_t matchEnd = _sourceSize - LastLiterals;
+			while (position + matchLength < matchEnd && _source[candidate + matchLength] == _source[position + matchLength])
+			{
+				matchLength++;
+			}
+
+			// Token, literal length, literals, offset, match length
+			size_t literalLength = position - anchor;
+			if (output + 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1 > _capacity)
+				return 0;
+
+			size_t tokenPosition = output++;
+			unsigned char token = 0;
+			if (literalLength >= 15)
+			{
+				token = 15 << 4;
+				WriteLength(literalLength - 15, _destination, output);
+			}
+			else
+			{
+				token = (unsigned char)(literalLength << 4);
+			}
+			std::memcpy(_destination + output, _source + anchor, literalLength);
+			output += literalLength;
+
+			size_t offset = position - (size_t)candidate;
+			_destination[output++] = (unsigned char)(offset & 0xFF);
+			_destination[output++] = (unsigned char)(offset >> 8);
+
+			size_t storedMatchLength = matchLength - MinMatch;
+			if (storedMatchLength >= 15)
+			{
+				token |= 15;
+				WriteLength(storedMatchLength - 15, _destination, output);
+			}
+			else
+			{
+				token |= (unsigned char)storedMatchLength;
+			}
+			_destination[tokenPosition] = token;
+
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	// The last sequence is literals only
+	size_t literalLength = _sourceSize - anchor;
+	if (output + 1 + literalLength / 255 + 1 + literalLength > _capacity)
+		return 0;
+	size_t tokenPosition = output++;
+	if (literalLength >= 15)
+	{
+		_destination[tokenPosition] = 15 << 4;
+		WriteLength(literalLength - 15, _destination, output);
+	}
+	else
+	{
+		_destination[tokenPosition] = (unsigned char)(literalLength << 4);
+	}
+	std::memcpy(_destination + output, _source + anchor, literalLength);
+	output += literalLength;
+	return output;
+}
+
+bool LZ4::Decompress(const unsigned char* _source, size_t _sourceSize, unsigned char* _destination, size_t _destinationSize)
+{
+	size_t input = 0;
+	size_t output = 0;
+	while (input < _sourceSize)
+	{
+		unsigned char token = _source[input++];
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !ReadLength(_source, _sourceSize, input, literalLength))
+			return false;
+		if (literalLength > _sourceSize - input || literalLength > _destinationSize - output)
+			return false;
+		std::memcpy(_destination + output, _source + input, literalLength);
+		input += literalLength;
+		output += literalLength;
+
+		// Only the last sequence ends without a match
+		if (input == _sourceSize)
+			break;
+
+		if (_sourceSize - input < 2)
+			return false;
+		size_t offset = _source[input] | ((size_t)_source[input + 1] << 8);
+		input += 2;
+		if (offset == 0 || offset > output)
+			return false;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadLength(_source, _sourceSize, input, matchLength))
+			return false;
+		matchLength += MinMatch;
+		if (matchLength > _destinationSize - output)
+			return false;
+
+		// Matches may overlap what they are copying, which repeats the last offset bytes
+		unsigned char* match = _destination + output - offset;
+		if (offset >= matchLength)
+		{
+			std::memcpy(_destination + output, match, matchLength);
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; i++)
+			{
+				_destination[output + i] = match[i];
+			}
+		}
+		output += matchLength;
+	}
+	return output == _destinationSize;
+}
+
+void LZ4::WriteLength(size_t _length, unsigned char* _destination, size_t& _position)
+{
+	while (_length >= 255)
+	{
+		_destination[_position++] = 255;
+		_length -= 255;
+	}
+	_destination[_position++] = (unsigned char)_length;
+}
+
+bool LZ4::ReadLength(const unsigned char* _source, size_t _sourceSize, size_t& _position, size_t& _length)
+{
+	unsigned char byte = 255;
+	while (byte == 255)
+	{
+		if (_position >= _sourceSize)
+			return false;
+		byte = _source[_position++];
+		_length += byte;
+	}
+	return true;
+}
@@ -0,0 +1,83 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : LZ4.h 
+// Description : LZ4 Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// Compression in the LZ4 block format, used for the files of asset packs.
+/// The compressor is a single pass greedy matcher, fast enough to pack the resources at build time,
+/// and the decompressor checks every length and offset so a corrupt pack fails instead of overrunning.
+/// </summary>
+class LZ4
+{
+public:
+	/// <summary>
+	/// Returns the largest compressed size of _size bytes, for sizing the destination.
+	/// </summary>
+	/// <param name="_size"></param>
+	/// <returns></returns>
+	static size_t GetCompressBound(size_t _size);
+
+	/// <summary>
+	/// Returns the largest size a block of _compressedSize bytes can expand to.
+	/// Each byte of a saturated length continuation adds at most 255 bytes, so no block expands further than that.
+	/// </summary>
+	/// <param name="_compressedSize"></param>
+	/// <returns></returns>
+	static size_t GetDecompressBound(size_t _compressedSize);
+
+	/// <summary>
+	/// Compresses _source into _destination and returns the compressed size, or 0 if it did not fit.
+	/// </summary>
+	/// <param name="_source"></param>
+	/// <param name="_sourceSize"></param>
+	/// <param name="_destination"></param>
+	/// <param name="_capacity"></param>
+	/// <returns></returns>
+	static size_t Compress(const unsigned char* _source, size_t _sourceSize, unsigned char* _destination, size_t _capacity);
+
+	/// <summary>
+	/// Decompresses a block that expands to exactly _destinationSize bytes.
+	/// Returns false if the block is malformed or does not expand to that size.
+	/// </summary>
+	/// <param name="_source"></param>
+	/// <param name="_sourceSize"></param>
+	/// <param name="_destination"></param>
+	/// <param name="_destinationSize"></param>
+	/// <returns></returns>
+	static bool Decompress(const unsigned char* _source, size_t _sourceSize, unsigned char* _destination, size_t _destinationSize);
+
+private:
+	static const int HashBits = 16;
+	static const size_t MinMatch = 4;
+	// The block format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end
+	static const size_t LastLiterals = 5;
+	static const size_t MatchLimit = 12;
+	static const size_t MaxOffset = 65535;
+
+	/// <summary>
+	/// Writes the 255 byte continuation of a length whose 4 bit field was saturated.
+	/// </summary>
+	/// <param name="_length"> The length minus the 15 already in the token </param>
+	/// <param name="_destination"></param>
+	/// <param name="_position"></param>
+	static void WriteLength(size_t _length, unsigned char* _destination, size_t& _position);
+
+	/// <summary>
+	/// Reads the continuation of a saturated length, returning false if the block ends first.
+	/// </summary>
+	/// <param name="_source"></param>
+	/// <param name="_sourceSize"></param>
+	/// <param name="_position"></param>
+	/// <param name="_length"></param>
+	/// <returns></returns>
+	static bool ReadLength(const unsigned char* _source, size_t _sourceSize, size_t& _position, size_t& _length);
+};
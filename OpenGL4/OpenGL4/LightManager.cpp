@@ -9,6 +9,7 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "LightManager.h"
+#include "GLState.h"
 
 LightManager::LightManager(Camera& _activeCamera, int _maxPointLights, int _maxDirectionalLights, int _maxSpotLights)
 {
@@ -34,14 +35,13 @@ void LightManager::Draw()
 	if (m_LightMesh)
 	{
 		// For Each PointLight, Draw An Unlit Mesh With The Same Color
-		glUseProgram(m_UnlitMeshShaderID);
+		GLState::SetPipeline(PipelineState{}, m_UnlitMeshShaderID);
 		for (auto& light : m_PointLights)
 		{
-			ShaderLoader::SetUniformMatrix4fv(std::move(m_UnlitMeshShaderID), "PVMMatrix", m_ActiveCamera->GetPVMatrix() * glm::translate(glm::mat4(1), light.Position));
-			ShaderLoader::SetUniform3fv(std::move(m_UnlitMeshShaderID), "Color", light.Color);
-			StaticMesh::Meshes[0]->Draw();
+			ShaderLoader::SetUniformMatrix4fv(std::move(m_UnlitMeshShaderID), "PVMMatrix"_id, m_ActiveCamera->GetPVMatrix() * glm::translate(glm::mat4(1), light.Position));
+			ShaderLoader::SetUniform3fv(std::move(m_UnlitMeshShaderID), "Color"_id, light.Color);
+			m_LightMesh->Draw();
 		}
-		glUseProgram(0);
 	}
 }
 
@@ -150,3 +150,167 @@ void LightManager::CaptureMoment(int _lightIndex, KEYMAP& _keyMap)
 		}
 	}
 }
+
+
+void LightManager::UpdateLightClusters()
+{
+	m_ClusterLights.clear();
+	for (auto& light : m_PointLights)
+	{
+		// Already in the irradiance probes
+		if (light.IsStatic && m_IsBakedLightingEnabled)
+			continue;
+
+		ClusterLight clusterLight{};
+		float radius = light.Radius > 0.0f ? light.Radius : CalculateInfluenceRadius(light.Color, light.SpecularStrength, light.AttenuationLinear, light.AttenuationExponent);
+		clusterLight.PositionRadius = { light.Position, radius };
+		clusterLight.ColorSpecular = { light.Color, light.SpecularStrength };
+		clusterLight.AttenuationInnerCutoff = { light.AttenuationLinear, light.AttenuationExponent, -2.0f, 0.0f };
+		m_ClusterLights.push_back(clusterLight);
+	}
+	for (auto& light : m_SpotLights)
+	{
+		if (light.IsStatic && m_IsBakedLightingEnabled)
+			continue;
+
+		ClusterLight clusterLight{};
+		glm::vec3 position = light.IsAttachedToCamera ? m_ActiveCamera->GetPosition() : light.Position;
+		glm::vec3 direction = light.IsAttachedToCamera ? m_ActiveCamera->GetFront() : light.Direction;
+		float radius = light.Radius > 0.0f ? light.Radius : CalculateInfluenceRadius(light.Color, light.SpecularStrength, light.AttenuationLinear, light.AttenuationExponent);
+		clusterLight.PositionRadius = { position, radius };
+		clusterLight.ColorSpecular = { light.Color, light.SpecularStrength };
+		clusterLight.DirectionOuterCutoff = { glm::normalize(direction), glm::cos(glm::radians(light.OuterCutoff)) };
+		clusterLight.AttenuationInnerCutoff = { light.AttenuationLinear, light.AttenuationExponent, glm::cos(glm::radians(light.Cutoff)), 0.0f };
+		m_ClusterLights.push_back(clusterLight);
+	}
+
+	UpdateLightTree();
+	m_Clusters.Build(m_ClusterLights, m_ActiveCamera->GetViewMatrix(), m_ActiveCamera->GetProjectionMatrix(), { m_ActiveCamera->GetNearPlane(), m_ActiveCamera->GetFarPlane() }, m_ActiveCamera->GetWindowSize());
+	m_Clusters.Upload();
+	m_Clusters.Bind();
+}
+
+void LightManager::SetAmbientLight(glm::vec3 _color, float _strength)
+{
+	m_AmbientColorStrength = { _color, _strength };
+}
+
+glm::vec4 LightManager::GetAmbientLight()
+{
+	return m_AmbientColorStrength;
+}
+
+ClusteredLighting& LightManager::GetClusteredLighting()
+{
+	return m_Clusters;
+}
+
+float LightManager::CalculateInfluenceRadius(glm::vec3 _color, float _specularStrength, float _attenuationLinear, float _attenuationExponent, float _cutoff)
+{
+	// Solve intensity / (1 + linear * d + exponent * d^2) = cutoff for d
+	float intensity = std::max(std::max(_color.r, _color.g), _color.b) * std::max(1.0f, _specularStrength);
+	float constant = 1.0f - intensity / _cutoff;
+	if (constant >= 0.0f)
+		return 0.0f;
+
+	if (_attenuationExponent > 0.0f)
+		return (-_attenuationLinear + std::sqrt(_attenuationLinear * _attenuationLinear - 4.0f * _attenuationExponent * constant)) / (2.0f * _attenuationExponent);
+	if (_attenuationLinear > 0.0f)
+		return -constant / _attenuationLinear;
+
+	// No attenuation reaches everything
+	return FLT_MAX;
+}
+
+void LightManager::GatherObjectLights(const AABB& _bounds, int _maxLights, std::vector<int>& _lightIndices)
+{
+	_lightIndices.clear();
+	m_LightQueryResults.clear();
+	m_LightScores.clear();
+	m_LightTree.QueryAABB(_bounds, m_LightQueryResults);
+
+	// Score by the attenuated brightness at the closest point of the bounds
+	auto scoreLight = [this, &_bounds](int _lightIndex)
+	{
+		ClusterLight& light = m_ClusterLights[_lightIndex];
+		float distanceSquared = DistanceSquaredToAABB(_bounds, glm::vec3(light.PositionRadius));
+		if (distanceSquared > light.PositionRadius.w * light.PositionRadius.w)
+			return;
+
+		float distance = std::sqrt(distanceSquared);
+		float intensity = std::max(std::max(light.ColorSpecular.r, light.ColorSpecular.g), light.ColorSpecular.b) * std::max(1.0f, light.ColorSpecular.w);
+		float attenuation = 1.0f + light.AttenuationInnerCutoff.x * distance + light.AttenuationInnerCutoff.y * distanceSquared;
+		m_LightScores.push_back({ intensity / attenuation, _lightIndex });
+	};
+	for (auto& proxyID : m_LightQueryResults)
+	{
+		scoreLight((int)(intptr_t)m_LightTree.GetUserData(proxyID));
+	}
+	for (auto& lightIndex : m_UnboundedLights)
+	{
+		scoreLight(lightIndex);
+	}
+
+	int count = std::min(_maxLights, (int)m_LightScores.size());
+	std::partial_sort(m_LightScores.begin(), m_LightScores.begin() + count, m_LightScores.end(), [](const std::pair<float, int>& _a, const std::pair<float, int>& _b)
+		{
+			return _a.first > _b.first;
+		});
+	for (int i = 0; i < count; i++)
+	{
+		_lightIndices.push_back(m_LightScores[i].second);
+	}
+}
+
+void LightManager::SetPerObjectLighting(bool _enabled)
+{
+	m_IsPerObjectLightingEnabled = _enabled;
+}
+
+bool LightManager::GetPerObjectLighting()
+{
+	return m_IsPerObjectLightingEnabled;
+}
+
+void LightManager::SetBakedLighting(bool _enabled)
+{
+	m_IsBakedLightingEnabled = _enabled;
+}
+
+bool LightManager::GetBakedLighting()
+{
+	return m_IsBakedLightingEnabled;
+}
+
+void LightManager::UpdateLightTree()
+{
+	// Lights are only added or trimmed, so indices are stable while the count is
+	if (m_LightProxies.size() != m_ClusterLights.size())
+	{
+		m_LightTree.Clear();
+		m_LightProxies.assign(m_ClusterLights.size(), int{ AABBTree::NullNode });
+	}
+
+	m_UnboundedLights.clear();
+	for (int i = 0; i < (int)m_ClusterLights.size(); i++)
+	{
+		glm::vec3 position = glm::vec3(m_ClusterLights[i].PositionRadius);
+		float radius = m_ClusterLights[i].PositionRadius.w;
+
+		// Lights without attenuation reach everything and are kept out of the tree
+		if (radius >= FLT_MAX)
+		{
+			if (m_LightProxies[i] != AABBTree::NullNode)
+				m_LightTree.DestroyProxy(m_LightProxies[i]);
+			m_LightProxies[i] = AABBTree::NullNode;
+			m_UnboundedLights.push_back(i);
+			continue;
+		}
+
+		AABB bounds{ position - radius, position + radius };
+		if (m_LightProxies[i] == AABBTree::NullNode)
+			m_LightProxies[i] = m_LightTree.CreateProxy(bounds, (void*)(intptr_t)i);
+		else
+			m_LightTree.MoveProxy(m_LightProxies[i], bounds);
+	}
+}
@@ -12,6 +12,8 @@
 #include "Helper.h"
 #include "StaticMesh.h"
 #include "Camera.h"
+#include "ClusteredLighting.h"
+#include "AABBTree.h"
 
 /// <summary>
 /// Struct For A Point Light.
@@ -20,6 +22,8 @@
 /// 3: Specular Strength, Default: 1.0f
 /// 4: Linear Attenuation, Default: 0.045f
 /// 5: Exponent Attenuation, Default: 0.0075f
+/// 6: Radius Of Influence, Default: 0.0f (Calculated From The Attenuation)
+/// 7: IsStatic, Default: false (Static Lights Can Be Baked Into Irradiance Probes)
 /// </summary>
 struct PointLight
 {
@@ -29,6 +33,9 @@ struct PointLight
 
     float AttenuationLinear = 0.045f;
     float AttenuationExponent = 0.0075f;
+
+    float Radius = 0.0f;
+    bool IsStatic{ false };
 };
 
 /// <summary>
@@ -55,6 +62,8 @@ struct DirectionalLight
 /// 7: Exponent Attenuation, Default: 0.0075f
 /// 8: Inner Cutoff, Default : 5 degrees
 /// 9: Outer Cutoff, Default : 10 degrees
+/// 10: Radius Of Influence, Default: 0.0f (Calculated From The Attenuation)
+/// 11: IsStatic, Default: false (Static Lights Can Be Baked Into Irradiance Probes)
 /// </summary>
 struct SpotLight
 {
@@ -70,6 +79,9 @@ struct SpotLight
 
     float Cutoff = 5.0f;
     float OuterCutoff = 10.0f;
+
+    float Radius = 0.0f;
+    bool IsStatic{ false };
 };
 
 class LightManager
@@ -165,6 +177,77 @@ public:
     /// <param name="_keyMap"></param>
     void CaptureMoment(int _lightIndex, KEYMAP& _keyMap);
 
+    /// <summary>
+    /// Assigns the point and spot lights to the clusters of the active camera, uploads and binds them.
+    /// Call once per frame before drawing lit objects.
+    /// </summary>
+    void UpdateLightClusters();
+
+    /// <summary>
+    /// Sets the ambient light color and strength shared by all lit objects.
+    /// </summary>
+    /// <param name="_color"></param>
+    /// <param name="_strength"></param>
+    void SetAmbientLight(glm::vec3 _color, float _strength);
+
+    /// <summary>
+    /// Returns the ambient light color (rgb) and strength (a).
+    /// </summary>
+    /// <returns></returns>
+    glm::vec4 GetAmbientLight();
+
+    /// <summary>
+    /// Returns the light clusters for stats.
+    /// </summary>
+    /// <returns></returns>
+    ClusteredLighting& GetClusteredLighting();
+
+    /// <summary>
+    /// Returns the distance at which a light of the given strength and attenuation falls below the cutoff brightness.
+    /// </summary>
+    /// <param name="_color"></param>
+    /// <param name="_specularStrength"></param>
+    /// <param name="_attenuationLinear"></param>
+    /// <param name="_attenuationExponent"></param>
+    /// <param name="_cutoff"></param>
+    /// <returns></returns>
+    static float CalculateInfluenceRadius(glm::vec3 _color, float _specularStrength, float _attenuationLinear, float _attenuationExponent, float _cutoff = 1.0f / 32.0f);
+
+    /// <summary>
+    /// Picks the _maxLights point and spot lights that contribute the most to the bounds, strongest first.
+    /// Indices refer to the light buffer bound by UpdateLightClusters.
+    /// </summary>
+    /// <param name="_bounds"></param>
+    /// <param name="_maxLights"></param>
+    /// <param name="_lightIndices"></param>
+    void GatherObjectLights(const AABB& _bounds, int _maxLights, std::vector<int>& _lightIndices);
+
+    /// <summary>
+    /// Sets whether forward shaded objects use their own light list instead of the light clusters.
+    /// </summary>
+    /// <param name="_enabled"></param>
+    void SetPerObjectLighting(bool _enabled);
+
+    /// <summary>
+    /// Returns true if forward shaded objects use their own light list.
+    /// </summary>
+    /// <returns></returns>
+    bool GetPerObjectLighting();
+
+    /// <summary>
+    /// Sets whether static lights come from baked irradiance probes, leaving them out of the dynamic lights.
+    /// </summary>
+    /// <param name="_enabled"></param>
+    void SetBakedLighting(bool _enabled);
+
+    /// <summary>
+    /// Returns true if static lights come from baked irradiance probes.
+    /// </summary>
+    /// <returns></returns>
+    bool GetBakedLighting();
+
+    static const int MaxObjectLights = 8;
+
 private:
 
     Camera* m_ActiveCamera{ nullptr };
@@ -176,5 +259,21 @@ private:
     std::vector<PointLight> m_PointLights{};
     std::vector<DirectionalLight> m_DirectionalLights{};
     std::vector<SpotLight> m_SpotLights{};
+    glm::vec4 m_AmbientColorStrength{ 1.0f,1.0f,1.0f,0.5f };
+    ClusteredLighting m_Clusters{};
+    std::vector<ClusterLight> m_ClusterLights{};
+
+    /// <summary>
+    /// Moves the light influence spheres in the light tree, rebuilding it if the number of lights changed.
+    /// </summary>
+    void UpdateLightTree();
+
+    AABBTree m_LightTree{ 0.5f };
+    std::vector<int> m_LightProxies{};
+    std::vector<int> m_UnboundedLights{};
+    std::vector<int> m_LightQueryResults{};
+    std::vector<std::pair<float, int>> m_LightScores{};
+    bool m_IsPerObjectLightingEnabled{ false };
+    bool m_IsBakedLightingEnabled{ false };
 };
 
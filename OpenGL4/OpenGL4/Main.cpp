@@ -5,6 +5,17 @@
 #include "GameObject.h"
 #include "Camera.h"
 #include "TextureLoader.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "GPUDrivenRenderer.h"
+#include "FrameUniforms.h"
+#include "DeferredRenderer.h"
+#include "ObjectTransforms.h"
+#include "ProgramCache.h"
+#include "GLState.h"
+#include "AssetCooker.h"
+#include "BlockCompressor.h"
+#include <random>
 
 LightManager* lightManager = nullptr;
 DirectionalLight SunLight;
@@ -20,6 +31,25 @@ ImVec4 PointLightColor = ImVec4{1,1,1,1.0f};
 bool IsCursorEnabled = false;
 
 GameObject* gameobject01 = nullptr;
+AABBTree* sceneTree = nullptr;
+
+std::vector<GameObject*> gameObjects;
+FrustumCuller frustumCuller;
+OcclusionCuller occlusionCuller;
+bool IsOcclusionCullingEnabled = true;
+std::vector<int> visibleObjects;
+GPUDrivenRenderer* gpuRenderer = nullptr;
+bool IsGPUDrivenEnabled = false;
+bool IsHiZCullingEnabled = true;
+DeferredRenderer* deferredRenderer = nullptr;
+bool IsDeferredEnabled = false;
+CascadedShadowMap* shadowMap = nullptr;
+IrradianceVolume* irradianceVolume = nullptr;
+const std::string IrradianceFilePath = "Resources/Scene.irradiance";
+const std::string ResourcePackPath = "Resources.pack";
+const std::string CookedResourcePath = "Cooked";
+RaycastHit PickedHit{};
+bool HasPickedHit = false;
 
 void InitGL();
 void InitGLFW();
@@ -28,6 +58,10 @@ void Initimgui();
 void Start();
 void Update();
 void Render();
+void CullGameObjects();
+void PickGameObject();
+void SpawnPointLights(int _count);
+void RunBenchmarks();
 
 void ImGUIRender();
 
@@ -43,13 +77,42 @@ namespace Utilities {
 	glm::vec2 mousePos;
 	float mouseSensitivity = 10.0f;
 }
-int main()
+int main(int argc, char** argv)
 {
+	// Headless benchmarks, no window or GL context needed
+	if (argc > 1 && std::string(argv[1]) == "-benchmark")
+	{
+		RunBenchmarks();
+		return 0;
+	}
+
+	// Cooks the resources into runtime formats, and packs the cooked resources for shipping.
+	// The shader cache is rebuilt per machine so it is left out
+	if (argc > 1 && (std::string(argv[1]) == "-cook" || std::string(argv[1]) == "-pack"))
+	{
+		VirtualFileSystem::MountDirectory("Resources");
+		bool isCooked = AssetCooker::Cook("Resources", CookedResourcePath, { "ShaderCache" });
+		if (isCooked && std::string(argv[1]) == "-pack")
+			isCooked = VirtualFileSystem::WritePack(CookedResourcePath, ResourcePackPath);
+		VirtualFileSystem::Unmount();
+		return isCooked ? 0 : 1;
+	}
+
+	// Loose resources are mounted last so edited shaders and copied files override the cooked ones and the pack without recooking.
+	// Models and textures are looked up by their cooked names first, so edits to them only show up once they are cooked again
+	VirtualFileSystem::MountPack(ResourcePackPath);
+	VirtualFileSystem::MountDirectory(CookedResourcePath);
+	VirtualFileSystem::MountDirectory("Resources");
+
 	InitGLFW();
 	InitGL();
 	Initimgui();
 
 	Start();
+	Print("Created " + std::to_string(ProgramCache::GetHitCount() + ProgramCache::GetMissCount()) + " programs ("
+		+ std::to_string(ProgramCache::GetHitCount()) + " from the binary cache, "
+		+ std::to_string(ProgramCache::GetMissCount()) + " compiled) in "
+		+ std::to_string(ShaderLoader::GetProgramCreationTime()) + " ms");
 	Update();
 
 	return Cleanup();
@@ -60,11 +123,9 @@ void InitGL()
 	if (glewInit() != GLEW_OK)
 		exit(0);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_DEPTH_TEST);
+	// Blending, depth and stencil are set per draw through GLState pipelines
+	GLState::Reset();
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-	glEnable(GL_STENCIL_TEST);
 }
 
 void InitGLFW()
@@ -105,6 +166,80 @@ void ImGUIRender() {
 	ImGui::Begin("Debug Window");
 	
 	ImGui::ColorPicker4("PointLight Color", (float*)&PointLightColor);
+	ImGui::Text("Visible Objects: %d / %d", frustumCuller.GetVisibleCount(), frustumCuller.GetCount());
+	ImGui::Checkbox("Occlusion Culling", &IsOcclusionCullingEnabled);
+	ImGui::Text("Occluded Objects: %d", occlusionCuller.GetTestedAndCulledCount().y);
+	ImGui::Text("Geometry Arena: %u / %u Vertices, Fragmentation: %.2f", GeometryArena::GetVertexAllocator().GetUsedSize(), GeometryArena::GetVertexAllocator().GetSize(), GeometryArena::GetVertexAllocator().GetFragmentation());
+	if (HasPickedHit)
+		ImGui::Text("Picked Triangle: %d UV: (%.2f, %.2f) Distance: %.2f", PickedHit.Triangle, PickedHit.UV.x, PickedHit.UV.y, PickedHit.Distance);
+	ImGui::Checkbox("GPU Driven Rendering", &IsGPUDrivenEnabled);
+	if (IsGPUDrivenEnabled)
+	{
+		ImGui::Checkbox("HiZ Culling", &IsHiZCullingEnabled);
+		ImGui::Text("GPU Instances: %d, Multi Draws: %d", gpuRenderer->GetInstanceCount(), gpuRenderer->GetDrawCallCount());
+	}
+	else
+	{
+		ImGui::Checkbox("Deferred Shading", &IsDeferredEnabled);
+	}
+	ImGui::Text("Programs Cached: %d, Compiled: %d", ProgramCache::GetHitCount(), ProgramCache::GetMissCount());
+	ImGui::Text("Uniform Uploads: %d, Redundant Skipped: %d", ShaderLoader::GetUniformStats().Uploads, ShaderLoader::GetUniformStats().Skipped);
+	ImGui::Text("GL State Calls: %d, Redundant Skipped: %d", GLState::GetStats().Calls, GLState::GetStats().Skipped);
+	TextureStats textureStats = TextureLoader::GetStats();
+	ImGui::Text("Textures: %d (%d Referenced), %.1f / %.0f MB", textureStats.ResidentCount, textureStats.ReferencedCount,
+		textureStats.ResidentBytes / (1024.0 * 1024.0), textureStats.BudgetBytes / (1024.0 * 1024.0));
+	ImGui::Text("Texture Cache Hits: %d, Misses: %d, Evictions: %d", textureStats.Hits, textureStats.Misses, textureStats.Evictions);
+	ImGui::Text("Textures Streaming: %d", textureStats.LoadingCount);
+	ImGui::Text("Lights: %d, Max Per Cluster: %d", lightManager->GetClusteredLighting().GetLightCount(), lightManager->GetClusteredLighting().GetMaxLightsPerCluster());
+	bool isPerObjectLightingEnabled = lightManager->GetPerObjectLighting();
+	if (ImGui::Checkbox("Per Object Lights", &isPerObjectLightingEnabled))
+		lightManager->SetPerObjectLighting(isPerObjectLightingEnabled);
+	if (ImGui::Button("Spawn 100 Point Lights"))
+	{
+		// New static lights are not in the probes until they are baked again
+		SpawnPointLights(100);
+		lightManager->SetBakedLighting(false);
+	}
+	if (lightManager->GetDirectionalLights().size() > 0 && ImGui::SliderFloat3("Sun Direction", &lightManager->GetDirectionalLights()[0].Direction.x, -1.0f, 1.0f))
+	{
+		if (glm::length(lightManager->GetDirectionalLights()[0].Direction) < 0.01f)
+			lightManager->GetDirectionalLights()[0].Direction = { 0,-1,0 };
+	}
+	if (ImGui::CollapsingHeader("Shadows"))
+	{
+		CascadedShadowSettings& shadowSettings = shadowMap->GetSettings();
+		ImGui::Text("Cascades Rendered This Frame: %d", shadowMap->GetRenderedCascadeCount());
+		ImGui::SliderInt("Cascades", &shadowSettings.CascadeCount, 1, CascadedShadowMap::MaxCascades);
+		ImGui::SliderInt("Resolution", &shadowSettings.Resolution, 512, 4096);
+		ImGui::SliderFloat("Max Distance", &shadowSettings.MaxDistance, 10.0f, 1000.0f);
+		ImGui::SliderFloat("Split Lambda", &shadowSettings.SplitLambda, 0.0f, 1.0f);
+		ImGui::SliderFloat("Cache Margin", &shadowSettings.CacheMargin, 1.0f, 3.0f);
+		for (int i = 0; i < shadowSettings.CascadeCount; i++)
+		{
+			ImGui::SliderInt(("Cascade " + std::to_string(i) + " Interval (0 = Cached)").c_str(), &shadowSettings.UpdateIntervals[i], 0, 8);
+		}
+		if (std::count(shadowSettings.UpdateIntervals, shadowSettings.UpdateIntervals + shadowSettings.CascadeCount, 0) > 0)
+		{
+			ImGui::TextWrapped("Cached cascades re-render static casters only when needed, dynamic casters are drawn over them every frame");
+		}
+	}
+	if (ImGui::CollapsingHeader("Baked Lighting"))
+	{
+		if (irradianceVolume->IsLoaded())
+		{
+			bool isBakedLightingEnabled = lightManager->GetBakedLighting();
+			if (ImGui::Checkbox("Irradiance Probes", &isBakedLightingEnabled))
+				lightManager->SetBakedLighting(isBakedLightingEnabled);
+			glm::ivec3 resolution = irradianceVolume->GetResolution();
+			ImGui::Text("Probes: %d x %d x %d, Last Bake: %.0fms", resolution.x, resolution.y, resolution.z, irradianceVolume->GetBakeTime());
+		}
+		if (ImGui::Button("Bake Irradiance Probes") && irradianceVolume->Bake(gameObjects, *lightManager))
+		{
+			irradianceVolume->Save(IrradianceFilePath);
+			irradianceVolume->Upload();
+			lightManager->SetBakedLighting(true);
+		}
+	}
 	
 	ImGui::End();
 	ImGui::Render();
@@ -114,50 +249,98 @@ void ImGUIRender() {
 
 void Start()
 {
-	StaticMesh::Meshes.push_back(new Mesh(SHAPE::SPHERE, GL_CCW));
-	StaticMesh::Meshes.push_back(new Mesh(SHAPE::CUBE, GL_CCW));
-	StaticMesh::Meshes.push_back(new Mesh(SHAPE::PYRAMID, GL_CCW));
-	StaticMesh::Meshes.push_back(new Mesh("Fella.fbx"));
-	StaticMesh::Meshes.push_back(new Mesh("link.obj"));
+	// Every program is checked against the C++ side of the blocks it declares as it links
+	ShaderLoader::AddBlockLayout(GL_UNIFORM_BLOCK, "FrameUniforms", FrameUniformLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "LightBuffer", ClusterLightLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "ClusterBuffer", ClusterRangeLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "LightIndexBuffer", LightIndexLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "ObjectTransformBuffer", ObjectTransformLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "ProbeBuffer", IrradianceVolume::ProbeCoefficientLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "InstanceBuffer", GPUInstanceLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "InstanceDrawBuffer", GPUInstanceDrawLayout::Describe());
+	ShaderLoader::AddBlockLayout(GL_SHADER_STORAGE_BLOCK, "CommandBuffer", DrawElementsIndirectCommandLayout::Describe());
+
+	// Programs compile on the driver's threads while the meshes and textures load
+	ShaderLoader::BeginProgramBatch();
+
+	StaticShader::Shaders["CellShading"_id] = new Shader{
+		{
+			ShaderInfo{GL_VERTEX_SHADER, "Normals3D.vert"},
+			ShaderInfo{GL_FRAGMENT_SHADER, "BlinnFong3D_CelShaded.frag"},
+		}
+	, nullptr };
+
+
+
+	StaticShader::Shaders["ToonOutline"_id] = new Shader{
+		{
+			ShaderInfo{GL_VERTEX_SHADER, "Normals3D.vert"},
+			ShaderInfo{GL_FRAGMENT_SHADER, "UnlitColor.frag"},
+		}
+	, nullptr, { "OUTLINE" } };
+
+	StaticMesh::Meshes["Sphere"_id] = new Mesh(SHAPE::SPHERE, GL_CCW);
+	StaticMesh::Meshes["Cube"_id] = new Mesh(SHAPE::CUBE, GL_CCW);
+	StaticMesh::Meshes["Pyramid"_id] = new Mesh(SHAPE::PYRAMID, GL_CCW);
+	StaticMesh::Meshes["Fella.fbx"_id] = new Mesh("Fella.fbx");
+	StaticMesh::Meshes["link.obj"_id] = new Mesh("link.obj");
 
 	//Initalise Camera
 	mainCamera = new Camera(Utilities::SCREENSIZE);
 
+	//Initalise Scene Tree
+	sceneTree = new AABBTree();
+
 	//Initalise LightManager
-	lightManager = new LightManager(*mainCamera, 1);
-	lightManager->SetLightMesh(StaticMesh::Meshes[0]);
+	lightManager = new LightManager(*mainCamera, 1024);
+	lightManager->SetLightMesh(StaticMesh::Meshes["Sphere"_id]);
 	lightManager->CreatePointLight(
 		{
 			{1.0f,1.0f,-7.0f},
 			{1,1,1},
 
 		});
-	
-	StaticShader::Shaders.insert_or_assign("CellShading", new Shader{ 
-		{
-			ShaderInfo{GL_VERTEX_SHADER, "Normals3D.vert"},
-			ShaderInfo{GL_FRAGMENT_SHADER, "BlinnFong3D_CelShaded.frag"},
-		}
-	, nullptr });
-
-
-
-	StaticShader::Shaders.insert_or_assign("ToonOutline", new Shader{
-		{
-			ShaderInfo{GL_VERTEX_SHADER, "Normals3D_ToonOutline.vert"},
-			ShaderInfo{GL_FRAGMENT_SHADER, "UnlitColor.frag"},
-		}
-	, nullptr });
+	SunLight.Direction = glm::normalize(glm::vec3{ -0.4f, -1.0f, -0.3f });
+	SunLight.Color = { 0.6f, 0.6f, 0.55f };
+	lightManager->CreateDirectionalLight(SunLight);
+	shadowMap = new CascadedShadowMap();
 
 	gameobject01 = new GameObject(*mainCamera, glm::vec3{ 0,-1,-9 });
 
 
-	gameobject01->SetMesh(StaticMesh::Meshes[4]);
+	gameobject01->SetMesh(StaticMesh::Meshes["link.obj"_id]);
 	gameobject01->SetScale({ 0.015f, 0.015f ,0.015f });
 	gameobject01->SetActiveCamera(*mainCamera);
 	gameobject01->SetActiveTextures({ TextureLoader::LoadTexture("body.png") });
 	gameobject01->SetLightManager(*lightManager);
-	gameobject01->SetShaders({ *StaticShader::Shaders["CellShading"], *StaticShader::Shaders["ToonOutline"]});
+	gameobject01->SetShaders({ *StaticShader::Shaders["CellShading"_id], *StaticShader::Shaders["ToonOutline"_id]});
+	gameobject01->SetSceneTree(*sceneTree);
+	gameObjects.push_back(gameobject01);
+
+	// Static ground for the cached shadow cascades, which also hides anything below it from the occlusion culler
+	GameObject* ground = new GameObject(*mainCamera, glm::vec3{ 0,-3,-9 });
+	ground->SetMesh(StaticMesh::Meshes["Cube"_id]);
+	ground->SetScale({ 60.0f, 1.0f, 60.0f });
+	ground->SetActiveCamera(*mainCamera);
+	ground->SetLightManager(*lightManager);
+	ground->SetShaders({ *StaticShader::Shaders["CellShading"_id], *StaticShader::Shaders["ToonOutline"_id] });
+	ground->SetSceneTree(*sceneTree);
+	ground->SetIsStatic(true);
+	ground->SetIsOccluder(true);
+	gameObjects.push_back(ground);
+
+	gpuRenderer = new GPUDrivenRenderer(*mainCamera, Utilities::SCREENSIZE);
+	deferredRenderer = new DeferredRenderer(*mainCamera, Utilities::SCREENSIZE);
+
+	// Probes baked by an earlier run
+	irradianceVolume = new IrradianceVolume();
+	if (irradianceVolume->Load(IrradianceFilePath))
+	{
+		irradianceVolume->Upload();
+		lightManager->SetBakedLighting(true);
+	}
+
+	ShaderLoader::EndProgramBatch();
 }
 
 void Update()
@@ -168,10 +351,21 @@ void Update()
 
 		lightManager->GetPointLights()[0].Color = glm::vec4{ PointLightColor.x, PointLightColor.y,PointLightColor.z, PointLightColor.w };
 		mainCamera->Movement(DeltaTime);
-		gameobject01->Update(DeltaTime);
+		for (auto& gameObject : gameObjects)
+		{
+			gameObject->Update(DeltaTime);
+		}
 		
 		if(!IsCursorEnabled)
 			mainCamera->MouseLook(DeltaTime,Utilities::mousePos);
+		else
+			PickGameObject();
+
+		// Move a few meshes per frame to close holes left by freed geometry
+		GeometryArena::Compact();
+
+		// Upload the textures the streaming workers have finished decoding
+		TextureLoader::Update();
 		
 		glfwPollEvents();
 		Render();
@@ -180,15 +374,113 @@ void Update()
 
 void Render()
 {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-	gameobject01->Draw();
+	GLState::BeginFrame();
+	GLState::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+	ShaderLoader::BeginUniformFrame();
+
+	// Per frame state is written once here instead of by every draw
+	ObjectTransforms::Update(gameObjects, *mainCamera);
+	lightManager->UpdateLightClusters();
+	if (lightManager->GetDirectionalLights().size() > 0)
+		shadowMap->Render(gameObjects, lightManager->GetDirectionalLights()[0], *mainCamera);
+	FrameUniforms::Update(*mainCamera, *lightManager, shadowMap, lightManager->GetBakedLighting() ? irradianceVolume : nullptr);
+	if (IsGPUDrivenEnabled)
+	{
+		// Culling and submission happen on the GPU
+		gpuRenderer->SetHiZCulling(IsHiZCullingEnabled);
+		gpuRenderer->Draw(gameObjects);
+	}
+	else
+	{
+		CullGameObjects();
+		if (IsDeferredEnabled)
+		{
+			deferredRenderer->Draw(gameObjects, visibleObjects);
+		}
+		else
+		{
+			for (auto& index : visibleObjects)
+			{
+				gameObjects[index]->Draw();
+			}
+		}
+	}
 	lightManager->Draw();
+	if (IsGPUDrivenEnabled)
+		gpuRenderer->CaptureDepth();
 	ImGUIRender();
 
 	glfwSwapBuffers(renderWindow);
 }
 
+void CullGameObjects()
+{
+	// Frustum cull the gameobjects
+	frustumCuller.Clear();
+	for (auto& gameObject : gameObjects)
+	{
+		frustumCuller.Add(gameObject->GetWorldSphere(), gameObject->GetWorldBounds());
+	}
+	frustumCuller.Cull(mainCamera->GetFrustum(), visibleObjects);
+
+	if (!IsOcclusionCullingEnabled)
+		return;
+
+	// Rasterize the visible occluders
+	occlusionCuller.BeginFrame(mainCamera->GetPVMatrix());
+	for (auto& index : visibleObjects)
+	{
+		GameObject* gameObject = gameObjects[index];
+		if (gameObject->GetIsOccluder() && gameObject->GetOccluderMesh())
+			occlusionCuller.AddOccluder(*gameObject->GetOccluderMesh(), gameObject->m_Transform.transform);
+	}
+	occlusionCuller.RasterizeOccluders();
+
+	// Remove anything hidden behind them
+	visibleObjects.erase(std::remove_if(visibleObjects.begin(), visibleObjects.end(), [](int _index)
+		{
+			return !occlusionCuller.IsVisible(gameObjects[_index]->GetWorldBounds());
+		}), visibleObjects.end());
+}
+
+void PickGameObject()
+{
+	// Click with the cursor enabled to pick, ignoring clicks on the debug window
+	if (glfwGetMouseButton(renderWindow, GLFW_MOUSE_BUTTON_LEFT) != GLFW_PRESS || ImGui::GetIO().WantCaptureMouse)
+		return;
+
+	double cursorX = 0.0, cursorY = 0.0;
+	glfwGetCursorPos(renderWindow, &cursorX, &cursorY);
+	HasPickedHit = GameObject::RayCastScene(*sceneTree, mainCamera->ScreenPointToRay({ (float)cursorX, (float)cursorY }), PickedHit);
+}
+
+void SpawnPointLights(int _count)
+{
+	// Small randomly coloured lights scattered around the scene
+	static std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> color(0.2f, 1.0f);
+	for (int i = 0; i < _count; i++)
+	{
+		PointLight light{};
+		light.Position = glm::vec3{ position(random), position(random) * 0.25f, position(random) - 9.0f };
+		light.Color = { color(random), color(random), color(random) };
+		light.AttenuationLinear = 0.7f;
+		light.AttenuationExponent = 1.8f;
+		light.IsStatic = true;
+		lightManager->CreatePointLight(light);
+	}
+}
+
+void RunBenchmarks()
+{
+	OcclusionCuller::Benchmark();
+	TriangleBVH::Benchmark();
+	ClusteredLighting::Benchmark();
+	BlockCompressor::Benchmark();
+}
+
 void CalculateDeltaTime()
 {
 	float currentFrame = (float)glfwGetTime();
@@ -198,18 +490,40 @@ void CalculateDeltaTime()
 
 int Cleanup()
 {
+	for (auto& gameObject : gameObjects)
+	{
+		delete gameObject;
+		gameObject = nullptr;
+	}
+	gameObjects.clear();
+	gameobject01 = nullptr;
+	delete gpuRenderer;
+	gpuRenderer = nullptr;
+	delete deferredRenderer;
+	deferredRenderer = nullptr;
+	delete shadowMap;
+	shadowMap = nullptr;
+	delete irradianceVolume;
+	irradianceVolume = nullptr;
+	delete sceneTree;
+	sceneTree = nullptr;
+
 	for (auto& shader : StaticShader::Shaders)
 	{
 		delete shader.second;
 		shader.second = nullptr;
 	}
-	StaticShader::Shaders.clear();
+	StaticShader::Shaders.Clear();
 	for (auto& mesh : StaticMesh::Meshes)
 	{
-		delete mesh;
-		mesh = nullptr;
+		delete mesh.second;
+		mesh.second = nullptr;
 	}
-	StaticMesh::Meshes.clear();
+	StaticMesh::Meshes.Clear();
+	TextureLoader::Cleanup();
+	GeometryArena::Cleanup();
+	FrameUniforms::Cleanup();
+	ObjectTransforms::Cleanup();
 
 	//Cleanup ImGui 
 	ImGui_ImplOpenGL3_Shutdown();
@@ -219,6 +533,7 @@ int Cleanup()
 	glfwDestroyWindow(renderWindow);
 	delete(mainCamera);
 	glfwTerminate();
+	VirtualFileSystem::Unmount();
 
 	return 0;
 }
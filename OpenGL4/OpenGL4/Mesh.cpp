@@ -9,9 +9,19 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "Mesh.h"
+#include "GLState.h"
 #include "TextureLoader.h"
 #include "StaticShader.h"
+#include "AssetCooker.h"
 
+namespace
+{
+	// Sampler uniform of each texture unit, hashed once instead of built as a string every draw
+	constexpr StringID TextureUniformNames[]{
+		"ImageTexture0"_id, "ImageTexture1"_id, "ImageTexture2"_id, "ImageTexture3"_id,
+		"ImageTexture4"_id, "ImageTexture5"_id, "ImageTexture6"_id, "ImageTexture7"_id,
+	};
+}
 
 Mesh::Mesh(SHAPE _shape, GLenum _windingOrder)
 {
@@ -20,33 +30,44 @@ Mesh::Mesh(SHAPE _shape, GLenum _windingOrder)
 	CreateShapeVertices(_shape);
 	CreateShapeIndices(_shape);
 	CreateAndInitializeBuffers();
+	CalculateBounds();
 }
 
-Mesh::Mesh(std::vector<Vertex> _vertices, std::vector<unsigned> _indices, std::vector<Texture> _textures)
+Mesh::Mesh(std::vector<Vertex> _vertices, std::vector<unsigned> _indices, std::vector<TextureHandle> _textures)
 {
 	m_Vertices =_vertices;
 	m_Indices = _indices;
 	m_Textures = _textures;
 	CreateAndInitializeBuffers();
+	CalculateBounds();
 }
 
 Mesh::Mesh(std::string _modelName)
 {
-	// read file via ASSIMP
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(("Resources/Models/" + _modelName).c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals  | aiProcess_CalcTangentSpace);
-	// check for errors
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
+	// Cooked models are read as they are, the source model is only imported when there is no cooked version or it was rejected
+	std::string path = "Models/" + _modelName;
+	ModelData model{};
+	FileData cooked = VirtualFileSystem::ReadFile(AssetCooker::GetCookedPath(path));
+	bool isLoaded = cooked.IsValid() && AssetCooker::ReadModel(cooked, model);
+	if (!isLoaded)
+	{
+		// A rejected file may have filled some of the sub meshes already
+		model = {};
+		isLoaded = AssetCooker::ImportModel(path, model);
+	}
+	if (!isLoaded)
 	{
-		std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+		Print("Could not load model " + _modelName);
 		return;
 	}
 
+	for (auto& subMesh : model.SubMeshes)
+	{
+		m_Meshes.push_back(new Mesh(std::move(subMesh.Vertices), std::move(subMesh.Indices), LoadMaterialTextures(subMesh.Textures)));
+	}
 
-	ProcessNode(scene->mRootNode, scene);
-
-	
 	CreateAndInitializeBuffers();
+	CalculateBounds();
 }
 
 Mesh::Mesh(unsigned int _numberOfSides, GLenum _windingOrder)
@@ -56,6 +77,7 @@ Mesh::Mesh(unsigned int _numberOfSides, GLenum _windingOrder)
 	CreatePolygonVertices(_numberOfSides);
 	CreatePolygonIndices(_numberOfSides);
 	CreateAndInitializeBuffers();
+	CalculateBounds();
 }
 
 Mesh::~Mesh()
@@ -69,18 +91,14 @@ Mesh::~Mesh()
 		mesh = nullptr;
 	}
 
-	// Unbind
-	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-	}
-	// Delete
+	for (auto& texture : m_Textures)
 	{
-		glDeleteVertexArrays(1, &m_VertexArrayID);
-		glDeleteBuffers(1, &m_VertexBufferID);
-		glDeleteBuffers(1, &m_IndexBufferID);
+		TextureLoader::Release(texture);
 	}
+
+	// Return the range to the shared buffers
+	GeometryArena::Free(m_GeometryHandle);
+	m_GeometryHandle = GeometryArena::InvalidHandle;
 }
 
 void Mesh::Draw()
@@ -89,23 +107,23 @@ void Mesh::Draw()
 
 	if (m_Meshes.size() > 0)
 	{
+		// Texture uniforms go to whichever lit program is bound, forward or G-buffer
+		GLuint program = GLState::GetProgram();
 		for (auto& mesh : m_Meshes)
 		{
-			for (int i = 0; i < m_Textures.size(); i++)
+			for (int i = 0; i < m_Textures.size() && i < std::size(TextureUniformNames); i++)
 			{
-				ShaderLoader::SetUniform1i(std::move(StaticShader::Shaders["CellShading"]->ID), "TextureCount", 0);
-				glActiveTexture(GL_TEXTURE0 + i);
-				glBindTexture(GL_TEXTURE_2D, m_Textures[i].ID);
-				ShaderLoader::SetUniform1i(std::move(StaticShader::Shaders["CellShading"]->ID), "ImageTexture" + std::to_string(i), i);
+				GLState::BindTexture(i, GL_TEXTURE_2D, TextureLoader::GetID(m_Textures[i]));
+				ShaderLoader::SetUniform1i(std::move(program), TextureUniformNames[i], i);
 			}
 			mesh->Draw();
 		}
 	}
 	else
 	{
-		glBindVertexArray(m_VertexArrayID);
-		glDrawElements(GL_TRIANGLES, (GLsizei)m_Indices.size(), GL_UNSIGNED_INT, nullptr);
-		glBindVertexArray(0);
+		GeometryRange range = GeometryArena::GetRange(m_GeometryHandle);
+		GLState::BindVertexArray(GeometryArena::GetVertexArrayID());
+		glDrawElementsBaseVertex(GL_TRIANGLES, range.IndexCount, GL_UNSIGNED_INT, (void*)(range.FirstIndex * sizeof(unsigned int)), range.BaseVertex);
 	}
 		
 
@@ -318,34 +336,145 @@ void Mesh::CreatePolygonIndices(unsigned int _numberOfSides)
 
 void Mesh::CreateAndInitializeBuffers()
 {
-	// Vertex Array
-	glGenVertexArrays(1, &m_VertexArrayID);
-	glBindVertexArray(m_VertexArrayID);
-
-	// Vertex Buffer
-	glGenBuffers(1, &m_VertexBufferID);
-	glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
-	glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(Vertex), m_Vertices.data(), GL_STATIC_DRAW);
-
-	// Index Buffer
-	glGenBuffers(1, &m_IndexBufferID);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(unsigned int), m_Indices.data(), GL_STATIC_DRAW);
-
-	// Layouts
-	// Position
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-	// TexCoords
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, texCoords)));
-	// Normals
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, normals)));
-	// Unbind
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	// Models have no geometry of their own, only their sub meshes
+	m_GeometryHandle = GeometryArena::Allocate(m_Vertices, m_Indices);
+}
+
+const AABB& Mesh::GetLocalBounds()
+{
+	return m_LocalBounds;
+}
+
+const BoundingSphere& Mesh::GetLocalSphere()
+{
+	return m_LocalSphere;
+}
+
+const std::vector<Vertex>& Mesh::GetVertices()
+{
+	return m_Vertices;
+}
+
+const std::vector<unsigned int>& Mesh::GetIndices()
+{
+	return m_Indices;
+}
+
+const std::vector<Mesh*>& Mesh::GetSubMeshes()
+{
+	return m_Meshes;
+}
+
+GLuint Mesh::GetVertexArrayID()
+{
+	return GeometryArena::GetVertexArrayID();
+}
+
+GeometryRange Mesh::GetGeometryRange()
+{
+	return GeometryArena::GetRange(m_GeometryHandle);
+}
+
+bool Mesh::Intersect(const Ray& _ray, MeshHit& _hit)
+{
+	// Models test each sub mesh, shortening the ray as closer hits are found
+	if (m_Meshes.size() > 0)
+	{
+		bool isHit = false;
+		Ray ray = _ray;
+		for (int i = 0; i < (int)m_Meshes.size(); i++)
+		{
+			MeshHit subMeshHit{};
+			if (m_Meshes[i]->Intersect(ray, subMeshHit))
+			{
+				_hit = subMeshHit;
+				_hit.SubMesh = i;
+				ray.MaxDistance = subMeshHit.Distance;
+				isHit = true;
+			}
+		}
+		return isHit;
+	}
+
+	TriangleHit triangleHit{};
+	if (!GetBVH().Intersect(_ray, triangleHit))
+		return false;
+
+	// Interpolate the vertex attributes at the hit
+	const Vertex& a = m_Vertices[m_Indices[triangleHit.Triangle * 3 + 0]];
+	const Vertex& b = m_Vertices[m_Indices[triangleHit.Triangle * 3 + 1]];
+	const Vertex& c = m_Vertices[m_Indices[triangleHit.Triangle * 3 + 2]];
+	float weightA = 1.0f - triangleHit.Barycentrics.x - triangleHit.Barycentrics.y;
+
+	_hit.Distance = triangleHit.Distance;
+	_hit.SubMesh = -1;
+	_hit.Triangle = triangleHit.Triangle;
+	_hit.Barycentrics = triangleHit.Barycentrics;
+	_hit.UV = a.texCoords * weightA + b.texCoords * triangleHit.Barycentrics.x + c.texCoords * triangleHit.Barycentrics.y;
+	_hit.Normal = a.normals * weightA + b.normals * triangleHit.Barycentrics.x + c.normals * triangleHit.Barycentrics.y;
+	if (Magnitude(_hit.Normal) > 0)
+		_hit.Normal = glm::normalize(_hit.Normal);
+	return true;
+}
+
+const TriangleBVH& Mesh::GetBVH()
+{
+	if (!m_BVH.IsBuilt() && m_Indices.size() > 0)
+		m_BVH.Build(m_Vertices, m_Indices);
+
+	return m_BVH;
+}
+
+void Mesh::BuildBVH()
+{
+	for (auto& subMesh : m_Meshes)
+	{
+		subMesh->BuildBVH();
+	}
+	GetBVH();
+}
+
+GLsizei Mesh::GetIndexCount()
+{
+	return (GLsizei)m_Indices.size();
+}
+
+void Mesh::CalculateBounds()
+{
+	if (m_Vertices.empty() && m_Meshes.empty())
+	{
+		m_LocalBounds = AABB{};
+		m_LocalSphere = BoundingSphere{};
+		return;
+	}
+
+	m_LocalBounds = AABB{ glm::vec3{ FLT_MAX }, glm::vec3{ -FLT_MAX } };
+	for (auto& vertex : m_Vertices)
+	{
+		m_LocalBounds.Min = glm::min(m_LocalBounds.Min, vertex.position);
+		m_LocalBounds.Max = glm::max(m_LocalBounds.Max, vertex.position);
+	}
+
+	// Include Sub Meshes
+	for (auto& mesh : m_Meshes)
+	{
+		m_LocalBounds = MergeAABB(m_LocalBounds, mesh->GetLocalBounds());
+	}
+
+	// Sphere around the AABB centre, radius from the furthest vertex (tighter than the half diagonal)
+	m_LocalSphere.Centre = (m_LocalBounds.Min + m_LocalBounds.Max) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (auto& vertex : m_Vertices)
+	{
+		glm::vec3 delta = vertex.position - m_LocalSphere.Centre;
+		radiusSquared = glm::max(radiusSquared, glm::dot(delta, delta));
+	}
+	m_LocalSphere.Radius = sqrtf(radiusSquared);
+	for (auto& mesh : m_Meshes)
+	{
+		const BoundingSphere& subSphere = mesh->GetLocalSphere();
+		m_LocalSphere.Radius = glm::max(m_LocalSphere.Radius, glm::length(subSphere.Centre - m_LocalSphere.Centre) + subSphere.Radius);
+	}
 }
 
 float Mesh::ToTexCoord(float& _position)
@@ -427,121 +556,20 @@ void Mesh::GenerateSphereIndices(int _fidelity)
 	}
 }
 
-void Mesh::ProcessNode(aiNode* node, const aiScene* scene)
+std::vector<TextureHandle> Mesh::LoadMaterialTextures(const std::vector<std::string>& _fileNames)
 {
-	// process each mesh located at the current node
-	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+	// Each texture gets a reference for the sub mesh and, the first time it is seen, one for the model's draw list
+	std::vector<TextureHandle> textures;
+	for (auto& fileName : _fileNames)
 	{
-		// the node object only contains indices to index the actual objects in the scene. 
-		// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-		aiMesh* mesh = scene->mMeshes[i];
-		m_Meshes.push_back(ProcessMesh(mesh, scene));
-	}
-	// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-	for (unsigned int i = 0; i < node->mNumChildren; i++)
-	{
-		ProcessNode(node->mChildren[i], scene);
-	}
-
-}
-
-Mesh* Mesh::ProcessMesh(aiMesh* mesh, const aiScene* scene)
-{
-	// data to fill
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices;
-	std::vector<Texture> textures;
-
-	// walk through each of the mesh's vertices
-	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-	{
-		Vertex vertex;
-		glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
-		// positions
-		vector.x = mesh->mVertices[i].x;
-		vector.y = mesh->mVertices[i].y;
-		vector.z = mesh->mVertices[i].z;
-		vertex.position = vector;
-		// normals
-		if (mesh->HasNormals())
-		{
-			vector.x = mesh->mNormals[i].x;
-			vector.y = mesh->mNormals[i].y;
-			vector.z = mesh->mNormals[i].z;
-			vertex.normals = vector;
-		}
-		// texture coordinates
-		if (mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
-		{
-			glm::vec2 vec;
-			// a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't 
-			// use models where a vertex can have multiple texture coordinates so we always take the first set (0).
-			vec.x = mesh->mTextureCoords[0][i].x;
-			vec.y = mesh->mTextureCoords[0][i].y;
-			vertex.texCoords = vec;
-		}
-		else
-			vertex.texCoords = glm::vec2(0.0f, 0.0f);
-
-		vertices.push_back(vertex);
-	}
-	// now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
-	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-	{
-		aiFace face = mesh->mFaces[i];
-		// retrieve all indices of the face and store them in the indices vector
-		for (unsigned int j = 0; j < face.mNumIndices; j++)
-			indices.push_back(face.mIndices[j]);
-	}
-	// process materials
-	aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-	// we assume a convention for sampler names in the shaders. Each diffuse texture should be named
-	// as 'texture_diffuseN' where N is a sequential number ranging from 1 to MAX_SAMPLER_NUMBER. 
-	// Same applies to other texture as the following list summarizes:
-	// diffuse: texture_diffuseN
-	// specular: texture_specularN
-	// normal: texture_normalN
-
-	// 1. diffuse maps
-	std::vector<Texture> diffuseMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-	textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-	// 2. specular maps
-	std::vector<Texture> specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-	textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-	// 3. normal maps
-	std::vector<Texture> normalMaps = LoadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-	textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-	// 4. height maps
-	std::vector<Texture> heightMaps = LoadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-	textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-	// return a mesh object created from the extracted mesh data
-	return new Mesh(vertices, indices, textures);
-}
-
-std::vector<Texture> Mesh::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName)
-{
-	std::vector<Texture> textures;
-	for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
-	{
-		aiString str;
-		mat->GetTexture(type, i, &str);
-		// check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-		bool skip = false;
-		for (unsigned int j = 0; j < m_Textures.size(); j++)
+		TextureHandle texture = TextureLoader::LoadTexture(std::string(fileName));
+		if (!texture.IsValid())
+			continue;
+		textures.push_back(texture);
+		if (std::find(m_Textures.begin(), m_Textures.end(), texture) == m_Textures.end())
 		{
-			if (std::strcmp(m_Textures[j].FilePath.data(), str.C_Str()) == 0)
-			{
-				textures.push_back(m_Textures[j]);
-				skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-				break;
-			}
-		}
-		if (!skip)
-		{   // if texture hasn't been loaded already, load it
-			Texture texture = TextureLoader::LoadTexture(str.C_Str());
-			textures.push_back(texture);
-			m_Textures.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecessary load duplicate textures.
+			TextureLoader::AddReference(texture);
+			m_Textures.push_back(texture);
 		}
 	}
 	return textures;
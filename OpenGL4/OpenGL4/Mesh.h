@@ -11,9 +11,22 @@
 #pragma once
 #include "Helper.h"
 #include "ShaderLoader.h"
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include "GeometryArena.h"
+#include "TriangleBVH.h"
+/// <summary>
+/// The closest surface of a mesh hit by a local space ray.
+/// SubMesh is -1 for primitives, Barycentrics are the weights of the triangles second and third vertex.
+/// </summary>
+struct MeshHit
+{
+	float Distance = FLT_MAX;
+	int SubMesh = -1;
+	int Triangle = -1;
+	glm::vec2 Barycentrics{ 0,0 };
+	glm::vec2 UV{ 0,0 };
+	glm::vec3 Normal{ 0,0,0 };
+};
+
 class Mesh
 {
 public:
@@ -23,7 +36,13 @@ public:
 	/// <param name="_shape"></param>
 	Mesh(SHAPE _shape, GLenum _windingOrder);
 
-	Mesh(std::vector<Vertex> _vertices, std::vector<unsigned> _indices, std::vector<Texture> _textures);
+	/// <summary>
+	/// Constructs a mesh from its vertices and indices, taking over a reference to each of the textures.
+	/// </summary>
+	/// <param name="_vertices"></param>
+	/// <param name="_indices"></param>
+	/// <param name="_textures"></param>
+	Mesh(std::vector<Vertex> _vertices, std::vector<unsigned> _indices, std::vector<TextureHandle> _textures);
 
 	Mesh(std::string _modelName);
 	/// <summary>
@@ -40,6 +59,74 @@ public:
 	/// </summary>
 	void Draw();
 
+	/// <summary>
+	/// Returns the local space bounds of the mesh (including any sub meshes).
+	/// </summary>
+	/// <returns></returns>
+	const AABB& GetLocalBounds();
+
+	/// <summary>
+	/// Returns the local space bounding sphere of the mesh (including any sub meshes).
+	/// </summary>
+	/// <returns></returns>
+	const BoundingSphere& GetLocalSphere();
+
+	/// <summary>
+	/// Returns the CPU copy of the vertices.
+	/// </summary>
+	/// <returns></returns>
+	const std::vector<Vertex>& GetVertices();
+
+	/// <summary>
+	/// Returns the CPU copy of the indices.
+	/// </summary>
+	/// <returns></returns>
+	const std::vector<unsigned int>& GetIndices();
+
+	/// <summary>
+	/// Returns the sub meshes of an imported model (empty for primitives).
+	/// </summary>
+	/// <returns></returns>
+	const std::vector<Mesh*>& GetSubMeshes();
+
+	/// <summary>
+	/// Returns the ID of the shared vertex array the mesh is stored in.
+	/// </summary>
+	/// <returns></returns>
+	GLuint GetVertexArrayID();
+
+	/// <summary>
+	/// Returns where the mesh is stored in the shared geometry buffers (empty for models, use the sub meshes).
+	/// </summary>
+	/// <returns></returns>
+	GeometryRange GetGeometryRange();
+
+	/// <summary>
+	/// Finds the closest triangle of the mesh (or its sub meshes) along a local space ray.
+	/// The triangle BVH is built the first time the mesh is intersected.
+	/// </summary>
+	/// <param name="_ray"></param>
+	/// <param name="_hit"></param>
+	/// <returns></returns>
+	bool Intersect(const Ray& _ray, MeshHit& _hit);
+
+	/// <summary>
+	/// Returns the triangle BVH of the mesh, building it if needed (empty for models, use the sub meshes).
+	/// </summary>
+	/// <returns></returns>
+	const TriangleBVH& GetBVH();
+
+	/// <summary>
+	/// Builds the triangle BVHs of the mesh and its sub meshes now, so they can be intersected from several threads.
+	/// </summary>
+	void BuildBVH();
+
+	/// <summary>
+	/// Returns the number of indices drawn by this mesh (excluding sub meshes).
+	/// </summary>
+	/// <returns></returns>
+	GLsizei GetIndexCount();
+
 private:
 	/// <summary>
 	/// Populates the vertices vector with values required for the specified shape.
@@ -62,11 +149,14 @@ private:
 	/// <param name="_numberOfSides"></param>
 	void CreatePolygonIndices(unsigned int _numberOfSides);
 	/// <summary>
-	/// Creates the vertexArray, vertex buffer and index buffer, 
-	/// populating them with the vertices and indices values.
+	/// Copies the vertices and indices into the shared geometry buffers.
 	/// </summary>
 	void CreateAndInitializeBuffers();
 	/// <summary>
+	/// Calculates the local space AABB and bounding sphere from the vertices and any sub meshes.
+	/// </summary>
+	void CalculateBounds();
+	/// <summary>
 	/// Converts the given positional value to texture coordinate space (0-1)
 	/// </summary>
 	/// <param name="_position"></param>
@@ -84,19 +174,24 @@ private:
 	/// <param name="_fidelity"></param>
 	void GenerateSphereIndices(int _fidelity);
 
-	void ProcessNode(aiNode* node, const aiScene* scene);
-	Mesh* ProcessMesh(aiMesh* mesh, const aiScene* scene);
-	std::vector<Texture> LoadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName);
+	/// <summary>
+	/// Loads the textures of a sub mesh's material, adding any the model has not drawn with yet to its textures.
+	/// </summary>
+	/// <param name="_fileNames"></param>
+	/// <returns></returns>
+	std::vector<TextureHandle> LoadMaterialTextures(const std::vector<std::string>& _fileNames);
 	
 
 	std::vector<unsigned int> m_Indices{};
 	std::vector<Vertex> m_Vertices{};
 	std::vector<Mesh*> m_Meshes{};
-	std::vector<Texture> m_Textures;
+	std::vector<TextureHandle> m_Textures;
+
+	int m_GeometryHandle{ GeometryArena::InvalidHandle };
+	TriangleBVH m_BVH{};
 
-	GLuint m_VertexArrayID{ 0 };
-	GLuint m_VertexBufferID{ 0 };
-	GLuint m_IndexBufferID{ 0 };
+	AABB m_LocalBounds{};
+	BoundingSphere m_LocalSphere{};
 
 	GLenum m_WindingOrder;
 };
@@ -0,0 +1,55 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : ObjectTransforms.cpp 
+// Description : ObjectTransforms Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "ObjectTransforms.h"
+#include "GLState.h"
+
+void ObjectTransforms::Update(const std::vector<GameObject*>& _gameObjects, Camera& _camera)
+{
+	if (m_BufferID == 0)
+		glGenBuffers(1, &m_BufferID);
+
+	glm::mat4 pvMatrix = _camera.GetPVMatrix();
+	m_Transforms.resize(_gameObjects.size());
+	for (int i = 0; i < (int)_gameObjects.size(); i++)
+	{
+		const glm::mat4& modelMatrix = _gameObjects[i]->m_Transform.transform;
+		m_Transforms[i].ModelMatrix = modelMatrix;
+		m_Transforms[i].NormalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(modelMatrix))));
+		m_Transforms[i].PVMMatrix = pvMatrix * modelMatrix;
+		_gameObjects[i]->SetObjectIndex(i);
+	}
+
+	// Grow the buffer only when there are more gameobjects than it can hold
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_BufferID);
+	if (m_Transforms.size() > m_BufferCapacity || m_BufferCapacity == 0)
+	{
+		m_BufferCapacity = std::max(m_Transforms.size(), (size_t)64);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_BufferCapacity * sizeof(ObjectTransform), nullptr, GL_DYNAMIC_DRAW);
+	}
+	if (m_Transforms.size() > 0)
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Transforms.size() * sizeof(ObjectTransform), m_Transforms.data());
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, Binding, m_BufferID);
+}
+
+const std::vector<ObjectTransform>& ObjectTransforms::GetTransforms()
+{
+	return m_Transforms;
+}
+
+void ObjectTransforms::Cleanup()
+{
+	if (m_BufferID)
+		GLState::DeleteBuffers(1, &m_BufferID);
+	m_BufferID = 0;
+	m_BufferCapacity = 0;
+	m_Transforms.clear();
+}
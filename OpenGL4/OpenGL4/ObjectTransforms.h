@@ -0,0 +1,64 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : ObjectTransforms.h 
+// Description : ObjectTransforms Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "GameObject.h"
+
+/// <summary>
+/// The per object matrices the vertex shaders read, computed once per frame on the CPU.
+/// Matches the std430 ObjectTransform struct in the vertex shaders.
+/// NormalMatrix is the inverse transpose of the model matrix, only the upper 3x3 is used.
+/// </summary>
+struct ObjectTransform
+{
+	glm::mat4 ModelMatrix{ 1 };
+	glm::mat4 NormalMatrix{ 1 };
+	glm::mat4 PVMMatrix{ 1 };
+};
+
+using ObjectTransformLayout = BufferLayout<LayoutStandard::Std430, glm::mat4, glm::mat4, glm::mat4>;
+
+static_assert(ObjectTransformLayout::Matches<ObjectTransform>({ offsetof(ObjectTransform, ModelMatrix), offsetof(ObjectTransform, NormalMatrix),
+	offsetof(ObjectTransform, PVMMatrix) }), "ObjectTransform does not match the std430 ObjectTransform struct");
+
+/// <summary>
+/// Owns the object transform storage buffer. Each gameobject is given the index of its transforms,
+/// which is the only per draw uniform the vertex shaders need.
+/// Declare the matching buffer in a shader as: layout(std430, binding = 8) readonly buffer ObjectTransformBuffer { ObjectTransform ObjectTransforms[]; };
+/// </summary>
+class ObjectTransforms
+{
+public:
+	/// <summary>
+	/// Computes the transforms of every gameobject in one pass and writes them to the buffer with a single update.
+	/// Call once per frame after gameobjects have moved and before drawing.
+	/// </summary>
+	/// <param name="_gameObjects"></param>
+	/// <param name="_camera"></param>
+	static void Update(const std::vector<GameObject*>& _gameObjects, Camera& _camera);
+
+	/// <summary>
+	/// Returns the transforms of the last update.
+	/// </summary>
+	/// <returns></returns>
+	static const std::vector<ObjectTransform>& GetTransforms();
+
+	/// <summary>
+	/// Deletes the storage buffer.
+	/// </summary>
+	static void Cleanup();
+
+	static const GLuint Binding = 8;
+
+private:
+	inline static std::vector<ObjectTransform> m_Transforms{};
+	inline static GLuint m_BufferID{ 0 };
+	inline static size_t m_BufferCapacity{ 0 };
+};
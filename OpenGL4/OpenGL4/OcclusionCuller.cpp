@@ -0,0 +1,459 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : OcclusionCuller.cpp 
+// Description : OcclusionCuller Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "OcclusionCuller.h"
+#include <immintrin.h>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <random>
+
+namespace
+{
+	// Vertices closer than this in clip space W are treated as crossing the near plane
+	constexpr float NearClipW = 1e-4f;
+
+	/// <summary>
+	/// Returns true if a clip space position is in front of the near plane, where the GPU would clip it away.
+	/// </summary>
+	bool IsNearClipped(const glm::vec4& _clip)
+	{
+		return _clip.w < NearClipW || _clip.z < -_clip.w;
+	}
+}
+
+OcclusionCuller::OcclusionCuller(glm::ivec2 _resolution, int _threadCount)
+{
+	// Rows are rasterized 8 pixels at a time from 8 aligned starts, so the width is padded to keep them inside the row
+	m_Resolution = { (_resolution.x + 7) / 8 * 8, _resolution.y };
+	m_TileCount = { (m_Resolution.x + TileSize - 1) / TileSize, (m_Resolution.y + TileSize - 1) / TileSize };
+	m_HiZResolution = { (m_Resolution.x + HiZBlockSize - 1) / HiZBlockSize, (m_Resolution.y + HiZBlockSize - 1) / HiZBlockSize };
+
+	m_ThreadCount = _threadCount > 0 ? _threadCount : (int)std::thread::hardware_concurrency();
+	m_ThreadCount = glm::clamp(m_ThreadCount, 1, m_TileCount.x * m_TileCount.y);
+
+	m_DepthBuffer.resize((size_t)m_Resolution.x * m_Resolution.y, 1.0f);
+	m_HiZ.resize((size_t)m_HiZResolution.x * m_HiZResolution.y, 1.0f);
+	m_TileBins.resize((size_t)m_TileCount.x * m_TileCount.y);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+	m_DepthBuffer.clear();
+	m_HiZ.clear();
+	m_Triangles.clear();
+	m_TileBins.clear();
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& _pvMatrix)
+{
+	m_PVMatrix = _pvMatrix;
+	m_Triangles.clear();
+	for (auto& bin : m_TileBins)
+	{
+		bin.clear();
+	}
+	std::fill(m_DepthBuffer.begin(), m_DepthBuffer.end(), 1.0f);
+	std::fill(m_HiZ.begin(), m_HiZ.end(), 1.0f);
+
+	m_TestedCount = 0;
+	m_CulledCount = 0;
+}
+
+void OcclusionCuller::AddOccluder(Mesh& _mesh, const glm::mat4& _modelMatrix)
+{
+	AddOccluder(_mesh.GetVertices(), _mesh.GetIndices(), _modelMatrix);
+	for (auto& subMesh : _mesh.GetSubMeshes())
+	{
+		AddOccluder(*subMesh, _modelMatrix);
+	}
+}
+
+void OcclusionCuller::AddOccluder(const std::vector<Vertex>& _vertices, const std::vector<unsigned int>& _indices, const glm::mat4& _modelMatrix)
+{
+	glm::mat4 pvmMatrix = m_PVMatrix * _modelMatrix;
+	glm::vec2 halfResolution = glm::vec2(m_Resolution) * 0.5f;
+
+	for (size_t i = 0; i + 2 < _indices.size(); i += 3)
+	{
+		OccluderTriangle triangle{};
+		bool isClipped = false;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			glm::vec4 clip = pvmMatrix * glm::vec4(_vertices[_indices[i + corner]].position, 1.0f);
+
+			// Triangles crossing the near plane are skipped, the GPU clips that part away and losing an occluder is always safe
+			if (IsNearClipped(clip))
+			{
+				isClipped = true;
+				break;
+			}
+
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			triangle.Vertices[corner] = {
+				(ndc.x + 1.0f) * halfResolution.x,
+				(ndc.y + 1.0f) * halfResolution.y,
+				ndc.z * 0.5f + 0.5f };
+		}
+		if (isClipped)
+			continue;
+
+		// Screen space bounds
+		glm::vec3 minimum = glm::min(glm::min(triangle.Vertices[0], triangle.Vertices[1]), triangle.Vertices[2]);
+		glm::vec3 maximum = glm::max(glm::max(triangle.Vertices[0], triangle.Vertices[1]), triangle.Vertices[2]);
+		if (maximum.x < 0 || maximum.y < 0 || minimum.x >= m_Resolution.x || minimum.y >= m_Resolution.y || maximum.z < 0 || minimum.z > 1)
+			continue;
+
+		// Degenerate
+		glm::vec2 edge1 = glm::vec2(triangle.Vertices[1] - triangle.Vertices[0]);
+		glm::vec2 edge2 = glm::vec2(triangle.Vertices[2] - triangle.Vertices[0]);
+		if (edge1.x * edge2.y - edge1.y * edge2.x == 0.0f)
+			continue;
+
+		// Bin to every tile the screen space bounds touch
+		int triangleIndex = (int)m_Triangles.size();
+		m_Triangles.push_back(triangle);
+
+		glm::ivec2 minTile = glm::clamp(glm::ivec2(glm::vec2(minimum)) / TileSize, glm::ivec2(0), m_TileCount - 1);
+		glm::ivec2 maxTile = glm::clamp(glm::ivec2(glm::vec2(maximum)) / TileSize, glm::ivec2(0), m_TileCount - 1);
+		for (int tileY = minTile.y; tileY <= maxTile.y; tileY++)
+		{
+			for (int tileX = minTile.x; tileX <= maxTile.x; tileX++)
+			{
+				m_TileBins[(size_t)tileY * m_TileCount.x + tileX].push_back(triangleIndex);
+			}
+		}
+	}
+}
+
+void OcclusionCuller::RasterizeOccluders()
+{
+	int tileCount = m_TileCount.x * m_TileCount.y;
+
+	// Each thread owns whole tiles so no two threads ever write the same pixel
+	auto rasterizeTiles = [this, tileCount](int _firstTile)
+	{
+		for (int tile = _firstTile; tile < tileCount; tile += m_ThreadCount)
+		{
+			RasterizeTile(tile);
+			BuildHiZ(tile);
+		}
+	};
+
+	std::vector<std::future<void>> workers;
+	for (int thread = 1; thread < m_ThreadCount; thread++)
+	{
+		workers.push_back(std::async(std::launch::async, rasterizeTiles, thread));
+	}
+	rasterizeTiles(0);
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+}
+
+bool OcclusionCuller::IsVisible(const AABB& _worldBounds)
+{
+	m_TestedCount++;
+
+	// Project the 8 corners and find the screen rectangle and nearest depth
+	glm::vec2 halfResolution = glm::vec2(m_Resolution) * 0.5f;
+	glm::vec2 minScreen{ FLT_MAX };
+	glm::vec2 maxScreen{ -FLT_MAX };
+	float minDepth = FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 position{
+			(corner & 1) ? _worldBounds.Max.x : _worldBounds.Min.x,
+			(corner & 2) ? _worldBounds.Max.y : _worldBounds.Min.y,
+			(corner & 4) ? _worldBounds.Max.z : _worldBounds.Min.z };
+		glm::vec4 clip = m_PVMatrix * glm::vec4(position, 1.0f);
+
+		// Bounds crossing the near plane are always visible
+		if (IsNearClipped(clip))
+			return true;
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 screen{ (ndc.x + 1.0f) * halfResolution.x, (ndc.y + 1.0f) * halfResolution.y };
+		minScreen = glm::min(minScreen, screen);
+		maxScreen = glm::max(maxScreen, screen);
+		minDepth = glm::min(minDepth, ndc.z * 0.5f + 0.5f);
+	}
+
+	glm::ivec2 minPixel = glm::max(glm::ivec2(glm::floor(minScreen)), glm::ivec2(0));
+	glm::ivec2 maxPixel = glm::min(glm::ivec2(glm::ceil(maxScreen)), m_Resolution) - 1;
+
+	// Off screen, the frustum culler should have caught this
+	if (minPixel.x > maxPixel.x || minPixel.y > maxPixel.y)
+	{
+		m_CulledCount++;
+		return false;
+	}
+
+	// Coarse test against the max depth of each HiZ block
+	glm::ivec2 minBlock = minPixel / HiZBlockSize;
+	glm::ivec2 maxBlock = maxPixel / HiZBlockSize;
+	bool isPotentiallyVisible = false;
+	for (int blockY = minBlock.y; blockY <= maxBlock.y && !isPotentiallyVisible; blockY++)
+	{
+		for (int blockX = minBlock.x; blockX <= maxBlock.x; blockX++)
+		{
+			if (m_HiZ[(size_t)blockY * m_HiZResolution.x + blockX] >= minDepth)
+			{
+				isPotentiallyVisible = true;
+				break;
+			}
+		}
+	}
+	if (!isPotentiallyVisible)
+	{
+		m_CulledCount++;
+		return false;
+	}
+
+	// Fine test against the full resolution depth buffer
+	for (int y = minPixel.y; y <= maxPixel.y; y++)
+	{
+		const float* row = &m_DepthBuffer[(size_t)y * m_Resolution.x];
+		for (int x = minPixel.x; x <= maxPixel.x; x++)
+		{
+			if (row[x] >= minDepth)
+				return true;
+		}
+	}
+
+	m_CulledCount++;
+	return false;
+}
+
+glm::ivec2 OcclusionCuller::GetResolution()
+{
+	return m_Resolution;
+}
+
+const std::vector<float>& OcclusionCuller::GetDepthBuffer()
+{
+	return m_DepthBuffer;
+}
+
+int OcclusionCuller::GetOccluderTriangleCount()
+{
+	return (int)m_Triangles.size();
+}
+
+glm::ivec2 OcclusionCuller::GetTestedAndCulledCount()
+{
+	return { m_TestedCount, m_CulledCount };
+}
+
+void OcclusionCuller::RasterizeTile(int _tileIndex)
+{
+	glm::ivec2 tile{ _tileIndex % m_TileCount.x, _tileIndex / m_TileCount.x };
+	glm::ivec2 tileMin = tile * TileSize;
+	glm::ivec2 tileMax = glm::min(tileMin + TileSize, m_Resolution) - 1;
+
+	for (int triangleIndex : m_TileBins[_tileIndex])
+	{
+		RasterizeTriangle(m_Triangles[triangleIndex], tileMin, tileMax);
+	}
+}
+
+void OcclusionCuller::RasterizeTriangle(const OccluderTriangle& _triangle, glm::ivec2 _minPixel, glm::ivec2 _maxPixel)
+{
+	glm::vec3 v0 = _triangle.Vertices[0];
+	glm::vec3 v1 = _triangle.Vertices[1];
+	glm::vec3 v2 = _triangle.Vertices[2];
+
+	// Occluders are double sided, make the winding counter clockwise
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+	if (area < 0)
+	{
+		std::swap(v1, v2);
+		area = -area;
+	}
+
+	// Edge functions E(x, y) = A * x + B * y + C, inside when all three are >= 0
+	glm::vec3 edgeA{ v1.y - v2.y, v2.y - v0.y, v0.y - v1.y };
+	glm::vec3 edgeB{ v2.x - v1.x, v0.x - v2.x, v1.x - v0.x };
+	glm::vec3 edgeC{
+		v1.x * v2.y - v1.y * v2.x,
+		v2.x * v0.y - v2.y * v0.x,
+		v0.x * v1.y - v0.y * v1.x };
+
+	// Depth plane Z(x, y) = A * x + B * y + C from the barycentric weights
+	float inverseArea = 1.0f / area;
+	float depthA = (edgeA.x * v0.z + edgeA.y * v1.z + edgeA.z * v2.z) * inverseArea;
+	float depthB = (edgeB.x * v0.z + edgeB.y * v1.z + edgeB.z * v2.z) * inverseArea;
+	float depthC = (edgeC.x * v0.z + edgeC.y * v1.z + edgeC.z * v2.z) * inverseArea;
+
+	// Pixel bounds of the triangle inside the tile
+	glm::ivec2 minPixel = glm::max(glm::ivec2(glm::floor(glm::min(glm::min(glm::vec2(v0), glm::vec2(v1)), glm::vec2(v2)))), _minPixel);
+	glm::ivec2 maxPixel = glm::min(glm::ivec2(glm::ceil(glm::max(glm::max(glm::vec2(v0), glm::vec2(v1)), glm::vec2(v2)))), _maxPixel);
+	if (minPixel.x > maxPixel.x || minPixel.y > maxPixel.y)
+		return;
+
+#if defined(__AVX2__)
+	// Rasterize 8 pixels at a time, starting aligned to 8 so loads and stores stay inside the row
+	int startX = minPixel.x & ~7;
+	const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 a0 = _mm256_set1_ps(edgeA.x), a1 = _mm256_set1_ps(edgeA.y), a2 = _mm256_set1_ps(edgeA.z);
+	const __m256 depthAX = _mm256_set1_ps(depthA);
+
+	for (int y = minPixel.y; y <= maxPixel.y; y++)
+	{
+		float pixelY = (float)y + 0.5f;
+		__m256 rowEdge0 = _mm256_set1_ps(edgeB.x * pixelY + edgeC.x);
+		__m256 rowEdge1 = _mm256_set1_ps(edgeB.y * pixelY + edgeC.y);
+		__m256 rowEdge2 = _mm256_set1_ps(edgeB.z * pixelY + edgeC.z);
+		__m256 rowDepth = _mm256_set1_ps(depthB * pixelY + depthC);
+		float* row = &m_DepthBuffer[(size_t)y * m_Resolution.x];
+
+		for (int x = startX; x <= maxPixel.x; x += 8)
+		{
+			__m256 pixelX = _mm256_add_ps(_mm256_set1_ps((float)x), laneOffsets);
+
+			__m256 edge0 = _mm256_add_ps(_mm256_mul_ps(a0, pixelX), rowEdge0);
+			__m256 edge1 = _mm256_add_ps(_mm256_mul_ps(a1, pixelX), rowEdge1);
+			__m256 edge2 = _mm256_add_ps(_mm256_mul_ps(a2, pixelX), rowEdge2);
+
+			// Inside if no edge function is negative
+			__m256 inside = _mm256_and_ps(
+				_mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ), _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ)),
+				_mm256_cmp_ps(edge2, zero, _CMP_GE_OQ));
+
+			// Clip lanes to the pixel bounds of the tile
+			__m256i laneX = _mm256_add_epi32(_mm256_set1_epi32(x), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			__m256i inRange = _mm256_and_si256(
+				_mm256_cmpgt_epi32(laneX, _mm256_set1_epi32(minPixel.x - 1)),
+				_mm256_cmpgt_epi32(_mm256_set1_epi32(maxPixel.x + 1), laneX));
+			inside = _mm256_and_ps(inside, _mm256_castsi256_ps(inRange));
+			if (_mm256_testz_ps(inside, inside))
+				continue;
+
+			__m256 depth = _mm256_add_ps(_mm256_mul_ps(depthAX, pixelX), rowDepth);
+			__m256 oldDepth = _mm256_loadu_ps(row + x);
+			__m256 newDepth = _mm256_blendv_ps(oldDepth, _mm256_min_ps(oldDepth, depth), inside);
+			_mm256_storeu_ps(row + x, newDepth);
+		}
+	}
+#else
+	for (int y = minPixel.y; y <= maxPixel.y; y++)
+	{
+		float pixelY = (float)y + 0.5f;
+		float* row = &m_DepthBuffer[(size_t)y * m_Resolution.x];
+		for (int x = minPixel.x; x <= maxPixel.x; x++)
+		{
+			float pixelX = (float)x + 0.5f;
+			float edge0 = edgeA.x * pixelX + edgeB.x * pixelY + edgeC.x;
+			float edge1 = edgeA.y * pixelX + edgeB.y * pixelY + edgeC.y;
+			float edge2 = edgeA.z * pixelX + edgeB.z * pixelY + edgeC.z;
+			if (edge0 < 0 || edge1 < 0 || edge2 < 0)
+				continue;
+
+			float depth = depthA * pixelX + depthB * pixelY + depthC;
+			row[x] = glm::min(row[x], depth);
+		}
+	}
+#endif
+}
+
+void OcclusionCuller::BuildHiZ(int _tileIndex)
+{
+	glm::ivec2 tile{ _tileIndex % m_TileCount.x, _tileIndex / m_TileCount.x };
+	glm::ivec2 minBlock = tile * (TileSize / HiZBlockSize);
+	glm::ivec2 maxBlock = glm::min(minBlock + TileSize / HiZBlockSize, m_HiZResolution);
+
+	for (int blockY = minBlock.y; blockY < maxBlock.y; blockY++)
+	{
+		for (int blockX = minBlock.x; blockX < maxBlock.x; blockX++)
+		{
+			// Furthest depth in the block, anything nearer than this is potentially visible
+			float maxDepth = 0.0f;
+			int endY = glm::min((blockY + 1) * HiZBlockSize, m_Resolution.y);
+			int endX = glm::min((blockX + 1) * HiZBlockSize, m_Resolution.x);
+			for (int y = blockY * HiZBlockSize; y < endY; y++)
+			{
+				const float* row = &m_DepthBuffer[(size_t)y * m_Resolution.x];
+				for (int x = blockX * HiZBlockSize; x < endX; x++)
+				{
+					maxDepth = glm::max(maxDepth, row[x]);
+				}
+			}
+			m_HiZ[(size_t)blockY * m_HiZResolution.x + blockX] = maxDepth;
+		}
+	}
+}
+
+void OcclusionCuller::Benchmark(int _occluderCount, int _testCount)
+{
+	// Unit cube occluder
+	std::vector<Vertex> cubeVertices{};
+	for (int corner = 0; corner < 8; corner++)
+	{
+		cubeVertices.push_back(Vertex{ { (corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f } });
+	}
+	std::vector<unsigned int> cubeIndices{
+		0,1,3, 0,3,2, 4,6,7, 4,7,5,
+		0,4,5, 0,5,1, 2,3,7, 2,7,6,
+		0,2,6, 0,6,4, 1,5,7, 1,7,3 };
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> size(1.0f, 8.0f);
+
+	glm::mat4 pvMatrix = glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 2000.0f) * glm::lookAt(glm::vec3{ 0,0,60 }, glm::vec3{ 0,0,0 }, glm::vec3{ 0,1,0 });
+
+	std::vector<glm::mat4> occluders{};
+	for (int i = 0; i < _occluderCount; i++)
+	{
+		glm::mat4 model = glm::translate(glm::mat4(1), { position(random), position(random), position(random) });
+		occluders.push_back(glm::scale(model, { size(random), size(random), size(random) }));
+	}
+
+	std::vector<AABB> tests{};
+	for (int i = 0; i < _testCount; i++)
+	{
+		glm::vec3 centre{ position(random), position(random), position(random) };
+		tests.push_back(AABB{ centre - 0.5f, centre + 0.5f });
+	}
+
+	OcclusionCuller culler{};
+	const int iterations = 100;
+	double rasterizeTime = 0.0, testTime = 0.0;
+	int culled = 0;
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		culler.BeginFrame(pvMatrix);
+		for (auto& model : occluders)
+		{
+			culler.AddOccluder(cubeVertices, cubeIndices, model);
+		}
+		culler.RasterizeOccluders();
+		auto rasterized = std::chrono::high_resolution_clock::now();
+
+		culled = 0;
+		for (auto& bounds : tests)
+		{
+			if (!culler.IsVisible(bounds))
+				culled++;
+		}
+		auto tested = std::chrono::high_resolution_clock::now();
+
+		rasterizeTime += std::chrono::duration<double, std::milli>(rasterized - start).count();
+		testTime += std::chrono::duration<double, std::milli>(tested - rasterized).count();
+	}
+
+	Print("Occlusion Culler Benchmark (" + std::to_string(culler.GetResolution().x) + "x" + std::to_string(culler.GetResolution().y) + ", " + std::to_string(culler.m_ThreadCount) + " threads)");
+	Print("Occluders: " + std::to_string(_occluderCount) + " (" + std::to_string(culler.GetOccluderTriangleCount()) + " triangles) Rasterize: " + std::to_string(rasterizeTime / iterations) + "ms");
+	Print("Tests: " + std::to_string(_testCount) + " Culled: " + std::to_string(culled) + " Test: " + std::to_string(testTime / iterations) + "ms");
+}
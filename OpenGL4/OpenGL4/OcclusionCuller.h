@@ -0,0 +1,146 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : OcclusionCuller.h 
+// Description : OcclusionCuller Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Mesh.h"
+
+/// <summary>
+/// A screen space occluder triangle. X and Y are in pixels, Z is depth in the range 0 (near) to 1 (far).
+/// </summary>
+struct OccluderTriangle
+{
+	glm::vec3 Vertices[3]{};
+};
+
+/// <summary>
+/// CPU software occlusion culler.
+/// Occluder meshes are rasterized into a low resolution depth buffer split into tiles,
+/// tiles are rasterized in parallel (8 pixels at a time with AVX2) and a max depth hierarchy
+/// is built so object bounds can be rejected before their draws are submitted.
+/// Runs entirely on the CPU so it can be used and benchmarked without a GL context.
+/// </summary>
+class OcclusionCuller
+{
+public:
+	/// <summary>
+	/// OcclusionCuller Constructor
+	/// </summary>
+	/// <param name="_resolution"> Depth buffer resolution. The width is rounded up to a multiple of 8 </param>
+	/// <param name="_threadCount"> Number of rasterizer threads, 0 uses the hardware thread count </param>
+	OcclusionCuller(glm::ivec2 _resolution = { 256, 128 }, int _threadCount = 0);
+
+	/// <summary>
+	/// OcclusionCuller Destructor
+	/// </summary>
+	~OcclusionCuller();
+
+	/// <summary>
+	/// Clears the depth buffer and occluders and sets the projection * view matrix to use this frame.
+	/// </summary>
+	/// <param name="_pvMatrix"></param>
+	void BeginFrame(const glm::mat4& _pvMatrix);
+
+	/// <summary>
+	/// Transforms and bins the triangles of the given mesh (and its sub meshes) as an occluder.
+	/// </summary>
+	/// <param name="_mesh"></param>
+	/// <param name="_modelMatrix"></param>
+	void AddOccluder(Mesh& _mesh, const glm::mat4& _modelMatrix);
+
+	/// <summary>
+	/// Transforms and bins the given triangles as an occluder.
+	/// </summary>
+	/// <param name="_vertices"></param>
+	/// <param name="_indices"></param>
+	/// <param name="_modelMatrix"></param>
+	void AddOccluder(const std::vector<Vertex>& _vertices, const std::vector<unsigned int>& _indices, const glm::mat4& _modelMatrix);
+
+	/// <summary>
+	/// Rasterizes all binned occluders and builds the hierarchical depth buffer.
+	/// </summary>
+	void RasterizeOccluders();
+
+	/// <summary>
+	/// Returns false if the world space AABB is completely hidden behind the rasterized occluders.
+	/// </summary>
+	/// <param name="_worldBounds"></param>
+	/// <returns></returns>
+	bool IsVisible(const AABB& _worldBounds);
+
+	/// <summary>
+	/// Returns the resolution of the depth buffer.
+	/// </summary>
+	/// <returns></returns>
+	glm::ivec2 GetResolution();
+
+	/// <summary>
+	/// Returns the depth buffer. Row major from the bottom left, 1.0 is the far plane.
+	/// </summary>
+	/// <returns></returns>
+	const std::vector<float>& GetDepthBuffer();
+
+	/// <summary>
+	/// Returns the number of occluder triangles rasterized this frame.
+	/// </summary>
+	/// <returns></returns>
+	int GetOccluderTriangleCount();
+
+	/// <summary>
+	/// Returns the number of bounds tested and culled since BeginFrame.
+	/// </summary>
+	/// <returns></returns>
+	glm::ivec2 GetTestedAndCulledCount();
+
+	/// <summary>
+	/// Runs a headless benchmark with randomly placed box occluders and prints the timings.
+	/// </summary>
+	/// <param name="_occluderCount"></param>
+	/// <param name="_testCount"></param>
+	static void Benchmark(int _occluderCount = 200, int _testCount = 10000);
+
+	static const int TileSize = 32;
+	static const int HiZBlockSize = 8;
+
+private:
+	/// <summary>
+	/// Rasterizes every triangle binned to the given tile.
+	/// </summary>
+	/// <param name="_tileIndex"></param>
+	void RasterizeTile(int _tileIndex);
+
+	/// <summary>
+	/// Rasterizes a single triangle clipped to the given pixel rectangle.
+	/// </summary>
+	/// <param name="_triangle"></param>
+	/// <param name="_minPixel"></param>
+	/// <param name="_maxPixel"></param>
+	void RasterizeTriangle(const OccluderTriangle& _triangle, glm::ivec2 _minPixel, glm::ivec2 _maxPixel);
+
+	/// <summary>
+	/// Builds the max depth of every HiZ block inside the given tile.
+	/// </summary>
+	/// <param name="_tileIndex"></param>
+	void BuildHiZ(int _tileIndex);
+
+	glm::ivec2 m_Resolution{ 256, 128 };
+	glm::ivec2 m_TileCount{ 8, 4 };
+	glm::ivec2 m_HiZResolution{ 32, 16 };
+	int m_ThreadCount{ 1 };
+
+	glm::mat4 m_PVMatrix{ 1 };
+
+	std::vector<float> m_DepthBuffer{};
+	std::vector<float> m_HiZ{};
+	std::vector<OccluderTriangle> m_Triangles{};
+	std::vector<std::vector<int>> m_TileBins{};
+
+	int m_TestedCount{ 0 };
+	int m_CulledCount{ 0 };
+};
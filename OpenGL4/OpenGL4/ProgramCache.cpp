@@ -0,0 +1,171 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : ProgramCache.cpp 
+// Description : ProgramCache Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "ProgramCache.h"
+#include <filesystem>
+
+namespace
+{
+	const uint32_t EntryMagic = 0x42505247; // "GRPB"
+
+	// 64 bit FNV-1a
+	uint64_t HashBytes(const void* _data, size_t _size, uint64_t _hash = 14695981039346656037ull)
+	{
+		const unsigned char* bytes = (const unsigned char*)_data;
+		for (size_t i = 0; i < _size; i++)
+		{
+			_hash ^= bytes[i];
+			_hash *= 1099511628211ull;
+		}
+		return _hash;
+	}
+}
+
+uint64_t ProgramCache::HashProgram(const std::vector<GLenum>& _types, const std::vector<std::string>& _sources)
+{
+	// Binaries are only valid for the driver that made them
+	if (m_DriverHash == 0)
+	{
+		uint64_t driverHash = HashBytes(nullptr, 0);
+		for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+		{
+			const char* value = (const char*)glGetString(name);
+			if (value)
+				driverHash = HashBytes(value, std::strlen(value), driverHash);
+		}
+		m_DriverHash = driverHash;
+	}
+
+	uint64_t hash = m_DriverHash;
+	for (size_t i = 0; i < _sources.size(); i++)
+	{
+		GLenum type = i < _types.size() ? _types[i] : 0;
+		hash = HashBytes(&type, sizeof(type), hash);
+		hash = HashBytes(_sources[i].data(), _sources[i].size(), hash);
+	}
+	return hash;
+}
+
+bool ProgramCache::Load(GLuint _program, uint64_t _key)
+{
+	if (!IsSupported())
+	{
+		m_MissCount++;
+		return false;
+	}
+
+	std::ifstream fileStream(GetEntryPath(_key), std::ios::binary | std::ios::ate);
+	if (!fileStream.is_open())
+	{
+		m_MissCount++;
+		return false;
+	}
+	uint64_t fileSize = (uint64_t)fileStream.tellg();
+	fileStream.seekg(0);
+
+	uint32_t magic = 0;
+	GLenum binaryFormat = 0;
+	uint32_t binarySize = 0;
+	fileStream.read((char*)&magic, sizeof(magic));
+	fileStream.read((char*)&binaryFormat, sizeof(binaryFormat));
+	fileStream.read((char*)&binarySize, sizeof(binarySize));
+
+	// The header is checked before anything is allocated, the binary has to be exactly the rest of the file
+	const uint64_t headerSize = sizeof(magic) + sizeof(binaryFormat) + sizeof(binarySize);
+	bool isRead = fileStream.good() && magic == EntryMagic && binarySize > 0 && binarySize == fileSize - headerSize;
+	std::vector<char> binary{};
+	if (isRead)
+	{
+		binary.resize(binarySize);
+		fileStream.read(binary.data(), binarySize);
+		isRead = fileStream.good();
+	}
+	fileStream.close();
+
+	GLint linkStatus = GL_FALSE;
+	if (isRead)
+	{
+		glProgramBinary(_program, binaryFormat, binary.data(), binarySize);
+		glGetProgramiv(_program, GL_LINK_STATUS, &linkStatus);
+	}
+
+	// Stale or corrupt, compile instead and let the fresh binary replace it
+	if (linkStatus == GL_FALSE)
+	{
+		std::error_code error{};
+		std::filesystem::remove(GetEntryPath(_key), error);
+		m_MissCount++;
+		return false;
+	}
+
+	m_HitCount++;
+	return true;
+}
+
+void ProgramCache::Store(GLuint _program, uint64_t _key)
+{
+	if (!IsSupported())
+		return;
+
+	GLint binarySize = 0;
+	glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+	if (binarySize <= 0)
+		return;
+
+	std::vector<char> binary(binarySize);
+	GLenum binaryFormat = 0;
+	GLsizei length = 0;
+	glGetProgramBinary(_program, binarySize, &length, &binaryFormat, binary.data());
+	if (length <= 0)
+		return;
+
+	std::error_code error{};
+	std::filesystem::create_directories(Directory, error);
+	std::ofstream fileStream(GetEntryPath(_key), std::ios::binary);
+	if (!fileStream.is_open())
+	{
+		Print("Failed to write program cache entry " + GetEntryPath(_key));
+		return;
+	}
+
+	uint32_t size = (uint32_t)length;
+	fileStream.write((const char*)&EntryMagic, sizeof(EntryMagic));
+	fileStream.write((const char*)&binaryFormat, sizeof(binaryFormat));
+	fileStream.write((const char*)&size, sizeof(size));
+	fileStream.write(binary.data(), length);
+}
+
+bool ProgramCache::IsSupported()
+{
+	if (m_IsSupported < 0)
+	{
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		m_IsSupported = formatCount > 0 ? 1 : 0;
+	}
+	return m_IsSupported == 1;
+}
+
+int ProgramCache::GetHitCount()
+{
+	return m_HitCount;
+}
+
+int ProgramCache::GetMissCount()
+{
+	return m_MissCount;
+}
+
+std::string ProgramCache::GetEntryPath(uint64_t _key)
+{
+	char name[17]{};
+	std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)_key);
+	return std::string(Directory) + name + ".bin";
+}
@@ -0,0 +1,79 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : ProgramCache.h 
+// Description : ProgramCache Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// On disk cache of linked program binaries, so later runs skip compiling and linking.
+/// Entries are named by a 64 bit hash of the shader stages, their final sources and the driver,
+/// so editing a shader or updating the driver simply misses and stores a new entry.
+/// </summary>
+class ProgramCache
+{
+public:
+	/// <summary>
+	/// Returns the cache key of a program built from the given stages and sources.
+	/// </summary>
+	/// <param name="_types"></param>
+	/// <param name="_sources"></param>
+	/// <returns></returns>
+	static uint64_t HashProgram(const std::vector<GLenum>& _types, const std::vector<std::string>& _sources);
+
+	/// <summary>
+	/// Restores the program from the cached binary.
+	/// Returns false if there is no entry or the driver rejects it, in which case the entry is removed.
+	/// </summary>
+	/// <param name="_program"></param>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	static bool Load(GLuint _program, uint64_t _key);
+
+	/// <summary>
+	/// Writes the binary of a linked program to the cache.
+	/// The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+	/// </summary>
+	/// <param name="_program"></param>
+	/// <param name="_key"></param>
+	static void Store(GLuint _program, uint64_t _key);
+
+	/// <summary>
+	/// Returns true if the driver supports at least one program binary format.
+	/// </summary>
+	/// <returns></returns>
+	static bool IsSupported();
+
+	/// <summary>
+	/// Returns the number of programs restored from the cache.
+	/// </summary>
+	/// <returns></returns>
+	static int GetHitCount();
+
+	/// <summary>
+	/// Returns the number of programs that had to be compiled.
+	/// </summary>
+	/// <returns></returns>
+	static int GetMissCount();
+
+	inline static const char* Directory = "Resources/ShaderCache/";
+
+private:
+	/// <summary>
+	/// Returns the path of the entry for a key.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	static std::string GetEntryPath(uint64_t _key);
+
+	inline static int m_HitCount{ 0 };
+	inline static int m_MissCount{ 0 };
+	inline static int m_IsSupported{ -1 };
+	inline static uint64_t m_DriverHash{ 0 };
+};
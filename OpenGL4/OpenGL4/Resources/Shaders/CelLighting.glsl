@@ -0,0 +1,153 @@
+// Cel shaded lighting shared by the forward and deferred shaders.
+// The including shader declares the surface being lit before including this:
+// vec3 FragPosition, vec3 FragNormal, float Shininess and vec3 ReverseViewDir.
+#include "FrameUniforms.glsl"
+#include "Lights.glsl"
+
+// Baked L2 spherical harmonic irradiance, 9 coefficients per probe
+layout(std430, binding = 7) readonly buffer ProbeBuffer
+{
+    vec4 ProbeCoefficients[];
+};
+
+// Cascaded shadow map of the sun, one cascade per layer
+layout (binding = 7) uniform sampler2DArrayShadow ShadowMap;
+
+float CalculateShadow();
+vec3 ApplyCellShading(vec3 _lighting, vec3 _lightDir);
+
+vec3 CalculateAmbientLight()
+{
+    if (ProbeGridMin.w == 0.0f)
+        return AmbientColorStrength.a * AmbientColorStrength.rgb;
+
+    // L2 basis of the normal
+    vec3 n = normalize(FragNormal);
+    float basis[9] = float[9](
+        0.282095f,
+        0.488603f * n.y, 0.488603f * n.z, 0.488603f * n.x,
+        1.092548f * n.x * n.y, 1.092548f * n.y * n.z, 0.315392f * (3.0f * n.z * n.z - 1.0f), 1.092548f * n.x * n.z, 0.546274f * (n.x * n.x - n.y * n.y));
+
+    // Trilinear blend of the 8 surrounding probes, clamped to the grid
+    vec3 gridPosition = clamp((FragPosition - ProbeGridMin.xyz) / ProbeGridCellSize.xyz, vec3(0.0f), vec3(ProbeGridResolution.xyz - 1));
+    ivec3 baseProbe = min(ivec3(gridPosition), max(ProbeGridResolution.xyz - 2, ivec3(0)));
+    vec3 fraction = clamp(gridPosition - vec3(baseProbe), 0.0f, 1.0f);
+
+    vec3 irradiance = vec3(0.0f);
+    for (int corner = 0; corner < 8; corner++)
+    {
+        ivec3 offset = ivec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+        ivec3 probe = min(baseProbe + offset, ProbeGridResolution.xyz - 1);
+        vec3 weights = mix(1.0f - fraction, fraction, vec3(offset));
+        int first = 9 * (probe.x + ProbeGridResolution.x * (probe.y + ProbeGridResolution.y * probe.z));
+        vec3 probeIrradiance = vec3(0.0f);
+        for (int i = 0; i < 9; i++)
+        {
+            probeIrradiance += basis[i] * ProbeCoefficients[first + i].rgb;
+        }
+        irradiance += weights.x * weights.y * weights.z * probeIrradiance;
+    }
+    return max(irradiance, vec3(0.0f));
+}
+
+uint CalculateClusterIndex(vec2 _screenPosition)
+{
+    // Screen tile from the fragment position, exponential depth slice from the view space depth
+    float viewDepth = -(ViewMatrix * vec4(FragPosition, 1.0f)).z;
+    int slice = int(max(log(viewDepth) * ClusterTileSizeDepthScaleBias.z - ClusterTileSizeDepthScaleBias.w, 0.0f));
+    ivec3 cluster = clamp(ivec3(ivec2(_screenPosition / ClusterTileSizeDepthScaleBias.xy), slice), ivec3(0), ClusterGridSize.xyz - 1);
+    return uint(cluster.x + ClusterGridSize.x * (cluster.y + ClusterGridSize.y * cluster.z));
+}
+
+vec3 CalculateLight(Light _light)
+{
+    vec3 lightPosition = _light.PositionRadius.xyz;
+    vec3 lightColor = _light.ColorSpecular.rgb;
+    vec3 lightDir = normalize(FragPosition - lightPosition);
+
+    float strength = max(dot(FragNormal, -lightDir), 1.0f);
+    vec3 diffuseLight = strength * lightColor;
+
+    vec3 halfwayVector = normalize(-lightDir + ReverseViewDir);
+    float specularReflectivity = pow(max(dot(FragNormal, halfwayVector), 0.0f), Shininess);
+    vec3 specularLight = _light.ColorSpecular.w * specularReflectivity * lightColor;
+
+    float distance = length(lightPosition - FragPosition);
+    float attenuation = 1 + (_light.AttenuationInnerCutoff.x * distance) + (_light.AttenuationInnerCutoff.y * pow(distance, 2.0f));
+
+    // Fade to zero at the radius the light was clustered with so it never pops at cluster edges
+    float window = clamp(1.0f - pow(distance / _light.PositionRadius.w, 4.0f), 0.0f, 1.0f);
+    float intensity = window * window / attenuation;
+
+    // Spot lights fade between their inner and outer cone
+    if (_light.DirectionOuterCutoff.w > -1.5f)
+    {
+        float theta = dot(lightDir, normalize(_light.DirectionOuterCutoff.xyz));
+        intensity *= clamp((theta - _light.DirectionOuterCutoff.w) / max(_light.AttenuationInnerCutoff.z - _light.DirectionOuterCutoff.w, 0.0001f), 0.0f, 1.0f);
+    }
+
+    return ApplyCellShading((diffuseLight + specularLight) * intensity, lightDir);
+}
+
+vec3 CalculateDirectionalLight()
+{
+    if (SunDirection.w == 0.0f)
+        return vec3(0.0f);
+
+    vec3 lightDir = SunDirection.xyz;
+    float strength = max(dot(FragNormal, -lightDir), 0.0f);
+    vec3 diffuseLight = strength * SunColorSpecular.rgb;
+
+    vec3 halfwayVector = normalize(-lightDir + ReverseViewDir);
+    float specularReflectivity = pow(max(dot(FragNormal, halfwayVector), 0.0f), Shininess);
+    vec3 specularLight = SunColorSpecular.w * specularReflectivity * SunColorSpecular.rgb;
+
+    return ApplyCellShading((diffuseLight + specularLight) * CalculateShadow(), lightDir);
+}
+
+float CalculateShadow()
+{
+    // Pick the first cascade that reaches the fragment, beyond the last there are no shadows
+    int cascadeCount = int(ShadowParameters.x);
+    float viewDepth = -(ViewMatrix * vec4(FragPosition, 1.0f)).z;
+    int cascade = 0;
+    while (cascade < cascadeCount && viewDepth > CascadeSplits[cascade])
+    {
+        cascade++;
+    }
+    if (cascade >= cascadeCount)
+        return 1.0f;
+
+    // Offset along the normal by a few texels to avoid acne on surfaces facing away from the light
+    vec3 position = FragPosition + FragNormal * CascadeTexelSizes[cascade] * ShadowParameters.w;
+    vec4 lightSpace = CascadeMatrices[cascade] * vec4(position, 1.0f);
+    vec3 coords = lightSpace.xyz / lightSpace.w * 0.5f + 0.5f;
+    if (any(lessThan(coords, vec3(0.0f))) || any(greaterThan(coords, vec3(1.0f))))
+        return 1.0f;
+
+    // 3x3 percentage closer filter, each tap is already bilinearly filtered by the comparison sampler
+    float lit = 0.0f;
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            vec2 offset = vec2(x, y) * ShadowParameters.y;
+            lit += texture(ShadowMap, vec4(coords.xy + offset, cascade, coords.z - ShadowParameters.z));
+        }
+    }
+    return lit / 9.0f;
+}
+
+vec3 ApplyCellShading(vec3 _lighting, vec3 _lightDir)
+{
+    float nl = dot(FragNormal, -_lightDir);
+
+    if(nl > 0.5f)
+    {
+        return _lighting * 0.6f; 
+    }
+    else
+    {
+        return _lighting * 0.35f;
+    }
+}
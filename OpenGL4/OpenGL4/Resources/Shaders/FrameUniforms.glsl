@@ -0,0 +1,20 @@
+// Per frame state written once by FrameUniforms on the CPU, must match FrameUniformData
+layout (std140, binding = 0) uniform FrameUniforms
+{
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    mat4 PVMatrix;
+    vec4 CameraPosition;
+    vec4 AmbientColorStrength;
+    ivec4 ClusterGridSize;
+    vec4 ClusterTileSizeDepthScaleBias;
+    vec4 SunDirection;
+    vec4 SunColorSpecular;
+    mat4 CascadeMatrices[4];
+    vec4 CascadeSplits;
+    vec4 CascadeTexelSizes;
+    vec4 ShadowParameters;
+    vec4 ProbeGridMin;
+    vec4 ProbeGridCellSize;
+    ivec4 ProbeGridResolution;
+};
@@ -0,0 +1,32 @@
+#version 460 core
+
+// Permutations
+// HAS_TEXTURE takes the albedo from ImageTexture0, otherwise it is white.
+
+in vec2 FragTexCoords;
+in vec3 FragNormal;
+in vec3 FragPosition;
+
+#ifdef HAS_TEXTURE
+uniform sampler2D ImageTexture0;
+#endif
+
+uniform float Shininess;
+uniform int MaterialID;
+
+// Lighting is applied later from these, position is rebuilt from depth
+layout (location = 0) out vec4 Albedo;
+layout (location = 1) out vec4 NormalShininess;
+layout (location = 2) out uint Material;
+
+void main()
+{
+#ifdef HAS_TEXTURE
+    Albedo = texture(ImageTexture0, FragTexCoords);
+#else
+    Albedo = vec4(1.0f);
+#endif
+
+    NormalShininess = vec4(normalize(FragNormal), Shininess);
+    Material = uint(MaterialID);
+}
@@ -0,0 +1,24 @@
+// Point light when DirectionOuterCutoff.w is -2, otherwise a spot light
+struct Light
+{
+    vec4 PositionRadius;
+    vec4 ColorSpecular;
+    vec4 DirectionOuterCutoff;
+    vec4 AttenuationInnerCutoff;
+};
+
+layout(std430, binding = 4) readonly buffer LightBuffer
+{
+    Light Lights[];
+};
+
+// Offset and count into LightIndices for each cluster
+layout(std430, binding = 5) readonly buffer ClusterBuffer
+{
+    uvec2 Clusters[];
+};
+
+layout(std430, binding = 6) readonly buffer LightIndexBuffer
+{
+    uint LightIndices[];
+};
@@ -1,11 +1,19 @@
 #version 460 core
 
+// Permutations
+// OUTLINE pushes each vertex out along its normal by OutlineWidth for the toon outline pass.
+
 layout (location = 0) in vec3 Position;
 layout (location = 1) in vec2 TexCoords;
 layout (location = 2) in vec3 Normals;
 
-uniform mat4 PVMMatrix;
-uniform mat4 ModelMatrix;
+#include "ObjectTransforms.glsl"
+#include "FrameUniforms.glsl"
+
+uniform int ObjectIndex;
+#ifdef OUTLINE
+uniform float OutlineWidth;
+#endif
 
 out vec2 FragTexCoords;
 out vec3 FragNormal;
@@ -13,9 +21,14 @@ out vec3 FragPosition;
 
 void main()
 {
-	gl_Position = PVMMatrix * vec4(Position, 1.0f);
-
 	FragTexCoords = TexCoords;
-	FragNormal = normalize(mat3(transpose(inverse(ModelMatrix))) * Normals);
-	FragPosition = vec3(ModelMatrix * vec4(Position, 1.0f));
-}
\ No newline at end of file
+	FragNormal = normalize(mat3(ObjectTransforms[ObjectIndex].NormalMatrix) * Normals);
+	FragPosition = vec3(ObjectTransforms[ObjectIndex].ModelMatrix * vec4(Position, 1.0f));
+
+#ifdef OUTLINE
+	vec4 newPosition = vec4(Position + FragNormal * OutlineWidth, 1.0f);
+	gl_Position = ObjectTransforms[ObjectIndex].PVMMatrix * newPosition;
+#else
+	gl_Position = ObjectTransforms[ObjectIndex].PVMMatrix * vec4(Position, 1.0f);
+#endif
+}
@@ -0,0 +1,47 @@
+#version 460 core
+
+// Permutations
+// OUTLINE pushes each vertex out along its normal by OutlineWidth for the toon outline pass.
+
+layout (location = 0) in vec3 Position;
+layout (location = 1) in vec2 TexCoords;
+layout (location = 2) in vec3 Normals;
+
+struct Instance
+{
+    mat4 ModelMatrix;
+    mat4 NormalMatrix;
+    vec4 BoundsMin;
+    vec4 BoundsMax;
+};
+
+layout (std430, binding = 0) readonly buffer InstanceBuffer { Instance Instances[]; };
+
+#include "FrameUniforms.glsl"
+
+#ifdef OUTLINE
+uniform float OutlineWidth;
+#endif
+
+out vec2 FragTexCoords;
+out vec3 FragNormal;
+out vec3 FragPosition;
+
+void main()
+{
+	// The culling pass writes the instance index into the draws base instance
+	Instance instance = Instances[gl_BaseInstance + gl_InstanceID];
+	mat4 modelMatrix = instance.ModelMatrix;
+
+	FragTexCoords = TexCoords;
+	FragNormal = normalize(mat3(instance.NormalMatrix) * Normals);
+	FragPosition = vec3(modelMatrix * vec4(Position, 1.0f));
+
+#ifdef OUTLINE
+	vec4 newPosition = vec4(Position + FragNormal * OutlineWidth, 1.0f);
+	gl_Position = PVMatrix * modelMatrix * newPosition;
+#else
+	gl_Position = PVMatrix * vec4(FragPosition, 1.0f);
+#endif
+}
+
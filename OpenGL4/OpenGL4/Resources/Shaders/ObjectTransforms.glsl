@@ -0,0 +1,9 @@
+struct ObjectTransform
+{
+	mat4 ModelMatrix;
+	mat4 NormalMatrix;
+	mat4 PVMMatrix;
+};
+
+// Computed once per frame on the CPU, indexed per draw
+layout (std430, binding = 8) readonly buffer ObjectTransformBuffer { ObjectTransform ObjectTransforms[]; };
@@ -0,0 +1,11 @@
+#version 460 core
+
+layout (location = 0) in vec3 Position;
+
+uniform mat4 LightPVMatrix;
+uniform mat4 ModelMatrix;
+
+void main()
+{
+	gl_Position = LightPVMatrix * ModelMatrix * vec4(Position, 1.0f);
+}
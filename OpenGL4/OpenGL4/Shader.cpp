@@ -1,52 +1,41 @@
 #include "Shader.h"
 #include "ShaderLoader.h"
+#include "GLState.h"
 
-Shader::Shader(std::vector<ShaderInfo> _shaders, std::function<void()> _uniformsFunction)
+Shader::Shader(std::vector<ShaderInfo> _shaders, std::function<void()> _uniformsFunction, std::vector<std::string> _defines)
 {
     UniformsFunction = _uniformsFunction;
+    m_Stages = std::move(_shaders);
+    m_Defines = std::move(_defines);
 
-    // Create A Default Program
-    ID = glCreateProgram();
-
-    // Create Shaders And Store There ID's Locally
-    for (auto& shader : _shaders)
-    {
-        shader.ID = ShaderLoader::CompileShader(shader.Type, ShaderLoader::PassFileToString(shader.Filename));
-        glAttachShader(ID, shader.ID);
-    }
-
-    glLinkProgram(ID);
-    glValidateProgram(ID);
-
-    // Debug Output With Error Specific Message
-    int result = 0;
-    glGetProgramiv(ID, GL_LINK_STATUS, &result);
-    if (result == GL_FALSE)
-    {
-        int length = 0;
-        glGetProgramiv(ID, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
-        glGetProgramInfoLog(ID, length, &length, message);
-        std::string debugOutput = "Failed to Compile Shader Program ";
-        if (message != 0)
-            debugOutput += message;
-        Print(debugOutput);
-        glDeleteProgram(ID);
-        _freea(message);
-    }
-
-	
+    // Compiled, or restored from the program cache
+    ID = ShaderLoader::GetProgramVariant(m_Stages, m_Defines);
+}
+
+GLuint Shader::GetVariant(const std::vector<std::string>& _defines)
+{
+    if (m_Defines.empty())
+        return ShaderLoader::GetProgramVariant(m_Stages, _defines);
+
+    std::vector<std::string> defines = m_Defines;
+    defines.insert(defines.end(), _defines.begin(), _defines.end());
+    return ShaderLoader::GetProgramVariant(m_Stages, defines);
+}
+
+void Shader::SelectVariant(const std::vector<std::string>& _defines)
+{
+    ID = GetVariant(_defines);
 }
 
 void Shader::Bind()
 {
-	glUseProgram(ID);
+	GLState::UseProgram(ID);
 	SetUniforms();
 }
 
 void Shader::UnBind()
 {
-	glUseProgram(0);
+	// Left bound, GLState skips rebinding it if the next draw uses the same program
 }
 
 void Shader::SetUniforms()
@@ -1,5 +1,6 @@
 #pragma once
 #include "Helper.h"
+#include "FlatHashMap.h"
 
 struct ShaderInfo
 {
@@ -11,7 +12,48 @@ struct ShaderInfo
 class Shader
 {
 public:
-	Shader(std::vector<ShaderInfo> _shaders, std::function<void()> _uniformsFunction);
+	Shader(std::vector<ShaderInfo> _shaders, std::function<void()> _uniformsFunction, std::vector<std::string> _defines = {});
+
+	/// <summary>
+	/// Returns the permutation of this shader with extra defines, compiling it on first use.
+	/// </summary>
+	/// <param name="_defines"></param>
+	/// <returns></returns>
+	GLuint GetVariant(const std::vector<std::string>& _defines);
+
+	/// <summary>
+	/// Points ID at the permutation with the extra defines so Bind uses it.
+	/// </summary>
+	/// <param name="_defines"></param>
+	void SelectVariant(const std::vector<std::string>& _defines);
+
+	/// <summary>
+	/// Returns the permutation for a small key chosen by the caller, building its defines only the first time the key is seen,
+	/// so picking a permutation every draw allocates nothing.
+	/// </summary>
+	/// <param name="_key"> Must map to the same defines every time it is used with this shader </param>
+	/// <param name="_buildDefines"> Returns the defines of the permutation </param>
+	/// <returns></returns>
+	template<typename BuildDefines>
+	GLuint GetVariant(uint32_t _key, BuildDefines&& _buildDefines)
+	{
+		if (GLuint* variant = m_KeyedVariants.Find(_key))
+			return *variant;
+		GLuint program = GetVariant(_buildDefines());
+		m_KeyedVariants[_key] = program;
+		return program;
+	}
+
+	/// <summary>
+	/// Points ID at the permutation for a key so Bind uses it.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <param name="_buildDefines"></param>
+	template<typename BuildDefines>
+	void SelectVariant(uint32_t _key, BuildDefines&& _buildDefines)
+	{
+		ID = GetVariant(_key, std::forward<BuildDefines>(_buildDefines));
+	}
 
 	void Bind();
 	void UnBind();
@@ -19,5 +61,9 @@ public:
 	GLuint ID;
 private:
 	void SetUniforms();
+
+	std::vector<ShaderInfo> m_Stages{};
+	std::vector<std::string> m_Defines{};
+	FlatHashMap<uint32_t, GLuint> m_KeyedVariants{};
 };
 
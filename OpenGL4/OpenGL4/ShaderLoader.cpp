@@ -9,18 +9,28 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "ShaderLoader.h"
+#include "GLState.h"
+#include "VirtualFileSystem.h"
+#include "ProgramCache.h"
+#include <chrono>
+#include <thread>
 
 ShaderLoader::~ShaderLoader()
 {
-    glUseProgram(0);
+    GLState::UseProgram(0);
     for (auto& item : m_ShaderPrograms)
     {
-        glDeleteProgram(item.second);
+        GLState::DeleteProgram(item.second);
     }
     for (auto& item : m_Shaders)
     {
         glDeleteShader(item.second);
     }
+    for (auto& program : m_FailedPrograms)
+    {
+        GLState::DeleteProgram(program);
+    }
+    m_FailedPrograms.clear();
 
     m_Shaders.clear();
     m_ShaderPrograms.clear();
@@ -28,117 +38,673 @@ ShaderLoader::~ShaderLoader()
 
 GLuint ShaderLoader::CreateShader(std::string&& _vertexShader, std::string&& _fragmentShader)
 {
-    // Create A Default Program
+    std::vector<ShaderInfo> shaders{ ShaderInfo{ GL_VERTEX_SHADER, _vertexShader.c_str() }, ShaderInfo{ GL_FRAGMENT_SHADER, _fragmentShader.c_str() } };
+    GLuint program = CreateProgram(shaders);
+    if (program == 0)
+        return program;
+
+    // Push The New Shader Program To Vector
+    m_ShaderPrograms.push_back(std::make_pair(ShaderProgramLocation{ _vertexShader.c_str(), _fragmentShader.c_str() }, program));
+
+    // Return Program ID
+    return program;
+}
+
+GLuint ShaderLoader::CreateProgram(std::vector<ShaderInfo>& _shaders, const std::vector<std::string>& _defines)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<GLenum> types{};
+    std::vector<std::string> sources{};
+    for (auto& shader : _shaders)
+    {
+        types.push_back(shader.Type);
+        sources.push_back(PreprocessShader(shader.Filename, _defines));
+    }
+
+    // Defines are part of the preprocessed sources, so each permutation gets its own entry
+    // A cached binary skips compiling and linking entirely
+    uint64_t cacheKey = ProgramCache::HashProgram(types, sources);
     GLuint program = glCreateProgram();
+    if (ProgramCache::Load(program, cacheKey))
+    {
+        ReflectProgram(program);
+        if (m_IsBatching && std::find(types.begin(), types.end(), GL_VERTEX_SHADER) != types.end())
+            m_PrewarmPrograms.push_back(program);
+        m_ProgramCreationTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        return program;
+    }
 
-    // Create Shaders And Store There ID's Locally
-    GLuint vertShader = CompileShader(GL_VERTEX_SHADER, PassFileToString(_vertexShader));
-    GLuint fragShader = CompileShader(GL_FRAGMENT_SHADER, PassFileToString(_fragmentShader));
+    // The rejected binary may have left the program in a failed state, start again
+    GLState::DeleteProgram(program);
+    program = glCreateProgram();
 
-    // Attach Shaders To Program
+    // Create Shaders And Attach Them To The Program, their compile status is only checked if linking fails
     if (IsDebug)
     {
         Print("Attaching Shaders");
     }
-    glAttachShader(program, vertShader);
-    glAttachShader(program, fragShader);
+    PendingProgram pending{ program, {}, cacheKey, false };
+    for (size_t i = 0; i < _shaders.size(); i++)
+    {
+        _shaders[i].ID = SubmitShader(_shaders[i].Type, std::move(sources[i]));
+        glAttachShader(program, _shaders[i].ID);
+        pending.Shaders.push_back(_shaders[i].ID);
+        pending.IsGraphics |= _shaders[i].Type == GL_VERTEX_SHADER;
+    }
 
-    // Link And Validate
+    // Link
     if (IsDebug)
     {
         Print("Linking program");
     }
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
-    glValidateProgram(program);
+
+    // In a batch the driver keeps compiling while the caller carries on
+    if (m_IsBatching)
+    {
+        m_PendingPrograms.push_back(std::move(pending));
+        m_ProgramCreationTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        return program;
+    }
+
+    bool isLinked = FinishProgram(pending);
+    if (!isLinked)
+        GLState::DeleteProgram(program);
+    m_ProgramCreationTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return isLinked ? program : 0;
+}
+
+GLuint ShaderLoader::GetProgramVariant(const std::vector<ShaderInfo>& _shaders, const std::vector<std::string>& _defines)
+{
+    // Hashed in place so selecting an existing permutation every draw builds no strings
+    uint64_t key = HashProgramVariant(_shaders, _defines);
+    if (GLuint* variant = m_Variants.Find(key))
+        return *variant;
+
+    // Repeated defines get their own key, so look again with the defines the program is built from
+    std::vector<std::string> defines = _defines;
+    std::sort(defines.begin(), defines.end());
+    defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+    uint64_t uniqueKey = HashProgramVariant(_shaders, defines);
+    if (GLuint* variant = m_Variants.Find(uniqueKey))
+    {
+        GLuint program = *variant;
+        m_Variants[key] = program;
+        return program;
+    }
+
+    // Failed programs are remembered as 0 so they are not rebuilt every draw
+    std::vector<ShaderInfo> shaders = _shaders;
+    GLuint program = CreateProgram(shaders, defines);
+    m_Variants[uniqueKey] = program;
+    m_Variants[key] = program;
+    if (IsDebug)
+    {
+        Print("Created program variant " + std::to_string(program) + " with " + std::to_string(defines.size()) + " defines");
+    }
+    return program;
+}
+
+uint64_t ShaderLoader::HashProgramVariant(const std::vector<ShaderInfo>& _shaders, const std::vector<std::string>& _defines)
+{
+    uint64_t stageHash = StringID::OffsetBasis;
+    for (auto& shader : _shaders)
+    {
+        stageHash = StringID::Hash(shader.Filename, stageHash);
+        stageHash = StringID::Hash(";", stageHash);
+    }
+
+    // Summed so the order the defines are given in does not matter
+    uint64_t defineHash = 0;
+    for (auto& define : _defines)
+    {
+        defineHash += StringID::Hash(define);
+    }
+    return stageHash ^ (defineHash * StringID::Prime);
+}
+
+void ShaderLoader::BeginProgramBatch()
+{
+    m_IsBatching = true;
+
+    // Let the driver use as many compiler threads as it likes
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        m_IsParallelCompileSupported = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        m_IsParallelCompileSupported = true;
+    }
+}
+
+size_t ShaderLoader::PollPrograms()
+{
+    for (size_t i = 0; i < m_PendingPrograms.size();)
+    {
+        if (!IsProgramComplete(m_PendingPrograms[i].Program))
+        {
+            i++;
+            continue;
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        PendingProgram pending = std::move(m_PendingPrograms[i]);
+        m_PendingPrograms.erase(m_PendingPrograms.begin() + i);
+        if (!FinishProgram(pending))
+            DiscardBatchedProgram(pending.Program);
+        m_ProgramCreationTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    return m_PendingPrograms.size();
+}
+
+void ShaderLoader::EndProgramBatch()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    double creationTime = m_ProgramCreationTime;
+    while (!m_PendingPrograms.empty())
+    {
+        if (m_IsParallelCompileSupported)
+        {
+            if (PollPrograms() > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        else
+        {
+            // Without completion queries finishing a program simply blocks until it is linked
+            WaitForProgram(m_PendingPrograms.front().Program);
+        }
+    }
+    m_IsBatching = false;
+
+    PrewarmPrograms();
+    m_PrewarmPrograms.clear();
+
+    // Count the whole wait once, including the programs finished inside it
+    m_ProgramCreationTime = creationTime + std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ShaderLoader::WaitForProgram(GLuint _program)
+{
+    for (size_t i = 0; i < m_PendingPrograms.size(); i++)
+    {
+        if (m_PendingPrograms[i].Program != _program)
+            continue;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        PendingProgram pending = std::move(m_PendingPrograms[i]);
+        m_PendingPrograms.erase(m_PendingPrograms.begin() + i);
+        if (!FinishProgram(pending))
+            DiscardBatchedProgram(pending.Program);
+        m_ProgramCreationTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        return;
+    }
+}
+
+bool ShaderLoader::IsProgramComplete(GLuint _program)
+{
+    if (!m_IsParallelCompileSupported)
+        return true;
+
+    int isComplete = GL_FALSE;
+    glGetProgramiv(_program, GL_COMPLETION_STATUS_KHR, &isComplete);
+    return isComplete == GL_TRUE;
+}
+
+bool ShaderLoader::FinishProgram(const PendingProgram& _pending)
+{
+    glValidateProgram(_pending.Program);
 
     // Debug Output With Error Specific Message
     int result = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    glGetProgramiv(_pending.Program, GL_LINK_STATUS, &result);
     if (result == GL_FALSE)
     {
+        for (auto& shader : _pending.Shaders)
+        {
+            CheckShader(shader);
+        }
+
         int length = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        glGetProgramiv(_pending.Program, GL_INFO_LOG_LENGTH, &length);
         char* message = (char*)_malloca(length * sizeof(char));
-        glGetProgramInfoLog(program, length, &length, message);
+        glGetProgramInfoLog(_pending.Program, length, &length, message);
         std::string debugOutput = "Failed to Compile Shader Program ";
         if (message != 0)
             debugOutput += message;
         Print(debugOutput);
-        glDeleteProgram(program);
         _freea(message);
-        return result;
+        return false;
     }
 
-    // Push The New Shader Program To Vector
-    m_ShaderPrograms.push_back(std::make_pair(ShaderProgramLocation{ _vertexShader.c_str(), _fragmentShader.c_str() }, program));
+    ReflectProgram(_pending.Program);
+    ProgramCache::Store(_pending.Program, _pending.CacheKey);
+    if (m_IsBatching && _pending.IsGraphics)
+        m_PrewarmPrograms.push_back(_pending.Program);
+    return true;
+}
 
-    // Return Program ID
-    return program;
+void ShaderLoader::DiscardBatchedProgram(GLuint _program)
+{
+    // The caller already has the name, so it is kept allocated and unlinked rather than freed for the driver to reuse.
+    // Permutations created with it resolve to 0 from now on, like a program that failed outside a batch
+    for (auto& variant : m_Variants)
+    {
+        if (variant.second == _program)
+            variant.second = 0;
+    }
+    m_Reflections[_program] = {};
+    m_FailedPrograms.push_back(_program);
 }
 
-void ShaderLoader::SetUniform1i(GLuint&& _program, std::string_view&& _location, GLint _value)
+void ShaderLoader::PrewarmPrograms()
 {
-    glUniform1i(glGetUniformLocation(_program, _location.data()), _value);
+    if (m_PrewarmPrograms.empty())
+        return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // A 1x1 target with every attachment the real passes have
+    GLuint targets[2]{};
+    glGenTextures(2, targets);
+    GLState::BindTexture(GL_TEXTURE_2D, targets[0]);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 1, 1);
+    GLState::BindTexture(GL_TEXTURE_2D, targets[1]);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, 1, 1);
+    GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targets[0], 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, targets[1], 0);
+
+    GLint viewport[4]{};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, 1, 1);
+
+    // Vertex attributes are left disabled so every vertex reads the same constant value
+    GLuint vertexArray = 0;
+    glGenVertexArrays(1, &vertexArray);
+    GLState::BindVertexArray(vertexArray);
+
+    // Zeroed stand in for any uniform or storage block nothing has been bound to yet,
+    // so the draw reads element 0 of an empty buffer instead of an unbound one
+    const GLint zeroBufferSize = 64 * 1024;
+    std::vector<unsigned char> zeros(zeroBufferSize, 0);
+    GLuint zeroBuffer = 0;
+    glGenBuffers(1, &zeroBuffer);
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, zeroBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, zeroBufferSize, zeros.data(), GL_STATIC_DRAW);
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    for (auto& program : m_PrewarmPrograms)
+    {
+        std::vector<std::pair<GLenum, GLuint>> borrowedBindings{};
+        for (auto [interfaceType, target, bindingQuery] : { std::tuple{ GL_UNIFORM_BLOCK, GL_UNIFORM_BUFFER, GL_UNIFORM_BUFFER_BINDING }, std::tuple{ GL_SHADER_STORAGE_BLOCK, GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING } })
+        {
+            GLint blockCount = 0;
+            glGetProgramInterfaceiv(program, interfaceType, GL_ACTIVE_RESOURCES, &blockCount);
+            for (GLint block = 0; block < blockCount; block++)
+            {
+                const GLenum properties[2]{ GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+                GLint values[2]{};
+                glGetProgramResourceiv(program, interfaceType, block, 2, properties, 2, nullptr, values);
+
+                GLint boundBuffer = 0;
+                glGetIntegeri_v(bindingQuery, values[0], &boundBuffer);
+                if (boundBuffer == 0 && values[1] <= zeroBufferSize)
+                {
+                    GLState::BindBufferBase(target, values[0], zeroBuffer);
+                    borrowedBindings.push_back({ target, (GLuint)values[0] });
+                }
+            }
+        }
+
+        GLState::UseProgram(program);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        for (auto& [target, binding] : borrowedBindings)
+        {
+            GLState::BindBufferBase(target, binding, 0);
+        }
+    }
+    GLState::UseProgram(0);
+
+    GLState::BindVertexArray(0);
+    GLState::DeleteVertexArrays(1, &vertexArray);
+    GLState::DeleteBuffers(1, &zeroBuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    GLState::DeleteTextures(2, targets);
+
+    // Wait here so the driver's late compiles land at startup rather than on the first frame
+    glFinish();
+
+    if (IsDebug)
+    {
+        Print("Prewarmed " + std::to_string(m_PrewarmPrograms.size()) + " programs in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()) + " ms");
+    }
 }
 
-void ShaderLoader::SetUniform1f(GLuint&& _program, std::string_view&& _location, GLfloat _value)
+double ShaderLoader::GetProgramCreationTime()
 {
-    glUniform1f(glGetUniformLocation(_program, _location.data()), _value);
+    return m_ProgramCreationTime;
 }
 
-void ShaderLoader::SetUniform2i(GLuint&& _program, std::string_view&& _location, GLint _value, GLint _value2)
+void ShaderLoader::SetUniform1i(GLuint&& _program, StringID _location, GLint _value)
 {
-    glUniform2i(glGetUniformLocation(_program, _location.data()), _value, _value2);
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, &_value, sizeof(_value), 1, location))
+        glUniform1i(location, _value);
 }
 
-void ShaderLoader::SetUniform2f(GLuint&& _program, std::string_view&& _location, GLfloat _value, GLfloat _value2)
+void ShaderLoader::SetUniform1iv(GLuint&& _program, StringID _location, GLsizei _count, const GLint* _values)
 {
-    glUniform2f(glGetUniformLocation(_program, _location.data()), _value, _value2);
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, _values, _count * sizeof(GLint), _count, location))
+        glUniform1iv(location, _count, _values);
 }
 
-void ShaderLoader::SetUniform3i(GLuint&& _program, std::string_view&& _location, GLint _value, GLint _value2, GLint _value3)
+void ShaderLoader::SetUniform1f(GLuint&& _program, StringID _location, GLfloat _value)
 {
-    glUniform3i(glGetUniformLocation(_program, _location.data()), _value, _value2, _value3);
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, &_value, sizeof(_value), 1, location))
+        glUniform1f(location, _value);
 }
 
-void ShaderLoader::SetUniform3f(GLuint&& _program, std::string_view&& _location, GLfloat _value, GLfloat _value2, GLfloat _value3)
+void ShaderLoader::SetUniform2i(GLuint&& _program, StringID _location, GLint _value, GLint _value2)
 {
-    glUniform3f(glGetUniformLocation(_program, _location.data()), _value, _value2, _value3);
+    GLint location = -1;
+    glm::ivec2 value{ _value, _value2 };
+    if (ShouldUpload(_program, _location, &value, sizeof(value), 1, location))
+        glUniform2i(location, _value, _value2);
 }
 
-void ShaderLoader::SetUniform3fv(GLuint&& _program, std::string_view&& _location, glm::vec3 _value)
+void ShaderLoader::SetUniform2f(GLuint&& _program, StringID _location, GLfloat _value, GLfloat _value2)
 {
-    glUniform3fv(glGetUniformLocation(_program, _location.data()), 1, glm::value_ptr(_value));
+    GLint location = -1;
+    glm::vec2 value{ _value, _value2 };
+    if (ShouldUpload(_program, _location, &value, sizeof(value), 1, location))
+        glUniform2f(location, _value, _value2);
 }
 
-void ShaderLoader::SetUniform3iv(GLuint&& _program, std::string_view&& _location, glm::ivec3 _value)
+void ShaderLoader::SetUniform3i(GLuint&& _program, StringID _location, GLint _value, GLint _value2, GLint _value3)
 {
-    glUniform3iv(glGetUniformLocation(_program, _location.data()), 1, glm::value_ptr(_value));
+    GLint location = -1;
+    glm::ivec3 value{ _value, _value2, _value3 };
+    if (ShouldUpload(_program, _location, &value, sizeof(value), 1, location))
+        glUniform3i(location, _value, _value2, _value3);
 }
 
-void ShaderLoader::SetUniform4fv(GLuint&& _program, std::string_view&& _location, glm::vec4 _value)
+void ShaderLoader::SetUniform3f(GLuint&& _program, StringID _location, GLfloat _value, GLfloat _value2, GLfloat _value3)
 {
-    glUniform4fv(glGetUniformLocation(_program, _location.data()), 1, glm::value_ptr(_value));
+    GLint location = -1;
+    glm::vec3 value{ _value, _value2, _value3 };
+    if (ShouldUpload(_program, _location, &value, sizeof(value), 1, location))
+        glUniform3f(location, _value, _value2, _value3);
 }
 
-void ShaderLoader::SetUniformMatrix4fv(GLuint&& _program, std::string_view&& _location, glm::mat4 _value)
+void ShaderLoader::SetUniform3fv(GLuint&& _program, StringID _location, glm::vec3 _value)
 {
-    glUniformMatrix4fv(glGetUniformLocation(_program, _location.data()), 1, GL_FALSE, glm::value_ptr(_value));
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, &_value, sizeof(_value), 1, location))
+        glUniform3fv(location, 1, glm::value_ptr(_value));
+}
+
+void ShaderLoader::SetUniform3iv(GLuint&& _program, StringID _location, glm::ivec3 _value)
+{
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, &_value, sizeof(_value), 1, location))
+        glUniform3iv(location, 1, glm::value_ptr(_value));
+}
+
+void ShaderLoader::SetUniform4fv(GLuint&& _program, StringID _location, glm::vec4 _value)
+{
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, &_value, sizeof(_value), 1, location))
+        glUniform4fv(location, 1, glm::value_ptr(_value));
+}
+
+void ShaderLoader::SetUniformMatrix4fv(GLuint&& _program, StringID _location, glm::mat4 _value)
+{
+    GLint location = -1;
+    if (ShouldUpload(_program, _location, &_value, sizeof(_value), 1, location))
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(_value));
+}
+
+void ShaderLoader::ReflectProgram(GLuint _program)
+{
+    // Relinking or a reused program ID starts from a clean table
+    ProgramReflection& reflection = m_Reflections[_program];
+    reflection = {};
+
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramInterfaceiv(_program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+    glGetProgramInterfaceiv(_program, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+    std::string name(std::max(maxNameLength, 1), '\0');
+
+    const GLenum properties[4]{ GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION, GL_BLOCK_INDEX };
+    for (GLint i = 0; i < uniformCount; i++)
+    {
+        GLint values[4]{};
+        glGetProgramResourceiv(_program, GL_UNIFORM, i, 4, properties, 4, nullptr, values);
+
+        // Block members are set through their buffers
+        if (values[3] != -1 || values[2] < 0)
+            continue;
+
+        GLsizei length = 0;
+        glGetProgramResourceName(_program, GL_UNIFORM, i, (GLsizei)name.size(), &length, name.data());
+        std::string baseName(name.data(), length);
+        bool isArray = baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0;
+        if (isArray)
+            baseName.resize(baseName.size() - 3);
+
+        GLint arraySize = std::max(values[1], 1);
+        GLuint elementSize = GetUniformTypeSize(values[0]);
+        GLuint shadowOffset = (GLuint)reflection.Shadow.size();
+        reflection.Shadow.resize(shadowOffset + elementSize * arraySize);
+
+        // Every element gets a slot so they can be set on their own or as a run from any element
+        for (GLint element = 0; element < arraySize; element++)
+        {
+            std::string elementName = baseName + "[" + std::to_string(element) + "]";
+            UniformSlot slot{};
+            slot.Location = element == 0 ? values[2] : glGetProgramResourceLocation(_program, GL_UNIFORM, elementName.c_str());
+            slot.Type = values[0];
+            slot.ElementSize = elementSize;
+            slot.Count = arraySize - element;
+            slot.ShadowOffset = shadowOffset + elementSize * element;
+
+            int slotIndex = (int)reflection.Slots.size();
+            reflection.Slots.push_back(slot);
+            if (element == 0)
+                reflection.Lookup[StringID{ baseName }] = slotIndex;
+            if (isArray)
+                reflection.Lookup[StringID{ elementName }] = slotIndex;
+        }
+    }
+
+    ValidateBlockLayouts(_program);
+}
+
+void ShaderLoader::AddBlockLayout(GLenum _interface, std::string_view _blockName, const BlockLayoutDescription& _layout)
+{
+    m_BlockLayouts.push_back({ _interface, std::string(_blockName), _layout });
+}
+
+void ShaderLoader::ValidateBlockLayouts(GLuint _program)
+{
+    for (auto& block : m_BlockLayouts)
+    {
+        // Nothing to check if the program does not declare the block or it was optimised out
+        GLuint blockIndex = glGetProgramResourceIndex(_program, block.Interface, block.BlockName.c_str());
+        if (blockIndex == GL_INVALID_INDEX)
+            continue;
+
+        const GLenum blockProperties[2]{ GL_NUM_ACTIVE_VARIABLES, GL_BUFFER_DATA_SIZE };
+        GLint blockValues[2]{};
+        glGetProgramResourceiv(_program, block.Interface, blockIndex, 2, blockProperties, 2, nullptr, blockValues);
+        if (blockValues[0] <= 0)
+            continue;
+
+        std::vector<GLint> variables(blockValues[0]);
+        const GLenum activeVariables = GL_ACTIVE_VARIABLES;
+        glGetProgramResourceiv(_program, block.Interface, blockIndex, 1, &activeVariables, (GLsizei)variables.size(), nullptr, variables.data());
+
+        // Members of a storage block are those of its array element, whose stride is the element size
+        bool isStorage = block.Interface == GL_SHADER_STORAGE_BLOCK;
+        const GLenum properties[2]{ GL_OFFSET, GL_TOP_LEVEL_ARRAY_STRIDE };
+        std::vector<size_t> offsets{};
+        size_t size = (size_t)blockValues[1];
+        for (GLint variable : variables)
+        {
+            GLint values[2]{};
+            glGetProgramResourceiv(_program, isStorage ? GL_BUFFER_VARIABLE : GL_UNIFORM, variable, isStorage ? 2 : 1, properties, 2, nullptr, values);
+            offsets.push_back((size_t)values[0]);
+            if (isStorage)
+                size = (size_t)values[1];
+        }
+        std::sort(offsets.begin(), offsets.end());
+
+        if (offsets != block.Layout.Offsets || size != block.Layout.Size)
+        {
+            Print("Block " + block.BlockName + " of program " + std::to_string(_program) + " does not match its C++ layout, size "
+                + std::to_string(size) + " expected " + std::to_string(block.Layout.Size));
+        }
+    }
+}
+
+void ShaderLoader::BeginUniformFrame()
+{
+    m_LastFrameStats = m_FrameStats;
+    m_FrameStats = {};
+}
+
+UniformStats ShaderLoader::GetUniformStats()
+{
+    return m_LastFrameStats;
+}
+
+int ShaderLoader::FindUniformSlot(GLuint _program, StringID _name)
+{
+    // Reflection only exists once a batched program has finished linking
+    if (!m_PendingPrograms.empty())
+        WaitForProgram(_program);
+
+    ProgramReflection* reflection = m_Reflections.Find(_program);
+    if (!reflection)
+    {
+        // Every program the ShaderLoader links is reflected, so this one was made elsewhere or never linked.
+        // Names are only hashed, so there is no glGetUniformLocation to fall back to. It is reported once,
+        // then the empty reflection left behind makes its uniforms resolve as inactive
+        Print("Program " + std::to_string(_program) + " was not reflected, uniform " + _name.GetName() + " and its others are not uploaded");
+        m_Reflections[_program];
+        return -1;
+    }
+
+    int* slot = reflection->Lookup.Find(_name);
+    return slot ? *slot : -1;
+}
+
+bool ShaderLoader::ShouldUploadSlot(GLuint _program, int _slot, const void* _data, size_t _size, GLint _count, GLint& _location)
+{
+    ProgramReflection& reflection = m_Reflections[_program];
+    UniformSlot& slot = reflection.Slots[_slot];
+    _location = slot.Location;
+
+    // Only compare what fits in the uniform, the rest would be ignored by GL anyway
+    GLint count = std::clamp(_count, 1, slot.Count);
+    size_t size = std::min(_size, (size_t)slot.ElementSize * count);
+    unsigned char* shadow = reflection.Shadow.data() + slot.ShadowOffset;
+
+    bool hasValue = true;
+    for (GLint element = 0; element < count; element++)
+    {
+        hasValue = hasValue && reflection.Slots[_slot + element].HasValue;
+    }
+    if (hasValue && std::memcmp(shadow, _data, size) == 0)
+    {
+        m_FrameStats.Skipped++;
+        return false;
+    }
+
+    std::memcpy(shadow, _data, size);
+    for (GLint element = 0; element < count; element++)
+    {
+        reflection.Slots[_slot + element].HasValue = true;
+    }
+    m_FrameStats.Uploads++;
+    return true;
+}
+
+bool ShaderLoader::ShouldUpload(GLuint _program, StringID _name, const void* _data, size_t _size, GLint _count, GLint& _location)
+{
+    if (!m_PendingPrograms.empty())
+        WaitForProgram(_program);
+
+    // Inactive uniforms, and programs that failed to link, have nothing to upload to
+    int slot = FindUniformSlot(_program, _name);
+    if (slot < 0)
+    {
+        m_FrameStats.Skipped++;
+        return false;
+    }
+    return ShouldUploadSlot(_program, slot, _data, _size, _count, _location);
+}
+
+GLuint ShaderLoader::GetUniformTypeSize(GLenum _type)
+{
+    switch (_type)
+    {
+    case GL_FLOAT_VEC2:
+    case GL_INT_VEC2:
+    case GL_UNSIGNED_INT_VEC2:
+        return 8;
+    case GL_FLOAT_VEC3:
+    case GL_INT_VEC3:
+    case GL_UNSIGNED_INT_VEC3:
+        return 12;
+    case GL_FLOAT_VEC4:
+    case GL_INT_VEC4:
+    case GL_UNSIGNED_INT_VEC4:
+    case GL_FLOAT_MAT2:
+        return 16;
+    case GL_FLOAT_MAT3:
+        return 36;
+    case GL_FLOAT_MAT4:
+        return 64;
+    default:
+        // Scalars, bools, samplers and images
+        return 4;
+    }
 }
 
 GLuint ShaderLoader::CompileShader(GLenum _type, std::string&& _source)
+{
+    GLuint shader = SubmitShader(_type, std::move(_source));
+    return CheckShader(shader) ? shader : 0;
+}
+
+GLuint ShaderLoader::SubmitShader(GLenum _type, std::string&& _source)
 {
     // Check If there Is Already A Shader With The Same Specifications Created
-    for (auto& item : m_Shaders)
+    auto item = m_Shaders.find(_source);
+    if (item != m_Shaders.end())
     {
-        if (item.first == _source)
+        if (IsDebug)
         {
-            if (IsDebug)
-            {
-                Print("Re-used Shader " + std::to_string(item.second) + "!");
-            }
-            return item.second;
+            Print("Re-used Shader " + std::to_string(item->second) + "!");
         }
+        return item->second;
     }
 
     // Create A Shader Of The Specified Type
@@ -176,56 +742,139 @@ GLuint ShaderLoader::CompileShader(GLenum _type, std::string&& _source)
     // Compile The Shader
     glCompileShader(shader);
 
+    // Push New Shader Into Vector
+    m_Shaders.emplace(std::move(_source), shader);
+
+    return shader;
+}
+
+bool ShaderLoader::CheckShader(GLuint _shader)
+{
     // Debug Output With Error Specific Message
     int result = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+    glGetShaderiv(_shader, GL_COMPILE_STATUS, &result);
     if (result == GL_FALSE)
     {
         int length = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        glGetShaderiv(_shader, GL_INFO_LOG_LENGTH, &length);
         char* message = (char*)_malloca(length * sizeof(char));
-        glGetShaderInfoLog(shader, length, &length, message);
-        std::string debugOutput = "Failed to Compile Vertex Shader";
+        glGetShaderInfoLog(_shader, length, &length, message);
+        std::string debugOutput = "Failed to Compile Shader ";
         if (message != 0)
             debugOutput += message;
         Print(debugOutput);
-        glDeleteShader(shader);
         _freea(message);
-        return result;
+
+        // Forget it so the next request for the same source compiles again
+        for (auto item = m_Shaders.begin(); item != m_Shaders.end(); item++)
+        {
+            if (item->second == _shader)
+            {
+                m_Shaders.erase(item);
+                break;
+            }
+        }
+        glDeleteShader(_shader);
+        return false;
     }
+    return true;
+}
 
-    // Push New Shader Into Vector
-    m_Shaders.push_back(std::make_pair(_source, shader));
+std::string ShaderLoader::PreprocessShader(const std::string& _fileName, const std::vector<std::string>& _defines, std::vector<std::string>* _files)
+{
+    std::vector<std::string> included{};
+    std::string source{};
+    ExpandIncludes(_fileName, included, source);
+    if (_files)
+        *_files = included;
+    if (_defines.empty())
+        return source;
+
+    // Defines have to follow #version, which must stay the first line
+    std::string defines{};
+    for (auto& define : _defines)
+    {
+        size_t equals = define.find('=');
+        if (equals == std::string::npos)
+            defines += "#define " + define + "\n";
+        else
+            defines += "#define " + define.substr(0, equals) + " " + define.substr(equals + 1) + "\n";
+    }
 
-    return shader;
+    size_t versionLine = source.find("#version");
+    size_t insertAt = versionLine == std::string::npos ? 0 : source.find('\n', versionLine);
+    insertAt = insertAt == std::string::npos ? source.size() : insertAt + 1;
+    source.insert(insertAt, defines + "#line 2 0\n");
+    return source;
 }
 
-std::string ShaderLoader::PassFileToString(const std::string& _fileName)
+void ShaderLoader::ExpandIncludes(const std::string& _fileName, std::vector<std::string>& _included, std::string& _output)
 {
-    // Container For File Information
-    std::string content{ "" };
+    int fileIndex = (int)_included.size();
+    _included.push_back(_fileName);
+
+    std::string source = PassFileToString(_fileName);
+    size_t lineStart = 0;
+    int lineNumber = 1;
+    while (lineStart < source.size())
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = source.size();
+        std::string_view line{ source.data() + lineStart, lineEnd - lineStart };
+        lineStart = lineEnd + 1;
+        lineNumber++;
+
+        // #include "File", anything else is passed through untouched
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string_view::npos || line.compare(first, 8, "#include") != 0)
+        {
+            _output.append(line);
+            _output += '\n';
+            continue;
+        }
+
+        size_t nameStart = line.find('"', first + 8);
+        size_t nameEnd = nameStart == std::string_view::npos ? nameStart : line.find('"', nameStart + 1);
+        if (nameEnd == std::string_view::npos)
+        {
+            Print("Malformed include in " + _fileName + " line " + std::to_string(lineNumber - 1));
+            _output += '\n';
+            continue;
+        }
 
-    // File Stream
-    std::ifstream fileStream("Resources/Shaders/" + _fileName);
+        std::string includeName{ line.substr(nameStart + 1, nameEnd - nameStart - 1) };
+        if (std::find(_included.begin(), _included.end(), includeName) != _included.end())
+        {
+            _output += '\n';
+            continue;
+        }
+
+        _output += "#line 1 " + std::to_string(_included.size()) + "\n";
+        ExpandIncludes(includeName, _included, _output);
+        _output += "#line " + std::to_string(lineNumber) + " " + std::to_string(fileIndex) + "\n";
+    }
+}
+
+std::string ShaderLoader::PassFileToString(const std::string& _fileName)
+{
+    // Read whole from a pack or the shader directory
+    FileData file = VirtualFileSystem::ReadFile("Shaders/" + _fileName);
 
     // If File Dident Open
-    if (!fileStream.is_open())
+    if (!file.IsValid())
     {
         std::string debugOutput = "Could not read file ";
         debugOutput += _fileName;
         debugOutput += ". File does not exist.";
         Print(debugOutput);
-        return content;
-    }
-
-    // Read File And Pass Contents To 'content' string
-    std::string line = "";
-    while (!fileStream.eof())
-    {
-        std::getline(fileStream, line);
-        content.append(line + "\n");
+        return "";
     }
-    fileStream.close();
 
+    // Line endings are left to the preprocessor as \n only, the same on every platform
+    std::string content{ file.GetText() };
+    content.erase(std::remove(content.begin(), content.end(), '\r'), content.end());
+    if (content.empty() || content.back() != '\n')
+        content += '\n';
     return content;
 }
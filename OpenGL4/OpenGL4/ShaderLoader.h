@@ -9,7 +9,30 @@
 // Mail : william.inman@mds.ac.nz
 
 #pragma once
-#include "Helper.h"
+#include "Shader.h"
+#include "BufferLayout.h"
+#include "FlatHashMap.h"
+
+/// <summary>
+/// A uniform of a reflected program that can be kept and set without looking up its name.
+/// </summary>
+template<typename T>
+struct UniformHandle
+{
+    GLuint Program{ 0 };
+    int Slot{ -1 };
+
+    bool IsValid() const { return Slot >= 0; }
+};
+
+/// <summary>
+/// Uniform calls made and calls skipped because the program already had the value.
+/// </summary>
+struct UniformStats
+{
+    int Uploads = 0;
+    int Skipped = 0;
+};
 
 class ShaderLoader
 {
@@ -29,13 +52,81 @@ public:
     /// <returns></returns>
     static GLuint CreateShader(std::string&& _vertexShader, std::string&& _fragmentShader);
 
+    /// <summary>
+    /// Creates a program from the given shader stages and returns its ID, or 0 if it failed to link.
+    /// Every stage is preprocessed with the given defines, each either "NAME" or "NAME=VALUE".
+    /// The linked binary is restored from the program cache when possible and stored to it otherwise.
+    /// </summary>
+    /// <param name="_shaders"></param>
+    /// <param name="_defines"></param>
+    /// <returns></returns>
+    static GLuint CreateProgram(std::vector<ShaderInfo>& _shaders, const std::vector<std::string>& _defines = {});
+
+    /// <summary>
+    /// Returns the permutation of a program with the given defines, creating it on first use.
+    /// Permutations are shared by every caller asking for the same stages and defines in any order.
+    /// </summary>
+    /// <param name="_shaders"></param>
+    /// <param name="_defines"></param>
+    /// <returns></returns>
+    static GLuint GetProgramVariant(const std::vector<ShaderInfo>& _shaders, const std::vector<std::string>& _defines);
+
+    /// <summary>
+    /// Returns the source of a shader file with its #include "File" lines expanded and the defines added after #version.
+    /// Each file is only included once, later includes of it are skipped.
+    /// </summary>
+    /// <param name="_fileName"></param>
+    /// <param name="_defines"></param>
+    /// <param name="_files"> If given, receives the file and every file it included </param>
+    /// <returns></returns>
+    static std::string PreprocessShader(const std::string& _fileName, const std::vector<std::string>& _defines = {}, std::vector<std::string>* _files = nullptr);
+
+    /// <summary>
+    /// Starts queueing programs so their compiles and links run in parallel on the driver's threads.
+    /// Until the batch ends CreateProgram returns as soon as the link is submitted, so a program that later fails to link
+    /// has already been returned. It is left unlinked rather than deleted and GetProgramVariant returns 0 for it afterwards.
+    /// </summary>
+    static void BeginProgramBatch();
+
+    /// <summary>
+    /// Finishes every queued program the driver has completed without blocking and returns how many are still compiling.
+    /// </summary>
+    /// <returns></returns>
+    static size_t PollPrograms();
+
+    /// <summary>
+    /// Waits for the queued programs, then prewarms the graphics ones with an offscreen draw.
+    /// </summary>
+    static void EndProgramBatch();
+
+    /// <summary>
+    /// Blocks until a queued program is linked and reflected, does nothing if it is not queued.
+    /// </summary>
+    /// <param name="_program"></param>
+    static void WaitForProgram(GLuint _program);
+
+    /// <summary>
+    /// Returns the total milliseconds spent creating programs.
+    /// </summary>
+    /// <returns></returns>
+    static double GetProgramCreationTime();
+
     /// <summary>
     /// Sets Uniform 1i At Location
     /// </summary>
     /// <param name="_program"></param>
     /// <param name="_location"></param>
     /// <param name="_value"></param>
-    static void SetUniform1i(GLuint&& _program, std::string_view&& _location, GLint _value);
+    static void SetUniform1i(GLuint&& _program, StringID _location, GLint _value);
+
+    /// <summary>
+    /// Sets Uniform 1i Array At Location
+    /// </summary>
+    /// <param name="_program"></param>
+    /// <param name="_location"></param>
+    /// <param name="_count"></param>
+    /// <param name="_values"></param>
+    static void SetUniform1iv(GLuint&& _program, StringID _location, GLsizei _count, const GLint* _values);
     
     /// <summary>
     /// Sets Uniform 1f At Location
@@ -43,7 +134,7 @@ public:
     /// <param name="_program"></param>
     /// <param name="_location"></param>
     /// <param name="_value"></param>
-    static void SetUniform1f(GLuint&& _program, std::string_view&& _location, GLfloat _value);
+    static void SetUniform1f(GLuint&& _program, StringID _location, GLfloat _value);
     
     /// <summary>
     /// Sets Uniform 2i At Location
@@ -52,7 +143,7 @@ public:
     /// <param name="_location"></param>
     /// <param name="_value"></param>
     /// <param name="_value2"></param>
-    static void SetUniform2i(GLuint&& _program, std::string_view&& _location, GLint _value, GLint _value2);
+    static void SetUniform2i(GLuint&& _program, StringID _location, GLint _value, GLint _value2);
     
     /// <summary>
     /// Sets Uniform 2f At Location
@@ -61,7 +152,7 @@ public:
     /// <param name="_location"></param>
     /// <param name="_value"></param>
     /// <param name="_value2"></param>
-    static void SetUniform2f(GLuint&& _program, std::string_view&& _location, GLfloat _value, GLfloat _value2);
+    static void SetUniform2f(GLuint&& _program, StringID _location, GLfloat _value, GLfloat _value2);
     
     /// <summary>
     /// Sets Uniform 3i At Location
@@ -71,7 +162,7 @@ public:
     /// <param name="_value"></param>
     /// <param name="_value2"></param>
     /// <param name="_value3"></param>
-    static void SetUniform3i(GLuint&& _program, std::string_view&& _location, GLint _value, GLint _value2, GLint _value3);
+    static void SetUniform3i(GLuint&& _program, StringID _location, GLint _value, GLint _value2, GLint _value3);
     
     /// <summary>
     /// Sets Uniform 3f At Location
@@ -81,7 +172,7 @@ public:
     /// <param name="_value"></param>
     /// <param name="_value2"></param>
     /// <param name="_value3"></param>
-    static void SetUniform3f(GLuint&& _program, std::string_view&& _location, GLfloat _value, GLfloat _value2, GLfloat _value3);
+    static void SetUniform3f(GLuint&& _program, StringID _location, GLfloat _value, GLfloat _value2, GLfloat _value3);
     
     /// <summary>
     /// Sets Uniform 3fv At Location
@@ -89,7 +180,7 @@ public:
     /// <param name="_program"></param>
     /// <param name="_location"></param>
     /// <param name="_value"></param>
-    static void SetUniform3fv(GLuint&& _program, std::string_view&& _location, glm::vec3 _value);
+    static void SetUniform3fv(GLuint&& _program, StringID _location, glm::vec3 _value);
     
     /// <summary>
     /// Sets Uniform 3iv At Location
@@ -97,7 +188,7 @@ public:
     /// <param name="_program"></param>
     /// <param name="_location"></param>
     /// <param name="_value"></param>
-    static void SetUniform3iv(GLuint&& _program, std::string_view&& _location, glm::ivec3 _value);
+    static void SetUniform3iv(GLuint&& _program, StringID _location, glm::ivec3 _value);
     
     /// <summary>
     /// Sets Uniform 4fv At Location
@@ -105,7 +196,7 @@ public:
     /// <param name="_program"></param>
     /// <param name="_location"></param>
     /// <param name="_value"></param>
-    static void SetUniform4fv(GLuint&& _program, std::string_view&& _location, glm::vec4 _value);
+    static void SetUniform4fv(GLuint&& _program, StringID _location, glm::vec4 _value);
 
     /// <summary>
     /// Sets Uniform 4fv At Location
@@ -113,7 +204,62 @@ public:
     /// <param name="_program"></param>
     /// <param name="_location"></param>
     /// <param name="_value"></param>
-    static void SetUniformMatrix4fv(GLuint&& _program, std::string_view&& _location, glm::mat4 _value);
+    static void SetUniformMatrix4fv(GLuint&& _program, StringID _location, glm::mat4 _value);
+
+    /// <summary>
+    /// Builds the name to location table and value shadow copy of a linked program.
+    /// Uniforms of reflected programs are only uploaded when their value changes.
+    /// Blocks of the program with a registered layout are checked against it.
+    /// </summary>
+    /// <param name="_program"></param>
+    static void ReflectProgram(GLuint _program);
+
+    /// <summary>
+    /// Registers the layout a uniform block or shader storage block must have in every program that declares it.
+    /// A shader storage block is expected to hold one runtime sized array and the layout describes its element.
+    /// Programs reflected afterwards are checked and a mismatch is printed with the block name.
+    /// </summary>
+    /// <param name="_interface"> GL_UNIFORM_BLOCK or GL_SHADER_STORAGE_BLOCK </param>
+    /// <param name="_blockName"></param>
+    /// <param name="_layout"></param>
+    static void AddBlockLayout(GLenum _interface, std::string_view _blockName, const BlockLayoutDescription& _layout);
+
+    /// <summary>
+    /// Returns a handle to a uniform of a reflected program, invalid if the program has no such active uniform.
+    /// Array elements are named as in GLSL, "Name" is the same as "Name[0]".
+    /// </summary>
+    /// <param name="_program"></param>
+    /// <param name="_name"></param>
+    /// <returns></returns>
+    template<typename T>
+    static UniformHandle<T> GetUniformHandle(GLuint _program, StringID _name)
+    {
+        return UniformHandle<T>{ _program, FindUniformSlot(_program, _name) };
+    }
+
+    /// <summary>
+    /// Sets the uniform of a handle if the value changed, the program must be bound.
+    /// </summary>
+    /// <param name="_handle"></param>
+    /// <param name="_value"></param>
+    template<typename T>
+    static void SetUniform(const UniformHandle<T>& _handle, const T& _value)
+    {
+        GLint location = -1;
+        if (_handle.IsValid() && ShouldUploadSlot(_handle.Program, _handle.Slot, &_value, sizeof(T), 1, location))
+            UploadUniform(location, _value);
+    }
+
+    /// <summary>
+    /// Starts counting uniform calls for a new frame.
+    /// </summary>
+    static void BeginUniformFrame();
+
+    /// <summary>
+    /// Returns the uniform calls made and skipped last frame.
+    /// </summary>
+    /// <returns></returns>
+    static UniformStats GetUniformStats();
 
     /// <summary>
     /// Compiles A Shader Of A Given Type And Source And Returns Its ID.
@@ -123,6 +269,21 @@ public:
     /// <returns></returns>
     static GLuint CompileShader(GLenum _type, std::string&& _source);
 
+    /// <summary>
+    /// Submits A Shader Of A Given Type And Source For Compiling And Returns Its ID Without Waiting For The Result.
+    /// </summary>
+    /// <param name="_type"></param>
+    /// <param name="_source"></param>
+    /// <returns></returns>
+    static GLuint SubmitShader(GLenum _type, std::string&& _source);
+
+    /// <summary>
+    /// Prints the log and deletes the shader if it failed to compile, returns true if it compiled.
+    /// </summary>
+    /// <param name="_shader"></param>
+    /// <returns></returns>
+    static bool CheckShader(GLuint _shader);
+
     /// <summary>
     /// Passes A File At The Given Adress Into A String And Returns It.
     /// </summary>
@@ -130,9 +291,163 @@ public:
     /// <returns></returns>
     static std::string PassFileToString(const std::string& _fileName);
 private:
+    /// <summary>
+    /// A uniform, or element of a uniform array, and where its last value is kept.
+    /// Count is the number of elements from this one to the end of the array.
+    /// </summary>
+    struct UniformSlot
+    {
+        GLint Location = -1;
+        GLenum Type = GL_FLOAT;
+        GLuint ElementSize = 0;
+        GLint Count = 1;
+        GLuint ShadowOffset = 0;
+        bool HasValue = false;
+    };
+
+    /// <summary>
+    /// A program whose link was submitted but not yet checked.
+    /// </summary>
+    struct PendingProgram
+    {
+        GLuint Program = 0;
+        std::vector<GLuint> Shaders{};
+        uint64_t CacheKey = 0;
+        bool IsGraphics = false;
+    };
+
+    /// <summary>
+    /// A block layout every program declaring the block is checked against.
+    /// </summary>
+    struct RegisteredBlockLayout
+    {
+        GLenum Interface = GL_UNIFORM_BLOCK;
+        std::string BlockName{};
+        BlockLayoutDescription Layout{};
+    };
+
+    struct ProgramReflection
+    {
+        FlatHashMap<StringID, int> Lookup{};
+        std::vector<UniformSlot> Slots{};
+        std::vector<unsigned char> Shadow{};
+    };
+
+    /// <summary>
+    /// Returns the slot of a named uniform, or -1 if the program is not reflected or has no such active uniform.
+    /// The first lookup on a program that was not reflected prints a warning.
+    /// </summary>
+    /// <param name="_program"></param>
+    /// <param name="_name"></param>
+    /// <returns></returns>
+    static int FindUniformSlot(GLuint _program, StringID _name);
+
+    /// <summary>
+    /// Hashes the stage files in order and the defines in any order into a permutation key.
+    /// </summary>
+    /// <param name="_shaders"></param>
+    /// <param name="_defines"></param>
+    /// <returns></returns>
+    static uint64_t HashProgramVariant(const std::vector<ShaderInfo>& _shaders, const std::vector<std::string>& _defines);
+
+    /// <summary>
+    /// Compares the reflected offsets and size of every registered block the program declares with its layout.
+    /// </summary>
+    /// <param name="_program"></param>
+    static void ValidateBlockLayouts(GLuint _program);
+
+    /// <summary>
+    /// Compares the value with the shadow copy of the slot, storing it and returning true if it has to be uploaded.
+    /// </summary>
+    /// <param name="_program"></param>
+    /// <param name="_slot"></param>
+    /// <param name="_data"></param>
+    /// <param name="_size"></param>
+    /// <param name="_count"></param>
+    /// <param name="_location"></param>
+    /// <returns></returns>
+    static bool ShouldUploadSlot(GLuint _program, int _slot, const void* _data, size_t _size, GLint _count, GLint& _location);
+
+    /// <summary>
+    /// Resolves the location of a named uniform and returns true if the value has to be uploaded.
+    /// Inactive uniforms and programs that were not reflected never upload, the latter are reported once.
+    /// </summary>
+    /// <param name="_program"></param>
+    /// <param name="_name"></param>
+    /// <param name="_data"></param>
+    /// <param name="_size"></param>
+    /// <param name="_count"></param>
+    /// <param name="_location"></param>
+    /// <returns></returns>
+    static bool ShouldUpload(GLuint _program, StringID _name, const void* _data, size_t _size, GLint _count, GLint& _location);
+
+    /// <summary>
+    /// Appends a shader file to the output, expanding its includes in place.
+    /// #line directives keep compile errors pointing at the line in the file, the source string number is its index in _included.
+    /// </summary>
+    /// <param name="_fileName"></param>
+    /// <param name="_included"></param>
+    /// <param name="_output"></param>
+    static void ExpandIncludes(const std::string& _fileName, std::vector<std::string>& _included, std::string& _output);
+
+    /// <summary>
+    /// Returns true if the driver has finished linking the program, always true without parallel compile support.
+    /// </summary>
+    /// <param name="_program"></param>
+    /// <returns></returns>
+    static bool IsProgramComplete(GLuint _program);
+
+    /// <summary>
+    /// Checks the link of a submitted program, then reflects it and stores it in the program cache.
+    /// Prints the logs and returns false if it failed, leaving the caller to discard the program.
+    /// </summary>
+    /// <param name="_pending"></param>
+    /// <returns></returns>
+    static bool FinishProgram(const PendingProgram& _pending);
+
+    /// <summary>
+    /// Handles a batched program that failed to link after its name was returned.
+    /// Its permutations resolve to 0 from then on, and the name stays allocated until cleanup so the driver cannot reuse it.
+    /// </summary>
+    /// <param name="_program"></param>
+    static void DiscardBatchedProgram(GLuint _program);
+
+    /// <summary>
+    /// Draws a triangle with each graphics program finished in the batch into a 1x1 target,
+    /// so drivers that compile their final shader variant on first use do it now.
+    /// </summary>
+    static void PrewarmPrograms();
+
+    /// <summary>
+    /// Returns the size in bytes of one element of a uniform type.
+    /// </summary>
+    /// <param name="_type"></param>
+    /// <returns></returns>
+    static GLuint GetUniformTypeSize(GLenum _type);
+
+    static void UploadUniform(GLint _location, GLint _value) { glUniform1i(_location, _value); }
+    static void UploadUniform(GLint _location, GLfloat _value) { glUniform1f(_location, _value); }
+    static void UploadUniform(GLint _location, const glm::ivec2& _value) { glUniform2iv(_location, 1, glm::value_ptr(_value)); }
+    static void UploadUniform(GLint _location, const glm::vec2& _value) { glUniform2fv(_location, 1, glm::value_ptr(_value)); }
+    static void UploadUniform(GLint _location, const glm::ivec3& _value) { glUniform3iv(_location, 1, glm::value_ptr(_value)); }
+    static void UploadUniform(GLint _location, const glm::vec3& _value) { glUniform3fv(_location, 1, glm::value_ptr(_value)); }
+    static void UploadUniform(GLint _location, const glm::vec4& _value) { glUniform4fv(_location, 1, glm::value_ptr(_value)); }
+    static void UploadUniform(GLint _location, const glm::mat4& _value) { glUniformMatrix4fv(_location, 1, GL_FALSE, glm::value_ptr(_value)); }
+
+    inline static FlatHashMap<GLuint, ProgramReflection> m_Reflections;
+    inline static UniformStats m_FrameStats{};
+    inline static UniformStats m_LastFrameStats{};
+    inline static std::vector<RegisteredBlockLayout> m_BlockLayouts{};
 
 
     inline static std::vector<std::pair<ShaderProgramLocation, GLuint>> m_ShaderPrograms;
-    inline static std::vector<std::pair<std::string, GLuint>> m_Shaders;
+    inline static std::unordered_map<std::string, GLuint> m_Shaders;
+    inline static double m_ProgramCreationTime{ 0.0 };
+    inline static FlatHashMap<uint64_t, GLuint> m_Variants{};
+    inline static std::vector<PendingProgram> m_PendingPrograms{};
+    inline static std::vector<GLuint> m_PrewarmPrograms{};
+    inline static std::vector<GLuint> m_FailedPrograms{};
+    inline static bool m_IsBatching{ false };
+    inline static bool m_IsParallelCompileSupported{ false };
 };
 
@@ -9,8 +9,10 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "Skybox.h"
+#include "GLState.h"
+#include "TextureLoader.h"
 
-Skybox::Skybox(Camera* _activeCamera, Texture _cubemapTexture)
+Skybox::Skybox(Camera* _activeCamera, TextureHandle _cubemapTexture)
 {
 	m_ActiveCamera = _activeCamera;
 	m_CubemapTexture = _cubemapTexture;
@@ -25,33 +27,35 @@ Skybox::~Skybox()
 {
 	if (m_ActiveCamera)
 		m_ActiveCamera = nullptr;
+
+	TextureLoader::Release(m_CubemapTexture);
 }
 
 void Skybox::Draw()
 {
-	glUseProgram(m_ShaderID);
+	GLState::UseProgram(m_ShaderID);
 
 	// Pass In Cubemap Texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_CubemapTexture.ID);
-	ShaderLoader::SetUniform1i(std::move(m_ShaderID), "Texture0", 0);
+	GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, TextureLoader::GetID(m_CubemapTexture));
+	ShaderLoader::SetUniform1i(std::move(m_ShaderID), "Texture0"_id, 0);
 
 	// Pass In PVM Matrix
 	if (m_ActiveCamera)
-		ShaderLoader::SetUniformMatrix4fv(std::move(m_ShaderID), "PVMMatrix", m_ActiveCamera->GetPVMatrix() * m_Transform.transform);
+		ShaderLoader::SetUniformMatrix4fv(std::move(m_ShaderID), "PVMMatrix"_id, m_ActiveCamera->GetPVMatrix() * m_Transform.transform);
 
 	// Draw
-	glBindVertexArray(m_VertexArrayID);
+	GLState::BindVertexArray(m_VertexArrayID);
 	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
 
 	// Unbind
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-	glUseProgram(0);
+	GLState::BindVertexArray(0);
+	GLState::BindTexture(0, GL_TEXTURE_CUBE_MAP, 0);
+	GLState::UseProgram(0);
 }
 
-void Skybox::SetTexture(Texture _cubemapTexture)
+void Skybox::SetTexture(TextureHandle _cubemapTexture)
 {
+	TextureLoader::Release(m_CubemapTexture);
 	m_CubemapTexture = _cubemapTexture;
 }
 
@@ -60,7 +64,7 @@ void Skybox::SetActiveCamera(Camera* _camera)
 	m_ActiveCamera = _camera;
 }
 
-Texture Skybox::GetTextureID()
+TextureHandle Skybox::GetTextureID()
 {
 	return m_CubemapTexture;
 }
@@ -160,16 +164,16 @@ void Skybox::CreateInvertedCubeVAO()
 
 	// Vertex Array
 	glGenVertexArrays(1, &m_VertexArrayID);
-	glBindVertexArray(m_VertexArrayID);
+	GLState::BindVertexArray(m_VertexArrayID);
 
 	// Vertex Buffer
 	glGenBuffers(1, &vertexBufferID);
-	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
 	glBufferData(GL_ARRAY_BUFFER, 24 * 3 * sizeof(GLfloat), &vertexPositions[0], GL_STATIC_DRAW);
 
 	// Index Buffer
 	glGenBuffers(1, &indexBufferID);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferID);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 36 * sizeof(unsigned), &indicesValues[0], GL_STATIC_DRAW);
 
 	// Position Layout
@@ -177,7 +181,7 @@ void Skybox::CreateInvertedCubeVAO()
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (void*)0);
 
 	// Unbind
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::BindVertexArray(0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -20,7 +20,7 @@ public:
 	/// <param name="_activeCamera"></param>
 	/// <param name="_cubemapTexture"></param>
 	/// <returns></returns>
-	static Skybox& GetInstance(Camera* _activeCamera, Texture _cubemapTexture)
+	static Skybox& GetInstance(Camera* _activeCamera, TextureHandle _cubemapTexture)
 	{
 		static Skybox instance(_activeCamera, _cubemapTexture);
 		return instance;
@@ -43,10 +43,10 @@ public:
 	void Draw();
 
 	/// <summary>
-	/// Sets the Cubemap of the skybox
+	/// Sets the Cubemap of the skybox, taking over a reference to it and releasing the previous one.
 	/// </summary>
 	/// <param name="_cubemapTexture"></param>
-	void SetTexture(Texture _cubemapTexture);
+	void SetTexture(TextureHandle _cubemapTexture);
 
 	/// <summary>
 	/// Sets the active camera
@@ -58,7 +58,7 @@ public:
 	/// Gets the Cubemap Texture ID
 	/// </summary>
 	/// <returns></returns>
-	Texture GetTextureID();
+	TextureHandle GetTextureID();
 
 	/// <summary>
 	/// Sets the position of the Skybox
@@ -101,7 +101,7 @@ private:
 	/// </summary>
 	/// <param name="_activeCamera"></param>
 	/// <param name="_cubemapTexture"></param>
-	Skybox(Camera* _activeCamera, Texture _cubemapTexture);
+	Skybox(Camera* _activeCamera, TextureHandle _cubemapTexture);
 	/// <summary>
 	/// Private Destructor
 	/// </summary>
@@ -115,7 +115,7 @@ private:
 	Transform m_Transform{};
 	GLuint m_ShaderID{ 0 };
 	Camera* m_ActiveCamera{ nullptr };
-	Texture m_CubemapTexture{};
+	TextureHandle m_CubemapTexture{};
 	GLuint m_VertexArrayID{ 0 };
 };
 
@@ -1,3 +1,3 @@
 #include "StaticMesh.h"
 
-std::vector<Mesh*> StaticMesh::Meshes{};
\ No newline at end of file
+FlatHashMap<StringID, Mesh*> StaticMesh::Meshes{};
\ No newline at end of file
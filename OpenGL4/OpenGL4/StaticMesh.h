@@ -1,11 +1,10 @@
 #pragma once
 #include "Mesh.h"
-#include <unordered_map>
+#include "FlatHashMap.h"
 
 class StaticMesh
 {
 public:
-	static std::map<int, Mesh*> MeshMap;
-	static std::vector<Mesh*> Meshes;
+	static FlatHashMap<StringID, Mesh*> Meshes;
 };
 
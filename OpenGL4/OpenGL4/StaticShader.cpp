@@ -1,2 +1,2 @@
 #include "StaticShader.h"
-std::map<const char*, Shader*>StaticShader::Shaders{};
\ No newline at end of file
+FlatHashMap<StringID, Shader*> StaticShader::Shaders{};
\ No newline at end of file
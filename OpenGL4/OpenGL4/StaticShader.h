@@ -1,8 +1,9 @@
 #pragma once
 #include "Shader.h"
+#include "FlatHashMap.h"
 class StaticShader
 {
 public:
-	static std::map<const char*, Shader*> Shaders;
+	static FlatHashMap<StringID, Shader*> Shaders;
 };
 
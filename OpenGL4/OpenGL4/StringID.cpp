@@ -0,0 +1,52 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : StringID.cpp 
+// Description : StringID Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "StringID.h"
+#include <mutex>
+#include <cstdio>
+
+#ifdef _DEBUG
+namespace
+{
+	// Function statics so IDs made during static initialisation can still register
+	std::unordered_map<uint64_t, std::string>& GetNames()
+	{
+		static std::unordered_map<uint64_t, std::string> names{};
+		return names;
+	}
+
+	std::mutex& GetNamesMutex()
+	{
+		static std::mutex mutex{};
+		return mutex;
+	}
+}
+
+void StringID::Register(uint64_t _hash, std::string_view _name)
+{
+	std::lock_guard lock{ GetNamesMutex() };
+	auto [name, isInserted] = GetNames().try_emplace(_hash, _name);
+	if (!isInserted && name->second != _name)
+		Print("StringID collision between " + name->second + " and " + std::string(_name));
+}
+#endif
+
+std::string StringID::GetName() const
+{
+#ifdef _DEBUG
+	std::lock_guard lock{ GetNamesMutex() };
+	auto name = GetNames().find(m_Hash);
+	if (name != GetNames().end())
+		return name->second;
+#endif
+	char hash[17]{};
+	std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)m_Hash);
+	return hash;
+}
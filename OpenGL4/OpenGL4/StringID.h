@@ -0,0 +1,109 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : StringID.h 
+// Description : StringID Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// A name reduced to its 64 bit FNV-1a hash so it can be stored and compared as an integer.
+/// "Name"_id is hashed at compile time, names only known at runtime are hashed once when converted.
+/// Debug builds remember the name of every ID for printing and report two names with the same hash.
+/// </summary>
+class StringID
+{
+public:
+	constexpr StringID() = default;
+
+	constexpr StringID(std::string_view _name)
+		: m_Hash{ Hash(_name) }
+	{
+#ifdef _DEBUG
+		if (!std::is_constant_evaluated())
+			Register(m_Hash, _name);
+#endif
+	}
+
+	constexpr StringID(const char* _name)
+		: StringID{ std::string_view{ _name } }
+	{
+	}
+
+	StringID(const std::string& _name)
+		: StringID{ std::string_view{ _name } }
+	{
+	}
+
+	/// <summary>
+	/// Returns the hash.
+	/// </summary>
+	/// <returns></returns>
+	constexpr uint64_t GetHash() const { return m_Hash; }
+
+	/// <summary>
+	/// Returns the hashed name in debug builds, otherwise the hash in hexadecimal.
+	/// </summary>
+	/// <returns></returns>
+	std::string GetName() const;
+
+	constexpr bool operator==(const StringID& _other) const = default;
+
+	/// <summary>
+	/// Continues an FNV-1a hash over more characters, so several strings can be hashed as one without joining them.
+	/// </summary>
+	/// <param name="_string"></param>
+	/// <param name="_hash"> The hash so far </param>
+	/// <returns></returns>
+	static constexpr uint64_t Hash(std::string_view _string, uint64_t _hash = OffsetBasis)
+	{
+		for (char character : _string)
+		{
+			_hash ^= (unsigned char)character;
+			_hash *= Prime;
+		}
+		return _hash;
+	}
+
+	static constexpr uint64_t OffsetBasis = 14695981039346656037ull;
+	static constexpr uint64_t Prime = 1099511628211ull;
+
+private:
+#ifdef _DEBUG
+	/// <summary>
+	/// Adds a name to the reverse lookup table, printing a warning if a different name already has its hash.
+	/// </summary>
+	/// <param name="_hash"></param>
+	/// <param name="_name"></param>
+	static void Register(uint64_t _hash, std::string_view _name);
+#endif
+
+	uint64_t m_Hash{ 0 };
+};
+
+/// <summary>
+/// Hashes a string literal into a StringID, at compile time outside of debug builds.
+/// Debug builds hash on first use so the name can be registered for lookup.
+/// </summary>
+#ifdef _DEBUG
+constexpr StringID operator""_id(const char* _name, size_t _length)
+{
+	return StringID{ std::string_view{ _name, _length } };
+}
+#else
+consteval StringID operator""_id(const char* _name, size_t _length)
+{
+	return StringID{ std::string_view{ _name, _length } };
+}
+#endif
+
+template<>
+struct std::hash<StringID>
+{
+	size_t operator()(const StringID& _id) const { return (size_t)_id.GetHash(); }
+};
@@ -0,0 +1,324 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TLSFAllocator.cpp 
+// Description : TLSFAllocator Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "TLSFAllocator.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	// Index of the highest set bit, _value must not be 0
+	inline int HighestBit(unsigned _value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse(&index, _value);
+		return (int)index;
+#else
+		return 31 - __builtin_clz(_value);
+#endif
+	}
+
+	// Index of the lowest set bit, _value must not be 0
+	inline int LowestBit(unsigned _value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward(&index, _value);
+		return (int)index;
+#else
+		return __builtin_ctz(_value);
+#endif
+	}
+}
+
+TLSFAllocator::TLSFAllocator(unsigned _size)
+{
+	for (auto& firstLevel : m_FreeLists)
+	{
+		for (auto& head : firstLevel)
+		{
+			head = -1;
+		}
+	}
+
+	if (_size > 0)
+		Grow(_size);
+}
+
+TLSFAllocation TLSFAllocator::Allocate(unsigned _size)
+{
+	if (_size == 0)
+		return {};
+
+	int firstLevel = 0, secondLevel = 0;
+	MapSearch(_size, firstLevel, secondLevel);
+	int blockIndex = firstLevel < FirstLevelCount ? FindFreeBlock(firstLevel, secondLevel) : -1;
+	if (blockIndex == -1)
+		return {};
+
+	RemoveFreeBlock(blockIndex);
+
+	// Split off the remainder as a new free block
+	if (m_Blocks[blockIndex].Size > _size)
+	{
+		int remainderIndex = CreateBlock();
+		Block& block = m_Blocks[blockIndex];
+		Block& remainder = m_Blocks[remainderIndex];
+
+		remainder.Offset = block.Offset + _size;
+		remainder.Size = block.Size - _size;
+		remainder.PreviousPhysical = blockIndex;
+		remainder.NextPhysical = block.NextPhysical;
+		if (block.NextPhysical != -1)
+			m_Blocks[block.NextPhysical].PreviousPhysical = remainderIndex;
+		else
+			m_LastPhysical = remainderIndex;
+
+		block.NextPhysical = remainderIndex;
+		block.Size = _size;
+		InsertFreeBlock(remainderIndex);
+	}
+
+	m_Blocks[blockIndex].IsFree = false;
+	m_UsedSize += _size;
+	m_AllocationCount++;
+
+	return { m_Blocks[blockIndex].Offset, _size, blockIndex };
+}
+
+void TLSFAllocator::Free(const TLSFAllocation& _allocation)
+{
+	if (!_allocation.IsValid())
+		return;
+
+	int blockIndex = _allocation.BlockIndex;
+	m_UsedSize -= m_Blocks[blockIndex].Size;
+	m_AllocationCount--;
+
+	// Merge with the following block
+	int nextIndex = m_Blocks[blockIndex].NextPhysical;
+	if (nextIndex != -1 && m_Blocks[nextIndex].IsFree)
+	{
+		RemoveFreeBlock(nextIndex);
+		Block& block = m_Blocks[blockIndex];
+		block.Size += m_Blocks[nextIndex].Size;
+		block.NextPhysical = m_Blocks[nextIndex].NextPhysical;
+		if (block.NextPhysical != -1)
+			m_Blocks[block.NextPhysical].PreviousPhysical = blockIndex;
+		else
+			m_LastPhysical = blockIndex;
+		ReleaseBlock(nextIndex);
+	}
+
+	// Merge into the preceding block
+	int previousIndex = m_Blocks[blockIndex].PreviousPhysical;
+	if (previousIndex != -1 && m_Blocks[previousIndex].IsFree)
+	{
+		RemoveFreeBlock(previousIndex);
+		Block& previous = m_Blocks[previousIndex];
+		previous.Size += m_Blocks[blockIndex].Size;
+		previous.NextPhysical = m_Blocks[blockIndex].NextPhysical;
+		if (previous.NextPhysical != -1)
+			m_Blocks[previous.NextPhysical].PreviousPhysical = previousIndex;
+		else
+			m_LastPhysical = previousIndex;
+		ReleaseBlock(blockIndex);
+		blockIndex = previousIndex;
+	}
+
+	InsertFreeBlock(blockIndex);
+}
+
+void TLSFAllocator::Grow(unsigned _newSize)
+{
+	if (_newSize <= m_Size)
+		return;
+
+	unsigned extraSize = _newSize - m_Size;
+
+	// Extend the last block if it is free, otherwise append a new one
+	if (m_LastPhysical != -1 && m_Blocks[m_LastPhysical].IsFree)
+	{
+		RemoveFreeBlock(m_LastPhysical);
+		m_Blocks[m_LastPhysical].Size += extraSize;
+		InsertFreeBlock(m_LastPhysical);
+	}
+	else
+	{
+		int blockIndex = CreateBlock();
+		Block& block = m_Blocks[blockIndex];
+		block.Offset = m_Size;
+		block.Size = extraSize;
+		block.PreviousPhysical = m_LastPhysical;
+		if (m_LastPhysical != -1)
+			m_Blocks[m_LastPhysical].NextPhysical = blockIndex;
+		m_LastPhysical = blockIndex;
+		InsertFreeBlock(blockIndex);
+	}
+
+	m_Size = _newSize;
+}
+
+unsigned TLSFAllocator::GetSize() const
+{
+	return m_Size;
+}
+
+unsigned TLSFAllocator::GetUsedSize() const
+{
+	return m_UsedSize;
+}
+
+unsigned TLSFAllocator::GetLargestFreeBlock() const
+{
+	if (m_FirstLevelBitmap == 0)
+		return 0;
+
+	// The largest block is in the highest non empty size class
+	int firstLevel = HighestBit(m_FirstLevelBitmap);
+	int secondLevel = HighestBit(m_SecondLevelBitmaps[firstLevel]);
+
+	unsigned largest = 0;
+	for (int blockIndex = m_FreeLists[firstLevel][secondLevel]; blockIndex != -1; blockIndex = m_Blocks[blockIndex].NextFree)
+	{
+		largest = std::max(largest, m_Blocks[blockIndex].Size);
+	}
+	return largest;
+}
+
+float TLSFAllocator::GetFragmentation() const
+{
+	unsigned freeSize = m_Size - m_UsedSize;
+	if (freeSize == 0)
+		return 0.0f;
+
+	return 1.0f - (float)GetLargestFreeBlock() / (float)freeSize;
+}
+
+int TLSFAllocator::GetAllocationCount() const
+{
+	return m_AllocationCount;
+}
+
+void TLSFAllocator::MapInsert(unsigned _size, int& _firstLevel, int& _secondLevel)
+{
+	// Small sizes all live in the first class, split linearly
+	if (_size < (unsigned)SecondLevelCount)
+	{
+		_firstLevel = 0;
+		_secondLevel = (int)_size;
+		return;
+	}
+
+	int highestBit = HighestBit(_size);
+	_firstLevel = highestBit - SecondLevelBits + 1;
+	_secondLevel = (int)((_size >> (highestBit - SecondLevelBits)) ^ (1u << SecondLevelBits));
+}
+
+void TLSFAllocator::MapSearch(unsigned _size, int& _firstLevel, int& _secondLevel)
+{
+	// Round up to the next class boundary so any block in the class found is large enough
+	if (_size >= (unsigned)SecondLevelCount)
+	{
+		unsigned roundUp = (1u << (HighestBit(_size) - SecondLevelBits)) - 1;
+		if (_size > 0xFFFFFFFF - roundUp)
+		{
+			_firstLevel = FirstLevelCount;
+			_secondLevel = 0;
+			return;
+		}
+		_size += roundUp;
+	}
+	MapInsert(_size, _firstLevel, _secondLevel);
+}
+
+int TLSFAllocator::FindFreeBlock(int _firstLevel, int _secondLevel) const
+{
+	// Look for a larger sub class in the same class first
+	unsigned secondLevelMap = m_SecondLevelBitmaps[_firstLevel] & (~0u << _secondLevel);
+	if (secondLevelMap == 0)
+	{
+		// Then the next non empty class
+		unsigned firstLevelMap = _firstLevel + 1 < FirstLevelCount ? m_FirstLevelBitmap & (~0u << (_firstLevel + 1)) : 0;
+		if (firstLevelMap == 0)
+			return -1;
+
+		_firstLevel = LowestBit(firstLevelMap);
+		secondLevelMap = m_SecondLevelBitmaps[_firstLevel];
+	}
+
+	return m_FreeLists[_firstLevel][LowestBit(secondLevelMap)];
+}
+
+void TLSFAllocator::InsertFreeBlock(int _blockIndex)
+{
+	Block& block = m_Blocks[_blockIndex];
+	int firstLevel = 0, secondLevel = 0;
+	MapInsert(block.Size, firstLevel, secondLevel);
+
+	int& head = m_FreeLists[firstLevel][secondLevel];
+	block.IsFree = true;
+	block.PreviousFree = -1;
+	block.NextFree = head;
+	if (head != -1)
+		m_Blocks[head].PreviousFree = _blockIndex;
+	head = _blockIndex;
+
+	m_FirstLevelBitmap |= 1u << firstLevel;
+	m_SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TLSFAllocator::RemoveFreeBlock(int _blockIndex)
+{
+	Block& block = m_Blocks[_blockIndex];
+	int firstLevel = 0, secondLevel = 0;
+	MapInsert(block.Size, firstLevel, secondLevel);
+
+	if (block.PreviousFree != -1)
+		m_Blocks[block.PreviousFree].NextFree = block.NextFree;
+	else
+		m_FreeLists[firstLevel][secondLevel] = block.NextFree;
+	if (block.NextFree != -1)
+		m_Blocks[block.NextFree].PreviousFree = block.PreviousFree;
+
+	// Clear the bitmaps once the class is empty
+	if (m_FreeLists[firstLevel][secondLevel] == -1)
+	{
+		m_SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+		if (m_SecondLevelBitmaps[firstLevel] == 0)
+			m_FirstLevelBitmap &= ~(1u << firstLevel);
+	}
+
+	block.IsFree = false;
+	block.PreviousFree = -1;
+	block.NextFree = -1;
+}
+
+int TLSFAllocator::CreateBlock()
+{
+	if (m_UnusedBlocks.size() > 0)
+	{
+		int blockIndex = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+		m_Blocks[blockIndex] = Block{};
+		return blockIndex;
+	}
+
+	m_Blocks.emplace_back();
+	return (int)m_Blocks.size() - 1;
+}
+
+void TLSFAllocator::ReleaseBlock(int _blockIndex)
+{
+	m_Blocks[_blockIndex] = Block{};
+	m_UnusedBlocks.push_back(_blockIndex);
+}
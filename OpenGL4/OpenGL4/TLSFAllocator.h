@@ -0,0 +1,153 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TLSFAllocator.h 
+// Description : TLSFAllocator Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// A range handed out by the TLSFAllocator.
+/// BlockIndex identifies the range when freeing it.
+/// </summary>
+struct TLSFAllocation
+{
+	unsigned Offset = 0xFFFFFFFF;
+	unsigned Size = 0;
+	int BlockIndex = -1;
+
+	bool IsValid() const { return BlockIndex != -1; }
+};
+
+/// <summary>
+/// Two level segregated fit allocator.
+/// Manages offsets into an external range (e.g. a GPU buffer) so it never touches the memory itself.
+/// Free blocks are binned by size into power of two classes split into 16 linear sub classes,
+/// with a bitmap per level so allocating and freeing are constant time. Neighbouring free blocks are merged on free.
+/// </summary>
+class TLSFAllocator
+{
+public:
+	/// <summary>
+	/// TLSFAllocator Constructor
+	/// </summary>
+	/// <param name="_size"> Number of units in the managed range </param>
+	TLSFAllocator(unsigned _size = 0);
+
+	/// <summary>
+	/// Allocates a range of the given number of units.
+	/// Returns an invalid allocation if no free block is large enough.
+	/// </summary>
+	/// <param name="_size"></param>
+	/// <returns></returns>
+	TLSFAllocation Allocate(unsigned _size);
+
+	/// <summary>
+	/// Returns the range to the allocator, merging it with any free neighbours.
+	/// </summary>
+	/// <param name="_allocation"></param>
+	void Free(const TLSFAllocation& _allocation);
+
+	/// <summary>
+	/// Extends the managed range to the given number of units.
+	/// </summary>
+	/// <param name="_newSize"></param>
+	void Grow(unsigned _newSize);
+
+	/// <summary>
+	/// Returns the number of units in the managed range.
+	/// </summary>
+	/// <returns></returns>
+	unsigned GetSize() const;
+
+	/// <summary>
+	/// Returns the number of allocated units.
+	/// </summary>
+	/// <returns></returns>
+	unsigned GetUsedSize() const;
+
+	/// <summary>
+	/// Returns the size of the largest free block.
+	/// </summary>
+	/// <returns></returns>
+	unsigned GetLargestFreeBlock() const;
+
+	/// <summary>
+	/// Returns how fragmented the free space is, 0 when it is one block and approaching 1 as it is split up.
+	/// </summary>
+	/// <returns></returns>
+	float GetFragmentation() const;
+
+	/// <summary>
+	/// Returns the number of live allocations.
+	/// </summary>
+	/// <returns></returns>
+	int GetAllocationCount() const;
+
+	static const unsigned InvalidOffset = 0xFFFFFFFF;
+	static const int SecondLevelBits = 4;
+	static const int SecondLevelCount = 1 << SecondLevelBits;
+	static const int FirstLevelCount = 32;
+
+private:
+	/// <summary>
+	/// A used or free range. Blocks are linked to their physical neighbours and free blocks to their size class.
+	/// </summary>
+	struct Block
+	{
+		unsigned Offset = 0;
+		unsigned Size = 0;
+		int PreviousPhysical = -1;
+		int NextPhysical = -1;
+		int PreviousFree = -1;
+		int NextFree = -1;
+		bool IsFree = false;
+	};
+
+	/// <summary>
+	/// Returns the size class a block of the given size is stored in.
+	/// </summary>
+	/// <param name="_size"></param>
+	/// <param name="_firstLevel"></param>
+	/// <param name="_secondLevel"></param>
+	static void MapInsert(unsigned _size, int& _firstLevel, int& _secondLevel);
+
+	/// <summary>
+	/// Returns the smallest size class whose blocks are all at least the given size.
+	/// </summary>
+	/// <param name="_size"></param>
+	/// <param name="_firstLevel"></param>
+	/// <param name="_secondLevel"></param>
+	static void MapSearch(unsigned _size, int& _firstLevel, int& _secondLevel);
+
+	/// <summary>
+	/// Returns the first free block in the given size class or any larger one, -1 if there is none.
+	/// </summary>
+	/// <param name="_firstLevel"></param>
+	/// <param name="_secondLevel"></param>
+	/// <returns></returns>
+	int FindFreeBlock(int _firstLevel, int _secondLevel) const;
+
+	void InsertFreeBlock(int _blockIndex);
+	void RemoveFreeBlock(int _blockIndex);
+
+	int CreateBlock();
+	void ReleaseBlock(int _blockIndex);
+
+	std::vector<Block> m_Blocks{};
+	std::vector<int> m_UnusedBlocks{};
+	int m_LastPhysical{ -1 };
+
+	unsigned m_FirstLevelBitmap{ 0 };
+	unsigned m_SecondLevelBitmaps[FirstLevelCount]{};
+	int m_FreeLists[FirstLevelCount][SecondLevelCount]{};
+
+	unsigned m_Size{ 0 };
+	unsigned m_UsedSize{ 0 };
+	int m_AllocationCount{ 0 };
+};
@@ -9,6 +9,7 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "TextLabel.h"
+#include "GLState.h"
 
 TextLabel::TextLabel(glm::ivec2& _windowSize, std::string_view&& _text, Font& _loadedFont, float& _deltaTime, glm::vec2&& _position, glm::vec4&& _colour , glm::vec2&& _scale)
 {
@@ -31,10 +32,10 @@ TextLabel::TextLabel(glm::ivec2& _windowSize, std::string_view&& _text, Font& _l
 
 	// Generate the vertex array, vertex buffer, and index buffer
 	glGenVertexArrays(1, &m_VertexArrayID);
-	glBindVertexArray(m_VertexArrayID);
+	GLState::BindVertexArray(m_VertexArrayID);
 
 	glGenBuffers(1, &m_VertexBufferID);
-	glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
 	// Vertex buffer will be 4*4 floats
 	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 4 * 4, nullptr, GL_DYNAMIC_DRAW);
 
@@ -45,7 +46,7 @@ TextLabel::TextLabel(glm::ivec2& _windowSize, std::string_view&& _text, Font& _l
 	};
 
 	glGenBuffers(1, &m_IndexBufferID);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID);
 	// Indices are 3*2 Gluints
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * 3 * 2, &indices[0], GL_STATIC_DRAW);
 
@@ -53,9 +54,9 @@ TextLabel::TextLabel(glm::ivec2& _windowSize, std::string_view&& _text, Font& _l
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
 	glEnableVertexAttribArray(0);
 
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::BindVertexArray(0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 TextLabel::~TextLabel()
@@ -71,18 +72,18 @@ void TextLabel::Draw()
 	if (m_FontLoaded)
 	{
 		// Assign all Uniforms
-		glUseProgram(m_ProgramID);
-		ShaderLoader::SetUniform4fv(std::move(m_ProgramID), "Colour", m_Colour);
-		ShaderLoader::SetUniformMatrix4fv(std::move(m_ProgramID), "PMatrix", m_ProjectionMatrix);
-		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "LeftClip", m_Position.x - m_LeftClip);
-		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "RightClip", m_Position.x + m_RightClip);
-		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "ElapsedTime", (float)glfwGetTime());
-		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "ScrollSpeed", m_ScrollSpeed);
-		ShaderLoader::SetUniform1i(std::move(m_ProgramID), "IsScrollingRight", m_ScrollRight);
-		ShaderLoader::SetUniform1i(std::move(m_ProgramID), "IsScrolling", m_IsScrolling);
+		GLState::UseProgram(m_ProgramID);
+		ShaderLoader::SetUniform4fv(std::move(m_ProgramID), "Colour"_id, m_Colour);
+		ShaderLoader::SetUniformMatrix4fv(std::move(m_ProgramID), "PMatrix"_id, m_ProjectionMatrix);
+		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "LeftClip"_id, m_Position.x - m_LeftClip);
+		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "RightClip"_id, m_Position.x + m_RightClip);
+		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "ElapsedTime"_id, (float)glfwGetTime());
+		ShaderLoader::SetUniform1f(std::move(m_ProgramID), "ScrollSpeed"_id, m_ScrollSpeed);
+		ShaderLoader::SetUniform1i(std::move(m_ProgramID), "IsScrollingRight"_id, m_ScrollRight);
+		ShaderLoader::SetUniform1i(std::move(m_ProgramID), "IsScrolling"_id, m_IsScrolling);
 
 		// Bind Vertex Array
-		glBindVertexArray(m_VertexArrayID);
+		GLState::BindVertexArray(m_VertexArrayID);
 
 		FontChar fontCharacter;
 		GLfloat posX;
@@ -113,13 +114,12 @@ void TextLabel::Draw()
 			};
 
 			// Stream in the vertices to the vertex buffer
-			glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
 			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
 
 			// Set the texture to that of thee current fontCharacter
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, fontCharacter.textureID);
-			ShaderLoader::SetUniform1i(std::move(m_ProgramID), "Texture", 0);
+			GLState::BindTexture(0, GL_TEXTURE_2D, fontCharacter.textureID);
+			ShaderLoader::SetUniform1i(std::move(m_ProgramID), "Texture"_id, 0);
 
 			// Draw character
 			glDrawElements(GL_TRIANGLES, sizeof(GLuint) * 6, GL_UNSIGNED_INT, nullptr);
@@ -129,10 +129,10 @@ void TextLabel::Draw()
 		}
 
 		// Unbind
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		glUseProgram(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GLState::BindVertexArray(0);
+		GLState::BindTexture(0, GL_TEXTURE_2D, 0);
+		GLState::UseProgram(0);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 }
 
@@ -9,16 +9,32 @@
 // Mail : william.inman@mds.ac.nz
 
 #include "TextureLoader.h"
+#include "GLState.h"
+#include "TextureStreamer.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "STBI/stb_image.h"
-
-TextureLoader::~TextureLoader()
+namespace
 {
-    // Cleanup All Stored Textures
-    for (auto& item : m_Textures)
+    GLenum GetFormat(int _components)
+    {
+        return _components == 4 ? GL_RGBA : _components == 3 ? GL_RGB : _components == 2 ? GL_RG : GL_RED;
+    }
+
+    // Uploads every level of an image to the bound target, returning false if the mips still have to be generated
+    bool UploadImage(GLenum _target, const ImageData& _image)
     {
-        glDeleteTextures(1, &item.ID);
+        // Levels are tightly packed, so rows of 1 to 3 channel images are not 4 byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLenum format = GetFormat(_image.Components);
+        for (int level = 0; level < (int)_image.Levels.size(); level++)
+        {
+            glm::ivec2 size = AssetCooker::GetLevelSize(_image, level);
+            if (_image.Format != 0)
+                glCompressedTexImage2D(_target, level, _image.Format, size.x, size.y, 0, (GLsizei)AssetCooker::GetLevelBytes(_image, level), _image.Levels[level]);
+            else
+                glTexImage2D(_target, level, format, size.x, size.y, 0, format, GL_UNSIGNED_BYTE, _image.Levels[level]);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return _image.Levels.size() > 1;
     }
 }
 
@@ -26,108 +42,284 @@ void TextureLoader::Init(std::vector<const char*>&& _textures)
 {
     for (auto& item : _textures)
     {
-        LoadTexture(item);
+        Release(LoadTexture(item));
     }
 }
 
-Texture TextureLoader::LoadTexture(std::string&& _fileName)
+TextureHandle TextureLoader::LoadTexture(std::string&& _fileName)
 {
-    // Checks If A Texture With The Same File path Has Already Been Created
-    for (auto& item : m_Textures)
+    // Checks If A Texture With The Same File path Is Already Loaded Or Loading
+    StringID key{ _fileName };
+    if (TextureHandle texture = Find(key); texture.IsValid())
+        return texture;
+
+    // The Slot Shows The Placeholder Until The Streamer Has Decoded And Uploaded The Image
+    uint32_t index = AllocateSlot(key, SlotState::Loading);
+    m_Stats.LoadingCount++;
+    TextureStreamer::Request(StreamRequest{ index, m_Slots[index].Generation, "Textures/" + _fileName, true });
+    return TextureHandle{ index, m_Slots[index].Generation };
+}
+
+TextureHandle TextureLoader::LoadCubemap(std::vector<std::string> _fileNames)
+{
+    // Keyed On Every Face So Cubemaps Sharing Some Faces Stay Separate Textures
+    std::string name{};
+    for (auto& fileName : _fileNames)
+    {
+        name += fileName + '|';
+    }
+    StringID key{ name };
+    if (TextureHandle texture = Find(key); texture.IsValid())
+        return texture;
+
+    GLuint id;
+
+    glGenTextures(1, &id);
+    GLState::BindTexture(GL_TEXTURE_CUBE_MAP, id);
+
+    // Load in all sides of cubemap, faces are not flipped
+    bool hasMips = true;
+    glm::ivec2 size{ 0,0 };
+    uint64_t bytes = 0;
+    for(int i = 0; i < 6; i++)
     {
-        if (item.FilePath == _fileName)
+        ImageData image{};
+        FileData cooked{};
+        if (!AssetCooker::ReadTexture("Textures/Cubemaps/" + _fileNames[i], false, cooked, image))
         {
-            return item;
+            hasMips = false;
+            continue;
         }
+        hasMips = UploadImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, image) && hasMips;
+        size = image.Size;
+        bytes += TextureStreamer::GetTextureBytes(image);
     }
 
-    stbi_set_flip_vertically_on_load(true);
+    // Generates MipMaps For Bound Texture Unless Every Face Was Cooked With Them
+    if (!hasMips)
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
-    GLint width, height, components;
+    // Set Texture Parameters For Bound Texture
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    // Grab Image Data Using STB_Image And Store It In A const char*
-    GLubyte* imageData = stbi_load(("Resources/Textures/" + _fileName).data(), & width, & height, & components, 0);
-    
-    // Generate And Bind A New Texture
-    GLuint id;
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    // Check And Assigns Number Of Components (e.g RGB)
-    components = components == 4 ? GL_RGBA : components == 3 ? GL_RGB : components == 2 ? GL_RG : GL_R;
-    
-    // Assigns The Image Data To The Bound Texture
-    glTexImage2D(GL_TEXTURE_2D, 0 ,components, width, height, 0, components, GL_UNSIGNED_BYTE, imageData);
-    
-    // Generates MipMaps For Bound Texture
-    glGenerateMipmap(GL_TEXTURE_2D);
+    GLState::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
-    // Set Texture Parameters For Bound Texture
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    return Add(key, id, size, bytes);
+}
 
-    // Free The Loaded Data And Unbind Texture
-    stbi_image_free(imageData);
-    imageData = nullptr;
-    glBindTexture(GL_TEXTURE_2D, 0);
+void TextureLoader::AddReference(TextureHandle _texture)
+{
+    if (TextureSlot* slot = GetSlot(_texture))
+        slot->References++;
+}
 
-    // Add Newly Created Texture To Vector
-    m_Textures.emplace_back(Texture{ id , {width,height},_fileName });
+void TextureLoader::Release(TextureHandle _texture)
+{
+    TextureSlot* slot = GetSlot(_texture);
+    if (!slot || slot->References == 0)
+        return;
+
+    slot->References--;
+    if (slot->References == 0)
+    {
+        m_Stats.ReferencedCount--;
+        // Failed textures are forgotten so loading them again retries, loading ones stay until they arrive
+        if (slot->State == SlotState::Failed)
+            FreeSlot(_texture.Index);
+        EvictToBudget();
+    }
+}
+
+GLuint TextureLoader::GetID(TextureHandle _texture)
+{
+    TextureSlot* slot = GetSlot(_texture);
+    if (!slot)
+        return 0;
+    slot->LastUsed = ++m_UseCount;
+    if (slot->State == SlotState::Resident)
+        return slot->ID;
+
+    if (m_Placeholder == 0)
+    {
+        const unsigned char white[4]{ 255, 255, 255, 255 };
+        glGenTextures(1, &m_Placeholder);
+        GLState::BindTexture(GL_TEXTURE_2D, m_Placeholder);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
+    }
+    return m_Placeholder;
+}
+
+glm::ivec2 TextureLoader::GetSize(TextureHandle _texture)
+{
+    TextureSlot* slot = GetSlot(_texture);
+    return slot ? slot->Size : glm::ivec2{ 0,0 };
+}
 
-    // Return Newly Created Texture
-    return m_Textures.back();
+void TextureLoader::SetBudget(uint64_t _bytes)
+{
+    m_Stats.BudgetBytes = _bytes;
+    EvictToBudget();
 }
 
-Texture TextureLoader::LoadCubemap(std::vector<std::string> _fileNames)
+void TextureLoader::Update()
 {
-    for (auto& item : m_Textures)
+    std::vector<StreamResult> finished{};
+    TextureStreamer::Update(finished);
+    if (finished.empty())
+        return;
+
+    for (auto& result : finished)
     {
-        if (item.FilePath == _fileNames[0])
+        m_Stats.LoadingCount--;
+        TextureSlot* slot = GetSlot(TextureHandle{ result.Index, result.Generation });
+        if (!slot || slot->State != SlotState::Loading)
+        {
+            if (result.ID != 0)
+                GLState::DeleteTextures(1, &result.ID);
+            continue;
+        }
+
+        if (result.ID == 0)
         {
-            return item;
+            slot->State = SlotState::Failed;
+            if (slot->References == 0)
+                FreeSlot(result.Index);
+            continue;
         }
+
+        slot->State = SlotState::Resident;
+        slot->ID = result.ID;
+        slot->Size = result.Size;
+        slot->Bytes = result.Bytes;
+        m_Stats.ResidentCount++;
+        m_Stats.ResidentBytes += result.Bytes;
     }
+    EvictToBudget();
+}
 
-    stbi_set_flip_vertically_on_load(false);
+TextureStats TextureLoader::GetStats()
+{
+    return m_Stats;
+}
 
-    GLint width, height, components;
-    GLuint id;
+void TextureLoader::Cleanup()
+{
+    TextureStreamer::Shutdown();
+    if (m_Placeholder != 0)
+        GLState::DeleteTextures(1, &m_Placeholder);
+    m_Placeholder = 0;
 
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    for (auto& slot : m_Slots)
+    {
+        if (slot.ID != 0)
+            GLState::DeleteTextures(1, &slot.ID);
+    }
+    m_Slots.assign(1, TextureSlot{});
+    m_FreeSlots.clear();
+    m_Lookup.Clear();
+    m_Stats = TextureStats{ .BudgetBytes = m_Stats.BudgetBytes };
+}
 
-    // Load in all sides of cubemap
-    for(int i = 0; i < 6; i++)
+TextureLoader::TextureSlot* TextureLoader::GetSlot(TextureHandle _texture)
+{
+    if (_texture.Index == 0 || _texture.Index >= m_Slots.size())
+        return nullptr;
+    TextureSlot& slot = m_Slots[_texture.Index];
+    return slot.State != SlotState::Free && slot.Generation == _texture.Generation ? &slot : nullptr;
+}
+
+TextureHandle TextureLoader::Find(StringID _key)
+{
+    uint32_t* index = m_Lookup.Find(_key);
+    if (!index)
     {
-        GLubyte* imageData = stbi_load(("Resources/Textures/Cubemaps/" + _fileNames[i]).data(), &width, &height, &components, 0);
-        
-        components = components == 4 ? GL_RGBA : components == 3 ? GL_RGB : components == 2 ? GL_RG : GL_R;
+        m_Stats.Misses++;
+        return TextureHandle{};
+    }
 
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-            0, components, width, height, 0,
-            components, GL_UNSIGNED_BYTE, imageData);
+    m_Stats.Hits++;
+    TextureSlot& slot = m_Slots[*index];
+    if (slot.References++ == 0)
+        m_Stats.ReferencedCount++;
+    slot.LastUsed = ++m_UseCount;
+    return TextureHandle{ *index, slot.Generation };
+}
 
-        stbi_image_free(imageData);
-        imageData = nullptr;
+uint32_t TextureLoader::AllocateSlot(StringID _key, SlotState _state)
+{
+    uint32_t index = 0;
+    if (!m_FreeSlots.empty())
+    {
+        index = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)m_Slots.size();
+        m_Slots.emplace_back();
     }
 
-    // Generates MipMaps For Bound Texture
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    TextureSlot& slot = m_Slots[index];
+    slot.State = _state;
+    slot.LastUsed = ++m_UseCount;
+    slot.Key = _key;
+    slot.References = 1;
+    m_Lookup[_key] = index;
+    m_Stats.ReferencedCount++;
+    return index;
+}
 
-    // Set Texture Parameters For Bound Texture
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void TextureLoader::FreeSlot(uint32_t _index)
+{
+    TextureSlot& slot = m_Slots[_index];
+    if (slot.ID != 0)
+        GLState::DeleteTextures(1, &slot.ID);
+    m_Lookup.Erase(slot.Key);
+    slot = TextureSlot{ .Generation = slot.Generation + 1 };
+    m_FreeSlots.push_back(_index);
+}
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+TextureHandle TextureLoader::Add(StringID _key, GLuint _id, glm::ivec2 _size, uint64_t _bytes)
+{
+    uint32_t index = AllocateSlot(_key, SlotState::Resident);
+    TextureSlot& slot = m_Slots[index];
+    slot.ID = _id;
+    slot.Size = _size;
+    slot.Bytes = _bytes;
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    m_Stats.ResidentCount++;
+    m_Stats.ResidentBytes += _bytes;
+    TextureHandle texture{ index, slot.Generation };
+    EvictToBudget();
+    return texture;
+}
 
-    m_Textures.emplace_back(Texture{ id , {0,0}, _fileNames[0]});
+void TextureLoader::EvictToBudget()
+{
+    // A linear scan per eviction, the registry holds at most a few hundred textures
+    while (m_Stats.ResidentBytes > m_Stats.BudgetBytes)
+    {
+        uint32_t oldest = 0;
+        for (uint32_t index = 1; index < (uint32_t)m_Slots.size(); index++)
+        {
+            const TextureSlot& slot = m_Slots[index];
+            if (slot.State == SlotState::Resident && slot.References == 0 && (oldest == 0 || slot.LastUsed < m_Slots[oldest].LastUsed))
+                oldest = index;
+        }
+        if (oldest == 0)
+            return;
 
-    return m_Textures.back();
+        m_Stats.ResidentCount--;
+        m_Stats.ResidentBytes -= m_Slots[oldest].Bytes;
+        m_Stats.Evictions++;
+        FreeSlot(oldest);
+    }
 }
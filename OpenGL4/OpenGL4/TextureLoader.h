@@ -10,34 +10,170 @@
 
 #pragma once
 #include "Helper.h"
+#include "FlatHashMap.h"
+
+/// <summary>
+/// Texture cache lookups, evictions and the GPU memory held by loaded textures.
+/// </summary>
+struct TextureStats
+{
+	int Hits = 0;
+	int Misses = 0;
+	int Evictions = 0;
+	int ResidentCount = 0;
+	int ReferencedCount = 0;
+	int LoadingCount = 0;
+	uint64_t ResidentBytes = 0;
+	uint64_t BudgetBytes = 0;
+};
+
+/// <summary>
+/// The registry every texture is loaded through, keyed by the hash of its path so each file is only loaded once.
+/// Loads return a TextureHandle holding one reference, which its owner gives back with Release.
+/// Textures nobody references stay resident so loading them again is a cache hit,
+/// until the memory of all textures goes over the budget and the least recently used of them are deleted.
+/// Referenced textures are never evicted, so the budget can be exceeded while they are all in use.
+/// 2D textures are streamed in by the TextureStreamer, their handles resolve to a 1x1 white placeholder until they are uploaded.
+/// </summary>
 class TextureLoader
 {
 public:
 	/// <summary>
-	/// Cleans Up All Loaded Textures
+	/// Loads any initial textures into the cache without holding a reference to them.
 	/// </summary>
-	~TextureLoader();
+	static void Init(std::vector<const char*>&& _textures = {});
 
 	/// <summary>
-	/// Initializes The Texture Loader With Any Initial Textures And Sets Flip_On_Load True
+	/// Returns a handle to the texture with the given file name, requesting it from the TextureStreamer if it is not in the registry,
+	/// and adds a reference to it. The handle shows the placeholder while loading and for good if the file could not be loaded.
 	/// </summary>
-	static void Init(std::vector<const char*>&& _textures = {});
+	/// <param name="_fileName"></param>
+	/// <returns></returns>
+	static TextureHandle LoadTexture(std::string&& _fileName);
 
 	/// <summary>
-	/// Creates A Texture And Returns Its ID, FilePath And Dimentions In A The Struct Texture Using Cache Optimization.
+	/// Returns a handle to a cubemap of the given 6 textures, loading it if it is not resident, and adds a reference to it.
 	/// </summary>
-	/// <param name="_filePath"></param>
+	/// <param name="_fileNames"></param>
 	/// <returns></returns>
-	static Texture LoadTexture(std::string&& _fileName);
+	static TextureHandle LoadCubemap(std::vector<std::string> _fileNames);
 
 	/// <summary>
-	/// Creates a cubemap from the given 6 textures and returns its id and filepath in the struct Texture using Cache Optimization
+	/// Adds a reference to a texture for another owner of the handle.
 	/// </summary>
-	/// <param name="_fileNames"></param>
+	/// <param name="_texture"></param>
+	static void AddReference(TextureHandle _texture);
+
+	/// <summary>
+	/// Gives back a reference. Once a texture has none it can be evicted.
+	/// </summary>
+	/// <param name="_texture"></param>
+	static void Release(TextureHandle _texture);
+
+	/// <summary>
+	/// Returns the GL name of a texture and marks it as used, the placeholder if it is still loading or failed to load,
+	/// or 0 if the handle is invalid or its texture was evicted.
+	/// </summary>
+	/// <param name="_texture"></param>
 	/// <returns></returns>
-	static Texture LoadCubemap(std::vector<std::string> _fileNames);
+	static GLuint GetID(TextureHandle _texture);
+
+	/// <summary>
+	/// Returns the size of the first level of a texture, or 0 if the handle is invalid or it is not loaded yet.
+	/// </summary>
+	/// <param name="_texture"></param>
+	/// <returns></returns>
+	static glm::ivec2 GetSize(TextureHandle _texture);
+
+	/// <summary>
+	/// Sets the GPU memory unreferenced textures are evicted to stay under, evicting straight away if it is already over.
+	/// </summary>
+	/// <param name="_bytes"></param>
+	static void SetBudget(uint64_t _bytes);
+
+	/// <summary>
+	/// Uploads the textures the TextureStreamer has finished decoding into their slots. Called once per frame.
+	/// </summary>
+	static void Update();
+
+	static TextureStats GetStats();
+
+	/// <summary>
+	/// Stops streaming and deletes every texture, referenced or not. Handles must not be used afterwards.
+	/// </summary>
+	static void Cleanup();
 
 private:
-	inline static std::vector<Texture> m_Textures;
-};
+	enum class SlotState
+	{
+		Free,
+		Loading,
+		Resident,
+		Failed,
+	};
+
+	/// <summary>
+	/// A texture in the registry. Only resident slots have a GL name, free slots are reused newest first.
+	/// </summary>
+	struct TextureSlot
+	{
+		SlotState State = SlotState::Free;
+		GLuint ID = 0;
+		glm::ivec2 Size{ 0,0 };
+		uint64_t Bytes = 0;
+		uint64_t LastUsed = 0;
+		StringID Key{};
+		uint32_t References = 0;
+		uint32_t Generation = 0;
+	};
+
+	/// <summary>
+	/// Returns the slot of a live handle, or nullptr if it is invalid or its texture was evicted.
+	/// </summary>
+	/// <param name="_texture"></param>
+	/// <returns></returns>
+	static TextureSlot* GetSlot(TextureHandle _texture);
+
+	/// <summary>
+	/// Returns a referenced handle to a resident texture, counting the lookup as a hit or a miss.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <returns></returns>
+	static TextureHandle Find(StringID _key);
+
+	/// <summary>
+	/// Takes a free slot for a texture and gives it one reference.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <param name="_state"></param>
+	/// <returns></returns>
+	static uint32_t AllocateSlot(StringID _key, SlotState _state);
+
+	/// <summary>
+	/// Removes a texture from the registry, invalidating its handles, and deletes its GL texture if it has one.
+	/// </summary>
+	/// <param name="_index"></param>
+	static void FreeSlot(uint32_t _index);
+
+	/// <summary>
+	/// Adds a newly loaded texture with one reference, evicting others if it takes the registry over the budget.
+	/// </summary>
+	/// <param name="_key"></param>
+	/// <param name="_id"></param>
+	/// <param name="_size"></param>
+	/// <param name="_bytes"></param>
+	/// <returns></returns>
+	static TextureHandle Add(StringID _key, GLuint _id, glm::ivec2 _size, uint64_t _bytes);
 
+	/// <summary>
+	/// Deletes unreferenced textures, least recently used first, until the resident memory is under the budget.
+	/// </summary>
+	static void EvictToBudget();
+
+	inline static std::vector<TextureSlot> m_Slots{ 1 };
+	inline static std::vector<uint32_t> m_FreeSlots{};
+	inline static FlatHashMap<StringID, uint32_t> m_Lookup{};
+	inline static TextureStats m_Stats{ .BudgetBytes = 512ull * 1024 * 1024 };
+	inline static uint64_t m_UseCount{ 0 };
+	inline static GLuint m_Placeholder{ 0 };
+};
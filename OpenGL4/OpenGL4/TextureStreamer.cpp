@@ -0,0 +1,271 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TextureStreamer.cpp 
+// Description : TextureStreamer Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "TextureStreamer.h"
+#include "GLState.h"
+#include <cstring>
+
+namespace
+{
+	GLenum GetFormat(int _components)
+	{
+		return _components == 4 ? GL_RGBA : _components == 3 ? GL_RGB : _components == 2 ? GL_RG : GL_RED;
+	}
+
+	GLenum GetSizedFormat(int _components)
+	{
+		return _components == 4 ? GL_RGBA8 : _components == 3 ? GL_RGB8 : _components == 2 ? GL_RG8 : GL_R8;
+	}
+
+	// Offsets into the ring are kept aligned so every copy starts on a cache line friendly boundary
+	const size_t UploadAlignment = 16;
+}
+
+void TextureStreamer::Request(StreamRequest&& _request)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		if (m_Workers.empty())
+		{
+			// One core is left for the main thread
+			int workerCount = std::clamp((int)std::thread::hardware_concurrency() - 1, 1, 4);
+			for (int i = 0; i < workerCount; i++)
+			{
+				m_Workers.emplace_back(&TextureStreamer::DecodeWorker);
+			}
+		}
+		m_Requests.push_back(std::move(_request));
+	}
+	m_PendingCount++;
+	m_Condition.notify_one();
+}
+
+void TextureStreamer::Update(std::vector<StreamResult>& _finished)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		for (auto& decoded : m_Decoded)
+		{
+			if (decoded.IsDecoded)
+			{
+				m_Uploads.push_back(Upload{ std::move(decoded) });
+				continue;
+			}
+			_finished.push_back(StreamResult{ decoded.Request.Index, decoded.Request.Generation });
+			m_PendingCount--;
+		}
+		m_Decoded.clear();
+	}
+	if (m_Uploads.empty())
+		return;
+	if (m_Buffer == 0)
+		CreateRing();
+
+	// The GPU may still be reading the segment from SegmentCount frames ago, in which case the uploads wait a frame
+	GLsync& fence = m_Fences[m_Segment];
+	if (fence)
+	{
+		if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			return;
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	if (m_Mapped)
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_Buffer);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	size_t offset = 0;
+	while (!m_Uploads.empty())
+	{
+		Upload& upload = m_Uploads.front();
+		const ImageData& image = upload.Decoded.Image;
+		if (upload.ID == 0)
+		{
+			// Immutable storage for the whole chain, so the levels can arrive over several frames
+			glGenTextures(1, &upload.ID);
+			GLState::BindTexture(GL_TEXTURE_2D, upload.ID);
+			GLenum format = image.Format != 0 ? image.Format : GetSizedFormat(image.Components);
+			glTexStorage2D(GL_TEXTURE_2D, (GLsizei)image.Levels.size(), format, image.Size.x, image.Size.y);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.Levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		}
+		else
+		{
+			GLState::BindTexture(GL_TEXTURE_2D, upload.ID);
+		}
+
+		if (!UploadLevels(upload, offset))
+			break;
+
+		_finished.push_back(StreamResult{ upload.Decoded.Request.Index, upload.Decoded.Request.Generation, upload.ID, image.Size, GetTextureBytes(image) });
+		m_PendingCount--;
+		m_Uploads.pop_front();
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+	if (m_Mapped)
+	{
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (offset > 0)
+		{
+			fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			m_Segment = (m_Segment + 1) % SegmentCount;
+		}
+	}
+}
+
+void TextureStreamer::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+		m_Requests.clear();
+	}
+	m_Condition.notify_all();
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+	m_Decoded.clear();
+	m_IsStopping = false;
+
+	for (auto& upload : m_Uploads)
+	{
+		if (upload.ID != 0)
+			GLState::DeleteTextures(1, &upload.ID);
+	}
+	m_Uploads.clear();
+	m_PendingCount = 0;
+
+	for (auto& fence : m_Fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	// Deleting the buffer also unmaps it
+	if (m_Buffer != 0)
+		GLState::DeleteBuffers(1, &m_Buffer);
+	m_Buffer = 0;
+	m_Mapped = nullptr;
+	m_Segment = 0;
+}
+
+int TextureStreamer::GetPendingCount()
+{
+	return m_PendingCount;
+}
+
+uint64_t TextureStreamer::GetTextureBytes(const ImageData& _image)
+{
+	uint64_t bytes = 0;
+	for (int level = 0; level < (int)_image.Levels.size(); level++)
+	{
+		glm::ivec2 size = AssetCooker::GetLevelSize(_image, level);
+		bytes += _image.Format != 0 || _image.Components != 3 ? AssetCooker::GetLevelBytes(_image, level) : (uint64_t)size.x * size.y * 4;
+	}
+	return bytes;
+}
+
+void TextureStreamer::DecodeWorker()
+{
+	while (true)
+	{
+		DecodedImage decoded{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_Condition.wait(lock, []() { return m_IsStopping || !m_Requests.empty(); });
+			if (m_IsStopping)
+				return;
+			decoded.Request = std::move(m_Requests.front());
+			m_Requests.pop_front();
+		}
+
+		// A cooked chain is used in place, a source image is decoded and its mips built here instead of by glGenerateMipmap
+		const StreamRequest& request = decoded.Request;
+		decoded.IsDecoded = AssetCooker::ReadTexture(request.Path, request.Flip, decoded.Cooked, decoded.Image);
+
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Decoded.push_back(std::move(decoded));
+	}
+}
+
+bool TextureStreamer::CreateRing()
+{
+	// Persistent and coherent, so copies into the mapping are seen by the GPU without flushing or remapping
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &m_Buffer);
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_Buffer);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, SegmentSize * SegmentCount, nullptr, flags);
+	m_Mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, SegmentSize * SegmentCount, flags);
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (!m_Mapped)
+		Print("Could not map the texture upload ring, textures are uploaded directly");
+	return m_Mapped != nullptr;
+}
+
+bool TextureStreamer::UploadLevels(Upload& _upload, size_t& _offset)
+{
+	const ImageData& image = _upload.Decoded.Image;
+	GLenum format = GetFormat(image.Components);
+
+	// Without the ring the whole chain is uploaded from the decoded memory straight away
+	if (!m_Mapped)
+	{
+		for (int level = 0; level < (int)image.Levels.size(); level++)
+		{
+			glm::ivec2 size = AssetCooker::GetLevelSize(image, level);
+			if (image.Format != 0)
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, size.x, size.y, image.Format, (GLsizei)AssetCooker::GetLevelBytes(image, level), image.Levels[level]);
+			else
+				glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, size.x, size.y, format, GL_UNSIGNED_BYTE, image.Levels[level]);
+		}
+		return true;
+	}
+
+	// Whole rows are copied, or rows of blocks for compressed images,
+	// so a level larger than what is left of the segment continues next frame where it stopped
+	size_t segmentStart = (size_t)m_Segment * SegmentSize;
+	int rowHeight = image.Format != 0 ? 4 : 1;
+	while (_upload.Level < (int)image.Levels.size())
+	{
+		glm::ivec2 size = AssetCooker::GetLevelSize(image, _upload.Level);
+		int rowCount = (size.y + rowHeight - 1) / rowHeight;
+		size_t rowSize = AssetCooker::GetLevelBytes(image, _upload.Level) / rowCount;
+		int rows = (int)std::min<size_t>(rowCount - _upload.Row, (SegmentSize - _offset) / rowSize);
+		if (rows <= 0)
+			return false;
+
+		size_t bytes = rowSize * rows;
+		int y = _upload.Row * rowHeight;
+		int height = std::min(rows * rowHeight, size.y - y);
+		const void* source = (const void*)(segmentStart + _offset);
+		std::memcpy(m_Mapped + segmentStart + _offset, image.Levels[_upload.Level] + rowSize * _upload.Row, bytes);
+		if (image.Format != 0)
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, _upload.Level, 0, y, size.x, height, image.Format, (GLsizei)bytes, source);
+		else
+			glTexSubImage2D(GL_TEXTURE_2D, _upload.Level, 0, y, size.x, height, format, GL_UNSIGNED_BYTE, source);
+		_offset = std::min(SegmentSize, (_offset + bytes + UploadAlignment - 1) / UploadAlignment * UploadAlignment);
+
+		_upload.Row += rows;
+		if (_upload.Row == rowCount)
+		{
+			_upload.Level++;
+			_upload.Row = 0;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,142 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TextureStreamer.h 
+// Description : TextureStreamer Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "AssetCooker.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+/// <summary>
+/// A texture to stream in, identified by the TextureLoader slot it is for.
+/// </summary>
+struct StreamRequest
+{
+	uint32_t Index = 0;
+	uint32_t Generation = 0;
+	std::string Path{};
+	bool Flip = true;
+};
+
+/// <summary>
+/// A finished request. The texture is 0 if the image could not be read or decoded.
+/// </summary>
+struct StreamResult
+{
+	uint32_t Index = 0;
+	uint32_t Generation = 0;
+	GLuint ID = 0;
+	glm::ivec2 Size{ 0,0 };
+	uint64_t Bytes = 0;
+};
+
+/// <summary>
+/// Loads 2D textures without stalling the frame.
+/// A pool of worker threads reads the cooked mip chain or decodes the source image and builds its mips,
+/// then Update copies finished images into a persistently mapped ring of pixel buffer segments on the main thread
+/// and uploads them into immutable texture storage with glTexSubImage2D from the buffer.
+/// Each frame fills at most one segment and fences it, and a segment is only written again once the GPU has passed its fence,
+/// so the upload cost per frame is bounded and the CPU never waits on the GPU. Images larger than a frame's segment span several frames.
+/// </summary>
+class TextureStreamer
+{
+public:
+	/// <summary>
+	/// Queues a texture for decoding, starting the workers on first use.
+	/// </summary>
+	/// <param name="_request"></param>
+	static void Request(StreamRequest&& _request);
+
+	/// <summary>
+	/// Uploads decoded images into the current ring segment and appends every request that finished to _finished.
+	/// Must be called once per frame on the thread with the GL context.
+	/// </summary>
+	/// <param name="_finished"></param>
+	static void Update(std::vector<StreamResult>& _finished);
+
+	/// <summary>
+	/// Stops the workers, deletes the textures still being uploaded and frees the ring.
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Returns the number of requested textures that have not finished.
+	/// </summary>
+	/// <returns></returns>
+	static int GetPendingCount();
+
+	/// <summary>
+	/// Returns the GPU memory of an image and the levels it has, drivers store 3 channel texels as 4.
+	/// </summary>
+	/// <param name="_image"></param>
+	/// <returns></returns>
+	static uint64_t GetTextureBytes(const ImageData& _image);
+
+	static const size_t SegmentSize = 16 * 1024 * 1024;
+	static const int SegmentCount = 3;
+
+private:
+	/// <summary>
+	/// A request once a worker has read it. Levels of the image may point into the cooked file, so both are kept together.
+	/// </summary>
+	struct DecodedImage
+	{
+		StreamRequest Request{};
+		FileData Cooked{};
+		ImageData Image{};
+		bool IsDecoded = false;
+	};
+
+	/// <summary>
+	/// A decoded image being uploaded level by level, or row by row for levels larger than a segment. Rows are rows of blocks for compressed images.
+	/// </summary>
+	struct Upload
+	{
+		DecodedImage Decoded{};
+		GLuint ID = 0;
+		int Level = 0;
+		int Row = 0;
+	};
+
+	/// <summary>
+	/// Takes requests off the queue and decodes them until Shutdown.
+	/// </summary>
+	static void DecodeWorker();
+
+	/// <summary>
+	/// Creates the pixel buffer ring and maps it for the lifetime of the streamer.
+	/// </summary>
+	/// <returns></returns>
+	static bool CreateRing();
+
+	/// <summary>
+	/// Copies as much of an upload as fits into the current segment, returning true once every level is uploaded.
+	/// </summary>
+	/// <param name="_upload"></param>
+	/// <param name="_offset"> Where the segment is filled up to, advanced past what was copied </param>
+	/// <returns></returns>
+	static bool UploadLevels(Upload& _upload, size_t& _offset);
+
+	inline static std::vector<std::thread> m_Workers{};
+	inline static std::mutex m_Mutex{};
+	inline static std::condition_variable m_Condition{};
+	inline static std::deque<StreamRequest> m_Requests{};
+	inline static std::vector<DecodedImage> m_Decoded{};
+	inline static bool m_IsStopping{ false };
+
+	inline static std::deque<Upload> m_Uploads{};
+	inline static int m_PendingCount{ 0 };
+
+	inline static GLuint m_Buffer{ 0 };
+	inline static unsigned char* m_Mapped{ nullptr };
+	inline static GLsync m_Fences[SegmentCount]{};
+	inline static int m_Segment{ 0 };
+};
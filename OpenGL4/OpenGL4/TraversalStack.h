@@ -0,0 +1,52 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TraversalStack.h 
+// Description : TraversalStack Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include <vector>
+
+/// <summary>
+/// The stack of nodes still to visit in a tree traversal, shared by the AABBTree and TriangleBVH.
+/// It starts in a fixed array, enough for any balanced tree, and moves to the heap rather than dropping nodes if that runs out.
+/// </summary>
+class TraversalStack
+{
+public:
+	TraversalStack() = default;
+	TraversalStack(const TraversalStack&) = delete;
+	TraversalStack& operator=(const TraversalStack&) = delete;
+
+	bool IsEmpty() const { return m_Size == 0; }
+
+	void Push(int _nodeID)
+	{
+		if (m_Size == m_Capacity)
+			Grow();
+		m_Data[m_Size++] = _nodeID;
+	}
+
+	int Pop() { return m_Data[--m_Size]; }
+
+private:
+	void Grow()
+	{
+		if (m_Heap.empty())
+			m_Heap.assign(m_Inline, m_Inline + m_Size);
+		m_Heap.resize((size_t)m_Capacity * 2);
+		m_Data = m_Heap.data();
+		m_Capacity = (int)m_Heap.size();
+	}
+
+	static const int InlineSize = 256;
+	int m_Inline[InlineSize];
+	int* m_Data{ m_Inline };
+	int m_Size{ 0 };
+	int m_Capacity{ InlineSize };
+	std::vector<int> m_Heap{};
+};
@@ -0,0 +1,533 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TriangleBVH.cpp 
+// Description : TriangleBVH Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "TriangleBVH.h"
+#include "TraversalStack.h"
+#include <immintrin.h>
+#include <future>
+#include <chrono>
+#include <random>
+#include <glm/gtc/constants.hpp>
+
+namespace
+{
+	// Subtrees with more triangles than this are built on their own thread near the top of the tree
+	constexpr int ParallelBuildThreshold = 16384;
+	constexpr int MaxParallelBuildDepth = 4;
+
+	const AABB EmptyBounds{ glm::vec3{ FLT_MAX }, glm::vec3{ -FLT_MAX } };
+
+	inline AABB GrowAABB(const AABB& _aabb, const glm::vec3& _point)
+	{
+		return AABB{ glm::min(_aabb.Min, _point), glm::max(_aabb.Max, _point) };
+	}
+
+	// Avoids infinite reciprocals so the slab test never multiplies 0 by infinity
+	inline float SafeReciprocal(float _value)
+	{
+		const float epsilon = 1e-12f;
+		if (std::abs(_value) < epsilon)
+			_value = _value < 0.0f ? -epsilon : epsilon;
+		return 1.0f / _value;
+	}
+}
+
+void TriangleBVH::Build(const std::vector<Vertex>& _vertices, const std::vector<unsigned int>& _indices)
+{
+	m_Nodes.clear();
+	m_Packets.clear();
+	m_Bounds = EmptyBounds;
+
+	int triangleCount = (int)_indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	m_Vertices = &_vertices;
+	m_Indices = &_indices;
+
+	// Per triangle bounds and centres used by the binning
+	m_TriangleBounds.resize(triangleCount);
+	m_TriangleCentres.resize(triangleCount);
+	m_TriangleOrder.resize(triangleCount);
+	for (int i = 0; i < triangleCount; i++)
+	{
+		const glm::vec3& a = _vertices[_indices[i * 3 + 0]].position;
+		const glm::vec3& b = _vertices[_indices[i * 3 + 1]].position;
+		const glm::vec3& c = _vertices[_indices[i * 3 + 2]].position;
+		m_TriangleBounds[i] = AABB{ glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) };
+		m_TriangleCentres[i] = (m_TriangleBounds[i].Min + m_TriangleBounds[i].Max) * 0.5f;
+		m_TriangleOrder[i] = i;
+	}
+
+	std::vector<BuildNode> buildNodes{};
+	buildNodes.reserve((size_t)triangleCount * 2 / 3 + 1);
+	int root = BuildRecursive(0, triangleCount, 0, buildNodes);
+	m_Bounds = buildNodes[root].Bounds;
+
+	// A leaf root still needs a 4 wide node to hold it
+	if (buildNodes[root].Left == -1)
+	{
+		m_Nodes.emplace_back();
+		TriangleBVHNode& node = m_Nodes.back();
+		for (int lane = 0; lane < 4; lane++)
+		{
+			node.MinX[lane] = node.MinY[lane] = node.MinZ[lane] = FLT_MAX;
+			node.MaxX[lane] = node.MaxY[lane] = node.MaxZ[lane] = -FLT_MAX;
+		}
+		node.MinX[0] = m_Bounds.Min.x; node.MinY[0] = m_Bounds.Min.y; node.MinZ[0] = m_Bounds.Min.z;
+		node.MaxX[0] = m_Bounds.Max.x; node.MaxY[0] = m_Bounds.Max.y; node.MaxZ[0] = m_Bounds.Max.z;
+		node.PacketCounts[0] = (buildNodes[root].Count + 3) / 4;
+		int firstPacket = CreatePackets(buildNodes[root].First, buildNodes[root].Count);
+		m_Nodes[0].Children[0] = firstPacket;
+	}
+	else
+	{
+		Collapse(buildNodes, root);
+	}
+
+	// Build data is not needed for traversal
+	m_Vertices = nullptr;
+	m_Indices = nullptr;
+	m_TriangleBounds = {};
+	m_TriangleCentres = {};
+	m_TriangleOrder = {};
+}
+
+bool TriangleBVH::Intersect(const Ray& _ray, TriangleHit& _hit) const
+{
+	if (m_Nodes.size() == 0)
+		return false;
+
+	const __m128 originX = _mm_set1_ps(_ray.Origin.x);
+	const __m128 originY = _mm_set1_ps(_ray.Origin.y);
+	const __m128 originZ = _mm_set1_ps(_ray.Origin.z);
+	const __m128 directionX = _mm_set1_ps(_ray.Direction.x);
+	const __m128 directionY = _mm_set1_ps(_ray.Direction.y);
+	const __m128 directionZ = _mm_set1_ps(_ray.Direction.z);
+	const __m128 inverseX = _mm_set1_ps(SafeReciprocal(_ray.Direction.x));
+	const __m128 inverseY = _mm_set1_ps(SafeReciprocal(_ray.Direction.y));
+	const __m128 inverseZ = _mm_set1_ps(SafeReciprocal(_ray.Direction.z));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 epsilon = _mm_set1_ps(1e-12f);
+	const __m128 absoluteMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	float closest = _ray.MaxDistance;
+	int closestTriangle = -1;
+	glm::vec2 closestBarycentrics{ 0,0 };
+
+	TraversalStack stack{};
+	stack.Push(0);
+
+	while (!stack.IsEmpty())
+	{
+		const TriangleBVHNode& node = m_Nodes[stack.Pop()];
+
+		// Slab test against all four children at once
+		__m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinX), originX), inverseX);
+		__m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxX), originX), inverseX);
+		__m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinY), originY), inverseY);
+		__m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxY), originY), inverseY);
+		__m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinZ), originZ), inverseZ);
+		__m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxZ), originZ), inverseZ);
+
+		__m128 entry = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), zero));
+		__m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), _mm_set1_ps(closest)));
+		int hitMask = _mm_movemask_ps(_mm_cmple_ps(entry, exit));
+		if (hitMask == 0)
+			continue;
+
+		alignas(16) float entryDistances[4];
+		_mm_store_ps(entryDistances, entry);
+
+		// Leaves are intersected now, inner nodes are pushed far to near so the nearest is visited first
+		int innerChildren[4];
+		float innerDistances[4];
+		int innerCount = 0;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if ((hitMask & (1 << lane)) == 0 || node.Children[lane] == -1)
+				continue;
+
+			if (node.PacketCounts[lane] == 0)
+			{
+				innerChildren[innerCount] = node.Children[lane];
+				innerDistances[innerCount] = entryDistances[lane];
+				innerCount++;
+				continue;
+			}
+
+			for (int packetIndex = node.Children[lane]; packetIndex < node.Children[lane] + node.PacketCounts[lane]; packetIndex++)
+			{
+				const TrianglePacket& packet = m_Packets[packetIndex];
+				__m128 edge1X = _mm_loadu_ps(packet.Edge1X), edge1Y = _mm_loadu_ps(packet.Edge1Y), edge1Z = _mm_loadu_ps(packet.Edge1Z);
+				__m128 edge2X = _mm_loadu_ps(packet.Edge2X), edge2Y = _mm_loadu_ps(packet.Edge2Y), edge2Z = _mm_loadu_ps(packet.Edge2Z);
+
+				// Moller Trumbore, four triangles at a time
+				__m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(directionZ, edge2Y));
+				__m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(directionX, edge2Z));
+				__m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(directionY, edge2X));
+				__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+				__m128 valid = _mm_cmpgt_ps(_mm_and_ps(determinant, absoluteMask), epsilon);
+				__m128 inverseDeterminant = _mm_div_ps(one, determinant);
+
+				__m128 tX = _mm_sub_ps(originX, _mm_loadu_ps(packet.V0X));
+				__m128 tY = _mm_sub_ps(originY, _mm_loadu_ps(packet.V0Y));
+				__m128 tZ = _mm_sub_ps(originZ, _mm_loadu_ps(packet.V0Z));
+				__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tX, pX), _mm_mul_ps(tY, pY)), _mm_mul_ps(tZ, pZ)), inverseDeterminant);
+
+				__m128 qX = _mm_sub_ps(_mm_mul_ps(tY, edge1Z), _mm_mul_ps(tZ, edge1Y));
+				__m128 qY = _mm_sub_ps(_mm_mul_ps(tZ, edge1X), _mm_mul_ps(tX, edge1Z));
+				__m128 qZ = _mm_sub_ps(_mm_mul_ps(tX, edge1Y), _mm_mul_ps(tY, edge1X));
+				__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)), _mm_mul_ps(directionZ, qZ)), inverseDeterminant);
+				__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+				valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+				valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, zero));
+				valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(closest)));
+
+				int triangleMask = _mm_movemask_ps(valid);
+				if (triangleMask == 0)
+					continue;
+
+				alignas(16) float distances[4], us[4], vs[4];
+				_mm_store_ps(distances, t);
+				_mm_store_ps(us, u);
+				_mm_store_ps(vs, v);
+				for (int triangleLane = 0; triangleLane < 4; triangleLane++)
+				{
+					if ((triangleMask & (1 << triangleLane)) && distances[triangleLane] < closest)
+					{
+						closest = distances[triangleLane];
+						closestTriangle = packet.Triangles[triangleLane];
+						closestBarycentrics = { us[triangleLane], vs[triangleLane] };
+					}
+				}
+			}
+		}
+
+		// Sort far to near, at most four so insertion sort
+		for (int i = 1; i < innerCount; i++)
+		{
+			for (int j = i; j > 0 && innerDistances[j] > innerDistances[j - 1]; j--)
+			{
+				std::swap(innerDistances[j], innerDistances[j - 1]);
+				std::swap(innerChildren[j], innerChildren[j - 1]);
+			}
+		}
+		for (int i = 0; i < innerCount; i++)
+		{
+			stack.Push(innerChildren[i]);
+		}
+	}
+
+	if (closestTriangle == -1)
+		return false;
+
+	_hit.Distance = closest;
+	_hit.Triangle = closestTriangle;
+	_hit.Barycentrics = closestBarycentrics;
+	return true;
+}
+
+bool TriangleBVH::IsBuilt() const
+{
+	return m_Nodes.size() > 0;
+}
+
+int TriangleBVH::GetNodeCount() const
+{
+	return (int)m_Nodes.size();
+}
+
+void TriangleBVH::Benchmark(int _triangleCount, int _rayCount)
+{
+	// UV sphere with roughly the requested number of triangles
+	int rings = std::max(2, (int)std::sqrt(_triangleCount / 2.0f));
+	int segments = std::max(3, _triangleCount / (2 * rings));
+	std::vector<Vertex> vertices{};
+	std::vector<unsigned int> indices{};
+	for (int ring = 0; ring <= rings; ring++)
+	{
+		float phi = glm::pi<float>() * ring / rings;
+		for (int segment = 0; segment <= segments; segment++)
+		{
+			float theta = glm::two_pi<float>() * segment / segments;
+			glm::vec3 position{ std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+			vertices.push_back(Vertex{ position, { (float)segment / segments, (float)ring / rings }, position });
+		}
+	}
+	for (int ring = 0; ring < rings; ring++)
+	{
+		for (int segment = 0; segment < segments; segment++)
+		{
+			unsigned int current = ring * (segments + 1) + segment;
+			unsigned int below = current + segments + 1;
+			indices.insert(indices.end(), { current, below, current + 1, current + 1, below, below + 1 });
+		}
+	}
+
+	TriangleBVH bvh{};
+	auto buildStart = std::chrono::high_resolution_clock::now();
+	bvh.Build(vertices, indices);
+	auto buildEnd = std::chrono::high_resolution_clock::now();
+
+	// Rays from outside the sphere aimed at random points near it, so roughly half of them hit
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Ray> rays(_rayCount);
+	for (auto& ray : rays)
+	{
+		glm::vec3 origin{ unit(random), unit(random), unit(random) };
+		ray.Origin = glm::normalize(origin + glm::vec3{ 0.001f }) * 3.0f;
+		ray.Direction = glm::normalize(glm::vec3{ unit(random), unit(random), unit(random) } * 1.4f - ray.Origin);
+	}
+
+	int hits = 0;
+	auto traceStart = std::chrono::high_resolution_clock::now();
+	for (auto& ray : rays)
+	{
+		TriangleHit hit{};
+		if (bvh.Intersect(ray, hit))
+			hits++;
+	}
+	auto traceEnd = std::chrono::high_resolution_clock::now();
+
+	double buildTime = std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+	double traceTime = std::chrono::duration<double>(traceEnd - traceStart).count();
+
+	Print("Triangle BVH Benchmark (" + std::to_string(indices.size() / 3) + " triangles, " + std::to_string(bvh.GetNodeCount()) + " nodes)");
+	Print("Build: " + std::to_string(buildTime) + "ms");
+	Print("Rays: " + std::to_string(_rayCount) + " Hits: " + std::to_string(hits) + " " + std::to_string(_rayCount / traceTime / 1000000.0) + " MRays/s (1 core)");
+}
+
+int TriangleBVH::BuildRecursive(int _first, int _count, int _depth, std::vector<BuildNode>& _nodes)
+{
+	int nodeIndex = (int)_nodes.size();
+	_nodes.emplace_back();
+
+	AABB bounds = EmptyBounds;
+	AABB centreBounds = EmptyBounds;
+	for (int i = _first; i < _first + _count; i++)
+	{
+		int triangle = m_TriangleOrder[i];
+		bounds = MergeAABB(bounds, m_TriangleBounds[triangle]);
+		centreBounds = GrowAABB(centreBounds, m_TriangleCentres[triangle]);
+	}
+	_nodes[nodeIndex].Bounds = bounds;
+	_nodes[nodeIndex].First = _first;
+	_nodes[nodeIndex].Count = _count;
+
+	// A single packet tests up to four triangles for the price of one
+	if (_count <= 4)
+		return nodeIndex;
+
+	// Binned surface area heuristic over all three axes
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = FLT_MAX;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centreBounds.Max[axis] - centreBounds.Min[axis];
+		if (extent <= 0.0f)
+			continue;
+
+		AABB binBounds[BinCount];
+		int binCounts[BinCount]{};
+		std::fill(std::begin(binBounds), std::end(binBounds), EmptyBounds);
+
+		float scale = BinCount / extent;
+		for (int i = _first; i < _first + _count; i++)
+		{
+			int triangle = m_TriangleOrder[i];
+			int bin = std::min(BinCount - 1, (int)((m_TriangleCentres[triangle][axis] - centreBounds.Min[axis]) * scale));
+			binBounds[bin] = MergeAABB(binBounds[bin], m_TriangleBounds[triangle]);
+			binCounts[bin]++;
+		}
+
+		// Sweep from the right to get the cost of everything after each split
+		float rightCosts[BinCount]{};
+		AABB rightBounds = EmptyBounds;
+		int rightCount = 0;
+		for (int bin = BinCount - 1; bin > 0; bin--)
+		{
+			rightBounds = MergeAABB(rightBounds, binBounds[bin]);
+			rightCount += binCounts[bin];
+			rightCosts[bin - 1] = rightCount > 0 ? rightCount * SurfaceArea(rightBounds) : 0.0f;
+		}
+
+		AABB leftBounds = EmptyBounds;
+		int leftCount = 0;
+		for (int bin = 0; bin < BinCount - 1; bin++)
+		{
+			leftBounds = MergeAABB(leftBounds, binBounds[bin]);
+			leftCount += binCounts[bin];
+			if (leftCount == 0 || leftCount == _count)
+				continue;
+
+			float cost = leftCount * SurfaceArea(leftBounds) + rightCosts[bin];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = bin;
+			}
+		}
+	}
+
+	// Traversal and intersection cost are both 1, so a leaf costs its triangle count
+	float area = SurfaceArea(bounds);
+	float splitCost = 1.0f + (area > 0.0f ? bestCost / area : 0.0f);
+	if (_count <= MaxLeafTriangles && (bestAxis == -1 || (float)_count <= splitCost))
+		return nodeIndex;
+
+	int middle = _first;
+	if (bestAxis != -1)
+	{
+		float scale = BinCount / (centreBounds.Max[bestAxis] - centreBounds.Min[bestAxis]);
+		float minimum = centreBounds.Min[bestAxis];
+		int axis = bestAxis;
+		middle = (int)(std::partition(m_TriangleOrder.begin() + _first, m_TriangleOrder.begin() + _first + _count, [&](int _triangle)
+			{
+				return std::min(BinCount - 1, (int)((m_TriangleCentres[_triangle][axis] - minimum) * scale)) <= bestSplit;
+			}) - m_TriangleOrder.begin());
+	}
+
+	// No useful split (e.g. every centre is the same), fall back to halving along the longest axis
+	if (middle == _first || middle == _first + _count)
+	{
+		glm::vec3 extent = centreBounds.Max - centreBounds.Min;
+		int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+		middle = _first + _count / 2;
+		std::nth_element(m_TriangleOrder.begin() + _first, m_TriangleOrder.begin() + middle, m_TriangleOrder.begin() + _first + _count, [&](int _a, int _b)
+			{
+				return m_TriangleCentres[_a][axis] < m_TriangleCentres[_b][axis];
+			});
+	}
+
+	int left = -1, right = -1;
+	if (_count >= ParallelBuildThreshold && _depth < MaxParallelBuildDepth)
+	{
+		// The right half builds into its own list on another thread, then is appended
+		std::vector<BuildNode> rightNodes{};
+		auto rightBuild = std::async(std::launch::async, [&]()
+			{
+				return BuildRecursive(middle, _first + _count - middle, _depth + 1, rightNodes);
+			});
+		left = BuildRecursive(_first, middle - _first, _depth + 1, _nodes);
+		int rightRoot = rightBuild.get();
+
+		int offset = (int)_nodes.size();
+		for (auto& node : rightNodes)
+		{
+			if (node.Left != -1)
+			{
+				node.Left += offset;
+				node.Right += offset;
+			}
+			_nodes.push_back(node);
+		}
+		right = rightRoot + offset;
+	}
+	else
+	{
+		left = BuildRecursive(_first, middle - _first, _depth + 1, _nodes);
+		right = BuildRecursive(middle, _first + _count - middle, _depth + 1, _nodes);
+	}
+
+	_nodes[nodeIndex].Left = left;
+	_nodes[nodeIndex].Right = right;
+	_nodes[nodeIndex].Count = 0;
+	return nodeIndex;
+}
+
+int TriangleBVH::Collapse(const std::vector<BuildNode>& _nodes, int _nodeIndex)
+{
+	// Pull grandchildren up until there are four children, opening the largest inner child first
+	int children[4] = { _nodes[_nodeIndex].Left, _nodes[_nodeIndex].Right, -1, -1 };
+	int childCount = 2;
+	while (childCount < 4)
+	{
+		int largest = -1;
+		float largestArea = -1.0f;
+		for (int i = 0; i < childCount; i++)
+		{
+			const BuildNode& child = _nodes[children[i]];
+			if (child.Left != -1 && SurfaceArea(child.Bounds) > largestArea)
+			{
+				largest = i;
+				largestArea = SurfaceArea(child.Bounds);
+			}
+		}
+		if (largest == -1)
+			break;
+
+		int opened = children[largest];
+		children[largest] = _nodes[opened].Left;
+		children[childCount++] = _nodes[opened].Right;
+	}
+
+	int wideIndex = (int)m_Nodes.size();
+	m_Nodes.emplace_back();
+	for (int lane = 0; lane < 4; lane++)
+	{
+		AABB bounds = lane < childCount ? _nodes[children[lane]].Bounds : EmptyBounds;
+		m_Nodes[wideIndex].MinX[lane] = bounds.Min.x;
+		m_Nodes[wideIndex].MinY[lane] = bounds.Min.y;
+		m_Nodes[wideIndex].MinZ[lane] = bounds.Min.z;
+		m_Nodes[wideIndex].MaxX[lane] = bounds.Max.x;
+		m_Nodes[wideIndex].MaxY[lane] = bounds.Max.y;
+		m_Nodes[wideIndex].MaxZ[lane] = bounds.Max.z;
+	}
+
+	for (int lane = 0; lane < childCount; lane++)
+	{
+		const BuildNode& child = _nodes[children[lane]];
+		if (child.Left == -1)
+		{
+			int firstPacket = CreatePackets(child.First, child.Count);
+			m_Nodes[wideIndex].Children[lane] = firstPacket;
+			m_Nodes[wideIndex].PacketCounts[lane] = (child.Count + 3) / 4;
+		}
+		else
+		{
+			int childIndex = Collapse(_nodes, children[lane]);
+			m_Nodes[wideIndex].Children[lane] = childIndex;
+			m_Nodes[wideIndex].PacketCounts[lane] = 0;
+		}
+	}
+
+	return wideIndex;
+}
+
+int TriangleBVH::CreatePackets(int _first, int _count)
+{
+	int firstPacket = (int)m_Packets.size();
+	for (int i = 0; i < _count; i += 4)
+	{
+		TrianglePacket packet{};
+		for (int lane = 0; lane < 4 && i + lane < _count; lane++)
+		{
+			int triangle = m_TriangleOrder[_first + i + lane];
+			const glm::vec3& a = (*m_Vertices)[(*m_Indices)[triangle * 3 + 0]].position;
+			const glm::vec3& b = (*m_Vertices)[(*m_Indices)[triangle * 3 + 1]].position;
+			const glm::vec3& c = (*m_Vertices)[(*m_Indices)[triangle * 3 + 2]].position;
+
+			packet.V0X[lane] = a.x; packet.V0Y[lane] = a.y; packet.V0Z[lane] = a.z;
+			packet.Edge1X[lane] = b.x - a.x; packet.Edge1Y[lane] = b.y - a.y; packet.Edge1Z[lane] = b.z - a.z;
+			packet.Edge2X[lane] = c.x - a.x; packet.Edge2Y[lane] = c.y - a.y; packet.Edge2Z[lane] = c.z - a.z;
+			packet.Triangles[lane] = triangle;
+		}
+		m_Packets.push_back(packet);
+	}
+	return firstPacket;
+}
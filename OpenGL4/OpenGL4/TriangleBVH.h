@@ -0,0 +1,145 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : TriangleBVH.h 
+// Description : TriangleBVH Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// The closest triangle hit by a ray.
+/// Barycentrics are the weights of the triangles second and third vertex.
+/// </summary>
+struct TriangleHit
+{
+	float Distance = FLT_MAX;
+	int Triangle = -1;
+	glm::vec2 Barycentrics{ 0,0 };
+};
+
+/// <summary>
+/// Four BVH children stored structure of arrays so their boxes are tested with one SIMD instruction per slab.
+/// A child with a packet count of 0 is an inner node, otherwise it is a leaf of that many triangle packets.
+/// </summary>
+struct TriangleBVHNode
+{
+	float MinX[4]{}, MinY[4]{}, MinZ[4]{};
+	float MaxX[4]{}, MaxY[4]{}, MaxZ[4]{};
+	int Children[4]{ -1, -1, -1, -1 };
+	int PacketCounts[4]{};
+};
+
+/// <summary>
+/// Four triangles stored as a vertex and two edges, structure of arrays, for a 4 wide ray/triangle test.
+/// Unused lanes have a triangle index of -1 and zero edges so they never hit.
+/// </summary>
+struct TrianglePacket
+{
+	float V0X[4]{}, V0Y[4]{}, V0Z[4]{};
+	float Edge1X[4]{}, Edge1Y[4]{}, Edge1Z[4]{};
+	float Edge2X[4]{}, Edge2Y[4]{}, Edge2Z[4]{};
+	int Triangles[4]{ -1, -1, -1, -1 };
+};
+
+/// <summary>
+/// Bounding volume hierarchy over the triangles of a mesh.
+/// Built top down with a binned surface area heuristic, large subtrees are built in parallel,
+/// then collapsed to a 4 wide tree so traversal tests four boxes or four triangles at a time with SSE.
+/// </summary>
+class TriangleBVH
+{
+public:
+	/// <summary>
+	/// Builds the hierarchy over the given triangles, replacing any previous build.
+	/// </summary>
+	/// <param name="_vertices"></param>
+	/// <param name="_indices"></param>
+	void Build(const std::vector<Vertex>& _vertices, const std::vector<unsigned int>& _indices);
+
+	/// <summary>
+	/// Finds the closest triangle along the ray within its max distance.
+	/// Returns true and fills _hit if a triangle was hit.
+	/// </summary>
+	/// <param name="_ray"></param>
+	/// <param name="_hit"></param>
+	/// <returns></returns>
+	bool Intersect(const Ray& _ray, TriangleHit& _hit) const;
+
+	/// <summary>
+	/// Returns true if the hierarchy has been built over at least one triangle.
+	/// </summary>
+	/// <returns></returns>
+	bool IsBuilt() const;
+
+	/// <summary>
+	/// Returns the number of 4 wide nodes.
+	/// </summary>
+	/// <returns></returns>
+	int GetNodeCount() const;
+
+	/// <summary>
+	/// Builds a hierarchy over a procedural sphere and prints the build time and single threaded rays per second.
+	/// </summary>
+	/// <param name="_triangleCount"></param>
+	/// <param name="_rayCount"></param>
+	static void Benchmark(int _triangleCount = 1000000, int _rayCount = 1000000);
+
+	static const int MaxLeafTriangles = 8;
+	static const int BinCount = 16;
+
+private:
+	/// <summary>
+	/// A node of the binary hierarchy built before collapsing.
+	/// </summary>
+	struct BuildNode
+	{
+		AABB Bounds{};
+		int Left = -1;
+		int Right = -1;
+		int First = 0;
+		int Count = 0;
+	};
+
+	/// <summary>
+	/// Recursively builds the binary hierarchy over the triangle order range into _nodes and returns the index of its root.
+	/// Subtrees with enough triangles are built on another thread into their own node list and appended.
+	/// </summary>
+	/// <param name="_first"></param>
+	/// <param name="_count"></param>
+	/// <param name="_depth"></param>
+	/// <param name="_nodes"></param>
+	/// <returns></returns>
+	int BuildRecursive(int _first, int _count, int _depth, std::vector<BuildNode>& _nodes);
+
+	/// <summary>
+	/// Collapses the binary node into a 4 wide node and returns its index.
+	/// </summary>
+	/// <param name="_nodes"></param>
+	/// <param name="_nodeIndex"></param>
+	/// <returns></returns>
+	int Collapse(const std::vector<BuildNode>& _nodes, int _nodeIndex);
+
+	/// <summary>
+	/// Packs the ordered triangles of a binary leaf into packets and returns the index of the first.
+	/// </summary>
+	/// <param name="_first"></param>
+	/// <param name="_count"></param>
+	/// <returns></returns>
+	int CreatePackets(int _first, int _count);
+
+	std::vector<TriangleBVHNode> m_Nodes{};
+	std::vector<TrianglePacket> m_Packets{};
+	AABB m_Bounds{};
+
+	// Build only
+	const std::vector<Vertex>* m_Vertices = nullptr;
+	const std::vector<unsigned int>* m_Indices = nullptr;
+	std::vector<AABB> m_TriangleBounds{};
+	std::vector<glm::vec3> m_TriangleCentres{};
+	std::vector<int> m_TriangleOrder{};
+};
@@ -0,0 +1,383 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : VirtualFileSystem.cpp 
+// Description : VirtualFileSystem Implementation File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#include "VirtualFileSystem.h"
+#include "StringID.h"
+#include "LZ4.h"
+#include <filesystem>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Entry data is aligned so a stored file can be read in place as any type
+	const uint64_t DataAlignment = 16;
+
+	// Larger compressed files are assumed to be corrupt rather than allocated for
+	const uint64_t MaxDecompressedSize = 1ull << 31;
+}
+
+FileData::FileData(FileData&& _other) noexcept
+{
+	*this = std::move(_other);
+}
+
+FileData& FileData::operator=(FileData&& _other) noexcept
+{
+	// Moving the vector keeps its buffer, so a pointer into it stays valid
+	m_Data = _other.m_Data;
+	m_Size = _other.m_Size;
+	m_Storage = std::move(_other.m_Storage);
+	m_IsValid = _other.m_IsValid;
+	_other.m_Data = nullptr;
+	_other.m_Size = 0;
+	_other.m_IsValid = false;
+	return *this;
+}
+
+bool VirtualFileSystem::MountDirectory(std::string_view _directory)
+{
+	std::error_code error{};
+	if (!std::filesystem::is_directory(_directory, error))
+		return false;
+
+	Mount mount{};
+	mount.Root = std::string(_directory);
+	if (!mount.Root.empty() && mount.Root.back() != '/' && mount.Root.back() != '\\')
+		mount.Root += '/';
+	m_Mounts.push_back(std::move(mount));
+	return true;
+}
+
+bool VirtualFileSystem::MountPack(std::string_view _packPath)
+{
+	Mount mount{};
+	mount.Root = std::string(_packPath);
+	if (!MapFile(mount.Root, mount.Pack))
+		return false;
+
+	// Everything the index points at must lie inside the mapping
+	const MappedFile& pack = mount.Pack;
+	const PackHeader* header = (const PackHeader*)pack.Data;
+	bool isValid = pack.Size >= sizeof(PackHeader) && header->Magic == PackMagic && header->Version == PackVersion
+		&& sizeof(PackHeader) + (uint64_t)header->EntryCount * sizeof(PackEntry) <= header->PathsOffset
+		&& header->PathsOffset <= header->DataOffset && header->DataOffset <= pack.Size;
+	const PackEntry* entries = (const PackEntry*)(pack.Data + sizeof(PackHeader));
+	for (uint32_t i = 0; isValid && i < header->EntryCount; i++)
+	{
+		const PackEntry& entry = entries[i];
+		isValid = header->PathsOffset + entry.PathOffset + entry.PathLength <= header->DataOffset
+			&& entry.Offset >= header->DataOffset && entry.Offset <= pack.Size && entry.StoredSize <= pack.Size - entry.Offset
+			&& (entry.Compression == PackCompression::LZ4 || (entry.Compression == PackCompression::None && entry.StoredSize == entry.Size));
+		// Reading a compressed file allocates its decompressed size up front, so that has to be plausible too
+		if (isValid && entry.Compression == PackCompression::LZ4)
+			isValid = entry.Size <= MaxDecompressedSize && entry.Size <= LZ4::GetDecompressBound((size_t)entry.StoredSize);
+	}
+	if (!isValid)
+	{
+		Print("Invalid asset pack " + mount.Root);
+		UnmapFile(mount.Pack);
+		return false;
+	}
+
+	mount.Header = header;
+	mount.Entries = entries;
+	m_Mounts.push_back(std::move(mount));
+	return true;
+}
+
+void VirtualFileSystem::Unmount()
+{
+	for (auto& mount : m_Mounts)
+	{
+		UnmapFile(mount.Pack);
+	}
+	m_Mounts.clear();
+}
+
+FileData VirtualFileSystem::ReadFile(std::string_view _path)
+{
+	// Loose files keep the path as given for file systems that are case sensitive
+	std::string path = NormalizePath(_path);
+	FileData data{};
+	for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); mount++)
+	{
+		if (!mount->Header)
+		{
+			if (ReadLooseFile(mount->Root + std::string(_path), data))
+				return data;
+			continue;
+		}
+
+		const PackEntry* entry = FindEntry(*mount, path);
+		if (!entry)
+			continue;
+
+		const unsigned char* stored = mount->Pack.Data + entry->Offset;
+		if (entry->Compression == PackCompression::None)
+		{
+			data.m_Data = stored;
+			data.m_Size = (size_t)entry->Size;
+			data.m_IsValid = true;
+			return data;
+		}
+
+		data.m_Storage.resize((size_t)entry->Size);
+		if (!LZ4::Decompress(stored, (size_t)entry->StoredSize, data.m_Storage.data(), data.m_Storage.size()))
+		{
+			Print("Corrupt file " + path + " in asset pack " + mount->Root);
+			return FileData{};
+		}
+		data.m_Data = data.m_Storage.data();
+		data.m_Size = data.m_Storage.size();
+		data.m_IsValid = true;
+		return data;
+	}
+	return data;
+}
+
+bool VirtualFileSystem::Exists(std::string_view _path)
+{
+	std::string path = NormalizePath(_path);
+	for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); mount++)
+	{
+		std::error_code error{};
+		if (mount->Header ? FindEntry(*mount, path) != nullptr : std::filesystem::is_regular_file(mount->Root + std::string(_path), error))
+			return true;
+	}
+	return false;
+}
+
+bool VirtualFileSystem::WritePack(std::string_view _directory, std::string_view _packPath, const std::vector<std::string>& _excludedDirectories)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Gather the files with their normalized paths relative to the directory
+	std::vector<std::pair<std::string, std::filesystem::path>> files{};
+	std::error_code error{};
+	std::filesystem::path root{ _directory };
+	auto iterator = std::filesystem::recursive_directory_iterator(root, error);
+	if (error)
+	{
+		Print("Could not read directory " + std::string(_directory));
+		return false;
+	}
+	for (auto file = std::filesystem::begin(iterator); file != std::filesystem::end(iterator); file.increment(error))
+	{
+		if (error)
+			break;
+		std::string name = file->path().filename().string();
+		if (file->is_directory(error) && std::find(_excludedDirectories.begin(), _excludedDirectories.end(), name) != _excludedDirectories.end())
+		{
+			file.disable_recursion_pending();
+			continue;
+		}
+		if (file->is_regular_file(error))
+			files.emplace_back(NormalizePath(std::filesystem::relative(file->path(), root, error).generic_string()), file->path());
+	}
+
+	// Sorted by hash so lookups can binary search the index
+	std::sort(files.begin(), files.end(), [](const auto& _a, const auto& _b)
+		{
+			return StringID::Hash(_a.first) < StringID::Hash(_b.first);
+		});
+
+	PackHeader header{};
+	header.EntryCount = (uint32_t)files.size();
+	std::vector<PackEntry> entries(files.size());
+	std::string paths{};
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		entries[i].PathHash = StringID::Hash(files[i].first);
+		entries[i].PathOffset = (uint32_t)paths.size();
+		entries[i].PathLength = (uint32_t)files[i].first.size();
+		paths += files[i].first;
+	}
+	header.PathsOffset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+	header.DataOffset = (header.PathsOffset + paths.size() + DataAlignment - 1) / DataAlignment * DataAlignment;
+
+	std::ofstream fileStream(std::string(_packPath), std::ios::binary);
+	if (!fileStream.is_open())
+	{
+		Print("Could not write asset pack " + std::string(_packPath));
+		return false;
+	}
+
+	// Data first so each entry knows its final size, then the header, index and paths at the front
+	fileStream.seekp((std::streamoff)header.DataOffset);
+	uint64_t offset = header.DataOffset;
+	uint64_t totalSize = 0;
+	std::vector<unsigned char> compressed{};
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		FileData loose{};
+		if (!ReadLooseFile(files[i].second.string(), loose))
+		{
+			Print("Could not read " + files[i].second.string());
+			return false;
+		}
+
+		compressed.resize(LZ4::GetCompressBound(loose.GetSize()));
+		size_t compressedSize = LZ4::Compress(loose.GetData(), loose.GetSize(), compressed.data(), compressed.size());
+		bool isCompressed = compressedSize > 0 && compressedSize < loose.GetSize();
+
+		PackEntry& entry = entries[i];
+		entry.Offset = offset;
+		entry.Size = loose.GetSize();
+		entry.StoredSize = isCompressed ? compressedSize : loose.GetSize();
+		entry.Compression = isCompressed ? PackCompression::LZ4 : PackCompression::None;
+		fileStream.write((const char*)(isCompressed ? compressed.data() : loose.GetData()), (std::streamsize)entry.StoredSize);
+
+		uint64_t padding = (DataAlignment - entry.StoredSize % DataAlignment) % DataAlignment;
+		const char zeros[DataAlignment]{};
+		fileStream.write(zeros, (std::streamsize)padding);
+		offset += entry.StoredSize + padding;
+		totalSize += entry.Size;
+	}
+
+	fileStream.seekp(0);
+	fileStream.write((const char*)&header, sizeof(header));
+	fileStream.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(PackEntry)));
+	fileStream.write(paths.data(), (std::streamsize)paths.size());
+	if (!fileStream.good())
+	{
+		Print("Could not write asset pack " + std::string(_packPath));
+		return false;
+	}
+
+	double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	Print("Packed " + std::to_string(files.size()) + " files, " + std::to_string(totalSize / 1024) + "KB to " + std::to_string(offset / 1024)
+		+ "KB in " + std::to_string((int)time) + "ms");
+	return true;
+}
+
+std::string VirtualFileSystem::NormalizePath(std::string_view _path)
+{
+	std::string path(_path);
+	for (char& character : path)
+	{
+		if (character == '\\')
+			character = '/';
+		else if (character >= 'A' && character <= 'Z')
+			character = character - 'A' + 'a';
+	}
+	return path;
+}
+
+const VirtualFileSystem::PackEntry* VirtualFileSystem::FindEntry(const Mount& _mount, std::string_view _path)
+{
+	uint64_t hash = StringID::Hash(_path);
+	const PackEntry* first = _mount.Entries;
+	const PackEntry* last = _mount.Entries + _mount.Header->EntryCount;
+	const PackEntry* entry = std::lower_bound(first, last, hash, [](const PackEntry& _entry, uint64_t _hash)
+		{
+			return _entry.PathHash < _hash;
+		});
+
+	// The stored path settles the rare paths that share a hash
+	const char* paths = (const char*)(_mount.Pack.Data + _mount.Header->PathsOffset);
+	for (; entry != last && entry->PathHash == hash; entry++)
+	{
+		if (std::string_view{ paths + entry->PathOffset, entry->PathLength } == _path)
+			return entry;
+	}
+	return nullptr;
+}
+
+bool VirtualFileSystem::ReadLooseFile(const std::string& _filePath, FileData& _data)
+{
+	std::ifstream fileStream(_filePath, std::ios::binary | std::ios::ate);
+	if (!fileStream.is_open())
+		return false;
+
+	std::streamsize size = fileStream.tellg();
+	if (size < 0)
+		return false;
+	fileStream.seekg(0);
+	_data.m_Storage.resize((size_t)size);
+	if (size > 0 && !fileStream.read((char*)_data.m_Storage.data(), size))
+		return false;
+
+	_data.m_Data = _data.m_Storage.data();
+	_data.m_Size = _data.m_Storage.size();
+	_data.m_IsValid = true;
+	return true;
+}
+
+bool VirtualFileSystem::MapFile(const std::string& _filePath, MappedFile& _file)
+{
+	_file = {};
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+	HANDLE mappingHandle = GetFileSizeEx(fileHandle, &size) && size.QuadPart > 0 ? CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	void* data = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!data)
+	{
+		if (mappingHandle)
+			CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	// Fault the whole pack in with large sequential reads instead of a page at a time as files are read
+	WIN32_MEMORY_RANGE_ENTRY range{ data, (SIZE_T)size.QuadPart };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+
+	_file.Data = (const unsigned char*)data;
+	_file.Size = (size_t)size.QuadPart;
+	_file.FileHandle = fileHandle;
+	_file.MappingHandle = mappingHandle;
+#else
+	int descriptor = open(_filePath.c_str(), O_RDONLY);
+	if (descriptor < 0)
+		return false;
+
+	struct stat status{};
+	void* data = fstat(descriptor, &status) == 0 && status.st_size > 0 ? mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0) : MAP_FAILED;
+	close(descriptor);
+	if (data == MAP_FAILED)
+		return false;
+
+	// Fault the whole pack in with large sequential reads instead of a page at a time as files are read
+	madvise(data, (size_t)status.st_size, MADV_WILLNEED);
+
+	_file.Data = (const unsigned char*)data;
+	_file.Size = (size_t)status.st_size;
+#endif
+	return true;
+}
+
+void VirtualFileSystem::UnmapFile(MappedFile& _file)
+{
+	if (!_file.Data)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(_file.Data);
+	CloseHandle((HANDLE)_file.MappingHandle);
+	CloseHandle((HANDLE)_file.FileHandle);
+#else
+	munmap((void*)_file.Data, _file.Size);
+#endif
+	_file = {};
+}
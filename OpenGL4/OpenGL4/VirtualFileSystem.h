@@ -0,0 +1,192 @@
+// Bachelor of Software Engineering 
+// Media Design School 
+// Auckland 
+// New Zealand 
+// (c) Media Design School
+// File Name : VirtualFileSystem.h 
+// Description : VirtualFileSystem Header File
+// Author : William Inman
+// Mail : william.inman@mds.ac.nz
+
+#pragma once
+#include "Helper.h"
+
+/// <summary>
+/// The contents of a file read through the VirtualFileSystem.
+/// Stored files of a pack point straight into its mapping, everything else owns a buffer.
+/// </summary>
+class FileData
+{
+public:
+	FileData() = default;
+	FileData(FileData&& _other) noexcept;
+	FileData& operator=(FileData&& _other) noexcept;
+	FileData(const FileData&) = delete;
+	FileData& operator=(const FileData&) = delete;
+
+	/// <summary>
+	/// Returns true if the file was found and read.
+	/// </summary>
+	/// <returns></returns>
+	bool IsValid() const { return m_IsValid; }
+
+	const unsigned char* GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Size; }
+
+	/// <summary>
+	/// Returns the contents as text.
+	/// </summary>
+	/// <returns></returns>
+	std::string_view GetText() const { return { (const char*)m_Data, m_Size }; }
+
+private:
+	friend class VirtualFileSystem;
+
+	const unsigned char* m_Data{ nullptr };
+	size_t m_Size{ 0 };
+	std::vector<unsigned char> m_Storage{};
+	bool m_IsValid{ false };
+};
+
+/// <summary>
+/// Read only file system the loaders go through instead of opening files themselves.
+/// Loose directories and packs are mounted at startup and searched newest mount first,
+/// so a loose directory mounted after a pack overrides single files during development.
+/// Paths are relative to the mount and use forward slashes, such as "Shaders/UnlitColor.frag". Lookups in packs are not case sensitive.
+///
+/// A pack is one file holding a header, an index of entries sorted by path hash, the paths and then the file data.
+/// Packs are memory mapped, found entries are binary searched, and files are LZ4 compressed unless that did not
+/// make them smaller, in which case reads return a pointer into the mapping without copying.
+/// Mounting is not thread safe but reading from mounted packs and directories is.
+/// </summary>
+class VirtualFileSystem
+{
+public:
+	/// <summary>
+	/// Mounts a directory of loose files. Returns false if it does not exist.
+	/// </summary>
+	/// <param name="_directory"></param>
+	/// <returns></returns>
+	static bool MountDirectory(std::string_view _directory);
+
+	/// <summary>
+	/// Maps a pack written by WritePack and mounts it. Returns false if it is missing or invalid.
+	/// </summary>
+	/// <param name="_packPath"></param>
+	/// <returns></returns>
+	static bool MountPack(std::string_view _packPath);
+
+	/// <summary>
+	/// Unmounts everything and unmaps the packs. FileData pointing into a pack must not be used afterwards.
+	/// </summary>
+	static void Unmount();
+
+	/// <summary>
+	/// Reads a whole file from the newest mount that has it. The result is invalid if no mount has it.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <returns></returns>
+	static FileData ReadFile(std::string_view _path);
+
+	/// <summary>
+	/// Returns true if a mount has the file.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <returns></returns>
+	static bool Exists(std::string_view _path);
+
+	/// <summary>
+	/// Packs every file under a directory, skipping any directory with one of the excluded names.
+	/// Returns false if the directory could not be read or the pack not written.
+	/// </summary>
+	/// <param name="_directory"></param>
+	/// <param name="_packPath"></param>
+	/// <param name="_excludedDirectories"></param>
+	/// <returns></returns>
+	static bool WritePack(std::string_view _directory, std::string_view _packPath, const std::vector<std::string>& _excludedDirectories = {});
+
+	/// <summary>
+	/// Lowercases a path and converts back slashes so every spelling of a path hashes the same.
+	/// </summary>
+	/// <param name="_path"></param>
+	/// <returns></returns>
+	static std::string NormalizePath(std::string_view _path);
+
+	static const uint32_t PackMagic = 0x4B415047; // "GPAK"
+	static const uint32_t PackVersion = 1;
+
+private:
+	struct PackHeader
+	{
+		uint32_t Magic = PackMagic;
+		uint32_t Version = PackVersion;
+		uint32_t EntryCount = 0;
+		uint32_t Reserved = 0;
+		uint64_t PathsOffset = 0;
+		uint64_t DataOffset = 0;
+	};
+
+	enum class PackCompression : uint32_t
+	{
+		None,
+		LZ4,
+	};
+
+	/// <summary>
+	/// A file in a pack, the index is an array of these sorted by PathHash.
+	/// </summary>
+	struct PackEntry
+	{
+		uint64_t PathHash = 0;
+		uint64_t Offset = 0;
+		uint64_t StoredSize = 0;
+		uint64_t Size = 0;
+		uint32_t PathOffset = 0;
+		uint32_t PathLength = 0;
+		PackCompression Compression = PackCompression::None;
+		uint32_t Reserved = 0;
+	};
+
+	/// <summary>
+	/// A read only mapping of a whole file.
+	/// </summary>
+	struct MappedFile
+	{
+		const unsigned char* Data = nullptr;
+		size_t Size = 0;
+		void* FileHandle = nullptr;
+		void* MappingHandle = nullptr;
+	};
+
+	/// <summary>
+	/// A mounted directory or pack. Packs have a mapping, directories only a root.
+	/// </summary>
+	struct Mount
+	{
+		std::string Root{};
+		MappedFile Pack{};
+		const PackHeader* Header = nullptr;
+		const PackEntry* Entries = nullptr;
+	};
+
+	/// <summary>
+	/// Returns the entry of a normalized path in a pack, or nullptr.
+	/// </summary>
+	/// <param name="_mount"></param>
+	/// <param name="_path"></param>
+	/// <returns></returns>
+	static const PackEntry* FindEntry(const Mount& _mount, std::string_view _path);
+
+	/// <summary>
+	/// Reads a whole loose file with a single read.
+	/// </summary>
+	/// <param name="_filePath"></param>
+	/// <param name="_data"></param>
+	/// <returns></returns>
+	static bool ReadLooseFile(const std::string& _filePath, FileData& _data);
+
+	static bool MapFile(const std::string& _filePath, MappedFile& _file);
+	static void UnmapFile(MappedFile& _file);
+
+	inline static std::vector<Mount> m_Mounts{};
+};